@@ -0,0 +1,66 @@
+#include "common/allocation_counter.h"
+
+#include <atomic>
+#include <cstddef>
+
+namespace dairlib {
+namespace {
+std::atomic<int64_t> num_allocations{0};
+}  // namespace
+
+int64_t AllocationCounter::GetTotal() {
+  return num_allocations.load(std::memory_order_relaxed);
+}
+
+#ifdef __GLIBC__
+
+bool AllocationCounter::is_supported() { return true; }
+
+}  // namespace dairlib
+
+// glibc's allocator entry points, which the replacements forward to
+extern "C" {
+void* __libc_malloc(size_t size);
+void* __libc_calloc(size_t count, size_t size);
+void* __libc_realloc(void* ptr, size_t size);
+void* __libc_memalign(size_t alignment, size_t size);
+
+void* malloc(size_t size) {
+  dairlib::num_allocations.fetch_add(1, std::memory_order_relaxed);
+  return __libc_malloc(size);
+}
+
+void* calloc(size_t count, size_t size) {
+  dairlib::num_allocations.fetch_add(1, std::memory_order_relaxed);
+  return __libc_calloc(count, size);
+}
+
+void* realloc(void* ptr, size_t size) {
+  dairlib::num_allocations.fetch_add(1, std::memory_order_relaxed);
+  return __libc_realloc(ptr, size);
+}
+
+void* memalign(size_t alignment, size_t size) {
+  dairlib::num_allocations.fetch_add(1, std::memory_order_relaxed);
+  return __libc_memalign(alignment, size);
+}
+
+void* aligned_alloc(size_t alignment, size_t size) {
+  dairlib::num_allocations.fetch_add(1, std::memory_order_relaxed);
+  return __libc_memalign(alignment, size);
+}
+
+int posix_memalign(void** ptr, size_t alignment, size_t size) {
+  dairlib::num_allocations.fetch_add(1, std::memory_order_relaxed);
+  *ptr = __libc_memalign(alignment, size);
+  return *ptr ? 0 : 12 /* ENOMEM */;
+}
+}  // extern "C"
+
+#else
+
+bool AllocationCounter::is_supported() { return false; }
+
+}  // namespace dairlib
+
+#endif
@@ -0,0 +1,31 @@
+#pragma once
+
+#include <cstdint>
+
+namespace dairlib {
+
+/// Counts the heap allocations of the process, for benchmarks.
+///
+/// Linking the allocation_counter library replaces malloc and its variants
+/// (which operator new and Eigen allocate through) with versions that count
+/// the calls. The counts are global to the process, so threads allocating
+/// concurrently with the measured code are counted as well. Only supported
+/// with glibc; elsewhere is_supported() is false and the counts stay zero.
+class AllocationCounter {
+ public:
+  /// Starts counting from the current number of allocations
+  AllocationCounter() : start_(GetTotal()) {}
+
+  /// Allocations since construction, or the last Reset()
+  int64_t count() const { return GetTotal() - start_; }
+  void Reset() { start_ = GetTotal(); }
+
+  /// Allocations since the start of the process
+  static int64_t GetTotal();
+  static bool is_supported();
+
+ private:
+  int64_t start_;
+};
+
+}  // namespace dairlib
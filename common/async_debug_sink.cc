@@ -0,0 +1,160 @@
+#include "common/async_debug_sink.h"
+
+#include <iostream>
+
+#include "drake/common/drake_assert.h"
+
+namespace dairlib {
+
+using std::chrono::duration_cast;
+using std::chrono::nanoseconds;
+using std::chrono::steady_clock;
+
+namespace {
+
+size_t NextPowerOfTwo(int n) {
+  size_t size = 1;
+  while (size < static_cast<size_t>(n)) {
+    size <<= 1;
+  }
+  return size;
+}
+
+int64_t NowNanoseconds() {
+  return duration_cast<nanoseconds>(steady_clock::now().time_since_epoch())
+      .count();
+}
+
+}  // namespace
+
+AsyncDebugSink::AsyncDebugSink(Writer writer, int capacity)
+    : writer_(std::move(writer)),
+      mask_(NextPowerOfTwo(capacity) - 1),
+      buffer_(new Cell[mask_ + 1]) {
+  DRAKE_THROW_UNLESS(capacity >= 1);
+  DRAKE_THROW_UNLESS(writer_ != nullptr);
+  for (size_t i = 0; i <= mask_; i++) {
+    buffer_[i].sequence.store(i, std::memory_order_relaxed);
+  }
+  drain_thread_ = std::thread(&AsyncDebugSink::Drain, this);
+}
+
+AsyncDebugSink::~AsyncDebugSink() {
+  keep_draining_ = false;
+  drain_thread_.join();
+}
+
+bool AsyncDebugSink::Log(std::string message) {
+  if (!TryPush(&message)) {
+    num_dropped_++;
+    return false;
+  }
+  num_logged_++;
+  return true;
+}
+
+void AsyncDebugSink::Flush() const {
+  const int64_t target = num_logged_;
+  while (num_written_ < target) {
+    std::this_thread::sleep_for(std::chrono::microseconds(100));
+  }
+}
+
+AsyncDebugSink& AsyncDebugSink::Default() {
+  static AsyncDebugSink sink;
+  return sink;
+}
+
+void AsyncDebugSink::WriteToStdout(const std::string& message) {
+  std::cout << message << '\n' << std::flush;
+}
+
+bool AsyncDebugSink::TryPush(std::string* message) {
+  Cell* cell;
+  size_t pos = enqueue_pos_.load(std::memory_order_relaxed);
+  while (true) {
+    cell = &buffer_[pos & mask_];
+    size_t sequence = cell->sequence.load(std::memory_order_acquire);
+    intptr_t diff = static_cast<intptr_t>(sequence) -
+                    static_cast<intptr_t>(pos);
+    if (diff == 0) {
+      // The cell is free; claim it
+      if (enqueue_pos_.compare_exchange_weak(pos, pos + 1,
+                                             std::memory_order_relaxed)) {
+        break;
+      }
+    } else if (diff < 0) {
+      // The cell still holds a message from one lap ago: the queue is full
+      return false;
+    } else {
+      pos = enqueue_pos_.load(std::memory_order_relaxed);
+    }
+  }
+  cell->message = std::move(*message);
+  cell->sequence.store(pos + 1, std::memory_order_release);
+  return true;
+}
+
+bool AsyncDebugSink::TryPop(std::string* message) {
+  Cell* cell;
+  size_t pos = dequeue_pos_.load(std::memory_order_relaxed);
+  while (true) {
+    cell = &buffer_[pos & mask_];
+    size_t sequence = cell->sequence.load(std::memory_order_acquire);
+    intptr_t diff = static_cast<intptr_t>(sequence) -
+                    static_cast<intptr_t>(pos + 1);
+    if (diff == 0) {
+      if (dequeue_pos_.compare_exchange_weak(pos, pos + 1,
+                                             std::memory_order_relaxed)) {
+        break;
+      }
+    } else if (diff < 0) {
+      // Empty
+      return false;
+    } else {
+      pos = dequeue_pos_.load(std::memory_order_relaxed);
+    }
+  }
+  *message = std::move(cell->message);
+  cell->sequence.store(pos + mask_ + 1, std::memory_order_release);
+  return true;
+}
+
+void AsyncDebugSink::Drain() {
+  std::string message;
+  while (true) {
+    if (TryPop(&message)) {
+      writer_(message);
+      num_written_++;
+    } else if (keep_draining_) {
+      // Producers never wait on the consumer, so poll rather than signal
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    } else {
+      // Stopped, and everything queued before the stop has been written
+      break;
+    }
+  }
+}
+
+DebugRateLimiter::DebugRateLimiter(double min_period)
+    : min_period_ns_(static_cast<int64_t>(min_period * 1e9)) {
+  DRAKE_THROW_UNLESS(min_period >= 0);
+}
+
+bool DebugRateLimiter::Ready() const {
+  if (min_period_ns_ == 0) {
+    return true;
+  }
+  const int64_t now = NowNanoseconds();
+  int64_t next_ready = next_ready_ns_.load(std::memory_order_relaxed);
+  if (now >= next_ready &&
+      next_ready_ns_.compare_exchange_strong(next_ready,
+                                             now + min_period_ns_,
+                                             std::memory_order_relaxed)) {
+    return true;
+  }
+  num_suppressed_++;
+  return false;
+}
+
+}  // namespace dairlib
@@ -0,0 +1,110 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <thread>
+
+#include "drake/common/drake_copyable.h"
+
+namespace dairlib {
+
+/// AsyncDebugSink moves debug printing off of real-time threads.
+///
+/// Log() copies a message into a bounded, lock-free multi-producer queue and
+/// returns immediately; a background thread drains the queue and hands each
+/// message to the writer (by default, std::cout). If the writer falls behind
+/// and the queue is full, new messages are dropped and counted rather than
+/// blocking the caller. Systems inside control loops (VectorScope,
+/// InputSupervisor, ...) should print through a sink instead of std::cout.
+///
+/// Pair with DebugRateLimiter to bound how often a system formats and logs.
+class AsyncDebugSink {
+ public:
+  DRAKE_NO_COPY_NO_MOVE_NO_ASSIGN(AsyncDebugSink)
+
+  using Writer = std::function<void(const std::string&)>;
+
+  /// @param writer called from the background thread, once per message
+  /// @param capacity maximum number of queued messages (rounded up to a power
+  ///   of two)
+  explicit AsyncDebugSink(Writer writer = WriteToStdout, int capacity = 256);
+
+  /// Writes all queued messages, then stops the background thread
+  ~AsyncDebugSink();
+
+  /// Queues a message without blocking. Returns false if it was dropped
+  /// because the queue is full.
+  bool Log(std::string message);
+
+  /// Blocks until every message queued so far has been written. Not meant to
+  /// be called from real-time threads.
+  void Flush() const;
+
+  int64_t num_logged() const { return num_logged_; }
+  int64_t num_written() const { return num_written_; }
+  int64_t num_dropped() const { return num_dropped_; }
+
+  /// Process-wide sink writing to std::cout
+  static AsyncDebugSink& Default();
+
+  /// Writes the message and a newline to std::cout
+  static void WriteToStdout(const std::string& message);
+
+ private:
+  // Bounded MPMC queue cell, after D. Vyukov's array-based queue. sequence
+  // tells producers and the consumer whose turn it is to use the cell.
+  struct Cell {
+    std::atomic<size_t> sequence;
+    std::string message;
+  };
+
+  bool TryPush(std::string* message);
+  bool TryPop(std::string* message);
+  void Drain();
+
+  const Writer writer_;
+  const size_t mask_;
+  std::unique_ptr<Cell[]> buffer_;
+  std::atomic<size_t> enqueue_pos_{0};
+  std::atomic<size_t> dequeue_pos_{0};
+
+  std::atomic<int64_t> num_logged_{0};
+  std::atomic<int64_t> num_written_{0};
+  std::atomic<int64_t> num_dropped_{0};
+
+  std::atomic<bool> keep_draining_{true};
+  std::thread drain_thread_;
+};
+
+/// DebugRateLimiter allows at most one event per min_period seconds of wall
+/// time. Ready() is lock-free and may be called concurrently.
+///
+/// Check Ready() before formatting a message, so that throttled calls cost
+/// only a clock read:
+///   if (limiter_.Ready()) sink->Log(...);
+class DebugRateLimiter {
+ public:
+  DRAKE_NO_COPY_NO_MOVE_NO_ASSIGN(DebugRateLimiter)
+
+  /// @param min_period minimum wall-clock time between events, in seconds.
+  ///   Zero disables rate limiting.
+  explicit DebugRateLimiter(double min_period);
+
+  /// Returns true, and starts a new period, if min_period has elapsed since
+  /// the last time this returned true
+  bool Ready() const;
+
+  /// Number of calls to Ready() that returned false
+  int64_t num_suppressed() const { return num_suppressed_; }
+
+ private:
+  const int64_t min_period_ns_;
+  mutable std::atomic<int64_t> next_ready_ns_{0};
+  mutable std::atomic<int64_t> num_suppressed_{0};
+};
+
+}  // namespace dairlib
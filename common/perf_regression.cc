@@ -0,0 +1,384 @@
+#include "common/perf_regression.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstdlib>
+#include <iomanip>
+#include <memory>
+#include <stdexcept>
+
+namespace dairlib {
+
+using std::string;
+using std::vector;
+
+namespace {
+
+// Minimal JSON document (enough for the baselines)
+struct JsonValue {
+  enum class Type { kNull, kBool, kNumber, kString, kArray, kObject };
+  Type type = Type::kNull;
+  double number = 0;
+  string str;
+  vector<JsonValue> array;
+  std::map<string, JsonValue> object;
+
+  const JsonValue* Find(const string& key) const {
+    if (type != Type::kObject) return nullptr;
+    auto it = object.find(key);
+    return it == object.end() ? nullptr : &it->second;
+  }
+};
+
+class JsonParser {
+ public:
+  explicit JsonParser(const string& text) : text_(text) {}
+
+  JsonValue Parse() {
+    JsonValue value = ParseValue();
+    SkipSpace();
+    if (pos_ != text_.size()) Fail("trailing characters");
+    return value;
+  }
+
+ private:
+  JsonValue ParseValue() {
+    SkipSpace();
+    if (pos_ >= text_.size()) Fail("unexpected end");
+    JsonValue value;
+    const char c = text_[pos_];
+    if (c == '{') {
+      value.type = JsonValue::Type::kObject;
+      pos_++;
+      SkipSpace();
+      if (Peek() == '}') {
+        pos_++;
+        return value;
+      }
+      while (true) {
+        SkipSpace();
+        string key = ParseString();
+        SkipSpace();
+        Expect(':');
+        value.object[key] = ParseValue();
+        SkipSpace();
+        if (Peek() == ',') {
+          pos_++;
+        } else {
+          Expect('}');
+          return value;
+        }
+      }
+    } else if (c == '[') {
+      value.type = JsonValue::Type::kArray;
+      pos_++;
+      SkipSpace();
+      if (Peek() == ']') {
+        pos_++;
+        return value;
+      }
+      while (true) {
+        value.array.push_back(ParseValue());
+        SkipSpace();
+        if (Peek() == ',') {
+          pos_++;
+        } else {
+          Expect(']');
+          return value;
+        }
+      }
+    } else if (c == '"') {
+      value.type = JsonValue::Type::kString;
+      value.str = ParseString();
+    } else if (text_.compare(pos_, 4, "true") == 0) {
+      value.type = JsonValue::Type::kBool;
+      value.number = 1;
+      pos_ += 4;
+    } else if (text_.compare(pos_, 5, "false") == 0) {
+      value.type = JsonValue::Type::kBool;
+      pos_ += 5;
+    } else if (text_.compare(pos_, 4, "null") == 0) {
+      pos_ += 4;
+    } else {
+      const char* begin = text_.c_str() + pos_;
+      char* end;
+      value.type = JsonValue::Type::kNumber;
+      value.number = std::strtod(begin, &end);
+      if (end == begin) Fail("unexpected character");
+      pos_ += end - begin;
+    }
+    return value;
+  }
+
+  string ParseString() {
+    Expect('"');
+    string str;
+    while (pos_ < text_.size() && text_[pos_] != '"') {
+      char c = text_[pos_++];
+      if (c == '\\') {
+        if (pos_ >= text_.size()) break;
+        c = text_[pos_++];
+        switch (c) {
+          case 'n': c = '\n'; break;
+          case 't': c = '\t'; break;
+          case 'r': c = '\r'; break;
+          case 'b': c = '\b'; break;
+          case 'f': c = '\f'; break;
+          case 'u': Fail("unicode escapes are not supported");
+          default: break;
+        }
+      }
+      str.push_back(c);
+    }
+    Expect('"');
+    return str;
+  }
+
+  void SkipSpace() {
+    while (pos_ < text_.size() &&
+           std::isspace(static_cast<unsigned char>(text_[pos_]))) {
+      pos_++;
+    }
+  }
+  char Peek() const { return pos_ < text_.size() ? text_[pos_] : '\0'; }
+  void Expect(char c) {
+    if (Peek() != c) Fail(string("expected '") + c + "'");
+    pos_++;
+  }
+  [[noreturn]] void Fail(const string& message) const {
+    throw std::runtime_error("Malformed JSON at offset " +
+                             std::to_string(pos_) + ": " + message);
+  }
+
+  const string& text_;
+  size_t pos_ = 0;
+};
+
+void ReadTolerance(const JsonValue& json, PerfTolerance* tolerance) {
+  if (auto p50 = json.Find("p50")) tolerance->p50 = p50->number;
+  if (auto p90 = json.Find("p90")) tolerance->p90 = p90->number;
+  if (auto count = json.Find("count")) tolerance->count = count->number;
+}
+
+void WriteTolerance(const PerfTolerance& tolerance, std::ostream* out) {
+  *out << "{\"p50\": " << tolerance.p50 << ", \"p90\": " << tolerance.p90
+       << ", \"count\": " << tolerance.count << "}";
+}
+
+string Escape(const string& str) {
+  string escaped;
+  for (char c : str) {
+    if (c == '"' || c == '\\') escaped.push_back('\\');
+    escaped.push_back(c == '\n' ? ' ' : c);
+  }
+  return escaped;
+}
+
+PerfComparison Compare(const string& key, double current, double tolerance,
+                       const PerfBaseline& baseline) {
+  PerfComparison comparison;
+  comparison.key = key;
+  comparison.current = current;
+  comparison.tolerance = tolerance;
+  auto it = baseline.values.find(key);
+  if (it == baseline.values.end()) return comparison;
+  comparison.baseline = it->second;
+  // Exact comparison of equal values, e.g. iteration counts with a zero
+  // tolerance
+  if (current > it->second * (1 + tolerance) && current != it->second) {
+    comparison.status = PerfComparison::Status::kRegression;
+  } else if (current < it->second * (1 - tolerance) && current != it->second) {
+    comparison.status = PerfComparison::Status::kImprovement;
+  } else {
+    comparison.status = PerfComparison::Status::kOk;
+  }
+  return comparison;
+}
+
+}  // namespace
+
+PerfTimingStats CalcPerfTimingStats(vector<double> samples) {
+  PerfTimingStats stats;
+  stats.count = samples.size();
+  if (samples.empty()) return stats;
+  for (double& sample : samples) sample *= 1e6;
+  std::sort(samples.begin(), samples.end());
+  double sum = 0;
+  for (double sample : samples) sum += sample;
+  stats.mean = sum / samples.size();
+  auto percentile = [&samples](double p) {
+    int rank = std::ceil(p * samples.size()) - 1;
+    return samples[std::min(std::max(rank, 0),
+                            static_cast<int>(samples.size()) - 1)];
+  };
+  stats.min = samples.front();
+  stats.p50 = percentile(0.5);
+  stats.p90 = percentile(0.9);
+  stats.p99 = percentile(0.99);
+  stats.max = samples.back();
+  return stats;
+}
+
+void WritePerfResultsJson(
+    const vector<PerfWorkloadResult>& results, const PerfTolerance& tolerance,
+    const std::map<string, PerfTolerance>& workload_tolerances,
+    std::ostream* out) {
+  *out << std::setprecision(6);
+  *out << "{\n  \"tolerance\": ";
+  WriteTolerance(tolerance, out);
+  *out << ",\n  \"workloads\": {";
+  for (size_t i = 0; i < results.size(); i++) {
+    const auto& result = results[i];
+    *out << (i ? "," : "") << "\n    \"" << Escape(result.name) << "\": {";
+    auto workload_tolerance = workload_tolerances.find(result.name);
+    if (workload_tolerance != workload_tolerances.end()) {
+      *out << "\n      \"tolerance\": ";
+      WriteTolerance(workload_tolerance->second, out);
+      *out << ",";
+    }
+    if (!result.skipped.empty()) {
+      *out << "\n      \"skipped\": \"" << Escape(result.skipped)
+           << "\"\n    }";
+      continue;
+    }
+    if (!result.failed.empty()) {
+      *out << "\n      \"failed\": \"" << Escape(result.failed)
+           << "\"\n    }";
+      continue;
+    }
+    *out << "\n      \"timings_us\": {";
+    bool first = true;
+    for (const auto& timing : result.timings) {
+      const auto stats = CalcPerfTimingStats(timing.second);
+      *out << (first ? "" : ",") << "\n        \"" << Escape(timing.first)
+           << "\": {\"count\": " << stats.count << ", \"mean\": " << stats.mean
+           << ", \"min\": " << stats.min << ", \"p50\": " << stats.p50
+           << ", \"p90\": " << stats.p90 << ", \"p99\": " << stats.p99
+           << ", \"max\": " << stats.max << "}";
+      first = false;
+    }
+    *out << "\n      },\n      \"counts\": {";
+    first = true;
+    for (const auto& count : result.counts) {
+      *out << (first ? "" : ",") << "\n        \"" << Escape(count.first)
+           << "\": " << count.second;
+      first = false;
+    }
+    *out << "\n      }\n    }";
+  }
+  *out << "\n  }\n}\n";
+}
+
+const PerfTolerance& PerfBaseline::GetTolerance(const string& workload) const {
+  auto it = workload_tolerances.find(workload);
+  return it == workload_tolerances.end() ? tolerance : it->second;
+}
+
+PerfBaseline ParsePerfBaseline(const string& json) {
+  const JsonValue root = JsonParser(json).Parse();
+  PerfBaseline baseline;
+  if (auto tolerance = root.Find("tolerance")) {
+    ReadTolerance(*tolerance, &baseline.tolerance);
+  }
+  const JsonValue* workloads = root.Find("workloads");
+  if (!workloads) return baseline;
+  for (const auto& workload : workloads->object) {
+    const string& name = workload.first;
+    if (auto tolerance = workload.second.Find("tolerance")) {
+      PerfTolerance workload_tolerance = baseline.tolerance;
+      ReadTolerance(*tolerance, &workload_tolerance);
+      baseline.workload_tolerances[name] = workload_tolerance;
+    }
+    if (auto timings = workload.second.Find("timings_us")) {
+      for (const auto& timing : timings->object) {
+        for (const string statistic : {"p50", "p90"}) {
+          const JsonValue* value = timing.second.Find(statistic);
+          if (value && value->type == JsonValue::Type::kNumber) {
+            baseline.values[name + "/" + timing.first + "/" + statistic] =
+                value->number;
+          }
+        }
+      }
+    }
+    if (auto counts = workload.second.Find("counts")) {
+      for (const auto& count : counts->object) {
+        if (count.second.type == JsonValue::Type::kNumber) {
+          baseline.values[name + "/" + count.first] = count.second.number;
+        }
+      }
+    }
+  }
+  return baseline;
+}
+
+vector<PerfComparison> ComparePerfResults(
+    const vector<PerfWorkloadResult>& results, const PerfBaseline& baseline) {
+  vector<PerfComparison> comparisons;
+  for (const auto& result : results) {
+    if (!result.skipped.empty()) continue;
+    if (!result.failed.empty()) {
+      PerfComparison comparison;
+      comparison.key = result.name;
+      comparison.status = PerfComparison::Status::kFailed;
+      comparisons.push_back(comparison);
+      continue;
+    }
+    const PerfTolerance& tolerance = baseline.GetTolerance(result.name);
+    for (const auto& timing : result.timings) {
+      const auto stats = CalcPerfTimingStats(timing.second);
+      const string prefix = result.name + "/" + timing.first;
+      comparisons.push_back(
+          Compare(prefix + "/p50", stats.p50, tolerance.p50, baseline));
+      comparisons.push_back(
+          Compare(prefix + "/p90", stats.p90, tolerance.p90, baseline));
+    }
+    for (const auto& count : result.counts) {
+      comparisons.push_back(Compare(result.name + "/" + count.first,
+                                    count.second, tolerance.count, baseline));
+    }
+  }
+  return comparisons;
+}
+
+int PrintPerfComparison(const vector<PerfComparison>& comparisons,
+                        std::ostream* out) {
+  int num_regressions = 0;
+  *out << std::left << std::setw(48) << "metric" << std::right
+       << std::setw(14) << "baseline" << std::setw(14) << "current"
+       << std::setw(10) << "change" << "  status\n";
+  for (const auto& comparison : comparisons) {
+    *out << std::left << std::setw(48) << comparison.key << std::right
+         << std::setprecision(4) << std::setw(14);
+    if (comparison.status == PerfComparison::Status::kFailed) {
+      *out << "-" << std::setw(14) << "-" << std::setw(10) << "-"
+           << "  FAILED\n";
+      num_regressions++;
+      continue;
+    }
+    if (comparison.status == PerfComparison::Status::kNoBaseline) {
+      *out << "-" << std::setw(14) << comparison.current << std::setw(10)
+           << "-" << "  no baseline\n";
+      continue;
+    }
+    *out << comparison.baseline << std::setw(14) << comparison.current
+         << std::setw(9) << std::fixed << std::setprecision(1)
+         << 100 * comparison.change() << "%" << std::defaultfloat << "  ";
+    switch (comparison.status) {
+      case PerfComparison::Status::kRegression:
+        *out << "REGRESSION (tolerance " << std::fixed << std::setprecision(0)
+             << 100 * comparison.tolerance << "%)" << std::defaultfloat;
+        num_regressions++;
+        break;
+      case PerfComparison::Status::kImprovement:
+        *out << "improved, consider updating the baseline";
+        break;
+      default:
+        *out << "ok";
+    }
+    *out << "\n";
+  }
+  return num_regressions;
+}
+
+}  // namespace dairlib
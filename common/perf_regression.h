@@ -0,0 +1,112 @@
+#pragma once
+
+#include <map>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace dairlib {
+
+/// Measurements of one workload of a performance regression run
+struct PerfWorkloadResult {
+  std::string name;
+  /// Durations (s) of the timed sections of the workload, by name, e.g. one
+  /// sample per control tick, or one per solve
+  std::map<std::string, std::vector<double>> timings;
+  /// Deterministic counts, e.g. solver iterations. Lower is better.
+  std::map<std::string, double> counts;
+  /// Reason the workload didn't run (e.g. a missing input file), if it didn't
+  std::string skipped;
+  /// Reason the workload failed (e.g. a crash of its process), if it did.
+  /// Unlike a skipped workload, a failed one counts as a regression.
+  std::string failed;
+};
+
+/// Statistics of the samples of a timing, in microseconds
+struct PerfTimingStats {
+  int count = 0;
+  double mean = 0;
+  double min = 0;
+  double p50 = 0;
+  double p90 = 0;
+  double p99 = 0;
+  double max = 0;
+};
+
+/// Statistics of durations given in seconds (nearest rank percentiles)
+PerfTimingStats CalcPerfTimingStats(std::vector<double> samples);
+
+/// Tolerance bands, as fractions of the baseline values. A metric regresses
+/// if it exceeds its baseline value by more than the tolerance.
+struct PerfTolerance {
+  /// Median of the timings
+  double p50 = 0.2;
+  /// 90th percentile of the timings (noisier than the median)
+  double p90 = 0.5;
+  /// Counts
+  double count = 0;
+};
+
+/// Writes the results as JSON. The same file, with the tolerances, serves as
+/// a baseline:
+///   {
+///     "tolerance": {"p50": 0.2, "p90": 0.5, "count": 0},
+///     "workloads": {
+///       "<workload>": {
+///         "tolerance": {...},  (optional, overrides the global tolerance)
+///         "timings_us": {"<timing>": {"count": ..., "p50": ..., ...}},
+///         "counts": {"<count>": ...}
+///       },
+///       "<skipped workload>": {"skipped": "<reason>"},
+///       "<failed workload>": {"failed": "<reason>"}
+///     }
+///   }
+void WritePerfResultsJson(
+    const std::vector<PerfWorkloadResult>& results,
+    const PerfTolerance& tolerance,
+    const std::map<std::string, PerfTolerance>& workload_tolerances,
+    std::ostream* out);
+
+/// Baseline of a performance regression run
+struct PerfBaseline {
+  PerfTolerance tolerance;
+  std::map<std::string, PerfTolerance> workload_tolerances;
+  /// Compared values, by key "<workload>/<timing>/p50",
+  /// "<workload>/<timing>/p90" (in microseconds) or "<workload>/<count>"
+  std::map<std::string, double> values;
+
+  const PerfTolerance& GetTolerance(const std::string& workload) const;
+};
+
+/// Parses a baseline written by WritePerfResultsJson (and possibly edited).
+/// Throws std::runtime_error if the JSON is malformed.
+PerfBaseline ParsePerfBaseline(const std::string& json);
+
+/// Comparison of one metric with its baseline
+struct PerfComparison {
+  enum class Status { kOk, kRegression, kImprovement, kNoBaseline, kFailed };
+
+  std::string key;
+  double current = 0;
+  double baseline = 0;
+  double tolerance = 0;
+  Status status = Status::kNoBaseline;
+
+  /// Relative change from the baseline
+  double change() const { return current / baseline - 1; }
+};
+
+/// Compares the metrics of the results with the baseline. Metrics faster (or
+/// lower) than the baseline by more than the tolerance are reported as
+/// improvements, a hint to update the baseline. A failed workload gives a
+/// single kFailed comparison, keyed by its name.
+std::vector<PerfComparison> ComparePerfResults(
+    const std::vector<PerfWorkloadResult>& results,
+    const PerfBaseline& baseline);
+
+/// Prints the comparisons as a table. Returns the number of regressions,
+/// failed workloads included.
+int PrintPerfComparison(const std::vector<PerfComparison>& comparisons,
+                        std::ostream* out);
+
+}  // namespace dairlib
@@ -0,0 +1,43 @@
+#include "common/allocation_counter.h"
+
+#include <memory>
+#include <vector>
+
+#include <gtest/gtest.h>
+#include <Eigen/Dense>
+
+namespace dairlib {
+namespace {
+
+GTEST_TEST(AllocationCounterTest, CountsAllocations) {
+  if (!AllocationCounter::is_supported()) return;
+  AllocationCounter counter;
+  EXPECT_EQ(counter.count(), 0);
+
+  auto value = std::make_unique<double>(1);
+  EXPECT_EQ(counter.count(), 1);
+
+  // Eigen allocates through malloc
+  Eigen::VectorXd vector = Eigen::VectorXd::Zero(100);
+  EXPECT_EQ(counter.count(), 2);
+
+  // No allocation for fixed size types, or to reuse a buffer
+  Eigen::Vector3d fixed = Eigen::Vector3d::Ones();
+  vector.setOnes();
+  vector += vector;
+  EXPECT_EQ(counter.count(), 2);
+
+  counter.Reset();
+  std::vector<int> list;
+  for (int i = 0; i < 3; i++) list.push_back(i);
+  EXPECT_EQ(counter.count(), 3);
+  EXPECT_EQ(fixed.sum() + vector.sum() + *value + list.size(), 207);
+}
+
+}  // namespace
+}  // namespace dairlib
+
+int main(int argc, char** argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,128 @@
+#include <chrono>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+#include "common/async_debug_sink.h"
+#include "drake/systems/analysis/simulator.h"
+#include "systems/vector_scope.h"
+
+namespace dairlib {
+namespace {
+
+using std::chrono::duration;
+using std::chrono::milliseconds;
+using std::chrono::steady_clock;
+
+TEST(AsyncDebugSinkTest, WritesInOrder) {
+  std::vector<std::string> written;
+  {
+    AsyncDebugSink sink(
+        [&written](const std::string& message) { written.push_back(message); },
+        16);
+    for (int i = 0; i < 10; i++) {
+      EXPECT_TRUE(sink.Log(std::to_string(i)));
+    }
+    sink.Flush();
+    EXPECT_EQ(sink.num_written(), 10);
+    EXPECT_EQ(sink.num_dropped(), 0);
+  }
+  ASSERT_EQ(written.size(), 10);
+  for (int i = 0; i < 10; i++) {
+    EXPECT_EQ(written[i], std::to_string(i));
+  }
+}
+
+TEST(AsyncDebugSinkTest, DropsWhenFull) {
+  // The writer is stuck until released, so the queue fills up
+  std::atomic<bool> release{false};
+  AsyncDebugSink sink(
+      [&release](const std::string&) {
+        while (!release) std::this_thread::sleep_for(milliseconds(1));
+      },
+      4);
+  int num_accepted = 0;
+  for (int i = 0; i < 100; i++) {
+    num_accepted += sink.Log("message");
+  }
+  // At most the queue capacity, plus the one message held by the writer
+  EXPECT_LE(num_accepted, 5);
+  EXPECT_EQ(sink.num_dropped(), 100 - num_accepted);
+  release = true;
+  sink.Flush();
+  EXPECT_EQ(sink.num_written(), num_accepted);
+}
+
+TEST(AsyncDebugSinkTest, ConcurrentProducers) {
+  std::atomic<int> num_written{0};
+  AsyncDebugSink sink([&num_written](const std::string&) { num_written++; },
+                      1024);
+  std::vector<std::thread> producers;
+  for (int i = 0; i < 4; i++) {
+    producers.emplace_back([&sink]() {
+      for (int j = 0; j < 100; j++) sink.Log("message");
+    });
+  }
+  for (auto& producer : producers) producer.join();
+  sink.Flush();
+  EXPECT_EQ(num_written + sink.num_dropped(), 400);
+  EXPECT_EQ(num_written, sink.num_logged());
+}
+
+TEST(AsyncDebugSinkTest, RateLimiter) {
+  DebugRateLimiter limiter(0.05);
+  EXPECT_TRUE(limiter.Ready());
+  EXPECT_FALSE(limiter.Ready());
+  EXPECT_EQ(limiter.num_suppressed(), 1);
+  std::this_thread::sleep_for(milliseconds(60));
+  EXPECT_TRUE(limiter.Ready());
+
+  DebugRateLimiter unlimited(0);
+  EXPECT_TRUE(unlimited.Ready());
+  EXPECT_TRUE(unlimited.Ready());
+}
+
+// Simulates a control loop containing a VectorScope that prints every tick,
+// and returns the wall time per tick in seconds
+double TimePerTick(AsyncDebugSink* sink, int num_ticks) {
+  const double period = 1e-3;
+  systems::VectorScope scope(3, "debug", period, 0, sink);
+  drake::systems::Simulator<double> simulator(scope);
+  simulator.get_mutable_context().FixInputPort(
+      0, drake::systems::BasicVector<double>(Eigen::Vector3d(1, 2, 3)));
+  simulator.Initialize();
+
+  auto start = steady_clock::now();
+  simulator.AdvanceTo(num_ticks * period);
+  return duration<double>(steady_clock::now() - start).count() / num_ticks;
+}
+
+TEST(AsyncDebugSinkTest, SlowConsumerDoesNotBlockControlThread) {
+  const int num_ticks = 200;
+  const auto slow_write = milliseconds(20);
+
+  AsyncDebugSink fast_sink([](const std::string&) {});
+  AsyncDebugSink slow_sink(
+      [slow_write](const std::string&) {
+        std::this_thread::sleep_for(slow_write);
+      },
+      64);
+
+  double fast_tick = TimePerTick(&fast_sink, num_ticks);
+  double slow_tick = TimePerTick(&slow_sink, num_ticks);
+
+  // A blocking print would cost the full write time every tick. Allow
+  // generous slack for scheduling noise on loaded machines.
+  EXPECT_LT(slow_tick, fast_tick + 0.1 * duration<double>(slow_write).count());
+  EXPECT_GT(slow_sink.num_dropped(), 0);
+}
+
+}  // namespace
+}  // namespace dairlib
+
+int main(int argc, char** argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
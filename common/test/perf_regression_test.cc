@@ -0,0 +1,158 @@
+#include "common/perf_regression.h"
+
+#include <sstream>
+#include <stdexcept>
+
+#include <gtest/gtest.h>
+
+namespace dairlib {
+namespace {
+
+using Status = PerfComparison::Status;
+
+std::vector<PerfWorkloadResult> MakeResults(double scale, double iterations) {
+  PerfWorkloadResult replay;
+  replay.name = "replay";
+  for (int i = 1; i <= 100; i++) {
+    replay.timings["tick"].push_back(scale * i * 1e-6);
+  }
+  PerfWorkloadResult solve;
+  solve.name = "solve";
+  solve.timings["solve"] = {scale * 2.0};
+  solve.counts["iterations"] = iterations;
+  PerfWorkloadResult skipped;
+  skipped.name = "sgd";
+  skipped.skipped = "no input";
+  return {replay, solve, skipped};
+}
+
+PerfBaseline MakeBaseline(
+    const std::vector<PerfWorkloadResult>& results,
+    const PerfTolerance& tolerance,
+    const std::map<std::string, PerfTolerance>& workload_tolerances = {}) {
+  std::stringstream json;
+  WritePerfResultsJson(results, tolerance, workload_tolerances, &json);
+  return ParsePerfBaseline(json.str());
+}
+
+GTEST_TEST(PerfRegressionTest, TimingStats) {
+  auto stats = CalcPerfTimingStats(MakeResults(1, 0)[0].timings["tick"]);
+  EXPECT_EQ(stats.count, 100);
+  EXPECT_NEAR(stats.mean, 50.5, 1e-9);
+  EXPECT_NEAR(stats.min, 1, 1e-9);
+  EXPECT_NEAR(stats.p50, 50, 1e-9);
+  EXPECT_NEAR(stats.p90, 90, 1e-9);
+  EXPECT_NEAR(stats.p99, 99, 1e-9);
+  EXPECT_NEAR(stats.max, 100, 1e-9);
+  EXPECT_EQ(CalcPerfTimingStats({}).count, 0);
+}
+
+GTEST_TEST(PerfRegressionTest, BaselineRoundTrip) {
+  PerfTolerance tolerance;
+  tolerance.p50 = 0.1;
+  tolerance.p90 = 0.3;
+  tolerance.count = 0.05;
+  PerfTolerance solve_tolerance;
+  solve_tolerance.p50 = 0.4;
+  auto baseline = MakeBaseline(MakeResults(1, 40), tolerance,
+                               {{"solve", solve_tolerance}});
+  EXPECT_EQ(baseline.tolerance.p50, 0.1);
+  EXPECT_EQ(baseline.tolerance.p90, 0.3);
+  EXPECT_EQ(baseline.tolerance.count, 0.05);
+  EXPECT_EQ(baseline.GetTolerance("replay").p50, 0.1);
+  EXPECT_EQ(baseline.GetTolerance("solve").p50, 0.4);
+  EXPECT_NEAR(baseline.values.at("replay/tick/p50"), 50, 1e-9);
+  EXPECT_NEAR(baseline.values.at("replay/tick/p90"), 90, 1e-9);
+  EXPECT_NEAR(baseline.values.at("solve/solve/p50"), 2e6, 1e-3);
+  EXPECT_EQ(baseline.values.at("solve/iterations"), 40);
+  // Skipped workloads have no values
+  EXPECT_EQ(baseline.values.size(), 5);
+}
+
+GTEST_TEST(PerfRegressionTest, Compare) {
+  auto baseline = MakeBaseline(MakeResults(1, 40), PerfTolerance());
+
+  auto same = ComparePerfResults(MakeResults(1, 40), baseline);
+  ASSERT_EQ(same.size(), 5);
+  for (const auto& comparison : same) {
+    EXPECT_EQ(comparison.status, Status::kOk) << comparison.key;
+  }
+
+  // 10% slower is within the default band, 30% slower is not on the median
+  for (const auto& comparison :
+       ComparePerfResults(MakeResults(1.1, 40), baseline)) {
+    EXPECT_EQ(comparison.status, Status::kOk) << comparison.key;
+  }
+  std::stringstream out;
+  auto slower = ComparePerfResults(MakeResults(1.3, 40), baseline);
+  EXPECT_EQ(PrintPerfComparison(slower, &out), 2);
+  EXPECT_EQ(slower[0].key, "replay/tick/p50");
+  EXPECT_EQ(slower[0].status, Status::kRegression);
+  EXPECT_EQ(slower[1].status, Status::kOk);
+
+  // Counts are compared exactly by default
+  auto more_iterations = ComparePerfResults(MakeResults(1, 41), baseline);
+  EXPECT_EQ(more_iterations[4].key, "solve/iterations");
+  EXPECT_EQ(more_iterations[4].status, Status::kRegression);
+  auto faster = ComparePerfResults(MakeResults(0.5, 39), baseline);
+  EXPECT_EQ(faster[0].status, Status::kImprovement);
+  EXPECT_EQ(faster[4].status, Status::kImprovement);
+  EXPECT_EQ(PrintPerfComparison(faster, &out), 0);
+}
+
+GTEST_TEST(PerfRegressionTest, WorkloadTolerance) {
+  auto baseline = ParsePerfBaseline(R"({
+      "tolerance": {"p50": 0.1},
+      "workloads": {
+        "solve": {
+          "tolerance": {"count": 0.1},
+          "counts": {"iterations": 40, "evaluations": 100}
+        },
+        "new": {}
+      }
+    })");
+  EXPECT_EQ(baseline.GetTolerance("replay").p50, 0.1);
+  EXPECT_EQ(baseline.GetTolerance("replay").count, 0);
+  EXPECT_EQ(baseline.GetTolerance("solve").p50, 0.1);
+  EXPECT_EQ(baseline.GetTolerance("solve").count, 0.1);
+
+  auto comparisons = ComparePerfResults(MakeResults(1, 43), baseline);
+  ASSERT_EQ(comparisons.size(), 5);
+  // No baseline for the timings
+  EXPECT_EQ(comparisons[0].status, Status::kNoBaseline);
+  EXPECT_EQ(comparisons[4].status, Status::kOk);
+
+  EXPECT_THROW(ParsePerfBaseline("{\"tolerance\": "), std::runtime_error);
+  EXPECT_THROW(ParsePerfBaseline("{} x"), std::runtime_error);
+}
+
+GTEST_TEST(PerfRegressionTest, Failed) {
+  auto baseline = MakeBaseline(MakeResults(1, 40), PerfTolerance());
+  auto results = MakeResults(1, 40);
+  results[1].timings.clear();
+  results[1].counts.clear();
+  results[1].failed = "exit status 134";
+
+  // A failed workload has no values, but is a regression
+  auto comparisons = ComparePerfResults(results, baseline);
+  ASSERT_EQ(comparisons.size(), 3);
+  EXPECT_EQ(comparisons[2].key, "solve");
+  EXPECT_EQ(comparisons[2].status, Status::kFailed);
+  std::stringstream out;
+  EXPECT_EQ(PrintPerfComparison(comparisons, &out), 1);
+  EXPECT_NE(out.str().find("FAILED"), std::string::npos);
+
+  std::stringstream json;
+  WritePerfResultsJson(results, PerfTolerance(), {}, &json);
+  EXPECT_NE(json.str().find("\"failed\": \"exit status 134\""),
+            std::string::npos);
+  EXPECT_EQ(ParsePerfBaseline(json.str()).values.size(), 2);
+}
+
+}  // namespace
+}  // namespace dairlib
+
+int main(int argc, char** argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -1,5 +1,6 @@
 #include "examples/Cassie/cassie_fixed_point_solver.h"
 #include "multibody/kinematic/kinematic_evaluator_set.h"
+#include "multibody/kinematic/kinematic_projector.h"
 #include "multibody/kinematic/world_point_evaluator.h"
 #include "multibody/multibody_solvers.h"
 #include "multibody/multibody_utils.h"
@@ -130,6 +131,12 @@ void CassieFixedPointSolver(
 
   q_guess += .05*Eigen::VectorXd::Random(plant.num_positions());
 
+  // Start from a pose satisfying the loop closures
+  multibody::KinematicEvaluatorSet<double> loop_closures(plant);
+  loop_closures.add_evaluator(&left_loop);
+  loop_closures.add_evaluator(&right_loop);
+  q_guess = multibody::KinematicProjector(loop_closures).Project(q_guess).q;
+
   // Only cost in this program: u^T u
   program.AddQuadraticCost(u.dot(1.0 * u));
 
@@ -202,6 +209,9 @@ void CassieFixedBaseFixedPointSolver(
   q_guess(positions_map.at("ankle_joint_right")) = 2;
   q_guess(positions_map.at("toe_right")) = -2;
 
+  // Start from a pose satisfying the loop closures
+  q_guess = multibody::KinematicProjector(evaluators).Project(q_guess).q;
+
   // Only cost in this program: u^T u
   program.AddQuadraticCost(u.dot(1.0 * u));
 
@@ -0,0 +1,231 @@
+#include "examples/Cassie/cassie_lipm_initial_guess.h"
+
+#include <algorithm>
+#include <cmath>
+#include <string>
+
+#include "examples/Cassie/cassie_utils.h"
+#include "multibody/kinematic/kinematic_evaluator_set.h"
+#include "multibody/kinematic/kinematic_projector.h"
+#include "multibody/kinematic/world_point_evaluator.h"
+#include "multibody/multibody_utils.h"
+
+namespace dairlib {
+
+using drake::multibody::Frame;
+using drake::multibody::MultibodyPlant;
+using Eigen::Matrix3d;
+using Eigen::MatrixXd;
+using Eigen::Vector3d;
+using Eigen::VectorXd;
+using multibody::KinematicEvaluatorSet;
+using multibody::KinematicProjectionResult;
+using multibody::KinematicProjector;
+using multibody::WorldPointEvaluator;
+using std::pair;
+
+namespace {
+
+// Passes of pelvis placement and projection per knot, as moving the legs
+// moves the center of mass
+constexpr int kPlacementPasses = 3;
+// Regularization of the inverse dynamics least squares, relative to the
+// largest diagonal entry of its normal equations
+constexpr double kRegularization = 1e-8;
+
+// Derivative of the columns of y, sampled with a uniform timestep h (central
+// differences, and one-sided at the ends)
+MatrixXd FiniteDifference(const MatrixXd& y, double h) {
+  const int n = y.cols();
+  MatrixXd dy(y.rows(), n);
+  for (int i = 0; i < n; i++) {
+    const int prev = std::max(i - 1, 0);
+    const int next = std::min(i + 1, n - 1);
+    dy.col(i) = (y.col(next) - y.col(prev)) / ((next - prev) * h);
+  }
+  return dy;
+}
+
+// Horizontal vector from the front to the rear contact point of a foot, in
+// the configuration of the context
+Vector3d FootAxis(const MultibodyPlant<double>& plant,
+                  const drake::systems::Context<double>& context,
+                  const pair<const Vector3d, const Frame<double>&>& toe,
+                  const pair<const Vector3d, const Frame<double>&>& heel) {
+  Vector3d front;
+  Vector3d rear;
+  plant.CalcPointsPositions(context, toe.second, toe.first,
+                            plant.world_frame(), &front);
+  plant.CalcPointsPositions(context, heel.second, heel.first,
+                            plant.world_frame(), &rear);
+  Vector3d axis = rear - front;
+  const double length = axis.norm();
+  axis(2) = 0;
+  return length * axis.normalized();
+}
+
+}  // namespace
+
+CassieWalkingGuess CassieLipmWalkingGuess(const MultibodyPlant<double>& plant,
+                                          const LipmGaitParameters& gait,
+                                          int num_knots) {
+  DRAKE_DEMAND(num_knots >= 2);
+  const int n_q = plant.num_positions();
+  const int n_v = plant.num_velocities();
+  const int n_u = plant.num_actuators();
+  auto positions_map = multibody::makeNameToPositionsMap(plant);
+  auto context = plant.CreateDefaultContext();
+  const auto& pelvis = plant.GetBodyByName("pelvis");
+  const int base_position_start = pelvis.floating_positions_start() + 4;
+  const int base_velocity_start = pelvis.floating_velocities_start();
+
+  // Ground frame G, whose z axis is the normal of the inclined ground (as in
+  // DirconPositionData)
+  const Vector3d ground_normal(sin(gait.ground_incline), 0,
+                               cos(gait.ground_incline));
+  Eigen::Quaterniond ground_rotation;
+  ground_rotation.setFromTwoVectors(Vector3d::UnitZ(), ground_normal);
+  const Matrix3d R_WG = ground_rotation.matrix();
+  const Matrix3d R_GW = R_WG.transpose();
+
+  const auto left_toe = LeftToe(plant);
+  const auto left_heel = LeftHeel(plant);
+  const auto right_toe = RightToe(plant);
+  const auto right_heel = RightHeel(plant);
+  auto left_loop = LeftLoopClosureEvaluator(plant);
+  auto right_loop = RightLoopClosureEvaluator(plant);
+
+  // Nominal pose with bent legs, which sets the orientation of the feet and
+  // starts the projection of the first knot
+  VectorXd q = VectorXd::Zero(n_q);
+  q(positions_map.at("base_qw")) = 1;
+  for (const std::string side : {"_left", "_right"}) {
+    q(positions_map.at("hip_pitch" + side)) = 0.9;
+    q(positions_map.at("knee" + side)) = -1.4;
+    q(positions_map.at("ankle_joint" + side)) = 1.6;
+    q(positions_map.at("toe" + side)) = -1.6;
+  }
+  KinematicEvaluatorSet<double> loop_closures(plant);
+  loop_closures.add_evaluator(&left_loop);
+  loop_closures.add_evaluator(&right_loop);
+  q = KinematicProjector(loop_closures).Project(q).q;
+  plant.SetPositions(context.get(), q);
+  const Vector3d left_axis = FootAxis(plant, *context, left_toe, left_heel);
+  const Vector3d right_axis =
+      FootAxis(plant, *context, right_toe, right_heel);
+
+  // LIPM over the stance (left) foot, in the ground frame. The solution
+  //   x = s/2 - s/2 sinh(w (T/2 - t)) / sinh(w T/2)
+  //   y = d - d cosh(w (t - T/2)) / cosh(w T/2)
+  // takes the center of mass from between the feet at touchdown to between
+  // the feet a stride ahead at the next touchdown, with velocities mirrored
+  // about mid-stance (see LIPMTrajGenerator for the general solution)
+  const double T = gait.duration;
+  const double s = gait.stride_length;
+  const double d = gait.foot_spread;
+  const double omega = sqrt(9.81 / gait.com_height);
+  const double h = T / (num_knots - 1);
+  const Vector3d stance_foot(s / 2, d, 0);
+
+  CassieWalkingGuess guess;
+  guess.times = VectorXd::LinSpaced(num_knots, 0, T);
+  guess.max_kinematic_residual = 0;
+  MatrixXd q_knots(n_q, num_knots);
+  for (int i = 0; i < num_knots; i++) {
+    const double t = guess.times(i);
+    const Vector3d com(
+        s / 2 - s / 2 * sinh(omega * (T / 2 - t)) / sinh(omega * T / 2),
+        d - d * cosh(omega * (t - T / 2)) / cosh(omega * T / 2),
+        gait.com_height);
+    const Vector3d swing_foot(-s / 2 + s * (1 - cos(M_PI * t / T)), -d,
+                              gait.swing_height * sin(M_PI * t / T));
+
+    // Contact points at the footholds, with the feet flat on the ground
+    WorldPointEvaluator<double> left_front(
+        plant, left_toe.first, left_toe.second, R_GW,
+        R_WG * (stance_foot - left_axis / 2));
+    WorldPointEvaluator<double> left_rear(
+        plant, left_heel.first, left_heel.second, R_GW,
+        R_WG * (stance_foot + left_axis / 2));
+    WorldPointEvaluator<double> right_front(
+        plant, right_toe.first, right_toe.second, R_GW,
+        R_WG * (swing_foot - right_axis / 2));
+    WorldPointEvaluator<double> right_rear(
+        plant, right_heel.first, right_heel.second, R_GW,
+        R_WG * (swing_foot + right_axis / 2));
+    KinematicEvaluatorSet<double> evaluators(plant);
+    evaluators.add_evaluator(&left_front);
+    evaluators.add_evaluator(&left_rear);
+    evaluators.add_evaluator(&right_front);
+    evaluators.add_evaluator(&right_rear);
+    evaluators.add_evaluator(&left_loop);
+    evaluators.add_evaluator(&right_loop);
+
+    // The pelvis is placed to put the center of mass on the LIPM, and the
+    // legs are projected onto the constraints (starting from the last knot)
+    KinematicProjector projector(evaluators);
+    for (int k = 0; k < 6; k++) {
+      projector.FixVelocity(base_velocity_start + k);
+    }
+    KinematicProjectionResult projection;
+    for (int pass = 0; pass < kPlacementPasses; pass++) {
+      plant.SetPositions(context.get(), q);
+      q.segment<3>(base_position_start) +=
+          R_WG * com - plant.CalcCenterOfMassPosition(*context);
+      projection = projector.Project(q);
+      q = projection.q;
+    }
+    guess.max_kinematic_residual =
+        std::max(guess.max_kinematic_residual, projection.residual);
+    q_knots.col(i) = q;
+  }
+
+  // Velocities and accelerations
+  const MatrixXd qdot_knots = FiniteDifference(q_knots, h);
+  MatrixXd v_knots(n_v, num_knots);
+  for (int i = 0; i < num_knots; i++) {
+    plant.SetPositions(context.get(), q_knots.col(i));
+    VectorXd v(n_v);
+    plant.MapQDotToVelocity(*context, qdot_knots.col(i), &v);
+    v_knots.col(i) = v;
+  }
+  const MatrixXd vdot_knots = FiniteDifference(v_knots, h);
+  guess.x.resize(n_q + n_v, num_knots);
+  guess.x << q_knots, v_knots;
+
+  // Inverse dynamics with the left support constraints, whose contact forces
+  // are in the ground frame
+  WorldPointEvaluator<double> stance_front(plant, left_toe.first,
+                                           left_toe.second, R_GW);
+  WorldPointEvaluator<double> stance_rear(plant, left_heel.first,
+                                          left_heel.second, R_GW);
+  KinematicEvaluatorSet<double> stance(plant);
+  stance.add_evaluator(&stance_front);
+  stance.add_evaluator(&stance_rear);
+  stance.add_evaluator(&left_loop);
+  stance.add_evaluator(&right_loop);
+  const int n_l = stance.count_full();
+  const MatrixXd B = plant.MakeActuationMatrix();
+  MatrixXd M(n_v, n_v);
+  VectorXd bias(n_v);
+  MatrixXd A(n_v, n_u + n_l);
+  guess.u.resize(n_u, num_knots);
+  guess.lambda.resize(n_l, num_knots);
+  for (int i = 0; i < num_knots; i++) {
+    plant.SetPositionsAndVelocities(context.get(), guess.x.col(i));
+    plant.CalcMassMatrix(*context, &M);
+    plant.CalcBiasTerm(*context, &bias);
+    // M vdot + C v = tau_g + B u + J' lambda
+    A << B, stance.EvalFullJacobian(*context).transpose();
+    const VectorXd b = M * vdot_knots.col(i) + bias -
+                       plant.CalcGravityGeneralizedForces(*context);
+    MatrixXd AtA = A.transpose() * A;
+    AtA.diagonal().array() += kRegularization * AtA.diagonal().maxCoeff();
+    const VectorXd z = AtA.ldlt().solve(A.transpose() * b);
+    guess.u.col(i) = z.head(n_u);
+    guess.lambda.col(i) = z.tail(n_l);
+  }
+  return guess;
+}
+
+}  // namespace dairlib
@@ -0,0 +1,58 @@
+#pragma once
+
+#include "drake/multibody/plant/multibody_plant.h"
+
+namespace dairlib {
+
+/// Walking step of the LIPM initial guess, as in run_dircon_walking: a left
+/// single support phase that starts and ends with the center of mass between
+/// the feet, over which the center of mass moves forward by stride_length.
+struct LipmGaitParameters {
+  double stride_length = 0.2;
+  double duration = 0.4;
+  /// Height of the center of mass above the ground
+  double com_height = 0.85;
+  /// Lateral distance between each foot and the center line of the gait
+  double foot_spread = 0.12;
+  /// Apex height of the swing foot
+  double swing_height = 0.1;
+  double ground_incline = 0;
+};
+
+/// Knot values of the initial guess, one column per knot
+struct CassieWalkingGuess {
+  Eigen::VectorXd times;
+  Eigen::MatrixXd x;
+  Eigen::MatrixXd u;
+  /// Forces of the left support constraints, in the order of
+  /// run_dircon_walking: left toe front (3), left toe rear (3), left four-bar,
+  /// right four-bar. The contact forces are expressed in the ground frame.
+  Eigen::MatrixXd lambda;
+  /// Largest norm, over the knots, of the violation of the contact and loop
+  /// closure constraints
+  double max_kinematic_residual;
+};
+
+/// Synthesizes a walking step of the fixed-spring Cassie from a linear
+/// inverted pendulum (LIPM) gait, to initialize DIRCON with a dynamically
+/// consistent trajectory.
+///  - The center of mass follows the analytical LIPM solution over the stance
+///    foot (see LIPMTrajGenerator), symmetric about mid-stance, so that the
+///    gait is periodic over steps.
+///  - The swing foot moves from the previous to the next foothold on a
+///    cosine profile.
+///  - The configuration of each knot is projected onto the contact and loop
+///    closure constraints by a KinematicProjector, with the pelvis placed so
+///    that the center of mass is on the LIPM trajectory.
+///  - Velocities and accelerations are finite differences of the knots, and
+///    the inputs and forces the (regularized) least squares solution of the
+///    inverse dynamics.
+/// @param plant the fixed-spring Cassie (cassie_fixed_springs.urdf), with a
+///    floating base
+/// @param gait
+/// @param num_knots number of knots of the single support phase
+CassieWalkingGuess CassieLipmWalkingGuess(
+    const drake::multibody::MultibodyPlant<double>& plant,
+    const LipmGaitParameters& gait, int num_knots);
+
+}  // namespace dairlib
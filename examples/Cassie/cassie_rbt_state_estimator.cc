@@ -8,6 +8,7 @@
 #include "drake/solvers/equality_constrained_qp_solver.h"
 #include "drake/math/orthonormal_basis.h"
 #include "drake/multibody/rigid_body_plant/contact_resultant_force_calculator.h"
+#include "systems/framework/system_tracer.h"
 
 namespace dairlib {
 namespace systems {
@@ -36,7 +37,7 @@ using multibody::GetBodyIndexFromName;
 CassieRbtStateEstimator::CassieRbtStateEstimator(
     const RigidBodyTree<double>& tree, bool is_floating_base,
     bool test_with_ground_truth_state, bool print_info_to_terminal,
-    int hardware_test_mode) :
+    int hardware_test_mode, double update_period) :
         tree_(tree),
         is_floating_base_(is_floating_base) {
   // Flags for testing and tuning
@@ -82,7 +83,12 @@ CassieRbtStateEstimator::CassieRbtStateEstimator(
     }
 
     // Declare update event for EKF
-    DeclarePerStepUnrestrictedUpdateEvent(&CassieRbtStateEstimator::Update);
+    if (update_period > 0) {
+      DeclarePeriodicUnrestrictedUpdateEvent(update_period, 0,
+                                             &CassieRbtStateEstimator::Update);
+    } else {
+      DeclarePerStepUnrestrictedUpdateEvent(&CassieRbtStateEstimator::Update);
+    }
 
     // a state which stores previous timestamp
     time_idx_ = DeclareDiscreteState(VectorXd::Zero(1));
@@ -1039,6 +1045,7 @@ void CassieRbtStateEstimator::EstimateContactForController(
 
 EventStatus CassieRbtStateEstimator::Update(const Context<double>& context,
     drake::systems::State<double>* state) const {
+  TraceScope trace("update", this->get_name(), "Update");
   // Get cassie output
   const auto& cassie_out = this->EvalAbstractInput(
       context, cassie_out_input_port_)->get_value<cassie_out_t>();
@@ -1342,6 +1349,7 @@ EventStatus CassieRbtStateEstimator::Update(const Context<double>& context,
 /// ordering of the vector are made, utilizes index maps to make this mapping.
 void CassieRbtStateEstimator::CopyStateOut(
     const Context<double>& context, OutputVector<double>* output) const {
+  TraceScope trace("calc", this->get_name(), "CopyStateOut");
   const auto& cassie_out = this->EvalAbstractInput(
       context, cassie_out_input_port_)->get_value<cassie_out_t>();
   // There might be a better way to initialize?
@@ -1403,5 +1411,85 @@ void CassieRbtStateEstimator::setPreviousImuMeasurement(Context<double>* context
       << imu_value;
 }
 
+void CassieRbtStateEstimator::AddSerializers(ContextSerializer* serializer) {
+  serializer->AddType<inekf::InEKF>(
+      [](const inekf::InEKF& filter, std::ostream* out) {
+        const auto& state = filter.getState();
+        ContextSerializer::WriteMatrix(state.getX(), out);
+        ContextSerializer::WriteMatrix(state.getTheta(), out);
+        ContextSerializer::WriteMatrix(state.getP(), out);
+        const auto& noise = filter.getNoiseParams();
+        ContextSerializer::WriteMatrix(noise.getGyroscopeCov(), out);
+        ContextSerializer::WriteMatrix(noise.getAccelerometerCov(), out);
+        ContextSerializer::WriteMatrix(noise.getGyroscopeBiasCov(), out);
+        ContextSerializer::WriteMatrix(noise.getAccelerometerBiasCov(), out);
+        ContextSerializer::WriteMatrix(noise.getContactCov(), out);
+        const auto contacts = filter.getContacts();
+        ContextSerializer::WriteScalar<int>(contacts.size(), out);
+        for (const auto& contact : contacts) {
+          ContextSerializer::WriteScalar<int>(contact.first, out);
+          ContextSerializer::WriteScalar<bool>(contact.second, out);
+        }
+        const auto positions = filter.getEstimatedContactPositions();
+        ContextSerializer::WriteScalar<int>(positions.size(), out);
+        for (const auto& position : positions) {
+          ContextSerializer::WriteScalar<int>(position.first, out);
+          ContextSerializer::WriteScalar<int>(position.second, out);
+        }
+      },
+      [](std::istream* in, inekf::InEKF* filter) {
+        MatrixXd X = ContextSerializer::ReadMatrix(in);
+        VectorXd Theta = ContextSerializer::ReadMatrix(in);
+        MatrixXd P = ContextSerializer::ReadMatrix(in);
+        inekf::NoiseParams noise;
+        noise.setGyroscopeNoise(Matrix3d(ContextSerializer::ReadMatrix(in)));
+        noise.setAccelerometerNoise(
+            Matrix3d(ContextSerializer::ReadMatrix(in)));
+        noise.setGyroscopeBiasNoise(
+            Matrix3d(ContextSerializer::ReadMatrix(in)));
+        noise.setAccelerometerBiasNoise(
+            Matrix3d(ContextSerializer::ReadMatrix(in)));
+        noise.setContactNoise(Matrix3d(ContextSerializer::ReadMatrix(in)));
+        std::vector<std::pair<int, bool>> contacts(
+            ContextSerializer::ReadScalar<int>(in));
+        for (auto& contact : contacts) {
+          contact.first = ContextSerializer::ReadScalar<int>(in);
+          contact.second = ContextSerializer::ReadScalar<bool>(in);
+        }
+        // Estimated contact positions, ordered by their column in X
+        std::map<int, int> positions;
+        int num_positions = ContextSerializer::ReadScalar<int>(in);
+        for (int i = 0; i < num_positions; i++) {
+          int id = ContextSerializer::ReadScalar<int>(in);
+          positions[ContextSerializer::ReadScalar<int>(in)] = id;
+        }
+
+        // InEKF has no setter for its map of estimated contact positions.
+        // Rebuild it the way the filter does, by augmenting the base state
+        // with each contact in the order of its column, then overwrite the
+        // whole state.
+        inekf::RobotState base_state(X.topLeftCorner(5, 5), Theta,
+                                     MatrixXd::Identity(15, 15));
+        *filter = inekf::InEKF(base_state, noise);
+        if (!positions.empty()) {
+          std::vector<std::pair<int, bool>> estimated_contacts;
+          inekf::vectorKinematics kinematics;
+          for (const auto& position : positions) {
+            estimated_contacts.emplace_back(position.second, true);
+            kinematics.emplace_back(position.second,
+                                    Eigen::Matrix4d::Identity(),
+                                    Eigen::Matrix<double, 6, 6>::Identity());
+          }
+          filter->setContacts(estimated_contacts);
+          filter->CorrectKinematics(kinematics);
+          DRAKE_DEMAND(filter->getEstimatedContactPositions().size() ==
+                       positions.size());
+        }
+        filter->setContacts(contacts);
+        inekf::RobotState state(X, Theta, P);
+        filter->setState(state);
+      });
+}
+
 }  // namespace systems
 }  // namespace dairlib
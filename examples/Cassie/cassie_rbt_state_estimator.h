@@ -10,6 +10,7 @@
 #include "src/InEKF.h"
 
 #include "attic/multibody/rigidbody_utils.h"
+#include "systems/framework/context_serializer.h"
 #include "systems/framework/output_vector.h"
 #include "systems/framework/timestamped_vector.h"
 #include "examples/Cassie/datatypes/cassie_out_t.h"
@@ -41,11 +42,14 @@ class CassieRbtStateEstimator : public drake::systems::LeafSystem<double> {
   ///    -1: regular EKF (not a testing mode).
   ///    0: assume both feet are always in contact with ground.
   ///    1: assume both feet are always in the air.
+  /// @param update_period period of the EKF update. If zero, the update runs
+  /// every simulator step (i.e. on every message of dispatcher_robot_out).
   explicit CassieRbtStateEstimator(const RigidBodyTree<double>& tree,
                                    bool is_floating_base,
                                    bool test_with_ground_truth_state = false,
                                    bool print_info_to_terminal = false,
-                                   int hardware_test_mode = -1);
+                                   int hardware_test_mode = -1,
+                                   double update_period = 0);
   void solveFourbarLinkage(const Eigen::VectorXd& q_init,
                            double* left_heel_spring,
                            double* right_heel_spring) const;
@@ -77,6 +81,12 @@ class CassieRbtStateEstimator : public drake::systems::LeafSystem<double> {
                                Eigen::Vector4d q);
   void setPreviousImuMeasurement(drake::systems::Context<double>* context,
                                  Eigen::VectorXd imu_value);
+
+  /// Registers the serializer of the EKF state (inekf::InEKF, the abstract
+  /// state of the estimator), so that the context of the estimator can be
+  /// saved and restored with ContextSerializer
+  static void AddSerializers(ContextSerializer* serializer);
+
  private:
   void AssignImuValueToOutputVector(const cassie_out_t& cassie_out,
       systems::OutputVector<double>* output) const;
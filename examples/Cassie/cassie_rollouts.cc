@@ -0,0 +1,234 @@
+#include "examples/Cassie/cassie_rollouts.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <fstream>
+#include <iostream>
+#include <limits>
+#include <random>
+#include <thread>
+
+#include "multibody/multibody_utils.h"
+#include "systems/framework/context_serializer.h"
+
+#include "drake/common/text_logging.h"
+
+namespace dairlib {
+
+using drake::trajectories::PiecewisePolynomial;
+using Eigen::MatrixXd;
+using Eigen::Quaterniond;
+using Eigen::Vector2d;
+using Eigen::VectorXd;
+using std::vector;
+
+namespace {
+
+double Uniform(std::mt19937* generator, double lower, double upper) {
+  std::uniform_real_distribution<double> distribution(0, 1);
+  return lower + (upper - lower) * distribution(*generator);
+}
+
+}  // namespace
+
+RolloutConditions SampleRolloutConditions(
+    const RolloutPerturbationRanges& ranges, int trial, int base_seed) {
+  std::seed_seq seed_sequence{base_seed, trial};
+  std::mt19937 generator(seed_sequence);
+
+  RolloutConditions conditions;
+  conditions.trial = trial;
+  conditions.seed = std::uniform_int_distribution<int>(
+      0, std::numeric_limits<int>::max())(generator);
+  double push_magnitude = Uniform(&generator, 0, ranges.max_push_force);
+  double push_direction = Uniform(&generator, -M_PI, M_PI);
+  conditions.push_force << push_magnitude * cos(push_direction),
+      push_magnitude * sin(push_direction);
+  conditions.push_time =
+      Uniform(&generator, ranges.min_push_time, ranges.max_push_time);
+  conditions.drop_height = Uniform(&generator, 0, ranges.max_drop_height);
+  conditions.mu = Uniform(&generator, ranges.min_mu, ranges.max_mu);
+  conditions.mass_scale =
+      1 + Uniform(&generator, -ranges.max_mass_deviation,
+                  ranges.max_mass_deviation);
+  return conditions;
+}
+
+CassieRolloutRunner::CassieRolloutRunner(
+    const CassieClosedLoopSimOptions& sim_options,
+    const RolloutPerturbationRanges& ranges, double duration,
+    double pelvis_height)
+    : sim_options_(sim_options), ranges_(ranges), duration_(duration) {
+  DRAKE_DEMAND(ranges.min_push_time > 0);
+  DRAKE_DEMAND(ranges.push_duration > 0);
+  // The fixed point solve is done once, here, rather than in every rollout
+  CassieClosedLoopSim sim(sim_options_);
+  q_standing_ = sim.CalcStandingPositions(pelvis_height);
+}
+
+vector<RolloutResult> CassieRolloutRunner::Run(int num_trials, int num_threads,
+                                               int base_seed) const {
+  return RunBranches("", num_trials, num_threads, base_seed);
+}
+
+vector<RolloutResult> CassieRolloutRunner::RunBranches(
+    const std::string& snapshot_file, int num_trials, int num_threads,
+    int base_seed) const {
+  DRAKE_DEMAND(num_threads > 0);
+  DRAKE_DEMAND(snapshot_file.empty() || ranges_.sensor_noise == 0);
+  vector<RolloutResult> results(num_trials);
+  std::atomic<int> next_trial(0);
+
+  auto worker = [&]() {
+    for (int trial = next_trial++; trial < num_trials; trial = next_trial++) {
+      RolloutConditions conditions =
+          SampleRolloutConditions(ranges_, trial, base_seed);
+      try {
+        results[trial] = RunRollout(conditions, snapshot_file);
+      } catch (const std::exception& e) {
+        drake::log()->warn("Rollout {} failed: {}", trial, e.what());
+        results[trial].conditions = conditions;
+        results[trial].success = false;
+      }
+    }
+  };
+
+  vector<std::thread> threads;
+  for (int i = 1; i < std::min(num_threads, num_trials); i++) {
+    threads.emplace_back(worker);
+  }
+  worker();
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  return results;
+}
+
+RolloutResult CassieRolloutRunner::RunRollout(
+    const RolloutConditions& conditions,
+    const std::string& snapshot_file) const {
+  auto start = std::chrono::steady_clock::now();
+
+  // The push of a branch is relative to the time of its snapshot
+  double start_time = 0;
+  if (!snapshot_file.empty()) {
+    start_time = systems::ContextSerializer::LoadTime(snapshot_file);
+  }
+
+  CassieClosedLoopSimOptions options = sim_options_;
+  options.mu = conditions.mu;
+  options.sensor_noise = ranges_.sensor_noise;
+  options.random_seed = conditions.seed;
+  if (conditions.push_force.norm() > 0) {
+    const double push_start = start_time + conditions.push_time;
+    const double push_end = push_start + ranges_.push_duration;
+    vector<double> breaks = {0, push_start, push_end, push_end + 1};
+    vector<MatrixXd> samples(breaks.size(), MatrixXd::Zero(3, 1));
+    samples[1].topRows(2) = conditions.push_force;
+    options.pelvis_force =
+        PiecewisePolynomial<double>::ZeroOrderHold(breaks, samples);
+  }
+  CassieClosedLoopSim sim(options);
+  const auto& plant = sim.get_plant();
+  auto position_map = multibody::makeNameToPositionsMap(plant);
+  const int x_idx = position_map.at("base_x");
+  const int y_idx = position_map.at("base_y");
+  const int z_idx = position_map.at("base_z");
+  const int qw_idx = position_map.at("base_qw");
+
+  if (snapshot_file.empty()) {
+    VectorXd q_init = q_standing_;
+    q_init(z_idx) += conditions.drop_height;
+    sim.SetInitialState(q_init, VectorXd::Zero(plant.num_velocities()));
+  } else {
+    sim.LoadSnapshot(snapshot_file);
+  }
+  const auto& pelvis = plant.GetRigidBodyByName("pelvis");
+  pelvis.SetMass(&sim.get_mutable_plant_context(),
+                 conditions.mass_scale * pelvis.default_mass());
+
+  RolloutResult result;
+  result.conditions = conditions;
+  result.success = true;
+  result.start_time = start_time;
+  double sum_squared_height_error = 0;
+  int num_samples = 0;
+  VectorXd x;
+  const double end_time = start_time + duration_;
+  for (double t = start_time + monitor_period_; ; t += monitor_period_) {
+    sim.AdvanceTo(std::min(t, end_time));
+    x = sim.GetState();
+
+    double height = x(z_idx);
+    Quaterniond quat(x(qw_idx), x(qw_idx + 1), x(qw_idx + 2), x(qw_idx + 3));
+    double cos_tilt = quat.normalized().toRotationMatrix()(2, 2);
+    double tilt = acos(std::max(-1.0, std::min(1.0, cos_tilt)));
+    sum_squared_height_error += pow(height - q_standing_(z_idx), 2);
+    num_samples++;
+    result.max_tilt = std::max(result.max_tilt, tilt);
+
+    if (!(height > fall_height_)) {
+      // Fell, or the state is not finite
+      result.success = false;
+      break;
+    }
+    if (t >= end_time) break;
+  }
+  result.end_time = sim.get_time();
+  result.rms_height_error = sqrt(sum_squared_height_error / num_samples);
+  result.final_position << x(x_idx), x(y_idx);
+  result.wall_time = std::chrono::duration<double>(
+                         std::chrono::steady_clock::now() - start)
+                         .count();
+  return result;
+}
+
+void WriteRolloutResults(const vector<RolloutResult>& results,
+                         const std::string& filename) {
+  std::ofstream file(filename);
+  file << "trial,seed,push_x,push_y,push_time,drop_height,mu,mass_scale,"
+          "success,start_time,end_time,rms_height_error,max_tilt,final_x,"
+          "final_y,wall_time\n";
+  for (const auto& result : results) {
+    const auto& c = result.conditions;
+    file << c.trial << "," << c.seed << "," << c.push_force(0) << ","
+         << c.push_force(1) << "," << c.push_time << "," << c.drop_height
+         << "," << c.mu << "," << c.mass_scale << "," << result.success << ","
+         << result.start_time << "," << result.end_time << "," << result.rms_height_error << ","
+         << result.max_tilt << "," << result.final_position(0) << ","
+         << result.final_position(1) << "," << result.wall_time << "\n";
+  }
+}
+
+void PrintRolloutSummary(const vector<RolloutResult>& results) {
+  int num_success = 0;
+  double sum_height_error = 0;
+  double max_height_error = 0;
+  double sum_tilt = 0;
+  double max_tilt = 0;
+  double sum_simulated_time = 0;
+  double sum_wall_time = 0;
+  for (const auto& result : results) {
+    num_success += result.success;
+    sum_height_error += result.rms_height_error;
+    max_height_error = std::max(max_height_error, result.rms_height_error);
+    sum_tilt += result.max_tilt;
+    max_tilt = std::max(max_tilt, result.max_tilt);
+    // Branches do not re-simulate the prefix up to their snapshot
+    sum_simulated_time += result.end_time - result.start_time;
+    sum_wall_time += result.wall_time;
+  }
+  int n = results.size();
+  std::cout << "Rollouts: " << n << ", successful: " << num_success << " ("
+            << 100.0 * num_success / n << "%)" << std::endl;
+  std::cout << "RMS pelvis height error (m): mean " << sum_height_error / n
+            << ", max " << max_height_error << std::endl;
+  std::cout << "Max pelvis tilt (rad): mean " << sum_tilt / n << ", max "
+            << max_tilt << std::endl;
+  std::cout << "Simulated " << sum_simulated_time << " s in "
+            << sum_wall_time << " s of rollout time" << std::endl;
+}
+
+}  // namespace dairlib
@@ -0,0 +1,137 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include <Eigen/Dense>
+
+#include "examples/Cassie/closed_loop_sim.h"
+
+namespace dairlib {
+
+/// Ranges of the randomized conditions of the rollouts run by
+/// CassieRolloutRunner. Each quantity is drawn uniformly in its range.
+struct RolloutPerturbationRanges {
+  /// Horizontal push on the pelvis, in a random direction (N)
+  double max_push_force = 0;
+  /// Duration and start time of the push (s)
+  double push_duration = 0.1;
+  double min_push_time = 0.5;
+  double max_push_time = 1.5;
+  /// Clearance between the feet and the ground at the start, i.e. the robot
+  /// is dropped from up to this height (m)
+  double max_drop_height = 0;
+  /// Friction coefficient of the ground
+  double min_mu = 0.8;
+  double max_mu = 0.8;
+  /// Relative change of the mass of the pelvis
+  double max_mass_deviation = 0;
+  /// Standard deviation of the encoder noise (the same for all rollouts, only
+  /// its seed is randomized)
+  double sensor_noise = 0;
+};
+
+/// Conditions of one rollout, drawn by SampleRolloutConditions()
+struct RolloutConditions {
+  int trial = 0;
+  int seed = 0;
+  Eigen::Vector2d push_force = Eigen::Vector2d::Zero();
+  double push_time = 0;
+  double drop_height = 0;
+  double mu = 0;
+  double mass_scale = 1;
+};
+
+/// Outcome of one rollout
+struct RolloutResult {
+  RolloutConditions conditions;
+  /// False if the robot fell (or the simulation failed)
+  bool success = false;
+  /// Simulation time at the start of the rollout: zero, or the time of the
+  /// snapshot it was forked from
+  double start_time = 0;
+  /// Time of the fall, or the end of the rollout if the robot did not fall
+  double end_time = 0;
+  /// RMS deviation of the pelvis height from its initial standing height
+  double rms_height_error = 0;
+  /// Maximum angle between the pelvis z axis and the vertical (rad)
+  double max_tilt = 0;
+  /// Final horizontal position of the pelvis, in the world frame
+  Eigen::Vector2d final_position = Eigen::Vector2d::Zero();
+  /// Wall clock time of the rollout (s)
+  double wall_time = 0;
+};
+
+/// Draws the conditions of rollout `trial`. They only depend on the ranges,
+/// the trial index and the base seed, not on the order in which the rollouts
+/// are run.
+RolloutConditions SampleRolloutConditions(
+    const RolloutPerturbationRanges& ranges, int trial, int base_seed);
+
+/// CassieRolloutRunner evaluates the closed loop system of
+/// CassieClosedLoopSim under randomized conditions (pushes, drop height,
+/// friction, mass and sensor noise).
+///
+/// Every rollout builds its own closed loop diagram, with its own contexts
+/// and random seed, so the rollouts are independent and are run concurrently
+/// on a pool of threads. Their results do not depend on the number of
+/// threads.
+class CassieRolloutRunner {
+ public:
+  /// @param sim_options options of the closed loop simulations (the friction,
+  ///   sensor noise, random seed and pelvis force are set per rollout)
+  /// @param ranges ranges of the randomized conditions
+  /// @param duration duration of each rollout (s)
+  /// @param pelvis_height initial standing height of the pelvis (m)
+  CassieRolloutRunner(const CassieClosedLoopSimOptions& sim_options,
+                      const RolloutPerturbationRanges& ranges,
+                      double duration, double pelvis_height = 1.0);
+
+  /// Runs rollouts 0 to num_trials - 1 on num_threads threads, and returns
+  /// their results in order
+  std::vector<RolloutResult> Run(int num_trials, int num_threads,
+                                 int base_seed = 0) const;
+
+  /// Runs rollouts 0 to num_trials - 1 forked from a snapshot of a closed
+  /// loop simulation (see CassieClosedLoopSim::SaveSnapshot()), instead of
+  /// from the standing configuration, so that the shared prefix up to the
+  /// snapshot is not re-simulated. The rollouts last the given duration from
+  /// the time of the snapshot, their push times are relative to it, and the
+  /// drop height is unused. The simulation options must be the ones of the
+  /// saved simulation. Sensor noise is not supported (see
+  /// CassieClosedLoopSim::SaveSnapshot()).
+  std::vector<RolloutResult> RunBranches(const std::string& snapshot_file,
+                                         int num_trials, int num_threads,
+                                         int base_seed = 0) const;
+
+  /// Runs a single rollout, from the standing configuration or, if
+  /// snapshot_file is not empty, from a snapshot
+  RolloutResult RunRollout(const RolloutConditions& conditions,
+                           const std::string& snapshot_file = "") const;
+
+  /// Pelvis height under which the robot is considered fallen (m)
+  void set_fall_height(double fall_height) { fall_height_ = fall_height; }
+  /// Period at which the rollout is monitored (s)
+  void set_monitor_period(double monitor_period) {
+    monitor_period_ = monitor_period;
+  }
+
+ private:
+  const CassieClosedLoopSimOptions sim_options_;
+  const RolloutPerturbationRanges ranges_;
+  const double duration_;
+  double fall_height_ = 0.5;
+  double monitor_period_ = 0.01;
+
+  // Standing configuration, shared by all rollouts
+  Eigen::VectorXd q_standing_;
+};
+
+/// Writes one line per rollout (conditions and outcome) to a CSV file
+void WriteRolloutResults(const std::vector<RolloutResult>& results,
+                         const std::string& filename);
+
+/// Prints the success rate and the statistics of the tracking metrics
+void PrintRolloutSummary(const std::vector<RolloutResult>& results);
+
+}  // namespace dairlib
@@ -0,0 +1,277 @@
+#include "examples/Cassie/cassie_udp_sim.h"
+
+#include <arpa/inet.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+
+#include "dairlib/lcmt_cassie_out.hpp"
+#include "examples/Cassie/cassie_fixed_point_solver.h"
+#include "examples/Cassie/cassie_utils.h"
+#include "examples/Cassie/datatypes/cassie_names.h"
+#include "examples/Cassie/datatypes/cassie_out_t.h"
+#include "examples/Cassie/datatypes/cassie_user_in_t.h"
+#include "examples/Cassie/networking/udp_lcm_translator.h"
+#include "multibody/multibody_utils.h"
+#include "systems/sensors/sim_cassie_sensor_aggregator.h"
+#include "systems/sensors/sim_imu.h"
+
+#include "drake/common/drake_throw.h"
+#include "drake/geometry/scene_graph.h"
+#include "drake/systems/framework/diagram_builder.h"
+#include "drake/systems/primitives/pass_through.h"
+
+namespace dairlib {
+
+using drake::geometry::SceneGraph;
+using drake::multibody::MultibodyPlant;
+using drake::systems::DiagramBuilder;
+using drake::systems::PassThrough;
+using drake::systems::Simulator;
+using Eigen::Vector3d;
+using Eigen::VectorXd;
+using std::chrono::duration;
+using std::chrono::duration_cast;
+using std::chrono::nanoseconds;
+using std::chrono::steady_clock;
+
+// Position of the IMU in the pelvis frame (as in CassieRbtStateEstimator)
+static const Vector3d kImuPositionInPelvis(0.03155, 0, -0.07996);
+
+void CassieUdpSimStats::Print() const {
+  std::cout << "State packets sent: " << packets_sent << std::endl;
+  std::cout << "Commands received: " << commands_received
+            << " (discarded packets: " << packets_discarded << ")"
+            << std::endl;
+  std::cout << "Overruns: " << overruns
+            << ", periods without a new command: " << missed_commands
+            << std::endl;
+  if (latencies.empty()) return;
+  std::vector<double> sorted = latencies;
+  std::sort(sorted.begin(), sorted.end());
+  double sum = 0;
+  for (double latency : sorted) sum += latency;
+  auto percentile = [&sorted](double p) {
+    return sorted[static_cast<int>(p * (sorted.size() - 1))];
+  };
+  std::cout << "Round trip latency (ms): mean " << 1e3 * sum / sorted.size()
+            << ", median " << 1e3 * percentile(0.5) << ", 99th percentile "
+            << 1e3 * percentile(0.99) << ", max " << 1e3 * sorted.back()
+            << std::endl;
+}
+
+CassieUdpSim::CassieUdpSim(const CassieUdpSimOptions& options)
+    : options_(options) {
+  DRAKE_DEMAND(options.period > 0);
+
+  DiagramBuilder<double> builder;
+  SceneGraph<double>& scene_graph = *builder.AddSystem<SceneGraph>();
+  scene_graph.set_name("scene_graph");
+  plant_ = builder.AddSystem<MultibodyPlant>(options.sim_dt);
+  multibody::addFlatTerrain(plant_, &scene_graph, options.mu, options.mu);
+  addCassieMultibody(plant_, &scene_graph, true /*floating base*/,
+                     "examples/Cassie/urdf/cassie_v2.urdf",
+                     true /*spring model*/, true /*loop closure*/);
+  plant_->Finalize();
+  plant_->set_penetration_allowance(options.penetration_allowance);
+  plant_->set_stiction_tolerance(options.v_stiction);
+  builder.Connect(
+      plant_->get_geometry_poses_output_port(),
+      scene_graph.get_source_pose_port(plant_->get_source_id().value()));
+  builder.Connect(scene_graph.get_query_output_port(),
+                  plant_->get_geometry_query_input_port());
+
+  // The actuation is an input of the diagram, set every period from the
+  // latest command. It is also reported in cassie_out_t.
+  auto actuation = builder.AddSystem<PassThrough>(plant_->num_actuators());
+  builder.ExportInput(actuation->get_input_port());
+  builder.Connect(actuation->get_output_port(),
+                  plant_->get_actuation_input_port());
+
+  // Sensors
+  auto imu = builder.AddSystem<systems::SimImu>(*plant_, "pelvis",
+                                                kImuPositionInPelvis,
+                                                options.period);
+  auto sensor_aggregator =
+      builder.AddSystem<systems::SimCassieSensorAggregator>(*plant_);
+  builder.Connect(plant_->get_state_output_port(),
+                  imu->get_input_port_state());
+  builder.Connect(actuation->get_output_port(),
+                  sensor_aggregator->get_input_port_input());
+  builder.Connect(plant_->get_state_output_port(),
+                  sensor_aggregator->get_input_port_state());
+  builder.Connect(imu->get_output_port_acce(),
+                  sensor_aggregator->get_input_port_acce());
+  builder.Connect(imu->get_output_port_gyro(),
+                  sensor_aggregator->get_input_port_gyro());
+  builder.ExportOutput(sensor_aggregator->get_output_port(0));
+
+  diagram_ = builder.Build();
+  diagram_->set_name("cassie udp sim");
+  simulator_ = std::make_unique<Simulator<double>>(*diagram_);
+  simulator_->set_publish_every_time_step(false);
+  simulator_->set_publish_at_initialization(false);
+
+  auto actuator_map = multibody::makeNameToActuatorsMap(*plant_);
+  for (const auto& name : cassieEffortNames) {
+    user_in_to_actuation_index_.push_back(actuator_map.at(name));
+  }
+  actuation_ = VectorXd::Zero(plant_->num_actuators());
+
+  // Sockets
+  send_socket_ = socket(AF_INET, SOCK_DGRAM, 0);
+  DRAKE_THROW_UNLESS(send_socket_ >= 0);
+  memset(&send_address_, 0, sizeof(send_address_));
+  send_address_.sin_family = AF_INET;
+  send_address_.sin_port = htons(options.output_port);
+  DRAKE_THROW_UNLESS(
+      inet_aton(options.address.c_str(), &send_address_.sin_addr) != 0);
+
+  receive_socket_ = socket(AF_INET, SOCK_DGRAM, 0);
+  DRAKE_THROW_UNLESS(receive_socket_ >= 0);
+  int reuse = 1;
+  setsockopt(receive_socket_, SOL_SOCKET, SO_REUSEADDR, &reuse,
+             sizeof(reuse));
+  struct sockaddr_in receive_address;
+  memset(&receive_address, 0, sizeof(receive_address));
+  receive_address.sin_family = AF_INET;
+  receive_address.sin_port = htons(options.input_port);
+  DRAKE_THROW_UNLESS(
+      inet_aton(options.address.c_str(), &receive_address.sin_addr) != 0);
+  DRAKE_THROW_UNLESS(bind(receive_socket_,
+                          (const struct sockaddr*)&receive_address,
+                          sizeof(receive_address)) >= 0);
+}
+
+CassieUdpSim::~CassieUdpSim() {
+  close(send_socket_);
+  close(receive_socket_);
+}
+
+void CassieUdpSim::SetStandingState(double pelvis_height) {
+  VectorXd q, u, lambda;
+  CassieFixedPointSolver(*plant_, pelvis_height, 0 /*mu*/,
+                         70 /*min normal force*/, true /*linear cone*/,
+                         0.2 /*toe spread*/, &q, &u, &lambda);
+  auto& context = simulator_->get_mutable_context();
+  context.SetTime(0);
+  auto& plant_context = diagram_->GetMutableSubsystemContext(*plant_, &context);
+  plant_->SetPositions(&plant_context, q);
+  plant_->SetVelocities(&plant_context,
+                        VectorXd::Zero(plant_->num_velocities()));
+  actuation_ = u;
+}
+
+void CassieUdpSim::Run(double end_time) {
+  auto& context = simulator_->get_mutable_context();
+  auto& actuation_value =
+      diagram_->get_input_port(0).FixValue(&context, actuation_);
+  simulator_->Initialize();
+
+  const auto start = steady_clock::now();
+  const double start_time = get_time();
+  for (int i = 1; get_time() < end_time; i++) {
+    SendState();
+
+    // The command received during the previous period is applied during
+    // this one
+    actuation_value.GetMutableVectorData<double>()->SetFromVector(actuation_);
+    simulator_->AdvanceTo(start_time + i * options_.period);
+
+    command_this_period_ = false;
+    if (options_.lockstep) {
+      ReceiveCommands(
+          steady_clock::now() +
+              duration_cast<steady_clock::duration>(
+                  duration<double>(options_.lockstep_timeout)),
+          true);
+    } else {
+      auto deadline = start + duration_cast<steady_clock::duration>(
+                                  duration<double>(i * options_.period));
+      if (steady_clock::now() > deadline) {
+        stats_.overruns++;
+      }
+      ReceiveCommands(deadline, false);
+    }
+    if (received_command_ && !command_this_period_) {
+      stats_.missed_commands++;
+    }
+  }
+}
+
+void CassieUdpSim::SendState() {
+  const auto& message =
+      diagram_->get_output_port(0).Eval<lcmt_cassie_out>(
+          simulator_->get_context());
+  cassie_out_t cassie_out{};
+  cassieOutFromLcm(message, &cassie_out);
+
+  unsigned char buffer[2 + CASSIE_OUT_T_LEN];
+  buffer[0] = ++seq_num_out_;
+  buffer[1] = seq_num_in_;
+  pack_cassie_out_t(&cassie_out, &buffer[2]);
+  int result = sendto(send_socket_, buffer, sizeof(buffer), 0,
+                      (struct sockaddr*)&send_address_, sizeof(send_address_));
+  DRAKE_THROW_UNLESS(result >= 0);
+
+  send_times_[seq_num_out_] = steady_clock::now();
+  awaiting_loopback_[seq_num_out_] = true;
+  stats_.packets_sent++;
+}
+
+void CassieUdpSim::ReceiveCommands(
+    std::chrono::time_point<steady_clock> deadline, bool wait_for_command) {
+  unsigned char buffer[2 + CASSIE_USER_IN_T_LEN];
+  pollfd fd{receive_socket_, POLLIN, 0};
+  while (true) {
+    if (wait_for_command && command_this_period_) return;
+    auto now = steady_clock::now();
+    // Drain the packets which are already there even if the deadline passed.
+    // ppoll takes the timeout in nanoseconds, so that the wait ends at the
+    // deadline rather than at the next whole millisecond (twice the period).
+    struct timespec timeout = {0, 0};
+    if (now < deadline) {
+      const int64_t remaining_ns =
+          duration_cast<nanoseconds>(deadline - now).count();
+      timeout.tv_sec = remaining_ns / 1000000000;
+      timeout.tv_nsec = remaining_ns % 1000000000;
+    }
+    if (ppoll(&fd, 1, &timeout, nullptr) <= 0) {
+      if (steady_clock::now() >= deadline) return;
+      continue;
+    }
+    ssize_t nbytes = recv(receive_socket_, buffer, sizeof(buffer), 0);
+    auto receive_time = steady_clock::now();
+    if (nbytes != static_cast<ssize_t>(sizeof(buffer))) {
+      stats_.packets_discarded++;
+      continue;
+    }
+
+    seq_num_in_ = buffer[0];
+    cassie_user_in_t cassie_in;
+    unpack_cassie_user_in_t(&buffer[2], &cassie_in);
+    for (int j = 0; j < static_cast<int>(user_in_to_actuation_index_.size());
+         j++) {
+      actuation_(user_in_to_actuation_index_[j]) = cassie_in.torque[j];
+    }
+
+    stats_.commands_received++;
+    // The round trip is measured against the state packet the command loops
+    // back, so that a late command is not paired with a newer state.
+    const unsigned char loopback = buffer[1];
+    if (awaiting_loopback_[loopback]) {
+      stats_.latencies.push_back(
+          duration<double>(receive_time - send_times_[loopback]).count());
+      awaiting_loopback_[loopback] = false;
+    }
+    command_this_period_ = true;
+    received_command_ = true;
+  }
+}
+
+}  // namespace dairlib
@@ -0,0 +1,131 @@
+#pragma once
+
+#include <netinet/in.h>
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <Eigen/Dense>
+
+#include "drake/multibody/plant/multibody_plant.h"
+#include "drake/systems/analysis/simulator.h"
+#include "drake/systems/framework/diagram.h"
+
+namespace dairlib {
+
+/// Options of CassieUdpSim. Times are in seconds.
+struct CassieUdpSimOptions {
+  /// Address of the robot stack. State packets (cassie_out_t) are sent to
+  /// output_port, where dispatcher_robot_out listens, and command packets
+  /// (cassie_user_in_t) are received on input_port, where dispatcher_robot_in
+  /// publishes.
+  std::string address = "127.0.0.1";
+  int output_port = 25001;
+  int input_port = 25000;
+  /// Period of the state packets (2 kHz on the robot)
+  double period = 5e-4;
+  /// Wait for a command after each state packet (up to lockstep_timeout)
+  /// instead of pacing the packets to the wall clock. Measures the throughput
+  /// of the stack rather than its behavior at the robot rate.
+  bool lockstep = false;
+  double lockstep_timeout = 0.1;
+  /// Simulated plant
+  double sim_dt = 8e-5;
+  double penetration_allowance = 1e-5;
+  double v_stiction = 1e-3;
+  double mu = 0.8;
+};
+
+/// Network statistics of a CassieUdpSim run
+struct CassieUdpSimStats {
+  int64_t packets_sent = 0;
+  int64_t commands_received = 0;
+  /// Received packets which are not commands (wrong size)
+  int64_t packets_discarded = 0;
+  /// Periods at the end of which the simulation was behind the wall clock
+  int64_t overruns = 0;
+  /// Periods (after the first command) in which no new command was received
+  int64_t missed_commands = 0;
+  /// Time between sending each state packet and receiving the first command
+  /// after it, for the state packets which got one before the next was sent
+  std::vector<double> latencies;
+
+  /// Prints the counts and the latency distribution
+  void Print() const;
+};
+
+/// CassieUdpSim stands in for the robot on the UDP link, to exercise and
+/// profile the hardware stack (dispatcher_robot_out, state estimator,
+/// controllers and dispatcher_robot_in) without the robot.
+///
+/// Every period, the state of a simulated Cassie (MultibodyPlant with springs,
+/// simulated IMU) is packed into a cassie_out_t packet, with the same header
+/// as the robot's, and sent. The torques of the latest command received are
+/// applied during the following period, as on the robot. Until the first
+/// command arrives, the robot is held by the torques of its standing fixed
+/// point.
+class CassieUdpSim {
+ public:
+  explicit CassieUdpSim(
+      const CassieUdpSimOptions& options = CassieUdpSimOptions());
+  ~CassieUdpSim();
+
+  /// Sets a standing configuration with the pelvis at the given height, and
+  /// the torques holding it (see CassieFixedPointSolver)
+  void SetStandingState(double pelvis_height);
+
+  /// Runs the simulation and the UDP link until the simulated time end_time
+  void Run(double end_time);
+
+  double get_time() const { return simulator_->get_context().get_time(); }
+  const CassieUdpSimStats& get_stats() const { return stats_; }
+  const drake::multibody::MultibodyPlant<double>& get_plant() const {
+    return *plant_;
+  }
+
+ private:
+  // Sends the current state of the robot
+  void SendState();
+
+  // Receives the commands until the wall clock time deadline, or (if
+  // wait_for_command) until the first command
+  void ReceiveCommands(
+      std::chrono::time_point<std::chrono::steady_clock> deadline,
+      bool wait_for_command);
+
+  const CassieUdpSimOptions options_;
+
+  drake::multibody::MultibodyPlant<double>* plant_;
+  std::unique_ptr<drake::systems::Diagram<double>> diagram_;
+  std::unique_ptr<drake::systems::Simulator<double>> simulator_;
+
+  // Index in the actuation vector of the plant of each torque of
+  // cassie_user_in_t
+  std::vector<int> user_in_to_actuation_index_;
+  Eigen::VectorXd actuation_;
+
+  int send_socket_;
+  int receive_socket_;
+  struct sockaddr_in send_address_;
+
+  // Packet header, as on the robot: the sequence number of the outgoing
+  // packets, and the one of the last incoming packet, looped back
+  unsigned char seq_num_out_ = 0;
+  unsigned char seq_num_in_ = 0;
+
+  // Send time of each outgoing sequence number, and whether a command
+  // looping it back has been received yet
+  std::array<std::chrono::time_point<std::chrono::steady_clock>, 256>
+      send_times_;
+  std::array<bool, 256> awaiting_loopback_{};
+  bool command_this_period_ = false;
+  bool received_command_ = false;
+
+  CassieUdpSimStats stats_;
+};
+
+}  // namespace dairlib
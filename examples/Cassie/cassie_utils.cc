@@ -96,6 +96,25 @@ void addCassieMultibody(MultibodyPlant<double>* plant,
   }
 }
 
+double CassieSimTimeStep(CassieSimFidelity fidelity) {
+  // The full model time step is limited by the leaf springs. The reduced
+  // fidelity one is a multiple of the sensor period (5e-4).
+  return fidelity == CassieSimFidelity::kFull ? 8e-5 : 2.5e-4;
+}
+
+void addCassieSimMultibody(MultibodyPlant<double>* plant,
+    SceneGraph<double>* scene_graph, bool floating_base,
+    CassieSimFidelity fidelity) {
+  if (fidelity == CassieSimFidelity::kFull) {
+    addCassieMultibody(plant, scene_graph, floating_base,
+                       "examples/Cassie/urdf/cassie_v2.urdf", true, true);
+  } else {
+    addCassieMultibody(plant, scene_graph, floating_base,
+                       "examples/Cassie/urdf/cassie_fixed_springs.urdf", false,
+                       true);
+  }
+}
+
 std::unique_ptr<RigidBodyTree<double>> makeCassieTreePointer(
     std::string filename, FloatingBaseType base_type, bool is_with_springs) {
   auto tree = std::make_unique<RigidBodyTree<double>>();
@@ -34,6 +34,15 @@ using dairlib::systems::SubvectorPassThrough;
 using drake::systems::lcm::LcmSubscriberSystem;
 using drake::systems::lcm::LcmPublisherSystem;
 
+/// Dimensions of the MultibodyPlant models built by addCassieMultibody, for
+/// use with compile-time-sized controllers (systems/controllers/
+/// fixed_size_controllers.h). The floating base uses a quaternion joint.
+constexpr int kCassieNumActuators = 10;
+constexpr int kCassieFixedBaseNumPositions = 16;
+constexpr int kCassieFixedBaseNumVelocities = 16;
+constexpr int kCassieFloatingBaseNumPositions = 23;
+constexpr int kCassieFloatingBaseNumVelocities = 22;
+
 /// Add a fixed base cassie to the given multibody plant and scene graph
 /// These methods are to be used rather that direct construction of the plant
 /// from the URDF to centralize any modeling changes or additions
@@ -51,6 +60,24 @@ void addCassieMultibody(drake::multibody::MultibodyPlant<double>* plant,
     std::string filename = "examples/Cassie/urdf/cassie_v2.urdf",
     bool add_leaf_springs = true,  bool add_loop_closure = true);
 
+/// Fidelity of a simulated Cassie. kFull is the model with the leaf springs.
+/// kReduced is the model with fixed springs (cassie_fixed_springs.urdf), whose
+/// four-bar loop closures only couple the knees and ankles. Without the stiff
+/// leaf spring dynamics, it can be stepped several times faster.
+enum class CassieSimFidelity { kFull, kReduced };
+
+/// Default time step of a discrete plant simulating Cassie at the given
+/// fidelity
+double CassieSimTimeStep(CassieSimFidelity fidelity);
+
+/// Adds the model of Cassie of the given fidelity (see addCassieMultibody).
+/// The names of the positions, velocities and actuators of the reduced
+/// fidelity model are a subset of the ones of the full model, so its state can
+/// be mapped to the layout of the full model by multibody::CreateStateMap().
+void addCassieSimMultibody(drake::multibody::MultibodyPlant<double>* plant,
+    drake::geometry::SceneGraph<double>* scene_graph, bool floating_base,
+    CassieSimFidelity fidelity);
+
 template <typename T>
 std::pair<const Eigen::Vector3d, const drake::multibody::Frame<T>&> LeftToe(
     const drake::multibody::MultibodyPlant<T>& plant);
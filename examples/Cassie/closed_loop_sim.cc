@@ -0,0 +1,450 @@
+#include "examples/Cassie/closed_loop_sim.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <utility>
+#include <vector>
+
+#include "dairlib/lcmt_cassie_out.hpp"
+#include "dairlib/lcmt_robot_output.hpp"
+#include "examples/Cassie/cassie_fixed_point_solver.h"
+#include "examples/Cassie/cassie_utils.h"
+#include "examples/Cassie/networking/cassie_output_receiver.h"
+#include "multibody/multibody_utils.h"
+#include "systems/primitives/subvector_pass_through.h"
+#include "systems/robot_lcm_systems.h"
+#include "systems/sensors/sim_cassie_sensor_aggregator.h"
+#include "systems/sensors/sim_imu.h"
+
+#include "drake/common/random.h"
+#include "drake/geometry/scene_graph.h"
+#include "drake/systems/framework/diagram_builder.h"
+#include "drake/systems/primitives/adder.h"
+#include "drake/systems/primitives/matrix_gain.h"
+#include "drake/systems/primitives/random_source.h"
+#include "drake/systems/primitives/trajectory_source.h"
+
+namespace dairlib {
+
+using drake::AbstractValue;
+using drake::RandomDistribution;
+using drake::RandomGenerator;
+using drake::geometry::SceneGraph;
+using drake::multibody::MultibodyPlant;
+using drake::systems::Adder;
+using drake::systems::Context;
+using drake::systems::DiagramBuilder;
+using drake::systems::DiscreteTimeDelay;
+using drake::systems::MatrixGain;
+using drake::systems::RandomSource;
+using drake::systems::Simulator;
+using drake::systems::TrajectorySource;
+using drake::systems::ZeroOrderHold;
+using Eigen::MatrixXd;
+using Eigen::Vector3d;
+using Eigen::VectorXd;
+using systems::SubvectorPassThrough;
+
+// Position of the IMU in the pelvis frame (as in CassieRbtStateEstimator)
+static const Vector3d kImuPositionInPelvis(0.03155, 0, -0.07996);
+
+CassieClosedLoopSim::CassieClosedLoopSim(
+    const CassieClosedLoopSimOptions& options)
+    : options_(options) {
+  DRAKE_DEMAND(options.control_period > 0);
+  DRAKE_DEMAND(options.control_latency >= 0);
+  latency_ticks_ = static_cast<int>(
+      std::round(options.control_latency / options.control_period));
+
+  DiagramBuilder<double> builder;
+
+  // Simulated robot
+  SceneGraph<double>& scene_graph = *builder.AddSystem<SceneGraph>();
+  scene_graph.set_name("scene_graph");
+  plant_ = builder.AddSystem<MultibodyPlant>(
+      options.sim_dt > 0 ? options.sim_dt
+                         : CassieSimTimeStep(options.fidelity));
+  multibody::addFlatTerrain(plant_, &scene_graph, options.mu, options.mu);
+  addCassieSimMultibody(plant_, &scene_graph, true /*floating base*/,
+                        options.fidelity);
+  plant_->Finalize();
+  plant_->set_penetration_allowance(options.penetration_allowance);
+  plant_->set_stiction_tolerance(options.v_stiction);
+  builder.Connect(
+      plant_->get_geometry_poses_output_port(),
+      scene_graph.get_source_pose_port(plant_->get_source_id().value()));
+  builder.Connect(scene_graph.get_query_output_port(),
+                  plant_->get_geometry_query_input_port());
+
+  // External force on the pelvis, applied as a generalized force on the
+  // translational velocities of the floating base (which are expressed in the
+  // world frame)
+  if (options.pelvis_force.rows() > 0) {
+    DRAKE_DEMAND(options.pelvis_force.rows() == 3);
+    auto velocity_map = multibody::makeNameToVelocitiesMap(*plant_);
+    MatrixXd B = MatrixXd::Zero(plant_->num_velocities(), 3);
+    B(velocity_map.at("base_vx"), 0) = 1;
+    B(velocity_map.at("base_vy"), 1) = 1;
+    B(velocity_map.at("base_vz"), 2) = 1;
+    auto force_source =
+        builder.AddSystem<TrajectorySource>(options.pelvis_force);
+    auto force_gain = builder.AddSystem<MatrixGain>(B);
+    builder.Connect(force_source->get_output_port(),
+                    force_gain->get_input_port());
+    builder.Connect(force_gain->get_output_port(),
+                    plant_->get_applied_generalized_force_input_port());
+  }
+
+  // State in the layout of the full fidelity model
+  const drake::systems::OutputPort<double>* full_state_port =
+      &plant_->get_state_output_port();
+  const MultibodyPlant<double>* sensor_plant = plant_;
+  if (options.fidelity == CassieSimFidelity::kFull) {
+    state_map_ = MatrixXd::Identity(
+        plant_->num_positions() + plant_->num_velocities(),
+        plant_->num_positions() + plant_->num_velocities());
+  } else {
+    plant_w_springs_ = std::make_unique<MultibodyPlant<double>>(0.0);
+    addCassieSimMultibody(plant_w_springs_.get(), nullptr,
+                          true /*floating base*/, CassieSimFidelity::kFull);
+    plant_w_springs_->Finalize();
+    sensor_plant = plant_w_springs_.get();
+    state_map_ = multibody::CreateStateMap(*plant_, *plant_w_springs_);
+    auto state_map = builder.AddSystem<MatrixGain>(state_map_);
+    builder.Connect(plant_->get_state_output_port(),
+                    state_map->get_input_port());
+    full_state_port = &state_map->get_output_port();
+  }
+
+  // Measured state (with encoder noise)
+  const drake::systems::OutputPort<double>* measured_state_port =
+      full_state_port;
+  if (options.sensor_noise > 0) {
+    const int n_q = sensor_plant->num_positions();
+    const int n_x = n_q + sensor_plant->num_velocities();
+    VectorXd noise_gain = options.sensor_noise * VectorXd::Ones(n_x);
+    for (const auto& name_and_index :
+         multibody::makeNameToPositionsMap(*sensor_plant)) {
+      if (name_and_index.first.find("base_") == 0) {
+        noise_gain(name_and_index.second) = 0;
+      }
+    }
+    for (const auto& name_and_index :
+         multibody::makeNameToVelocitiesMap(*sensor_plant)) {
+      if (name_and_index.first.find("base_") == 0) {
+        noise_gain(n_q + name_and_index.second) = 0;
+      }
+    }
+    auto noise_source = builder.AddSystem<RandomSource>(
+        RandomDistribution::kGaussian, n_x, options.sensor_period);
+    auto noise_gain_system =
+        builder.AddSystem<MatrixGain>(MatrixXd(noise_gain.asDiagonal()));
+    auto measured_state = builder.AddSystem<Adder>(2, n_x);
+    builder.Connect(noise_source->get_output_port(0),
+                    noise_gain_system->get_input_port());
+    builder.Connect(*full_state_port, measured_state->get_input_port(0));
+    builder.Connect(noise_gain_system->get_output_port(),
+                    measured_state->get_input_port(1));
+    measured_state_port = &measured_state->get_output_port();
+  }
+
+  // Controller. Its model of Cassie is built by the same function as the
+  // simulated plant, so the actuator ordering of the two agree. Its discrete
+  // updates run once per control period, not on every step of the plant.
+  cassie::osc::OSCWalkingControllerOptions controller_options =
+      options.controller;
+  controller_options.update_period = options.control_period;
+  controller_ = builder.AddSystem<cassie::osc::OSCWalkingControllerDiagram>(
+      controller_options);
+  const auto& controller_plant = controller_->get_plant_w_springs();
+  DRAKE_DEMAND(controller_plant.num_actuators() == plant_->num_actuators());
+
+  // Command sample, and its latency
+  const int command_size = controller_->get_output_port_control().size();
+  const drake::systems::OutputPort<double>* command_port;
+  if (latency_ticks_ == 0) {
+    command_sample_ = builder.AddSystem<ZeroOrderHold>(options.control_period,
+                                                       command_size);
+    builder.Connect(controller_->get_output_port_control(),
+                    command_sample_->get_input_port());
+    command_port = &command_sample_->get_output_port();
+  } else {
+    command_delay_ = builder.AddSystem<DiscreteTimeDelay>(
+        options.control_period, latency_ticks_, command_size);
+    builder.Connect(controller_->get_output_port_control(),
+                    command_delay_->get_input_port());
+    command_port = &command_delay_->get_output_port();
+  }
+  // Drop the timestamp
+  auto command_passthrough = builder.AddSystem<SubvectorPassThrough>(
+      command_size, 0, plant_->num_actuators());
+  builder.Connect(*command_port, command_passthrough->get_input_port());
+  builder.Connect(command_passthrough->get_output_port(),
+                  plant_->get_actuation_input_port());
+
+  // State of the robot as seen by the controller
+  auto state_receiver =
+      builder.AddSystem<systems::RobotOutputReceiver>(controller_plant);
+  builder.Connect(state_receiver->get_output_port(0),
+                  controller_->get_input_port_state());
+
+  if (options.use_state_estimator) {
+    // Sensors
+    auto imu = builder.AddSystem<systems::SimImu>(
+        *plant_, "pelvis", kImuPositionInPelvis, options.sensor_period);
+    auto sensor_aggregator =
+        builder.AddSystem<systems::SimCassieSensorAggregator>(*sensor_plant);
+    builder.Connect(plant_->get_state_output_port(),
+                    imu->get_input_port_state());
+    builder.Connect(command_passthrough->get_output_port(),
+                    sensor_aggregator->get_input_port_input());
+    builder.Connect(*measured_state_port,
+                    sensor_aggregator->get_input_port_state());
+    builder.Connect(imu->get_output_port_acce(),
+                    sensor_aggregator->get_input_port_acce());
+    builder.Connect(imu->get_output_port_gyro(),
+                    sensor_aggregator->get_input_port_gyro());
+    sensor_sample_ = builder.AddSystem<ZeroOrderHold>(
+        options.sensor_period,
+        *AbstractValue::Make<dairlib::lcmt_cassie_out>());
+    builder.Connect(sensor_aggregator->get_output_port(0),
+                    sensor_sample_->get_input_port());
+
+    // State estimation (as in dispatcher_robot_out)
+    tree_ = makeCassieTreePointer("examples/Cassie/urdf/cassie_v2.urdf",
+                                  drake::multibody::joints::kQuaternion);
+    drake::multibody::AddFlatTerrainToWorld(tree_.get(), 100, 0.2);
+    auto input_receiver = builder.AddSystem<systems::CassieOutputReceiver>();
+    // The EKF runs once per sensor sample
+    state_estimator_ = builder.AddSystem<systems::CassieRbtStateEstimator>(
+        *tree_, true /*floating base*/, false, false, -1,
+        options.sensor_period);
+    auto robot_output_sender =
+        builder.AddSystem<systems::RobotOutputSender>(*tree_, true);
+    auto state_passthrough = builder.AddSystem<SubvectorPassThrough>(
+        state_estimator_->get_output_port(0).size(), 0,
+        robot_output_sender->get_input_port_state().size());
+    auto effort_passthrough = builder.AddSystem<SubvectorPassThrough>(
+        state_estimator_->get_output_port(0).size(),
+        robot_output_sender->get_input_port_state().size(),
+        robot_output_sender->get_input_port_effort().size());
+    builder.Connect(sensor_sample_->get_output_port(),
+                    input_receiver->get_input_port(0));
+    builder.Connect(input_receiver->get_output_port(0),
+                    state_estimator_->get_input_port(0));
+    builder.Connect(state_estimator_->get_output_port(0),
+                    state_passthrough->get_input_port());
+    builder.Connect(state_passthrough->get_output_port(),
+                    robot_output_sender->get_input_port_state());
+    builder.Connect(state_estimator_->get_output_port(0),
+                    effort_passthrough->get_input_port());
+    builder.Connect(effort_passthrough->get_output_port(),
+                    robot_output_sender->get_input_port_effort());
+    builder.Connect(robot_output_sender->get_output_port(0),
+                    state_receiver->get_input_port(0));
+  } else {
+    // Ground truth state (as published by multibody_sim)
+    auto state_sender =
+        builder.AddSystem<systems::RobotOutputSender>(*sensor_plant);
+    builder.Connect(*measured_state_port,
+                    state_sender->get_input_port_state());
+    sensor_sample_ = builder.AddSystem<ZeroOrderHold>(
+        options.sensor_period,
+        *AbstractValue::Make<dairlib::lcmt_robot_output>());
+    builder.Connect(state_sender->get_output_port(0),
+                    sensor_sample_->get_input_port());
+    builder.Connect(sensor_sample_->get_output_port(),
+                    state_receiver->get_input_port(0));
+  }
+
+  diagram_ = builder.Build();
+  diagram_->set_name("cassie closed loop sim");
+
+  simulator_ = std::make_unique<Simulator<double>>(*diagram_);
+  simulator_->set_publish_every_time_step(false);
+  simulator_->set_publish_at_initialization(false);
+
+  // Abstract states of the diagram, for snapshots
+  serializer_.AddLcmType<lcmt_cassie_out>();
+  serializer_.AddLcmType<lcmt_robot_output>();
+  systems::CassieRbtStateEstimator::AddSerializers(&serializer_);
+}
+
+VectorXd CassieClosedLoopSim::CalcStandingPositions(double pelvis_height,
+                                                    double toe_spread) const {
+  VectorXd q, u, lambda;
+  double mu_fp = 0;
+  double min_normal_fp = 70;
+  CassieFixedPointSolver(*plant_, pelvis_height, mu_fp, min_normal_fp, true,
+                         toe_spread, &q, &u, &lambda);
+  return q;
+}
+
+void CassieClosedLoopSim::SetInitialState(const VectorXd& q, const VectorXd& v,
+                                          double t0) {
+  Context<double>& context = simulator_->get_mutable_context();
+  RandomGenerator generator(options_.random_seed);
+  diagram_->SetRandomContext(&context, &generator);
+  context.SetTime(t0);
+  Context<double>& plant_context =
+      diagram_->GetMutableSubsystemContext(*plant_, &context);
+  plant_->SetPositions(&plant_context, q);
+  plant_->SetVelocities(&plant_context, v);
+
+  // No command has been computed yet
+  if (command_sample_) {
+    diagram_->GetMutableSubsystemContext(*command_sample_, &context)
+        .get_mutable_discrete_state(0)
+        .SetZero();
+  } else {
+    diagram_->GetMutableSubsystemContext(*command_delay_, &context)
+        .get_mutable_discrete_state(0)
+        .SetZero();
+  }
+
+  // Sample the sensors at t0
+  Context<double>& sensor_sample_context =
+      diagram_->GetMutableSubsystemContext(*sensor_sample_, &context);
+  if (options_.use_state_estimator) {
+    sensor_sample_context.get_mutable_abstract_state<lcmt_cassie_out>(0) =
+        sensor_sample_->get_input_port().Eval<lcmt_cassie_out>(
+            sensor_sample_context);
+
+    // Initialize the EKF with the true pose of the IMU, as
+    // dispatcher_robot_out does with the initial height of the robot
+    const auto& X_WP = plant_->EvalBodyPoseInWorld(
+        plant_context, plant_->GetBodyByName("pelvis"));
+    auto& state_estimator_context =
+        diagram_->GetMutableSubsystemContext(*state_estimator_, &context);
+    state_estimator_->setPreviousTime(&state_estimator_context, t0);
+    state_estimator_->setInitialImuPosition(&state_estimator_context,
+                                            X_WP * kImuPositionInPelvis);
+    state_estimator_->setInitialImuQuaternion(&state_estimator_context,
+                                              q.head(4));
+  } else {
+    sensor_sample_context.get_mutable_abstract_state<lcmt_robot_output>(0) =
+        sensor_sample_->get_input_port().Eval<lcmt_robot_output>(
+            sensor_sample_context);
+  }
+
+  // Apply the command computed at t0 (for all the delayed samples as well)
+  const auto& controller_context =
+      diagram_->GetSubsystemContext(*controller_, context);
+  VectorXd command =
+      controller_->get_output_port_control().Eval(controller_context);
+  if (command_sample_) {
+    diagram_->GetMutableSubsystemContext(*command_sample_, &context)
+        .get_mutable_discrete_state(0)
+        .SetFromVector(command);
+  } else {
+    auto& buffer =
+        diagram_->GetMutableSubsystemContext(*command_delay_, &context)
+            .get_mutable_discrete_state(0);
+    buffer.SetFromVector(
+        command.replicate(buffer.size() / command.size(), 1));
+  }
+
+  simulator_->Initialize();
+}
+
+void CassieClosedLoopSim::SaveSnapshot(const std::string& filename) {
+  serializer_.Save(simulator_->get_context(), filename);
+  simulator_->Initialize();
+}
+
+void CassieClosedLoopSim::LoadSnapshot(const std::string& filename) {
+  serializer_.Load(filename, &simulator_->get_mutable_context());
+  simulator_->Initialize();
+}
+
+VectorXd CassieClosedLoopSim::GetState() const {
+  const auto& plant_context =
+      diagram_->GetSubsystemContext(*plant_, simulator_->get_context());
+  return plant_->GetPositionsAndVelocities(plant_context);
+}
+
+double SimFidelityGap::max_pelvis_position_error() const {
+  return pelvis_position_errors.empty()
+             ? 0
+             : *std::max_element(pelvis_position_errors.begin(),
+                                 pelvis_position_errors.end());
+}
+
+double SimFidelityGap::rms_pelvis_position_error() const {
+  if (pelvis_position_errors.empty()) return 0;
+  double sum_squares = 0;
+  for (double error : pelvis_position_errors) sum_squares += error * error;
+  return std::sqrt(sum_squares / pelvis_position_errors.size());
+}
+
+double SimFidelityGap::max_joint_position_error() const {
+  return joint_position_errors.empty()
+             ? 0
+             : *std::max_element(joint_position_errors.begin(),
+                                 joint_position_errors.end());
+}
+
+SimFidelityGap CompareSimFidelity(const CassieClosedLoopSimOptions& options,
+                                  double pelvis_height, double end_time,
+                                  double sample_period) {
+  CassieClosedLoopSimOptions full_options = options;
+  full_options.fidelity = CassieSimFidelity::kFull;
+  full_options.sim_dt = 0;
+  CassieClosedLoopSimOptions reduced_options = options;
+  reduced_options.fidelity = CassieSimFidelity::kReduced;
+  reduced_options.sim_dt = 0;
+  CassieClosedLoopSim full_sim(full_options);
+  CassieClosedLoopSim reduced_sim(reduced_options);
+
+  // Compared positions: the ones of the reduced model, in both layouts
+  const auto& full_plant = full_sim.get_plant();
+  const auto& reduced_plant = reduced_sim.get_plant();
+  auto full_positions = multibody::makeNameToPositionsMap(full_plant);
+  std::vector<std::pair<int, int>> joint_indices;
+  for (const auto& name_and_index :
+       multibody::makeNameToPositionsMap(reduced_plant)) {
+    if (name_and_index.first.find("base_") == 0) continue;
+    joint_indices.emplace_back(full_positions.at(name_and_index.first),
+                               name_and_index.second);
+  }
+  const int base_x = full_positions.at("base_x");
+  DRAKE_DEMAND(multibody::makeNameToPositionsMap(reduced_plant).at("base_x") ==
+               base_x);
+
+  SimFidelityGap gap;
+  std::vector<Eigen::VectorXd> full_states;
+  auto run = [&](CassieClosedLoopSim* sim, bool full) {
+    sim->SetInitialState(sim->CalcStandingPositions(pelvis_height),
+                         VectorXd::Zero(sim->get_plant().num_velocities()));
+    auto start = std::chrono::steady_clock::now();
+    int sample = 0;
+    for (double t = sample_period; t < end_time + sample_period / 2;
+         t += sample_period, sample++) {
+      sim->AdvanceTo(std::min(t, end_time));
+      VectorXd q = sim->GetState().head(sim->get_plant().num_positions());
+      if (full) {
+        full_states.push_back(q);
+        continue;
+      }
+      const VectorXd& q_full = full_states[sample];
+      gap.times.push_back(sim->get_time());
+      gap.pelvis_position_errors.push_back(
+          (q.segment<3>(base_x) - q_full.segment<3>(base_x)).norm());
+      double joint_error = 0;
+      for (const auto& indices : joint_indices) {
+        joint_error = std::max(
+            joint_error, std::abs(q(indices.second) - q_full(indices.first)));
+      }
+      gap.joint_position_errors.push_back(joint_error);
+    }
+    std::chrono::duration<double> elapsed =
+        std::chrono::steady_clock::now() - start;
+    return elapsed.count();
+  };
+  gap.full_wall_time = run(&full_sim, true);
+  gap.reduced_wall_time = run(&reduced_sim, false);
+  return gap;
+}
+
+}  // namespace dairlib
@@ -0,0 +1,194 @@
+#pragma once
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "examples/Cassie/cassie_rbt_state_estimator.h"
+#include "examples/Cassie/cassie_utils.h"
+#include "examples/Cassie/osc/osc_walking_controller_diagram.h"
+#include "systems/framework/context_serializer.h"
+
+#include "drake/common/trajectories/piecewise_polynomial.h"
+#include "drake/multibody/plant/multibody_plant.h"
+#include "drake/systems/analysis/simulator.h"
+#include "drake/systems/framework/diagram.h"
+#include "drake/systems/primitives/discrete_time_delay.h"
+#include "drake/systems/primitives/zero_order_hold.h"
+
+namespace dairlib {
+
+/// Options of CassieClosedLoopSim. Times are in seconds.
+struct CassieClosedLoopSimOptions {
+  /// Fidelity of the simulated robot. With kReduced, the sensors and the
+  /// controller still see the state in the layout of the full model (with
+  /// zero spring deflections).
+  CassieSimFidelity fidelity = CassieSimFidelity::kFull;
+  /// Time step of the (discrete) MultibodyPlant. CassieSimTimeStep(fidelity)
+  /// if 0.
+  double sim_dt = 0;
+  /// Contact model
+  double penetration_allowance = 1e-5;
+  double v_stiction = 1e-3;
+  /// Static and kinetic friction coefficient of the ground
+  double mu = 0.8;
+  /// Sample period of the robot sensors (joint encoders and IMU)
+  double sensor_period = 5e-4;
+  /// Period of the controller
+  double control_period = 2e-3;
+  /// Delay between sampling the controller input and applying its output.
+  /// Rounded to a whole number of control periods.
+  double control_latency = 0;
+  /// Close the loop through SimCassieSensorAggregator and
+  /// CassieRbtStateEstimator, as on the robot. Otherwise the controller reads
+  /// the (sampled) ground truth state.
+  bool use_state_estimator = true;
+  /// Standard deviation of the Gaussian noise on the measured joint
+  /// positions and velocities, drawn every sensor period. The IMU is noiseless.
+  double sensor_noise = 0;
+  /// Seed of the random sources of the diagram
+  int random_seed = 0;
+  /// External force on the pelvis (3D, in the world frame) as a function of
+  /// time, e.g. a push. Unused if empty.
+  drake::trajectories::PiecewisePolynomial<double> pelvis_force;
+  /// Options of the walking controller
+  cassie::osc::OSCWalkingControllerOptions controller;
+};
+
+/// CassieClosedLoopSim is the in-process equivalent of running multibody_sim,
+/// dispatcher_robot_out and run_osc_walking_controller together. All of them
+/// are composed into one diagram and wired directly through ports:
+///
+///   MultibodyPlant -> SimImu, SimCassieSensorAggregator
+///     -> sensor sample (ZeroOrderHold of lcmt_cassie_out)
+///     -> CassieOutputReceiver -> CassieRbtStateEstimator
+///     -> RobotOutputSender -> RobotOutputReceiver
+///     -> OSCWalkingControllerDiagram
+///     -> command sample (ZeroOrderHold, or DiscreteTimeDelay with latency)
+///     -> MultibodyPlant
+///
+/// The LCM message types are only used as port values (as between the LCM
+/// systems of the separate processes), so that the state is exchanged by name
+/// between the RigidBodyTree of the estimator and the MultibodyPlant of the
+/// controller. No LCM traffic is generated.
+///
+/// The discrete updates of the state estimator run once per sensor period and
+/// those of the controller once per control period, as periodic events (not
+/// on every step of the plant). As in an LcmDrivenLoop, all the updates of a
+/// tick happen together, so each system sees the states of the others from
+/// the previous tick; in particular, the EKF reads the sensor sample of the
+/// previous sensor period. The command is sampled at the same time as the
+/// controller updates. The controller is evaluated exactly once per control
+/// period, and the simulation is not throttled (the Simulator runs as fast as possible unless
+/// a target realtime rate is set). Since every component is deterministic and
+/// the message timing is fixed by the sample periods, two simulations from the
+/// same initial state are bitwise identical.
+class CassieClosedLoopSim {
+ public:
+  explicit CassieClosedLoopSim(
+      const CassieClosedLoopSimOptions& options = CassieClosedLoopSimOptions());
+
+  /// Standing configuration of the simulated plant, with the pelvis at the
+  /// given height (see CassieFixedPointSolver)
+  Eigen::VectorXd CalcStandingPositions(double pelvis_height,
+                                        double toe_spread = 0.2) const;
+
+  /// Sets the state of the simulated robot at time t0, and makes the sensor
+  /// samples, the state estimator and the command consistent with it. The
+  /// rest of the diagram state and parameters is reset to its default, with
+  /// the random sources seeded by random_seed. Call before the first
+  /// AdvanceTo().
+  void SetInitialState(const Eigen::VectorXd& q, const Eigen::VectorXd& v,
+                       double t0 = 0);
+
+  /// Saves the time and the state of the whole closed loop system (plant,
+  /// sensors, state estimator and controller) to a binary file. The simulator
+  /// is then re-initialized at the current time, as it is by LoadSnapshot(),
+  /// so that this simulation and the ones restored from the snapshot continue
+  /// identically. Not supported with sensor noise, whose random generator
+  /// state can't be serialized.
+  void SaveSnapshot(const std::string& filename);
+
+  /// Restores a snapshot written by SaveSnapshot(), in place of
+  /// SetInitialState(). The options must be the same as the ones of the saved
+  /// simulation, except for the ground friction and the pelvis force, which
+  /// are not part of the state.
+  void LoadSnapshot(const std::string& filename);
+
+  /// Simulates the closed loop system up to time t
+  void AdvanceTo(double t) { simulator_->AdvanceTo(t); }
+
+  /// State of the simulated robot (positions and velocities)
+  Eigen::VectorXd GetState() const;
+  /// State of the simulated robot in the layout of the full fidelity model
+  Eigen::VectorXd GetFullState() const { return state_map_ * GetState(); }
+
+  double get_time() const { return simulator_->get_context().get_time(); }
+  const drake::multibody::MultibodyPlant<double>& get_plant() const {
+    return *plant_;
+  }
+  const drake::systems::Diagram<double>& get_diagram() const {
+    return *diagram_;
+  }
+  drake::systems::Simulator<double>& get_mutable_simulator() {
+    return *simulator_;
+  }
+  drake::systems::Context<double>& get_mutable_plant_context() {
+    return diagram_->GetMutableSubsystemContext(
+        *plant_, &simulator_->get_mutable_context());
+  }
+  const CassieClosedLoopSimOptions& get_options() const { return options_; }
+
+ private:
+  const CassieClosedLoopSimOptions options_;
+
+  // Model used by the state estimator
+  std::unique_ptr<RigidBodyTree<double>> tree_;
+  // Full fidelity model, giving the layout of the state seen by the sensors
+  // when simulating the reduced fidelity model, and the map to that layout
+  std::unique_ptr<drake::multibody::MultibodyPlant<double>> plant_w_springs_;
+  Eigen::MatrixXd state_map_;
+
+  // Subsystems of the diagram (owned by the diagram)
+  drake::multibody::MultibodyPlant<double>* plant_;
+  drake::systems::ZeroOrderHold<double>* sensor_sample_;
+  systems::CassieRbtStateEstimator* state_estimator_ = nullptr;
+  cassie::osc::OSCWalkingControllerDiagram* controller_;
+  drake::systems::ZeroOrderHold<double>* command_sample_ = nullptr;
+  drake::systems::DiscreteTimeDelay<double>* command_delay_ = nullptr;
+  int latency_ticks_;
+
+  std::unique_ptr<drake::systems::Diagram<double>> diagram_;
+  std::unique_ptr<drake::systems::Simulator<double>> simulator_;
+
+  systems::ContextSerializer serializer_;
+};
+
+/// Gap between the full and reduced fidelity simulations of the same closed
+/// loop system, each started standing (at its own fixed point) and tracking
+/// the same controller reference
+struct SimFidelityGap {
+  /// Wall clock time of each simulation (s)
+  double full_wall_time = 0;
+  double reduced_wall_time = 0;
+  /// Sample times, and the distance between the pelvis positions and the
+  /// largest difference between the joint positions (excluding the springs)
+  /// of the two simulations at those times
+  std::vector<double> times;
+  std::vector<double> pelvis_position_errors;
+  std::vector<double> joint_position_errors;
+
+  double speedup() const { return full_wall_time / reduced_wall_time; }
+  double max_pelvis_position_error() const;
+  double rms_pelvis_position_error() const;
+  double max_joint_position_error() const;
+};
+
+/// Simulates the closed loop system with options at full and reduced fidelity
+/// (with the default time step of each) from a standing pose, until end_time,
+/// and compares the two every sample_period
+SimFidelityGap CompareSimFidelity(const CassieClosedLoopSimOptions& options,
+                                  double pelvis_height, double end_time,
+                                  double sample_period);
+
+}  // namespace dairlib
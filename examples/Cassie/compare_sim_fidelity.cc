@@ -0,0 +1,60 @@
+#include <fstream>
+#include <iostream>
+
+#include <gflags/gflags.h>
+
+#include "examples/Cassie/closed_loop_sim.h"
+
+namespace dairlib {
+
+DEFINE_double(end_time, 3, "Duration of the compared simulations");
+DEFINE_double(sample_period, 0.01, "Period at which the states are compared");
+DEFINE_double(init_height, 1.0,
+              "Initial starting height of the pelvis above ground");
+DEFINE_bool(state_estimator, true,
+            "Close the loop through the state estimator. Otherwise the "
+            "controller uses the ground truth state");
+DEFINE_bool(footstep_mpc, false,
+            "Plan foot placement with the multi-step LIPM MPC instead of the "
+            "single-step capture point heuristic");
+DEFINE_string(output_file, "",
+              "CSV file of the pelvis and joint position errors over time");
+
+// Reports the speedup of the reduced fidelity Cassie model (fixed springs,
+// larger time step) over the full model, and the gap between the two on the
+// same closed loop walking reference.
+int do_main(int argc, char* argv[]) {
+  gflags::ParseCommandLineFlags(&argc, &argv, true);
+
+  CassieClosedLoopSimOptions options;
+  options.use_state_estimator = FLAGS_state_estimator;
+  options.controller.footstep_mpc = FLAGS_footstep_mpc;
+  SimFidelityGap gap = CompareSimFidelity(options, FLAGS_init_height,
+                                          FLAGS_end_time, FLAGS_sample_period);
+
+  std::cout << "Full fidelity: " << gap.full_wall_time << " s ("
+            << FLAGS_end_time / gap.full_wall_time << "x realtime)"
+            << std::endl;
+  std::cout << "Reduced fidelity: " << gap.reduced_wall_time << " s ("
+            << FLAGS_end_time / gap.reduced_wall_time << "x realtime), "
+            << gap.speedup() << "x faster" << std::endl;
+  std::cout << "Pelvis position error: max " << gap.max_pelvis_position_error()
+            << " m, rms " << gap.rms_pelvis_position_error() << " m"
+            << std::endl;
+  std::cout << "Joint position error: max " << gap.max_joint_position_error()
+            << " rad" << std::endl;
+
+  if (!FLAGS_output_file.empty()) {
+    std::ofstream file(FLAGS_output_file);
+    file << "time,pelvis_position_error,joint_position_error\n";
+    for (int i = 0; i < static_cast<int>(gap.times.size()); i++) {
+      file << gap.times[i] << "," << gap.pelvis_position_errors[i] << ","
+           << gap.joint_position_errors[i] << "\n";
+    }
+  }
+  return 0;
+}
+
+}  // namespace dairlib
+
+int main(int argc, char* argv[]) { return dairlib::do_main(argc, argv); }
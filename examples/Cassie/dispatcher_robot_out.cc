@@ -18,6 +18,7 @@
 #include "dairlib/lcmt_cassie_out.hpp"
 #include "dairlib/lcmt_robot_output.hpp"
 #include "systems/framework/lcm_driven_loop.h"
+#include "systems/framework/system_tracer.h"
 
 namespace dairlib {
 
@@ -51,6 +52,13 @@ DEFINE_int64(test_mode, -1, "-1: Regular EKF (not testing mode). "
                             "1: both feet never in contact with ground. ");
 DEFINE_double(init_imu_height, 0.969223, "The height of imu that we initialize the ekf with");
 
+DEFINE_string(trace_file, "",
+              "Prefix of the execution trace dumps (Chrome trace format), "
+              "written on SIGUSR1 and on overruns of --trace_deadline. Empty "
+              "disables the tracing");
+DEFINE_double(trace_deadline, 0,
+              "Tick duration (s) above which the trace is dumped, 0 for none");
+
 void setInitialEkfState(const drake::systems::Diagram<double>& diagram,
                         systems::CassieRbtStateEstimator* state_estimator,
                         drake::systems::Context<double>& diagram_context,
@@ -70,6 +78,11 @@ void setInitialEkfState(const drake::systems::Diagram<double>& diagram,
 int do_main(int argc, char* argv[]) {
   gflags::ParseCommandLineFlags(&argc, &argv, true);
 
+  if (!FLAGS_trace_file.empty()) {
+    systems::SystemTracer::EnableDefault(FLAGS_trace_file,
+                                         FLAGS_trace_deadline);
+  }
+
   drake::lcm::DrakeLcm lcm_local("udpm://239.255.76.67:7667?ttl=0");
   drake::lcm::DrakeLcm lcm_network("udpm://239.255.76.67:7667?ttl=1");
   DiagramBuilder<double> builder;
@@ -164,6 +177,7 @@ int do_main(int argc, char* argv[]) {
 
   // Create the diagram, simulator, and context.
   auto owned_diagram = builder.Build();
+  owned_diagram->set_name("dispatcher_robot_out");
   const auto& diagram = *owned_diagram;
   drake::systems::Simulator<double> simulator(std::move(owned_diagram));
   auto& diagram_context = simulator.get_mutable_context();
@@ -196,6 +210,7 @@ int do_main(int argc, char* argv[]) {
       input_sub.clear();
       LcmHandleSubscriptionsUntil(&lcm_local, [&]() {
         return input_sub.count() > 0; });
+      systems::TickTraceScope tick(diagram.get_name());
       // Write the lcmt_robot_input message into the context and advance.
       input_value.GetMutableData()->set_value(input_sub.message());
       const double time = input_sub.message().utime * 1e-6;
@@ -241,6 +256,7 @@ int do_main(int argc, char* argv[]) {
 
     while (true) {
       udp_sub.Poll();
+      systems::TickTraceScope tick(diagram.get_name());
       output_sender_value.GetMutableData()->set_value(udp_sub.message());
       state_estimator_value.GetMutableData()->set_value(udp_sub.message());
       const double time = udp_sub.message_time();
@@ -1,4 +1,7 @@
 #include "examples/Cassie/input_supervisor.h"
+
+#include <sstream>
+
 #include "systems/framework/output_vector.h"
 
 using drake::systems::Context;
@@ -20,7 +23,8 @@ InputSupervisor::InputSupervisor(const RigidBodyTree<double>& tree,
       num_velocities_(tree_.get_num_velocities()),
       min_consecutive_failures_(min_consecutive_failures),
       max_joint_velocity_(max_joint_velocity),
-      input_limit_(input_limit) {
+      input_limit_(input_limit),
+      error_print_limiter_(kMinErrorPrintPeriod) {
   // Create input ports
   command_input_port_ =
       this->DeclareVectorInputPort(TimestampedVector<double>(num_actuators_))
@@ -125,13 +129,16 @@ void InputSupervisor::UpdateErrorFlag(
       // Increment counter
       (*discrete_state)[0]++;
       discrete_state->get_mutable_vector(status_index_)[0] = true;
-      std::cout << "Error! Velocity has exceeded the threshold of "
-                << max_joint_velocity_ << std::endl;
-      std::cout << "Consecutive error " << (*discrete_state)[0] << " of "
-                << min_consecutive_failures_ << std::endl;
-      std::cout << "Velocity vector: " << std::endl
-                << velocities << std::endl
-                << std::endl;
+      // Printed asynchronously so that the update never waits on the console
+      if (error_print_limiter_.Ready()) {
+        std::ostringstream out;
+        out << "Error! Velocity has exceeded the threshold of "
+            << max_joint_velocity_ << "\n"
+            << "Consecutive error " << (*discrete_state)[0] << " of "
+            << min_consecutive_failures_ << "\n"
+            << "Velocity vector: \n" << velocities << "\n";
+        AsyncDebugSink::Default().Log(out.str());
+      }
     } else {
       // Reset counter
       (*discrete_state)[0] = 0;
@@ -1,6 +1,7 @@
 #pragma once
 #include <limits>
 
+#include "common/async_debug_sink.h"
 #include "systems/framework/timestamped_vector.h"
 #include "drake/multibody/rigid_body_tree.h"
 #include "drake/systems/framework/leaf_system.h"
@@ -80,6 +81,9 @@ class InputSupervisor : public drake::systems::LeafSystem<double> {
   double max_joint_velocity_;
 
   double input_limit_;
+  // Velocity error messages are printed at most once per period [s]
+  static constexpr double kMinErrorPrintPeriod = 0.1;
+  dairlib::DebugRateLimiter error_print_limiter_;
   int n_consecutive_fails_index_;
   int status_index_;
   int state_input_port_;
@@ -12,6 +12,7 @@
 #include "drake/systems/framework/diagram_builder.h"
 #include "drake/systems/lcm/lcm_publisher_system.h"
 #include "drake/systems/lcm/lcm_subscriber_system.h"
+#include "drake/systems/primitives/matrix_gain.h"
 
 #include "dairlib/lcmt_robot_input.hpp"
 #include "dairlib/lcmt_robot_output.hpp"
@@ -33,6 +34,7 @@ using drake::systems::DiagramBuilder;
 using drake::systems::Simulator;
 using drake::systems::lcm::LcmPublisherSystem;
 using drake::systems::lcm::LcmSubscriberSystem;
+using drake::systems::MatrixGain;
 
 using drake::math::RotationMatrix;
 using Eigen::Matrix3d;
@@ -50,7 +52,8 @@ DEFINE_bool(time_stepping, true,
             "discrete system with periodic updates. "
             "If 'false', the plant is modeled as a continuous system.");
 DEFINE_double(dt, 8e-5,
-              "The step size to use for time_stepping, ignored for continuous");
+              "The step size to use for time_stepping, ignored for continuous."
+              " Defaults to a larger step with --reduced_fidelity.");
 DEFINE_double(v_stiction, 1e-3, "Stiction tolernace (m/s)");
 DEFINE_double(penetration_allowance, 1e-5,
               "Penetration allowance for the contact model. Nearly equivalent"
@@ -62,6 +65,10 @@ DEFINE_double(init_height, .7,
               "Initial starting height of the pelvis above "
               "ground");
 DEFINE_bool(spring_model, true, "Use a URDF with or without legs springs");
+DEFINE_bool(reduced_fidelity, false,
+            "Simulate the model with fixed leg springs at a larger time step, "
+            "but publish the state with the layout of the model with springs "
+            "(zero spring deflections), for faster controller iteration");
 
 
 int do_main(int argc, char* argv[]) {
@@ -72,21 +79,34 @@ int do_main(int argc, char* argv[]) {
   SceneGraph<double>& scene_graph = *builder.AddSystem<SceneGraph>();
   scene_graph.set_name("scene_graph");
 
-  const double time_step = FLAGS_time_stepping ? FLAGS_dt : 0.0;
+  const CassieSimFidelity fidelity = FLAGS_reduced_fidelity
+                                         ? CassieSimFidelity::kReduced
+                                         : CassieSimFidelity::kFull;
+  double dt = FLAGS_dt;
+  if (FLAGS_reduced_fidelity &&
+      gflags::GetCommandLineFlagInfoOrDie("dt").is_default) {
+    dt = CassieSimTimeStep(fidelity);
+  }
+  const double time_step = FLAGS_time_stepping ? dt : 0.0;
   MultibodyPlant<double>& plant = *builder.AddSystem<MultibodyPlant>(time_step);
   if (FLAGS_floating_base) {
     multibody::addFlatTerrain(&plant, &scene_graph, .8, .8);
   }
 
-  std::string urdf;
-  if (FLAGS_spring_model) {
-    urdf = "examples/Cassie/urdf/cassie_v2.urdf";
+  if (FLAGS_reduced_fidelity) {
+    addCassieSimMultibody(&plant, &scene_graph, FLAGS_floating_base,
+                          fidelity);
   } else {
-    urdf = "examples/Cassie/urdf/cassie_fixed_springs.urdf";
+    std::string urdf;
+    if (FLAGS_spring_model) {
+      urdf = "examples/Cassie/urdf/cassie_v2.urdf";
+    } else {
+      urdf = "examples/Cassie/urdf/cassie_fixed_springs.urdf";
+    }
+
+    addCassieMultibody(&plant, &scene_graph, FLAGS_floating_base, urdf,
+        FLAGS_spring_model, true);
   }
-
-  addCassieMultibody(&plant, &scene_graph, FLAGS_floating_base, urdf,
-      FLAGS_spring_model, true);
   plant.Finalize();
 
   plant.set_penetration_allowance(FLAGS_penetration_allowance);
@@ -104,7 +124,16 @@ int do_main(int argc, char* argv[]) {
   auto state_pub =
       builder.AddSystem(LcmPublisherSystem::Make<dairlib::lcmt_robot_output>(
           "CASSIE_STATE_SIMULATION", lcm, 1.0 / FLAGS_publish_rate));
-  auto state_sender = builder.AddSystem<systems::RobotOutputSender>(plant);
+
+  // The published state has the layout of the model with springs
+  MultibodyPlant<double> plant_w_springs(0.0);
+  if (FLAGS_reduced_fidelity) {
+    addCassieSimMultibody(&plant_w_springs, nullptr, FLAGS_floating_base,
+                          CassieSimFidelity::kFull);
+    plant_w_springs.Finalize();
+  }
+  auto state_sender = builder.AddSystem<systems::RobotOutputSender>(
+      FLAGS_reduced_fidelity ? plant_w_springs : plant);
 
   // Contact Information
   ContactResultsToLcmSystem<double>& contact_viz =
@@ -120,8 +149,17 @@ int do_main(int argc, char* argv[]) {
   builder.Connect(*input_receiver, *passthrough);
   builder.Connect(passthrough->get_output_port(),
                   plant.get_actuation_input_port());
-  builder.Connect(plant.get_state_output_port(),
-                  state_sender->get_input_port_state());
+  if (FLAGS_reduced_fidelity) {
+    auto state_map = builder.AddSystem<MatrixGain>(
+        multibody::CreateStateMap(plant, plant_w_springs));
+    builder.Connect(plant.get_state_output_port(),
+                    state_map->get_input_port());
+    builder.Connect(state_map->get_output_port(),
+                    state_sender->get_input_port_state());
+  } else {
+    builder.Connect(plant.get_state_output_port(),
+                    state_sender->get_input_port_state());
+  }
   builder.Connect(*state_sender, *state_pub);
   builder.Connect(
       plant.get_geometry_poses_output_port(),
@@ -165,7 +203,7 @@ int do_main(int argc, char* argv[]) {
     // simulator.get_mutable_integrator()->set_target_accuracy(1e-1);
     // simulator.get_mutable_integrator()->set_fixed_step_mode(true);
     simulator.reset_integrator<drake::systems::RungeKutta2Integrator<double>>(
-        FLAGS_dt);
+        dt);
   }
 
   simulator.set_publish_every_time_step(false);
@@ -1,5 +1,7 @@
 #include "examples/Cassie/networking/udp_driven_loop.h"
 
+#include "systems/framework/system_tracer.h"
+
 namespace dairlib {
 namespace systems {
 
@@ -54,12 +56,14 @@ void UDPDrivenLoop::RunToSecondsAssumingInitialized(double stop_time) {
     WaitForMessage();
     msg_time = driving_sub_.get_message_utime(*sub_context_)/1.0e6;
     if (msg_time >= stop_time) break;
+    TickTraceScope tick(system_.get_name());
     // std::cout << "UDPDrivenLoop::Starting step." << std::endl;
     stepper_->AdvanceTo(msg_time);
     // std::cout << "UDPDrivenLoop::Starting publish" << std::endl; 
     // Explicitly publish after we are done with all the intermediate
     // computation.
     if (publish_on_every_received_message_) {
+      TraceScope trace("publish", system_.get_name(), "Publish");
       system_.Publish(stepper_->get_context());
     }
   }
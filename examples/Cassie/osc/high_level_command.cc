@@ -37,7 +37,7 @@ namespace osc {
 HighLevelCommand::HighLevelCommand(
     const drake::multibody::MultibodyPlant<double>& plant,
     const Vector2d& global_target_position,
-    const Vector2d& params_of_no_turning)
+    const Vector2d& params_of_no_turning, double update_period)
     : plant_(plant),
       world_(plant_.world_frame()),
       pelvis_(plant_.GetBodyByName("pelvis")),
@@ -58,7 +58,13 @@ HighLevelCommand::HighLevelCommand(
           .get_index();
 
   // Declare update event
-  DeclarePerStepDiscreteUpdateEvent(&HighLevelCommand::DiscreteVariableUpdate);
+  if (update_period > 0) {
+    DeclarePeriodicDiscreteUpdateEvent(
+        update_period, 0, &HighLevelCommand::DiscreteVariableUpdate);
+  } else {
+    DeclarePerStepDiscreteUpdateEvent(
+        &HighLevelCommand::DiscreteVariableUpdate);
+  }
 
   // Discrete state which stores previous timestamp
   prev_time_idx_ = DeclareDiscreteState(VectorXd::Zero(1));
@@ -37,11 +37,15 @@ namespace osc {
 ///
 /// Assumption: the roll and pitch angles are close to 0.
 /// Requirement: quaternion floating-based Cassie only
+///
+/// The commands are updated every `update_period` seconds, or every simulator
+/// step if it is zero.
 class HighLevelCommand : public drake::systems::LeafSystem<double> {
  public:
   HighLevelCommand(const drake::multibody::MultibodyPlant<double>& plant,
                    const Eigen::Vector2d& global_target_position,
-                   const Eigen::Vector2d& params_of_no_turning);
+                   const Eigen::Vector2d& params_of_no_turning,
+                   double update_period = 0);
 
   // Input/output ports
   const drake::systems::InputPort<double>& get_state_input_port() const {
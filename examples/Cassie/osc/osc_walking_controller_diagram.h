@@ -0,0 +1,98 @@
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include "multibody/kinematic/distance_evaluator.h"
+#include "multibody/kinematic/kinematic_evaluator_set.h"
+#include "multibody/kinematic/world_point_evaluator.h"
+#include "systems/controllers/osc/osc_tracking_data.h"
+
+#include "drake/multibody/plant/multibody_plant.h"
+#include "drake/systems/framework/diagram.h"
+
+namespace dairlib {
+namespace cassie {
+namespace osc {
+
+/// Options of OSCWalkingControllerDiagram
+struct OSCWalkingControllerOptions {
+  /// true: only right/left single support
+  /// false: both double and single support
+  bool is_two_phase = false;
+  /// Plan foot placement with the multi-step LIPM MPC instead of the
+  /// single-step capture point heuristic
+  bool footstep_mpc = false;
+  /// Print the OSC tracking info to the terminal
+  bool print_osc = false;
+  /// Drift rate for the floating-base state (see SimulatorDrift). No drift is
+  /// emulated if zero.
+  double drift_rate = 0;
+  /// Period of the discrete updates of the controller (fsm, trajectory
+  /// generators, OSC). If zero, they run on every step of the simulator,
+  /// i.e. once per state message in an LcmDrivenLoop.
+  double update_period = 0;
+};
+
+/// OSCWalkingControllerDiagram is the walking controller of Cassie: the
+/// finite state machine, the CoM, swing foot and pelvis trajectory generators,
+/// the foot placement controller and the operational space controller.
+///
+/// It builds and owns its own models of Cassie (with and without springs),
+/// and owns the tracking data and kinematic evaluators of the OSC, so that it
+/// can be added to any diagram, e.g. the LCM-driven loop of
+/// run_osc_walking_controller or the in-process closed-loop simulation.
+///
+/// Input:
+///  - OutputVector of the robot (state of the model with springs)
+///
+/// Output:
+///  - TimestampedVector of the motor torques
+class OSCWalkingControllerDiagram : public drake::systems::Diagram<double> {
+ public:
+  DRAKE_NO_COPY_NO_MOVE_NO_ASSIGN(OSCWalkingControllerDiagram)
+
+  explicit OSCWalkingControllerDiagram(
+      const OSCWalkingControllerOptions& options =
+          OSCWalkingControllerOptions());
+
+  const drake::systems::InputPort<double>& get_input_port_state() const {
+    return this->get_input_port(state_port_);
+  }
+  const drake::systems::OutputPort<double>& get_output_port_control() const {
+    return this->get_output_port(control_port_);
+  }
+
+  const drake::multibody::MultibodyPlant<double>& get_plant_w_springs() const {
+    return *plant_w_springs_;
+  }
+
+ private:
+  std::unique_ptr<drake::multibody::MultibodyPlant<double>> plant_w_springs_;
+  std::unique_ptr<drake::multibody::MultibodyPlant<double>> plant_wo_springs_;
+
+  // Constraints and tracking data of the OSC, which keeps pointers to them
+  std::unique_ptr<multibody::KinematicEvaluatorSet<double>> evaluators_;
+  std::unique_ptr<multibody::DistanceEvaluator<double>> left_loop_;
+  std::unique_ptr<multibody::DistanceEvaluator<double>> right_loop_;
+  std::vector<std::unique_ptr<multibody::WorldPointEvaluator<double>>>
+      contact_evaluators_;
+  std::unique_ptr<systems::controllers::TransTaskSpaceTrackingData>
+      swing_foot_traj_;
+  std::unique_ptr<systems::controllers::ComTrackingData> center_of_mass_traj_;
+  std::unique_ptr<systems::controllers::RotTaskSpaceTrackingData>
+      pelvis_balance_traj_;
+  std::unique_ptr<systems::controllers::RotTaskSpaceTrackingData>
+      pelvis_heading_traj_;
+  std::unique_ptr<systems::controllers::JointSpaceTrackingData>
+      swing_toe_traj_;
+  std::unique_ptr<systems::controllers::JointSpaceTrackingData>
+      swing_hip_yaw_traj_;
+
+  int state_port_;
+  int control_port_;
+};
+
+}  // namespace osc
+}  // namespace cassie
+}  // namespace dairlib
@@ -0,0 +1,55 @@
+#include <iostream>
+
+#include <gflags/gflags.h>
+
+#include "examples/Cassie/cassie_udp_sim.h"
+
+namespace dairlib {
+
+// Network parameters.
+DEFINE_string(address, "127.0.0.1", "IPv4 address of the robot stack");
+DEFINE_int32(output_port, 25001,
+             "Port the state packets are sent to (dispatcher_robot_out)");
+DEFINE_int32(input_port, 25000,
+             "Port the commands are received on (dispatcher_robot_in)");
+DEFINE_double(publish_rate, 2000, "Rate of the state packets (Hz)");
+DEFINE_bool(lockstep, false,
+            "Wait for a command after each state packet instead of pacing "
+            "the packets to the wall clock");
+
+// Simulation parameters.
+DEFINE_double(end_time, 10, "End time of the simulation");
+DEFINE_double(dt, 8e-5, "Time step of the simulated plant");
+DEFINE_double(penetration_allowance, 1e-5,
+              "Penetration allowance for the contact model. Nearly equivalent"
+              " to (m)");
+DEFINE_double(v_stiction, 1e-3, "Stiction tolerance (m/s)");
+DEFINE_double(mu, 0.8, "Friction coefficient of the ground");
+DEFINE_double(init_height, 1.0,
+              "Initial starting height of the pelvis above ground");
+
+int do_main(int argc, char* argv[]) {
+  gflags::ParseCommandLineFlags(&argc, &argv, true);
+
+  CassieUdpSimOptions options;
+  options.address = FLAGS_address;
+  options.output_port = FLAGS_output_port;
+  options.input_port = FLAGS_input_port;
+  options.period = 1.0 / FLAGS_publish_rate;
+  options.lockstep = FLAGS_lockstep;
+  options.sim_dt = FLAGS_dt;
+  options.penetration_allowance = FLAGS_penetration_allowance;
+  options.v_stiction = FLAGS_v_stiction;
+  options.mu = FLAGS_mu;
+
+  CassieUdpSim sim(options);
+  sim.SetStandingState(FLAGS_init_height);
+  sim.Run(FLAGS_end_time);
+  sim.get_stats().Print();
+
+  return 0;
+}
+
+}  // namespace dairlib
+
+int main(int argc, char* argv[]) { return dairlib::do_main(argc, argv); }
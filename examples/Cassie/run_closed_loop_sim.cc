@@ -0,0 +1,110 @@
+#include <chrono>
+#include <iostream>
+
+#include <gflags/gflags.h>
+
+#include "examples/Cassie/closed_loop_sim.h"
+
+namespace dairlib {
+
+using Eigen::VectorXd;
+
+// Simulation parameters.
+DEFINE_double(end_time, 5, "End time of the simulation");
+DEFINE_bool(reduced_fidelity, false,
+            "Simulate the model with fixed leg springs, at a larger time "
+            "step");
+DEFINE_double(dt, 0,
+              "Time step of the simulated plant (0 uses the default of the "
+              "model fidelity)");
+DEFINE_double(penetration_allowance, 1e-5,
+              "Penetration allowance for the contact model. Nearly equivalent"
+              " to (m)");
+DEFINE_double(v_stiction, 1e-3, "Stiction tolerance (m/s)");
+DEFINE_double(mu, 0.8, "Friction coefficient of the ground");
+DEFINE_double(init_height, 1.0,
+              "Initial starting height of the pelvis above ground");
+DEFINE_double(target_realtime_rate, 0,
+              "Desired rate relative to real time (0 runs as fast as "
+              "possible). See documentation for "
+              "Simulator::set_target_realtime_rate() for details.");
+DEFINE_string(save_snapshot, "",
+              "File the state of the simulation is saved to at "
+              "snapshot_time");
+DEFINE_double(snapshot_time, 1, "Time at which the snapshot is saved");
+DEFINE_string(load_snapshot, "",
+              "Resume the simulation from this snapshot instead of starting "
+              "from a standing configuration");
+
+// Loop parameters.
+DEFINE_double(sensor_period, 5e-4, "Sample period of the sensors");
+DEFINE_double(control_period, 2e-3, "Period of the controller");
+DEFINE_double(control_latency, 0,
+              "Delay between sampling the controller input and applying its "
+              "output (rounded to a whole number of control periods)");
+DEFINE_bool(state_estimator, true,
+            "Close the loop through the state estimator. Otherwise the "
+            "controller uses the ground truth state");
+
+// Controller parameters.
+DEFINE_bool(is_two_phase, false,
+            "true: only right/left single support"
+            "false: both double and single support");
+DEFINE_bool(footstep_mpc, false,
+            "Plan foot placement with the multi-step LIPM MPC instead of the "
+            "single-step capture point heuristic");
+
+int do_main(int argc, char* argv[]) {
+  gflags::ParseCommandLineFlags(&argc, &argv, true);
+
+  CassieClosedLoopSimOptions options;
+  options.fidelity = FLAGS_reduced_fidelity ? CassieSimFidelity::kReduced
+                                             : CassieSimFidelity::kFull;
+  options.sim_dt = FLAGS_dt;
+  options.penetration_allowance = FLAGS_penetration_allowance;
+  options.v_stiction = FLAGS_v_stiction;
+  options.mu = FLAGS_mu;
+  options.sensor_period = FLAGS_sensor_period;
+  options.control_period = FLAGS_control_period;
+  options.control_latency = FLAGS_control_latency;
+  options.use_state_estimator = FLAGS_state_estimator;
+  options.controller.is_two_phase = FLAGS_is_two_phase;
+  options.controller.footstep_mpc = FLAGS_footstep_mpc;
+  CassieClosedLoopSim sim(options);
+
+  const auto& plant = sim.get_plant();
+  if (FLAGS_load_snapshot.empty()) {
+    VectorXd q_init = sim.CalcStandingPositions(FLAGS_init_height);
+    sim.SetInitialState(q_init, VectorXd::Zero(plant.num_velocities()));
+  } else {
+    sim.LoadSnapshot(FLAGS_load_snapshot);
+  }
+  sim.get_mutable_simulator().set_target_realtime_rate(
+      FLAGS_target_realtime_rate);
+
+  const double start_time = sim.get_time();
+  auto start = std::chrono::steady_clock::now();
+  if (!FLAGS_save_snapshot.empty() && FLAGS_snapshot_time > start_time &&
+      FLAGS_snapshot_time < FLAGS_end_time) {
+    sim.AdvanceTo(FLAGS_snapshot_time);
+    sim.SaveSnapshot(FLAGS_save_snapshot);
+    std::cout << "Saved snapshot at t = " << sim.get_time() << std::endl;
+  }
+  sim.AdvanceTo(FLAGS_end_time);
+  std::chrono::duration<double> elapsed =
+      std::chrono::steady_clock::now() - start;
+
+  VectorXd x = sim.GetState();
+  const double duration = FLAGS_end_time - start_time;
+  std::cout << "Simulated " << duration << " s in " << elapsed.count()
+            << " s (" << duration / elapsed.count() << "x real time)"
+            << std::endl;
+  std::cout << "Final pelvis position: " << x.segment(4, 3).transpose()
+            << std::endl;
+
+  return 0;
+}
+
+}  // namespace dairlib
+
+int main(int argc, char* argv[]) { return dairlib::do_main(argc, argv); }
@@ -10,7 +10,9 @@
 #include "examples/Cassie/cassie_utils.h"
 #include "multibody/com_pose_system.h"
 #include "multibody/multibody_utils.h"
+#include "solvers/kkt_polish.h"
 #include "solvers/nonlinear_constraint.h"
+#include "solvers/structured_sqp_solver.h"
 #include "systems/goldilocks_models/file_utils.h"
 #include "systems/trajectory_optimization/dircon_distance_data.h"
 #include "systems/trajectory_optimization/dircon_kinematic_data_set.h"
@@ -73,11 +75,20 @@ DEFINE_bool(store_data, false, "To store solution or not");
 DEFINE_int32(max_iter, 100000, "Iteration limit");
 DEFINE_double(duration, 0.4, "Duration of the single support phase (s)");
 DEFINE_double(tol, 1e-4, "Tolerance for constraint violation and dual gap");
+DEFINE_bool(polish, false,
+            "Stop SNOPT at --loose_tol, then converge to --tol with Newton "
+            "steps on the KKT conditions of the active constraints (falling "
+            "back to SNOPT if the active set changes)");
+DEFINE_double(loose_tol, 1e-2, "SNOPT tolerance before polishing");
 
 // Parameters which enable dircon-improving features
 DEFINE_bool(is_scale_constraint, true, "Scale the nonlinear constraint values");
 DEFINE_bool(is_scale_variable, false, "Scale the decision variable");
 
+DEFINE_string(solver, "snopt",
+              "snopt, or sqp for the structured SQP solver, which factors "
+              "the KKT system knot by knot");
+
 namespace dairlib {
 void DoMain(double duration, int max_iter, string data_directory,
             string init_file, double tol, bool to_store_data) {
@@ -226,7 +237,9 @@ void DoMain(double duration, int max_iter, string data_directory,
   auto trajopt = std::make_shared<HybridDircon<double>>(
       plant, num_time_samples, min_dt, max_dt, dataset_list, options_list);
 
-  // Snopt settings
+  // Snopt settings. With --polish, SNOPT stops at a loose tolerance and the
+  // KKT polish takes the solution to tol.
+  const double snopt_tol = FLAGS_polish ? FLAGS_loose_tol : tol;
   // trajopt->SetSolverOption(drake::solvers::SnoptSolver::id(),
   //                          "Print file", "../snopt.out");
   trajopt->SetSolverOption(drake::solvers::SnoptSolver::id(),
@@ -239,10 +252,10 @@ void DoMain(double duration, int max_iter, string data_directory,
                            0);  // snopt doc said try 2 if seeing snopta exit 40
   trajopt->SetSolverOption(drake::solvers::SnoptSolver::id(),
                            "Major optimality tolerance",
-                           tol);  // target nonlinear constraint violation
+                           snopt_tol);  // target nonlinear constraint violation
   trajopt->SetSolverOption(drake::solvers::SnoptSolver::id(),
                            "Major feasibility tolerance",
-                           tol);  // target complementarity gap
+                           snopt_tol);  // target complementarity gap
 
   int N = 0;
   for (uint i = 0; i < num_time_samples.size(); i++) N += num_time_samples[i];
@@ -460,7 +473,48 @@ void DoMain(double duration, int max_iter, string data_directory,
 
   cout << "Solving DIRCON\n\n";
   auto start = std::chrono::high_resolution_clock::now();
-  const auto result = Solve(*trajopt, trajopt->initial_guess());
+  drake::solvers::MathematicalProgramResult result;
+  if (FLAGS_solver == "sqp") {
+    solvers::StructuredSqpOptions sqp_options;
+    sqp_options.max_iterations = max_iter;
+    sqp_options.feasibility_tolerance = tol;
+    sqp_options.optimality_tolerance = tol;
+    sqp_options.verbose = true;
+    const auto sqp_result = solvers::SolveWithStructuredSqp(
+        *trajopt, trajopt->GetDecisionVariableStages(),
+        trajopt->initial_guess(), sqp_options, &result);
+    cout << "SQP iterations: " << sqp_result.iterations
+         << ", QP iterations: " << sqp_result.qp_iterations << endl;
+    cout << "KKT size: " << sqp_result.kkt_size
+         << ", stored entries: " << sqp_result.kkt_entries
+         << ", border: " << sqp_result.kkt_border << endl;
+    cout << "Constraint violation: " << sqp_result.constraint_violation
+         << ", stationarity: " << sqp_result.stationarity << endl;
+  } else {
+    result = Solve(*trajopt, trajopt->initial_guess());
+  }
+  if (FLAGS_polish) {
+    solvers::KktPolishOptions polish_options;
+    polish_options.active_tolerance = FLAGS_loose_tol;
+    polish_options.feasibility_tolerance = tol;
+    polish_options.optimality_tolerance = tol;
+    const auto polish = solvers::PolishKktSolution(
+        *trajopt, result.get_x_val(), polish_options);
+    cout << "KKT polish: " << polish.iterations << " Newton steps, "
+         << polish.num_active << " active constraints, violation "
+         << polish.constraint_violation << endl;
+    if (polish.is_success()) {
+      result.set_x_val(polish.x);
+      result.set_optimal_cost(polish.cost);
+    } else {
+      cout << "Polish failed, resolving with SNOPT\n";
+      trajopt->SetSolverOption(drake::solvers::SnoptSolver::id(),
+                               "Major optimality tolerance", tol);
+      trajopt->SetSolverOption(drake::solvers::SnoptSolver::id(),
+                               "Major feasibility tolerance", tol);
+      result = Solve(*trajopt, result.get_x_val());
+    }
+  }
   SolutionResult solution_result = result.get_solution_result();
   auto finish = std::chrono::high_resolution_clock::now();
   std::chrono::duration<double> elapsed = finish - start;
@@ -1,14 +1,20 @@
 #include <algorithm>
 #include <chrono>
+#include <cstdio>
 #include <fstream>
 #include <memory>
+#include <numeric>
+#include <sstream>
 #include <string>
 #include <gflags/gflags.h>
 #include "common/find_resource.h"
+#include "examples/Cassie/cassie_lipm_initial_guess.h"
 #include "examples/Cassie/cassie_utils.h"
 #include "multibody/com_pose_system.h"
 #include "multibody/multibody_utils.h"
 #include "multibody/visualization_utils.h"
+#include "solvers/kkt_polish.h"
+#include "solvers/lazy_constraints.h"
 #include "systems/goldilocks_models/file_utils.h"
 #include "systems/trajectory_optimization/dircon_distance_data.h"
 #include "systems/trajectory_optimization/dircon_kinematic_data_set.h"
@@ -41,6 +47,7 @@ using Eigen::VectorXd;
 using dairlib::goldilocks_models::readCSV;
 using dairlib::goldilocks_models::writeCSV;
 using dairlib::systems::SubvectorPassThrough;
+using dairlib::systems::trajectory_optimization::CompletedStateConstraint;
 using dairlib::systems::trajectory_optimization::DirconOptions;
 using dairlib::systems::trajectory_optimization::HybridDircon;
 using dairlib::systems::trajectory_optimization::PointPositionConstraint;
@@ -54,7 +61,10 @@ using drake::multibody::MultibodyPlant;
 using drake::multibody::Parser;
 using drake::multibody::SpatialInertia;
 using drake::multibody::UnitInertia;
+using drake::solvers::BoundingBoxConstraint;
 using drake::solvers::Constraint;
+using drake::solvers::LinearEqualityConstraint;
+using drake::solvers::MathematicalProgramResult;
 using drake::solvers::SolutionResult;
 using drake::systems::rendering::MultibodyPositionToGeometryPose;
 using drake::trajectories::PiecewisePolynomial;
@@ -67,6 +77,25 @@ DEFINE_bool(store_data, false, "To store solution or not");
 // SNOPT parameters
 DEFINE_int32(max_iter, 100000, "Iteration limit");
 DEFINE_double(tol, 1e-4, "Tolerance for constraint violation and dual gap");
+DEFINE_bool(polish, false,
+            "Stop SNOPT at --loose_tol, then converge to --tol with Newton "
+            "steps on the KKT conditions of the active constraints (falling "
+            "back to SNOPT if the active set changes)");
+DEFINE_double(loose_tol, 1e-2, "SNOPT tolerance before polishing");
+DEFINE_bool(lazy_constraints, false,
+            "Start without the inequality constraints (friction cones, ...) "
+            "but the variable bounds, and add the violated ones over "
+            "successive warm started solves");
+DEFINE_string(continuation_n_node, "",
+              "Comma separated numbers of nodes of coarser meshes (e.g. "
+              "\"6,10\") to solve on first, each warm starting the next one, "
+              "before solving on --n_node. The coarse meshes start from the "
+              "inverse kinematics guess (not --init_file) and are solved to "
+              "--continuation_tol. There is no play back of the solution.");
+DEFINE_double(continuation_tol, 1e-2, "SNOPT tolerance of the coarse meshes");
+DEFINE_bool(compare_direct, false,
+            "After the continuation, also solve directly on --n_node and "
+            "report both solve times and iteration counts");
 DEFINE_int32(scale_option, 0,
              "Scale option of SNOPT"
              "Use 2 if seeing snopta exit 40 in log file");
@@ -88,8 +117,20 @@ DEFINE_bool(is_scale_constraint, true, "Scale the nonlinear constraint values");
 DEFINE_bool(is_scale_variable, true, "Scale the decision variable");
 
 // Others
+DEFINE_bool(minimal_coordinates, false,
+            "Eliminate the four-bar loop closures by minimal coordinates: the "
+            "ankle joints are computed from the knees, and the closures have "
+            "no force variables or kinematic constraints");
+DEFINE_bool(lipm_init_guess, false,
+            "Start from a walking step synthesized from a LIPM gait (with "
+            "consistent inputs and forces) instead of the inverse kinematics "
+            "guess. Ignored with --init_file.");
 DEFINE_bool(visualize_init_guess, false,
             "to visualize the poses of the initial guess");
+DEFINE_bool(visualize, true,
+            "Visualize the iterations and play back the solution. Disable for "
+            "unattended runs (e.g. timing the solve).");
+DEFINE_string(snopt_print_file, "", "File to write the SNOPT log to");
 
 namespace dairlib {
 
@@ -226,16 +267,101 @@ vector<VectorXd> GetInitGuessForV(const vector<VectorXd>& q_seed, double dt,
   return v_seed;
 }
 
+// Solution of one mesh of the continuation, as trajectories that can be
+// sampled on the next (finer) mesh. The forces are those of the single
+// support mode, and the variables of the impact mode, which has a single
+// knot, don't depend on the mesh.
+struct WalkingSolution {
+  PiecewisePolynomial<double> x;
+  PiecewisePolynomial<double> u;
+  PiecewisePolynomial<double> lambda;
+  PiecewisePolynomial<double> lambda_c;
+  PiecewisePolynomial<double> v_c;
+  // Pre-impact state at the last knot
+  VectorXd x_final;
+  VectorXd lambda_impact_mode;
+  VectorXd impulse;
+  VectorXd v_post_impact;
+  vector<VectorXd> offsets;
+  SolutionResult solution_result;
+  double solve_time = 0;
+};
+
+WalkingSolution ExtractWalkingSolution(
+    const HybridDircon<double>& trajopt,
+    const MathematicalProgramResult& result) {
+  WalkingSolution solution;
+  solution.x = trajopt.ReconstructStateTrajectory(result);
+  solution.u = trajopt.ReconstructInputTrajectory(result);
+  solution.x_final = result.GetSolution(trajopt.state(trajopt.N() - 1));
+
+  // All knots but the impact one belong to the single support mode
+  const VectorXd times = trajopt.GetSampleTimes(result);
+  const int n_l = trajopt.num_kinematic_constraints_wo_skipping(0);
+  vector<double> knot_times;
+  vector<double> collocation_times;
+  vector<MatrixXd> lambda;
+  vector<MatrixXd> lambda_c;
+  vector<MatrixXd> v_c;
+  for (int i = 0; i < trajopt.N(); i++) {
+    knot_times.push_back(times(i));
+    lambda.push_back(result.GetSolution(trajopt.force(0, i)));
+  }
+  for (int i = 0; i < trajopt.N() - 1; i++) {
+    collocation_times.push_back((times(i) + times(i + 1)) / 2);
+    lambda_c.push_back(result.GetSolution(trajopt.collocation_force(0, i)));
+    v_c.push_back(result.GetSolution(
+        trajopt.collocation_slack_vars(0).segment(i * n_l, n_l)));
+  }
+  solution.lambda = PiecewisePolynomial<double>::FirstOrderHold(knot_times,
+                                                                lambda);
+  solution.lambda_c =
+      PiecewisePolynomial<double>::FirstOrderHold(collocation_times, lambda_c);
+  solution.v_c =
+      PiecewisePolynomial<double>::FirstOrderHold(collocation_times, v_c);
+
+  solution.lambda_impact_mode = result.GetSolution(trajopt.force_vars(1));
+  solution.impulse = result.GetSolution(trajopt.impulse_vars(0));
+  solution.v_post_impact = result.GetSolution(trajopt.v_post_impact_vars());
+  for (int mode = 0; mode < 2; mode++) {
+    solution.offsets.push_back(result.GetSolution(trajopt.offset_vars(mode)));
+  }
+  solution.solution_result = result.get_solution_result();
+  return solution;
+}
+
+// Sum of the SNOPT major iterations of the solves logged in a print file, or
+// -1 if there are none
+int CountSnoptMajorIterations(const string& print_file) {
+  const string label = "No. of major iterations";
+  std::ifstream file(print_file);
+  string line;
+  int total = -1;
+  while (std::getline(file, line)) {
+    auto position = line.find(label);
+    if (position == string::npos) continue;
+    std::stringstream stream(line.substr(position + label.size()));
+    int iterations;
+    if (stream >> iterations) total = std::max(total, 0) + iterations;
+  }
+  return total;
+}
+
+/// @param visualize visualize the iterations and play back the solution
+/// @param snopt_print_file SNOPT log (none if empty)
+/// @param warm_start solution on a coarser mesh to start from, instead of
+///   init_file or the inverse kinematics guess
+/// @param solution if not null, receives the solution
 void DoMain(double duration, double stride_length, double ground_incline,
             bool is_fix_time, int n_node, int max_iter,
             const string& data_directory, const string& init_file, double tol,
-            bool to_store_data, int scale_option) {
+            bool to_store_data, int scale_option, bool visualize,
+            const string& snopt_print_file,
+            const WalkingSolution* warm_start = nullptr,
+            WalkingSolution* solution = nullptr) {
   // Dircon parameter
   double minimum_timestep = 0.01;
   DRAKE_DEMAND(duration / (n_node - 1) >= minimum_timestep);
-  // If the node density is too low, it's harder for SNOPT to converge well.
-  double max_distance_per_node = 0.2 / 16;
-  DRAKE_DEMAND((stride_length / n_node) <= max_distance_per_node);
 
   // Cost on velocity and input
   double w_Q = 0.05;
@@ -343,6 +469,11 @@ void DoMain(double duration, double stride_length, double ground_incline,
       plant, thigh_right, pt_on_thigh_right, heel_spring_right,
       pt_on_heel_spring, rod_length);
 
+  vector<DirconKinematicData<double>*> loop_closures;
+  loop_closures.push_back(&distance_constraint_left);
+  loop_closures.push_back(&distance_constraint_right);
+  const bool minimal_coordinates = FLAGS_minimal_coordinates;
+
   // get rid of redundant constraint
   vector<int> skip_constraint_inds;
   skip_constraint_inds.push_back(3);
@@ -351,19 +482,37 @@ void DoMain(double duration, double stride_length, double ground_incline,
   vector<DirconKinematicData<double>*> ls_constraint;
   ls_constraint.push_back(&left_toe_front_constraint);
   ls_constraint.push_back(&left_toe_rear_constraint);
-  ls_constraint.push_back(&distance_constraint_left);
-  ls_constraint.push_back(&distance_constraint_right);
+  if (!minimal_coordinates) {
+    ls_constraint.push_back(&distance_constraint_left);
+    ls_constraint.push_back(&distance_constraint_right);
+  }
   auto ls_dataset = DirconKinematicDataSet<double>(plant, &ls_constraint,
                                                    skip_constraint_inds);
   // Right support
   vector<DirconKinematicData<double>*> rs_constraint;
   rs_constraint.push_back(&right_toe_front_constraint);
   rs_constraint.push_back(&right_toe_rear_constraint);
-  rs_constraint.push_back(&distance_constraint_left);
-  rs_constraint.push_back(&distance_constraint_right);
+  if (!minimal_coordinates) {
+    rs_constraint.push_back(&distance_constraint_left);
+    rs_constraint.push_back(&distance_constraint_right);
+  }
   auto rs_dataset = DirconKinematicDataSet<double>(plant, &rs_constraint,
                                                    skip_constraint_inds);
 
+  // With minimal coordinates, the ankle joints depend on the knees through
+  // the four-bars (and start the inner solve bent as in the initial guess)
+  if (minimal_coordinates) {
+    vector<int> dependent_positions{pos_map.at("ankle_joint_left"),
+                                    pos_map.at("ankle_joint_right")};
+    vector<int> dependent_velocities{vel_map.at("ankle_joint_leftdot"),
+                                     vel_map.at("ankle_joint_rightdot")};
+    const Eigen::Vector2d ankle_guess(1.6, 1.6);
+    ls_dataset.setLoopClosures(&loop_closures, dependent_positions,
+                               dependent_velocities, ankle_guess);
+    rs_dataset.setLoopClosures(&loop_closures, dependent_positions,
+                               dependent_velocities, ankle_guess);
+  }
+
   // Set up options
   std::vector<DirconOptions> options_list;
   options_list.push_back(DirconOptions(ls_dataset.countConstraints(), plant));
@@ -404,10 +553,12 @@ void DoMain(double duration, double stride_length, double ground_incline,
           {n_l + 0, n_l + 1, n_l + 2, n_l + 3, n_l + 4}, s / 10.0);
       options_list[i].setKinConstraintScaling(
           {2 * n_l + 0, 2 * n_l + 1, 2 * n_l + 2, 2 * n_l + 3, 2 * n_l + 4}, s);
-      options_list[i].setKinConstraintScaling({5, 6}, s / 300.0);
-      options_list[i].setKinConstraintScaling({n_l + 5, n_l + 6}, s);
-      options_list[i].setKinConstraintScaling({2 * n_l + 5, 2 * n_l + 6},
-                                              s * 20);
+      if (!minimal_coordinates) {
+        options_list[i].setKinConstraintScaling({5, 6}, s / 300.0);
+        options_list[i].setKinConstraintScaling({n_l + 5, n_l + 6}, s);
+        options_list[i].setKinConstraintScaling({2 * n_l + 5, 2 * n_l + 6},
+                                                s * 20);
+      }
       // Impact constraints
       options_list[i].setImpConstraintScaling({0, 1, 2}, s / 50.0);
       options_list[i].setImpConstraintScaling({3, 4, 5}, s / 300.0);
@@ -436,9 +587,13 @@ void DoMain(double duration, double stride_length, double ground_incline,
   auto trajopt = std::make_shared<HybridDircon<double>>(
       plant, num_time_samples, min_dt, max_dt, dataset_list, options_list);
 
-  // Snopt settings
-  //  trajopt->SetSolverOption(drake::solvers::SnoptSolver::id(), "Print file",
-  //                           "../snopt.out");
+  // Snopt settings. With --polish, SNOPT stops at a loose tolerance and the
+  // KKT polish takes the solution to tol.
+  const double snopt_tol = FLAGS_polish ? FLAGS_loose_tol : tol;
+  if (!snopt_print_file.empty()) {
+    trajopt->SetSolverOption(drake::solvers::SnoptSolver::id(), "Print file",
+                             snopt_print_file);
+  }
   trajopt->SetSolverOption(drake::solvers::SnoptSolver::id(),
                            "Major iterations limit", max_iter);
   trajopt->SetSolverOption(drake::solvers::SnoptSolver::id(),
@@ -450,10 +605,10 @@ void DoMain(double duration, double stride_length, double ground_incline,
       scale_option);  // snopt doc said try 2 if seeing snopta exit 40
   trajopt->SetSolverOption(drake::solvers::SnoptSolver::id(),
                            "Major optimality tolerance",
-                           tol);  // target nonlinear constraint violation
+                           snopt_tol);  // target nonlinear constraint violation
   trajopt->SetSolverOption(drake::solvers::SnoptSolver::id(),
                            "Major feasibility tolerance",
-                           tol);  // target complementarity gap
+                           snopt_tol);  // target complementarity gap
 
   int N = 0;
   for (uint i = 0; i < num_time_samples.size(); i++) N += num_time_samples[i];
@@ -544,6 +699,10 @@ void DoMain(double duration, double stride_length, double ground_incline,
           -uf(act_map.at(asy_joint_names[i] + l_r_pair.second + "_motor")));
     }
     for (unsigned int i = 0; i < sym_joint_names.size(); i++) {
+      // (the fixed ankle joints of minimal coordinates follow the knees)
+      if (minimal_coordinates && sym_joint_names[i] == "ankle_joint") {
+        continue;
+      }
       // positions
       trajopt->AddLinearConstraint(
           x0(pos_map.at(sym_joint_names[i] + l_r_pair.first)) ==
@@ -561,8 +720,21 @@ void DoMain(double duration, double stride_length, double ground_incline,
     }
   }  // end for (l_r_pairs)
 
-  // joint limits
+  // joint limits (with minimal coordinates, those of the ankle joints on the
+  // complete states, as their state variables are fixed)
   for (const auto& member : joint_names) {
+    if (minimal_coordinates && member.find("ankle_joint") == 0) {
+      auto limits = std::make_shared<CompletedStateConstraint<double>>(
+          plant, &ls_dataset, vector<int>{pos_map.at(member)},
+          std::make_shared<BoundingBoxConstraint>(
+              plant.GetJointByName(member).position_lower_limits(),
+              plant.GetJointByName(member).position_upper_limits()),
+          member + "_limits");
+      for (int i = 0; i < N; i++) {
+        trajopt->AddConstraint(limits, trajopt->state(i));
+      }
+      continue;
+    }
     trajopt->AddConstraintToAllKnotPoints(
         x(pos_map.at(member)) <=
         plant.GetJointByName(member).position_upper_limits()(0));
@@ -578,6 +750,25 @@ void DoMain(double duration, double stride_length, double ground_incline,
                                       VectorXd::Constant(n_u, +300), ui);
   }
 
+  // Adds a constraint on the positions of a knot point. The toe positions
+  // depend on the ankle joints, so with minimal coordinates it is evaluated on
+  // the complete state.
+  vector<int> position_indices(n_q);
+  std::iota(position_indices.begin(), position_indices.end(), 0);
+  auto add_position_constraint =
+      [&](const std::shared_ptr<PointPositionConstraint<double>>& constraint,
+          int index) {
+        auto x_index = trajopt->state(index);
+        if (minimal_coordinates) {
+          trajopt->AddConstraint(
+              std::make_shared<CompletedStateConstraint<double>>(
+                  plant, &ls_dataset, position_indices, constraint),
+              x_index);
+        } else {
+          trajopt->AddConstraint(constraint, x_index.head(n_q));
+        }
+      };
+
   // toe position constraint in y direction (avoid leg crossing)
   auto left_foot_constraint = std::make_shared<PointPositionConstraint<double>>(
       plant, "toe_left", Vector3d::Zero(), MatrixXd::Identity(3, 3).row(1),
@@ -597,9 +788,8 @@ void DoMain(double duration, double stride_length, double ground_incline,
     right_foot_constraint->SetConstraintScaling(odbp_constraint_scale);
   }
   for (int index = 0; index < num_time_samples[0]; index++) {
-    auto x = trajopt->state(index);
-    trajopt->AddConstraint(left_foot_constraint, x.head(n_q));
-    trajopt->AddConstraint(right_foot_constraint, x.head(n_q));
+    add_position_constraint(left_foot_constraint, index);
+    add_position_constraint(right_foot_constraint, index);
   }
   // toe height constraint (avoid foot scuffing)
   Vector3d z_hat(0, 0, 1);
@@ -612,8 +802,7 @@ void DoMain(double duration, double stride_length, double ground_incline,
           0.08 * VectorXd::Ones(1),
           std::numeric_limits<double>::infinity() * VectorXd::Ones(1),
           "toe_right_z");
-  auto x_mid = trajopt->state(num_time_samples[0] / 2);
-  trajopt->AddConstraint(right_foot_constraint_z, x_mid.head(n_q));
+  add_position_constraint(right_foot_constraint_z, num_time_samples[0] / 2);
 
   // Optional -- constraint on initial floating base
   trajopt->AddConstraint(x0(0) == 1);
@@ -652,7 +841,7 @@ void DoMain(double duration, double stride_length, double ground_incline,
     trajopt->AddLinearConstraint(ui(6) >= 0);
   }*/
   // Optional -- constraint left four-bar force (seems to help in high speed)
-  if (constrain_stance_leg_fourbar_force) {
+  if (constrain_stance_leg_fourbar_force && !minimal_coordinates) {
     for (unsigned int mode = 0; mode < num_time_samples.size(); mode++) {
       for (int index = 0; index < num_time_samples[mode]; index++) {
         auto lambda = trajopt->force(mode, index);
@@ -700,7 +889,9 @@ void DoMain(double duration, double stride_length, double ground_incline,
     trajopt->ScaleQuaternionSlackVariables(30);
     // Constraint slack
     trajopt->ScaleKinConstraintSlackVariables(0, {0, 1, 2, 3, 4, 5}, 50);
-    trajopt->ScaleKinConstraintSlackVariables(0, {6, 7}, 500);
+    if (!minimal_coordinates) {
+      trajopt->ScaleKinConstraintSlackVariables(0, {6, 7}, 500);
+    }
   }
 
   // add cost
@@ -712,6 +903,36 @@ void DoMain(double duration, double stride_length, double ground_incline,
   trajopt->AddRunningCost(x.tail(n_v).transpose() * W_Q * x.tail(n_v));
   trajopt->AddRunningCost(u.transpose() * W_R * u);
 
+  // With minimal coordinates, the ankle velocity variables are fixed, so the
+  // velocity costs use extra variables constrained to the ankle velocities of
+  // the complete states instead
+  const vector<int> ankle_velocity_indices{
+      n_q + vel_map.at("ankle_joint_leftdot"),
+      n_q + vel_map.at("ankle_joint_rightdot")};
+  drake::solvers::VectorXDecisionVariable ankle_v;
+  if (minimal_coordinates) {
+    ankle_v = trajopt->NewContinuousVariables(2 * N, "ankle_v");
+    MatrixXd A(2, 4);
+    A << MatrixXd::Identity(2, 2), -MatrixXd::Identity(2, 2);
+    auto ankle_v_constraint =
+        std::make_shared<CompletedStateConstraint<double>>(
+            plant, &ls_dataset, ankle_velocity_indices,
+            std::make_shared<LinearEqualityConstraint>(A, VectorXd::Zero(2)),
+            "ankle_v");
+    for (int i = 0; i < N; i++) {
+      trajopt->AddConstraint(ankle_v_constraint,
+                             {trajopt->state(i), ankle_v.segment(2 * i, 2)});
+    }
+    // Trapezoidal integration, as AddRunningCost
+    for (int i = 0; i < N - 1; i++) {
+      auto v0 = ankle_v.segment(2 * i, 2);
+      auto v1 = ankle_v.segment(2 * i + 2, 2);
+      const drake::symbolic::Expression g0 = w_Q * v0.transpose() * v0;
+      const drake::symbolic::Expression g1 = w_Q * v1.transpose() * v1;
+      trajopt->AddCost((g0 + g1) * trajopt->timestep(i)(0) / 2);
+    }
+  }
+
   // add cost on force difference wrt time
   bool diff_with_force_at_collocation = false;
   if (w_lambda_diff) {
@@ -739,6 +960,12 @@ void DoMain(double duration, double stride_length, double ground_incline,
       auto v0 = trajopt->state(i).tail(n_v);
       auto v1 = trajopt->state(i + 1).tail(n_v);
       trajopt->AddCost((v0 - v1).dot(Q_v_diff * (v0 - v1)));
+      if (minimal_coordinates) {
+        auto ankle_v0 = ankle_v.segment(2 * i, 2);
+        auto ankle_v1 = ankle_v.segment(2 * i + 2, 2);
+        trajopt->AddCost(w_v_diff *
+                         (ankle_v0 - ankle_v1).dot(ankle_v0 - ankle_v1));
+      }
     }
   }
   // add cost on input difference wrt time
@@ -770,9 +997,55 @@ void DoMain(double duration, double stride_length, double ground_incline,
   }
 
   // initial guess
-  if (!init_file.empty()) {
+  if (warm_start) {
+    // Sample the solution of the coarser mesh on this one
+    trajopt->SetInitialGuessForAllVariables(
+        VectorXd::Zero(trajopt->decision_variables().size()));
+    trajopt->SetInitialTrajectory(warm_start->u, warm_start->x);
+    trajopt->SetInitialGuess(trajopt->state(N - 1), warm_start->x_final);
+    trajopt->SetInitialForceTrajectory(0, warm_start->lambda,
+                                       warm_start->lambda_c, warm_start->v_c);
+    trajopt->SetInitialGuess(trajopt->force_vars(1),
+                             warm_start->lambda_impact_mode);
+    trajopt->SetInitialGuess(trajopt->impulse_vars(0), warm_start->impulse);
+    trajopt->SetInitialGuess(trajopt->v_post_impact_vars(),
+                             warm_start->v_post_impact);
+    for (int mode = 0; mode < 2; mode++) {
+      trajopt->SetInitialGuess(trajopt->offset_vars(mode),
+                               warm_start->offsets[mode]);
+    }
+  } else if (!init_file.empty()) {
     MatrixXd z0 = readCSV(data_directory + init_file);
     trajopt->SetInitialGuessForAllVariables(z0);
+  } else if (FLAGS_lipm_init_guess) {
+    LipmGaitParameters gait;
+    gait.stride_length = stride_length;
+    gait.duration = duration;
+    gait.ground_incline = ground_incline;
+    const auto guess = CassieLipmWalkingGuess(plant, gait, N);
+    cout << "LIPM initial guess, kinematic residual: "
+         << guess.max_kinematic_residual << endl;
+    // The slacks start at zero, and the impact at the end of the step with
+    // no impulse
+    trajopt->SetInitialGuessForAllVariables(
+        VectorXd::Zero(trajopt->decision_variables().size()));
+    // (without the four-bar forces with minimal coordinates)
+    const int n_l = trajopt->num_kinematic_constraints_wo_skipping(0);
+    for (int i = 0; i < N; i++) {
+      trajopt->SetInitialGuess(trajopt->state(i), guess.x.col(i));
+      trajopt->SetInitialGuess(trajopt->input(i), guess.u.col(i));
+      trajopt->SetInitialGuess(trajopt->force(0, i),
+                               guess.lambda.col(i).head(n_l));
+    }
+    for (int i = 0; i < N - 1; i++) {
+      trajopt->SetInitialGuess(
+          trajopt->collocation_force(0, i),
+          (guess.lambda.col(i) + guess.lambda.col(i + 1)).head(n_l) / 2);
+      trajopt->SetInitialGuess(trajopt->timestep(i)(0),
+                               guess.times(i + 1) - guess.times(i));
+    }
+    trajopt->SetInitialGuess(trajopt->v_post_impact_vars(),
+                             guess.x.col(N - 1).tail(n_v));
   } else {
     // Add random initial guess first (the seed for RNG is fixed)
     trajopt->SetInitialGuessForAllVariables(
@@ -809,8 +1082,10 @@ void DoMain(double duration, double stride_length, double ground_incline,
         auto lambda = trajopt->force(0, i);
         trajopt->SetInitialGuess(lambda(2), 170);
         trajopt->SetInitialGuess(lambda(5), 170);
-        trajopt->SetInitialGuess(lambda(6), -500);
-        trajopt->SetInitialGuess(lambda(7), 50);
+        if (!minimal_coordinates) {
+          trajopt->SetInitialGuess(lambda(6), -500);
+          trajopt->SetInitialGuess(lambda(7), 50);
+        }
       }
       for (int i = 0; i < N - 1; i++) {
         auto lambda0 = trajopt->GetInitialGuess(trajopt->force(0, i));
@@ -903,22 +1178,71 @@ void DoMain(double duration, double stride_length, double ground_incline,
     cout << endl;
   }*/
 
-  trajopt->CreateVisualizationCallback(
-      "examples/Cassie/urdf/cassie_fixed_springs.urdf", 5);
+  if (visualize) {
+    trajopt->CreateVisualizationCallback(
+        "examples/Cassie/urdf/cassie_fixed_springs.urdf", 5);
+  }
 
   cout << "\nChoose the best solver: "
        << drake::solvers::ChooseBestSolver(*trajopt).name() << endl;
 
   cout << "Solving DIRCON\n\n";
   auto start = std::chrono::high_resolution_clock::now();
-  const auto result = Solve(*trajopt, trajopt->initial_guess());
+  solvers::LazyConstraintStatistics lazy_statistics;
+  auto result = FLAGS_lazy_constraints
+                    ? solvers::SolveWithLazyConstraints(
+                          *trajopt, trajopt->initial_guess(),
+                          solvers::LazyConstraintOptions(), &lazy_statistics)
+                    : Solve(*trajopt, trajopt->initial_guess());
+  if (FLAGS_lazy_constraints) {
+    cout << "Lazy constraints: " << lazy_statistics.rounds << " rounds\n";
+    for (int i = 0; i < lazy_statistics.rounds; i++) {
+      cout << "  round " << i << ": "
+           << lazy_statistics.num_lazy_constraints[i] << " of "
+           << lazy_statistics.num_lazy_constraints_total
+           << " inequality constraints, "
+           << lazy_statistics.num_constraint_rows[i] << " constraint rows\n";
+    }
+    if (!lazy_statistics.converged) {
+      cout << "WARNING: inequality constraints still violated after "
+           << lazy_statistics.rounds << " rounds, the solution is infeasible\n";
+    }
+  }
+  if (FLAGS_polish) {
+    solvers::KktPolishOptions polish_options;
+    polish_options.active_tolerance = FLAGS_loose_tol;
+    polish_options.feasibility_tolerance = tol;
+    polish_options.optimality_tolerance = tol;
+    const auto polish = solvers::PolishKktSolution(
+        *trajopt, result.get_x_val(), polish_options);
+    cout << "KKT polish: " << polish.iterations << " Newton steps, "
+         << polish.num_active << " active constraints, violation "
+         << polish.constraint_violation << endl;
+    if (polish.is_success()) {
+      result.set_x_val(polish.x);
+      result.set_optimal_cost(polish.cost);
+    } else {
+      cout << "Polish failed, resolving with SNOPT\n";
+      trajopt->SetSolverOption(drake::solvers::SnoptSolver::id(),
+                               "Major optimality tolerance", tol);
+      trajopt->SetSolverOption(drake::solvers::SnoptSolver::id(),
+                               "Major feasibility tolerance", tol);
+      result = Solve(*trajopt, result.get_x_val());
+    }
+  }
   SolutionResult solution_result = result.get_solution_result();
   auto finish = std::chrono::high_resolution_clock::now();
   std::chrono::duration<double> elapsed = finish - start;
+  if (solution) {
+    *solution = ExtractWalkingSolution(*trajopt, result);
+    solution->solve_time = elapsed.count();
+  }
   // trajopt->PrintSolution();
-  for (int i = 0; i < 100; i++) {
-    cout << '\a';
-  }  // making noise to notify
+  if (visualize) {
+    for (int i = 0; i < 100; i++) {
+      cout << '\a';
+    }  // making noise to notify
+  }
 
   // Testing - check if the nonlinear constraints are all satisfied
   // bool constraint_satisfied = solvers::CheckGenericConstraints(*trajopt,
@@ -942,14 +1266,20 @@ void DoMain(double duration, double stride_length, double ground_incline,
   VectorXd time_at_knots = trajopt->GetSampleTimes(result);
   MatrixXd state_at_knots = trajopt->GetStateSamples(result);
   MatrixXd input_at_knots = trajopt->GetInputSamples(result);
+  // Full states, with the dependent ankle joints of minimal coordinates
+  MatrixXd full_state_at_knots = state_at_knots;
+  for (int i = 0; i < state_at_knots.cols(); i++) {
+    full_state_at_knots.col(i) =
+        ls_dataset.completeState(state_at_knots.col(i));
+  }
   //  state_at_knots.col(N - 1) = result.GetSolution(xf);
   cout << "time_at_knots = \n" << time_at_knots << "\n";
-  cout << "state_at_knots = \n" << state_at_knots << "\n";
+  cout << "state_at_knots = \n" << full_state_at_knots << "\n";
   cout << "state_at_knots.size() = " << state_at_knots.size() << endl;
   cout << "input_at_knots = \n" << input_at_knots << "\n";
   if (to_store_data) {
     writeCSV(data_directory + string("t_i.csv"), time_at_knots);
-    writeCSV(data_directory + string("x_i.csv"), state_at_knots);
+    writeCSV(data_directory + string("x_i.csv"), full_state_at_knots);
     writeCSV(data_directory + string("u_i.csv"), input_at_knots);
   }
 
@@ -990,8 +1320,8 @@ void DoMain(double duration, double stride_length, double ground_incline,
   double total_cost = 0;
   double cost_x = 0;
   for (int i = 0; i < N - 1; i++) {
-    auto v0 = state_at_knots.col(i).tail(n_v);
-    auto v1 = state_at_knots.col(i + 1).tail(n_v);
+    auto v0 = full_state_at_knots.col(i).tail(n_v);
+    auto v1 = full_state_at_knots.col(i + 1).tail(n_v);
     auto h = time_at_knots(i + 1) - time_at_knots(i);
     cost_x += ((v0.transpose() * W_Q * v0) * h / 2)(0);
     cost_x += ((v1.transpose() * W_Q * v1) * h / 2)(0);
@@ -1038,8 +1368,8 @@ void DoMain(double duration, double stride_length, double ground_incline,
   // cost on vel difference wrt time
   double cost_vel_diff = 0;
   for (int i = 0; i < N - 1; i++) {
-    auto v0 = result.GetSolution(trajopt->state(i).tail(n_v));
-    auto v1 = result.GetSolution(trajopt->state(i + 1).tail(n_v));
+    auto v0 = full_state_at_knots.col(i).tail(n_v);
+    auto v1 = full_state_at_knots.col(i + 1).tail(n_v);
     cost_vel_diff += (v0 - v1).dot(Q_v_diff * (v0 - v1));
   }
   total_cost += cost_vel_diff;
@@ -1079,6 +1409,8 @@ void DoMain(double duration, double stride_length, double ground_incline,
 
   cout << "total_cost = " << total_cost << endl;
 
+  if (!visualize) return;
+
   // visualizer
   const PiecewisePolynomial<double> pp_xtraj =
       trajopt->ReconstructStateTrajectory(result);
@@ -1153,12 +1485,94 @@ void DoMain(double duration, double stride_length, double ground_incline,
 
   return;
 }
+
+// Solves on the meshes of --continuation_n_node and then on --n_node, each
+// warm started from the previous solution, and reports the solve time and
+// SNOPT major iterations of each mesh (and of the direct solve with
+// --compare_direct)
+void DoContinuation() {
+  vector<int> n_nodes;
+  std::stringstream list(FLAGS_continuation_n_node);
+  string item;
+  while (std::getline(list, item, ',')) {
+    if (!item.empty()) n_nodes.push_back(std::stoi(item));
+  }
+  for (int n : n_nodes) {
+    // The force trajectories of a mesh need at least two intervals
+    DRAKE_DEMAND(3 <= n && n < FLAGS_n_node);
+  }
+  n_nodes.push_back(FLAGS_n_node);
+
+  // The iterations are read from the SNOPT logs
+  const string print_file_base = FLAGS_snopt_print_file.empty()
+                                     ? "/tmp/dircon_walking_snopt.out"
+                                     : FLAGS_snopt_print_file;
+  vector<WalkingSolution> solutions(n_nodes.size());
+  vector<int> iterations;
+  for (unsigned int i = 0; i < n_nodes.size(); i++) {
+    const bool is_final = (i == n_nodes.size() - 1);
+    const string print_file =
+        print_file_base + "." + std::to_string(n_nodes[i]);
+    std::remove(print_file.c_str());
+    cout << "\nContinuation: n_node = " << n_nodes[i] << endl;
+    DoMain(FLAGS_duration, FLAGS_stride_length, FLAGS_ground_incline,
+           FLAGS_is_fix_time, n_nodes[i], FLAGS_max_iter,
+           FLAGS_data_directory, "",
+           is_final ? FLAGS_tol : FLAGS_continuation_tol,
+           is_final && FLAGS_store_data, FLAGS_scale_option, false,
+           print_file, (i > 0) ? &solutions[i - 1] : nullptr, &solutions[i]);
+    iterations.push_back(CountSnoptMajorIterations(print_file));
+  }
+
+  WalkingSolution direct;
+  int direct_iterations = -1;
+  if (FLAGS_compare_direct) {
+    const string print_file = print_file_base + ".direct";
+    std::remove(print_file.c_str());
+    cout << "\nDirect solve: n_node = " << FLAGS_n_node << endl;
+    DoMain(FLAGS_duration, FLAGS_stride_length, FLAGS_ground_incline,
+           FLAGS_is_fix_time, FLAGS_n_node, FLAGS_max_iter,
+           FLAGS_data_directory, FLAGS_init_file, FLAGS_tol, false,
+           FLAGS_scale_option, false, print_file, nullptr, &direct);
+    direct_iterations = CountSnoptMajorIterations(print_file);
+  }
+
+  double total_time = 0;
+  int total_iterations = 0;
+  cout << "\nContinuation summary:\n";
+  for (unsigned int i = 0; i < n_nodes.size(); i++) {
+    cout << "  n_node = " << n_nodes[i] << ": "
+         << to_string(solutions[i].solution_result) << ", "
+         << solutions[i].solve_time << " s, " << iterations[i]
+         << " major iterations\n";
+    total_time += solutions[i].solve_time;
+    total_iterations += std::max(iterations[i], 0);
+  }
+  cout << "  total: " << total_time << " s, " << total_iterations
+       << " major iterations\n";
+  if (FLAGS_compare_direct) {
+    cout << "  direct: " << to_string(direct.solution_result) << ", "
+         << direct.solve_time << " s, " << direct_iterations
+         << " major iterations\n";
+    cout << "  speedup: " << direct.solve_time / total_time << endl;
+  }
+}
 }  // namespace dairlib
 
 int main(int argc, char* argv[]) {
   gflags::ParseCommandLineFlags(&argc, &argv, true);
+  // If the node density is too low, it's harder for SNOPT to converge well.
+  // (The coarse meshes of the continuation only need to give a warm start.)
+  double max_distance_per_node = 0.2 / 16;
+  DRAKE_DEMAND((FLAGS_stride_length / FLAGS_n_node) <= max_distance_per_node);
+
+  if (!FLAGS_continuation_n_node.empty()) {
+    dairlib::DoContinuation();
+    return 0;
+  }
   dairlib::DoMain(FLAGS_duration, FLAGS_stride_length, FLAGS_ground_incline,
                   FLAGS_is_fix_time, FLAGS_n_node, FLAGS_max_iter,
                   FLAGS_data_directory, FLAGS_init_file, FLAGS_tol,
-                  FLAGS_store_data, FLAGS_scale_option);
+                  FLAGS_store_data, FLAGS_scale_option, FLAGS_visualize,
+                  FLAGS_snopt_print_file);
 }
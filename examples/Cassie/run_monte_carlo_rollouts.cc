@@ -0,0 +1,116 @@
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <thread>
+
+#include <gflags/gflags.h>
+
+#include "examples/Cassie/cassie_rollouts.h"
+
+namespace dairlib {
+
+// Rollout parameters.
+DEFINE_int32(num_trials, 100, "Number of rollouts");
+DEFINE_int32(num_threads, 0,
+             "Number of threads running rollouts (0 uses all the hardware "
+             "threads)");
+DEFINE_int32(seed, 0, "Seed of the randomized conditions");
+DEFINE_double(duration, 3, "Duration of each rollout");
+DEFINE_double(init_height, 1.0,
+              "Initial starting height of the pelvis above ground");
+DEFINE_double(fall_height, 0.5,
+              "Pelvis height under which the robot is considered fallen");
+DEFINE_string(output_file, "",
+              "CSV file the results of all rollouts are written to");
+DEFINE_string(snapshot, "",
+              "Fork the rollouts from this snapshot (saved by "
+              "run_closed_loop_sim --save_snapshot) instead of starting them "
+              "from a standing configuration. The loop parameters must match "
+              "the ones of the saved simulation.");
+
+// Perturbation ranges.
+DEFINE_double(max_push_force, 0, "Maximum horizontal push on the pelvis (N)");
+DEFINE_double(push_duration, 0.1, "Duration of the push");
+DEFINE_double(min_push_time, 0.5, "Earliest start of the push");
+DEFINE_double(max_push_time, 1.5, "Latest start of the push");
+DEFINE_double(max_drop_height, 0,
+              "Maximum initial clearance between the feet and the ground");
+DEFINE_double(min_mu, 0.8, "Minimum friction coefficient of the ground");
+DEFINE_double(max_mu, 0.8, "Maximum friction coefficient of the ground");
+DEFINE_double(max_mass_deviation, 0,
+              "Maximum relative change of the pelvis mass");
+DEFINE_double(sensor_noise, 0,
+              "Standard deviation of the joint encoder noise");
+
+// Loop parameters.
+DEFINE_double(control_latency, 0,
+              "Delay between sampling the controller input and applying its "
+              "output");
+DEFINE_bool(state_estimator, true,
+            "Close the loop through the state estimator. Otherwise the "
+            "controller uses the ground truth state");
+DEFINE_bool(footstep_mpc, false,
+            "Plan foot placement with the multi-step LIPM MPC instead of the "
+            "single-step capture point heuristic");
+DEFINE_bool(reduced_fidelity, false,
+            "Simulate the model with fixed leg springs, at a larger time "
+            "step");
+
+int do_main(int argc, char* argv[]) {
+  gflags::ParseCommandLineFlags(&argc, &argv, true);
+  if (!FLAGS_snapshot.empty() && FLAGS_sensor_noise > 0) {
+    std::cerr << "--snapshot does not support --sensor_noise: the state of "
+                 "the noise generators is not saved in snapshots"
+              << std::endl;
+    return 1;
+  }
+
+  CassieClosedLoopSimOptions sim_options;
+  sim_options.fidelity = FLAGS_reduced_fidelity ? CassieSimFidelity::kReduced
+                                                 : CassieSimFidelity::kFull;
+  sim_options.control_latency = FLAGS_control_latency;
+  sim_options.use_state_estimator = FLAGS_state_estimator;
+  sim_options.controller.footstep_mpc = FLAGS_footstep_mpc;
+
+  RolloutPerturbationRanges ranges;
+  ranges.max_push_force = FLAGS_max_push_force;
+  ranges.push_duration = FLAGS_push_duration;
+  ranges.min_push_time = FLAGS_min_push_time;
+  ranges.max_push_time = FLAGS_max_push_time;
+  ranges.max_drop_height = FLAGS_max_drop_height;
+  ranges.min_mu = FLAGS_min_mu;
+  ranges.max_mu = FLAGS_max_mu;
+  ranges.max_mass_deviation = FLAGS_max_mass_deviation;
+  ranges.sensor_noise = FLAGS_sensor_noise;
+
+  CassieRolloutRunner runner(sim_options, ranges, FLAGS_duration,
+                             FLAGS_init_height);
+  runner.set_fall_height(FLAGS_fall_height);
+
+  int num_threads = FLAGS_num_threads;
+  if (num_threads <= 0) {
+    num_threads = std::max(1u, std::thread::hardware_concurrency());
+  }
+  std::cout << "Running " << FLAGS_num_trials << " rollouts on "
+            << num_threads << " threads" << std::endl;
+
+  auto start = std::chrono::steady_clock::now();
+  auto results = runner.RunBranches(FLAGS_snapshot, FLAGS_num_trials,
+                                    num_threads, FLAGS_seed);
+  std::chrono::duration<double> elapsed =
+      std::chrono::steady_clock::now() - start;
+
+  PrintRolloutSummary(results);
+  std::cout << "Wall time: " << elapsed.count() << " s ("
+            << FLAGS_num_trials / elapsed.count() << " rollouts/s)"
+            << std::endl;
+  if (!FLAGS_output_file.empty()) {
+    WriteRolloutResults(results, FLAGS_output_file);
+  }
+
+  return 0;
+}
+
+}  // namespace dairlib
+
+int main(int argc, char* argv[]) { return dairlib::do_main(argc, argv); }
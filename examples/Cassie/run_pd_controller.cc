@@ -10,6 +10,7 @@
 #include "dairlib/lcmt_robot_input.hpp"
 #include "dairlib/lcmt_robot_output.hpp"
 #include "examples/Cassie/cassie_utils.h"
+#include "systems/controllers/fixed_size_controllers.h"
 #include "systems/controllers/linear_controller.h"
 #include "systems/controllers/pd_config_lcm.h"
 #include "systems/robot_lcm_systems.h"
@@ -33,6 +34,44 @@ DEFINE_string(channel_u, "CASSIE_INPUT",
 // Cassie model parameter
 DEFINE_bool(floating_base, true, "Fixed or floating base model");
 
+DEFINE_string(controller, "dynamic",
+              "Controller implementation. "
+              "dynamic: LinearController with a dense, dynamic-size K. "
+              "fixed: FixedSizeLinearController with a dense, fixed-size K. "
+              "joint_pd: FixedSizeJointPDController with per-joint gains.");
+
+/// Adds a compile-time-sized controller and connects it between the state
+/// receiver, the PD config receiver, and the command sender
+template <int kNumPositions, int kNumVelocities>
+void AddFixedSizeController(DiagramBuilder<double>* builder,
+                            const systems::RobotOutputReceiver& state_receiver,
+                            const systems::PDConfigReceiver& config_receiver,
+                            const systems::RobotCommandSender& command_sender,
+                            bool joint_pd) {
+  constexpr int kNumInputs = kCassieNumActuators;
+  if (joint_pd) {
+    auto controller = builder->AddSystem<systems::FixedSizeJointPDController<
+        kNumPositions, kNumVelocities, kNumInputs>>(
+        config_receiver.actuator_to_position_index(),
+        config_receiver.actuator_to_velocity_index());
+    builder->Connect(state_receiver.get_output_port(0),
+                     controller->get_input_port_output());
+    builder->Connect(config_receiver.get_output_port_joint_gains(),
+                     controller->get_input_port_gains());
+    builder->Connect(controller->get_output_port(0),
+                     command_sender.get_input_port(0));
+  } else {
+    auto controller = builder->AddSystem<systems::FixedSizeLinearController<
+        kNumPositions, kNumVelocities, kNumInputs>>();
+    builder->Connect(state_receiver.get_output_port(0),
+                     controller->get_input_port_output());
+    builder->Connect(config_receiver.get_output_port_config(),
+                     controller->get_input_port_config());
+    builder->Connect(controller->get_output_port(0),
+                     command_sender.get_input_port(0));
+  }
+}
+
 int doMain(int argc, char* argv[]) {
   gflags::ParseCommandLineFlags(&argc, &argv, true);
 
@@ -68,6 +107,7 @@ int doMain(int argc, char* argv[]) {
       builder.AddSystem<systems::PDConfigReceiver>(plant);
   builder.Connect(config_sub->get_output_port(),
                   config_receiver->get_input_port(0));
+  DRAKE_DEMAND(plant.num_actuators() == kCassieNumActuators);
 
   // Create command sender.
   auto command_pub =
@@ -79,20 +119,35 @@ int doMain(int argc, char* argv[]) {
   builder.Connect(command_sender->get_output_port(0),
                   command_pub->get_input_port());
 
-  auto controller = builder.AddSystem<systems::LinearController>(
-      plant.num_positions(), plant.num_velocities(),
-      plant.num_actuators());
-
-  builder.Connect(state_receiver->get_output_port(0),
-                  controller->get_input_port_output());
-
-  builder.Connect(config_receiver->get_output_port(0),
-                  controller->get_input_port_config());
-
-  std::cout << controller->get_output_port(0).size() << std::endl;
-  std::cout << command_sender->get_input_port(0).size() << std::endl;
-  builder.Connect(controller->get_output_port(0),
-                  command_sender->get_input_port(0));
+  if (FLAGS_controller == "dynamic") {
+    auto controller = builder.AddSystem<systems::LinearController>(
+        plant.num_positions(), plant.num_velocities(),
+        plant.num_actuators());
+
+    builder.Connect(state_receiver->get_output_port(0),
+                    controller->get_input_port_output());
+
+    builder.Connect(config_receiver->get_output_port_config(),
+                    controller->get_input_port_config());
+
+    builder.Connect(controller->get_output_port(0),
+                    command_sender->get_input_port(0));
+  } else {
+    DRAKE_DEMAND(FLAGS_controller == "fixed" ||
+                 FLAGS_controller == "joint_pd");
+    const bool joint_pd = FLAGS_controller == "joint_pd";
+    if (FLAGS_floating_base) {
+      AddFixedSizeController<kCassieFloatingBaseNumPositions,
+                             kCassieFloatingBaseNumVelocities>(
+          &builder, *state_receiver, *config_receiver, *command_sender,
+          joint_pd);
+    } else {
+      AddFixedSizeController<kCassieFixedBaseNumPositions,
+                             kCassieFixedBaseNumVelocities>(
+          &builder, *state_receiver, *config_receiver, *command_sender,
+          joint_pd);
+    }
+  }
 
   auto diagram = builder.Build();
   auto context = diagram->CreateDefaultContext();
@@ -5,7 +5,8 @@ using Eigen::VectorXd;
 
 SimulatorDrift::SimulatorDrift(
     const drake::multibody::MultibodyPlant<double>& plant,
-    const Eigen::VectorXd& drift_mean, const Eigen::MatrixXd& drift_cov)
+    const Eigen::VectorXd& drift_mean, const Eigen::MatrixXd& drift_cov,
+    double update_period)
     : plant_(plant), drift_mean_(drift_mean), drift_cov_(drift_cov) {
   DRAKE_ASSERT(drift_mean_.size() == drift_cov_.cols());
   DRAKE_ASSERT(drift_mean_.size() == plant.num_positions());
@@ -15,7 +16,12 @@ SimulatorDrift::SimulatorDrift(
                                                         plant_.num_actuators()))
           .get_index();
 
-  DeclarePerStepDiscreteUpdateEvent(&SimulatorDrift::DiscreteVariableUpdate);
+  if (update_period > 0) {
+    DeclarePeriodicDiscreteUpdateEvent(update_period, 0,
+                                       &SimulatorDrift::DiscreteVariableUpdate);
+  } else {
+    DeclarePerStepDiscreteUpdateEvent(&SimulatorDrift::DiscreteVariableUpdate);
+  }
   accumulated_drift_index_ =
       this->DeclareDiscreteState(VectorXd::Zero(plant_.num_positions()));
 
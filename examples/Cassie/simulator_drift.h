@@ -13,11 +13,14 @@
 /// random walk governed by the drift rate mean/covariance in m/s
 /// mean/covariance must be of the same size as the number of n_positions/
 /// n_positions x n_positions.
+/// The drift is accumulated every update_period seconds, or every simulator
+/// step if update_period is zero.
 class SimulatorDrift : public drake::systems::LeafSystem<double> {
  public:
   SimulatorDrift(const drake::multibody::MultibodyPlant<double>& plant,
                  const Eigen::VectorXd& drift_mean,
-                 const Eigen::MatrixXd& drift_cov);
+                 const Eigen::MatrixXd& drift_cov,
+                 double update_period = 0);
 
   const drake::systems::InputPort<double>& get_input_port_state() const {
     return this->get_input_port(state_port_);
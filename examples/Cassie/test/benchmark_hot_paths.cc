@@ -0,0 +1,420 @@
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include "common/allocation_counter.h"
+#include "dairlib/lcmt_robot_output.hpp"
+#include "examples/Cassie/cassie_fixed_point_solver.h"
+#include "examples/Cassie/cassie_rbt_state_estimator.h"
+#include "examples/Cassie/cassie_utils.h"
+#include "examples/Cassie/osc/osc_walking_controller_diagram.h"
+#include "multibody/kinematic/kinematic_evaluator_set.h"
+#include "multibody/kinematic/world_point_evaluator.h"
+#include "multibody/multibody_utils.h"
+#include "systems/controllers/osc/osc_tracking_data.h"
+#include "systems/framework/output_vector.h"
+#include "systems/robot_lcm_systems.h"
+#include "systems/trajectory_optimization/dircon_distance_data.h"
+#include "systems/trajectory_optimization/dircon_kinematic_data_set.h"
+#include "systems/trajectory_optimization/dircon_opt_constraints.h"
+#include "systems/trajectory_optimization/dircon_position_data.h"
+
+#include "drake/common/trajectories/piecewise_polynomial.h"
+#include "drake/math/autodiff_gradient.h"
+#include "drake/multibody/rigid_body_tree_construction.h"
+
+// Microbenchmarks of the per-tick paths of the Cassie controllers and state
+// estimator, and of the DIRCON constraint evaluation.
+//
+// Every benchmark reports the time per iteration (ns), and the number of heap
+// allocations per iteration ("allocs", see AllocationCounter). Each benchmark
+// is repeated, and the mean, median, standard deviation, min and max of the
+// repetitions are reported. Run with e.g.
+//   bazel run -c opt examples/Cassie:benchmark_hot_paths -- \
+//     --benchmark_filter=Osc --benchmark_format=json
+//
+// The inputs are changed on every iteration, so that the cached results of
+// the previous iteration (Drake output port caches, the DIRCON kinematic data
+// cache) are never reused.
+
+namespace dairlib {
+namespace {
+
+using drake::AutoDiffVecXd;
+using drake::multibody::MultibodyPlant;
+using drake::systems::Context;
+using drake::trajectories::PiecewisePolynomial;
+using Eigen::Matrix3d;
+using Eigen::MatrixXd;
+using Eigen::Vector3d;
+using Eigen::VectorXd;
+using systems::OutputVector;
+
+constexpr int kRepetitions = 5;
+
+// Reports the allocations per iteration of the enclosing benchmark loop
+class AllocationReporter {
+ public:
+  explicit AllocationReporter(benchmark::State* state) : state_(state) {}
+  ~AllocationReporter() {
+    state_->counters["allocs"] = benchmark::Counter(
+        counter_.count(), benchmark::Counter::kAvgIterations);
+  }
+
+ private:
+  benchmark::State* state_;
+  AllocationCounter counter_;
+};
+
+// Options shared by all the benchmarks
+void Configure(benchmark::internal::Benchmark* b) {
+  b->Unit(benchmark::kNanosecond)->Repetitions(kRepetitions);
+  b->ComputeStatistics("min", [](const std::vector<double>& v) {
+    return *std::min_element(v.begin(), v.end());
+  });
+  b->ComputeStatistics("max", [](const std::vector<double>& v) {
+    return *std::max_element(v.begin(), v.end());
+  });
+}
+
+// Standing configuration of Cassie (model with springs)
+VectorXd StandingPositions(const MultibodyPlant<double>& plant) {
+  VectorXd q, u, lambda;
+  CassieFixedPointSolver(plant, 1.0, 0 /*mu*/, 70 /*min normal force*/, true,
+                         0.2 /*toe spread*/, &q, &u, &lambda);
+  return q;
+}
+
+// Cassie (model with springs), standing
+class CassieFixture : public benchmark::Fixture {
+ public:
+  void SetUp(const benchmark::State&) override {
+    if (plant_) return;
+    plant_ = std::make_unique<MultibodyPlant<double>>(0.0);
+    addCassieMultibody(plant_.get(), nullptr, true,
+                       "examples/Cassie/urdf/cassie_v2.urdf", true, false);
+    plant_->Finalize();
+    q_ = StandingPositions(*plant_);
+    v_ = VectorXd::Zero(plant_->num_velocities());
+    context_ = plant_->CreateDefaultContext();
+    plant_->SetPositions(context_.get(), q_);
+  }
+
+ protected:
+  // Perturbs the velocities, so that every iteration has a new state
+  void NextState(int i) {
+    v_(plant_->num_velocities() - 1) = 1e-6 * (i % 1000);
+    plant_->SetVelocities(context_.get(), v_);
+  }
+
+  std::unique_ptr<MultibodyPlant<double>> plant_;
+  std::unique_ptr<Context<double>> context_;
+  VectorXd q_;
+  VectorXd v_;
+};
+
+// Contact and loop closure constraints of the walking controller
+BENCHMARK_DEFINE_F(CassieFixture, KinematicEvaluatorSet)(
+    benchmark::State& state) {
+  auto left_toe = LeftToe(*plant_);
+  auto left_heel = LeftHeel(*plant_);
+  auto right_toe = RightToe(*plant_);
+  auto right_heel = RightHeel(*plant_);
+  std::vector<int> yz_active({1, 2});
+  multibody::WorldPointEvaluator<double> left_toe_evaluator(
+      *plant_, left_toe.first, left_toe.second, Matrix3d::Identity(),
+      Vector3d::Zero(), yz_active);
+  multibody::WorldPointEvaluator<double> left_heel_evaluator(
+      *plant_, left_heel.first, left_heel.second, Matrix3d::Identity(),
+      Vector3d::Zero(), yz_active);
+  multibody::WorldPointEvaluator<double> right_toe_evaluator(
+      *plant_, right_toe.first, right_toe.second, Matrix3d::Identity(),
+      Vector3d::Zero(), yz_active);
+  multibody::WorldPointEvaluator<double> right_heel_evaluator(
+      *plant_, right_heel.first, right_heel.second, Matrix3d::Identity(),
+      Vector3d::Zero(), yz_active);
+  auto left_loop = LeftLoopClosureEvaluator(*plant_);
+  auto right_loop = RightLoopClosureEvaluator(*plant_);
+  multibody::KinematicEvaluatorSet<double> evaluators(*plant_);
+  evaluators.add_evaluator(&left_loop);
+  evaluators.add_evaluator(&right_loop);
+  evaluators.add_evaluator(&left_toe_evaluator);
+  evaluators.add_evaluator(&left_heel_evaluator);
+  evaluators.add_evaluator(&right_toe_evaluator);
+  evaluators.add_evaluator(&right_heel_evaluator);
+
+  AllocationReporter allocations(&state);
+  int i = 0;
+  for (auto _ : state) {
+    NextState(i++);
+    benchmark::DoNotOptimize(evaluators.EvalActive(*context_));
+    benchmark::DoNotOptimize(evaluators.EvalActiveJacobian(*context_));
+    benchmark::DoNotOptimize(
+        evaluators.EvalActiveJacobianDotTimesV(*context_));
+  }
+}
+BENCHMARK_REGISTER_F(CassieFixture, KinematicEvaluatorSet)->Apply(Configure);
+
+// Update() of the pelvis tracking data of the walking controller
+BENCHMARK_DEFINE_F(CassieFixture, OscTrackingDataUpdate)(
+    benchmark::State& state) {
+  MultibodyPlant<double> plant_wo_springs(0.0);
+  addCassieMultibody(&plant_wo_springs, nullptr, true,
+                     "examples/Cassie/urdf/cassie_fixed_springs.urdf", false,
+                     false);
+  plant_wo_springs.Finalize();
+  auto context_wo_springs = plant_wo_springs.CreateDefaultContext();
+  MatrixXd map = multibody::CreateStateMap(*plant_, plant_wo_springs);
+
+  systems::controllers::TransTaskSpaceTrackingData tracking_data(
+      "pelvis_traj", 3, 100 * MatrixXd::Identity(3, 3),
+      10 * MatrixXd::Identity(3, 3), MatrixXd::Identity(3, 3), plant_.get(),
+      &plant_wo_springs);
+  tracking_data.AddPointToTrack("pelvis");
+  tracking_data.CheckOscTrackingData();
+  auto traj = PiecewisePolynomial<double>::FirstOrderHold(
+      std::vector<double>({0, 1}),
+      std::vector<MatrixXd>({Vector3d(0, 0, 1), Vector3d(0.1, 0, 1)}));
+
+  VectorXd x(plant_->num_positions() + plant_->num_velocities());
+  AllocationReporter allocations(&state);
+  int i = 0;
+  for (auto _ : state) {
+    NextState(i);
+    x << q_, v_;
+    VectorXd x_wo_springs = map * x;
+    plant_wo_springs.SetPositionsAndVelocities(context_wo_springs.get(),
+                                               x_wo_springs);
+    benchmark::DoNotOptimize(tracking_data.Update(
+        x, *context_, x_wo_springs, *context_wo_springs, traj,
+        1e-3 * (i % 1000), 0));
+    i++;
+  }
+}
+BENCHMARK_REGISTER_F(CassieFixture, OscTrackingDataUpdate)->Apply(Configure);
+
+// DirconDynamicConstraint of the left support mode of run_dircon_walking
+// (fixed spring model, toe contacts and loop closures), evaluated as SNOPT
+// does: values, and values with gradients. The gradients are requested with
+// AutoDiffXd inputs, for which NonlinearConstraint<double> uses forward
+// differences of the double evaluation.
+class DirconFixture : public benchmark::Fixture {
+ public:
+  void SetUp(const benchmark::State&) override {
+    if (plant_) return;
+    plant_ = std::make_unique<MultibodyPlant<double>>(0.0);
+    addCassieMultibody(plant_.get(), nullptr, true,
+                       "examples/Cassie/urdf/cassie_fixed_springs.urdf", false,
+                       false);
+    plant_->Finalize();
+
+    const auto& toe_left = plant_->GetBodyByName("toe_left");
+    Vector3d pt_front_contact(-0.0457, 0.112, 0);
+    Vector3d pt_rear_contact(0.088, 0, 0);
+    toe_front_ = std::make_unique<DirconPositionData<double>>(
+        *plant_, toe_left, pt_front_contact);
+    toe_rear_ = std::make_unique<DirconPositionData<double>>(
+        *plant_, toe_left, pt_rear_contact);
+    toe_front_->addFixedNormalFrictionConstraints(1);
+    toe_rear_->addFixedNormalFrictionConstraints(1);
+    double rod_length = 0.5012;
+    Vector3d pt_on_heel_spring(.11877, -.01, 0.0);
+    loop_left_ = std::make_unique<DirconDistanceData<double>>(
+        *plant_, plant_->GetBodyByName("thigh_left"), Vector3d(0, 0, 0.045),
+        plant_->GetBodyByName("heel_spring_left"), pt_on_heel_spring,
+        rod_length);
+    loop_right_ = std::make_unique<DirconDistanceData<double>>(
+        *plant_, plant_->GetBodyByName("thigh_right"),
+        Vector3d(0, 0, -0.045), plant_->GetBodyByName("heel_spring_right"),
+        pt_on_heel_spring, rod_length);
+    constraints_ = {toe_front_.get(), toe_rear_.get(), loop_left_.get(),
+                    loop_right_.get()};
+    dataset_ = std::make_unique<DirconKinematicDataSet<double>>(
+        *plant_, &constraints_, std::vector<int>({3}));
+    constraint_ = std::make_unique<DirconDynamicConstraint<double>>(
+        *plant_, *dataset_, true);
+
+    // Two standing knots, 10 ms apart
+    VectorXd q = StandingPositions(*plant_);
+    const int n_x = plant_->num_positions() + plant_->num_velocities();
+    VectorXd x_knot = VectorXd::Zero(n_x);
+    x_knot.head(plant_->num_positions()) = q;
+    vars_ = VectorXd::Zero(constraint_->num_vars());
+    vars_(0) = 0.01;
+    vars_.segment(1, n_x) = x_knot;
+    vars_.segment(1 + n_x, n_x) = x_knot;
+  }
+
+ protected:
+  // Perturbs the first knot velocities, so that every iteration misses the
+  // DIRCON kinematic data cache
+  void NextVars(int i) {
+    vars_(plant_->num_positions() + 1) = 1e-6 * i;
+  }
+
+  std::unique_ptr<MultibodyPlant<double>> plant_;
+  std::unique_ptr<DirconPositionData<double>> toe_front_;
+  std::unique_ptr<DirconPositionData<double>> toe_rear_;
+  std::unique_ptr<DirconDistanceData<double>> loop_left_;
+  std::unique_ptr<DirconDistanceData<double>> loop_right_;
+  std::vector<DirconKinematicData<double>*> constraints_;
+  std::unique_ptr<DirconKinematicDataSet<double>> dataset_;
+  std::unique_ptr<DirconDynamicConstraint<double>> constraint_;
+  VectorXd vars_;
+};
+
+BENCHMARK_DEFINE_F(DirconFixture, DynamicConstraintValue)(
+    benchmark::State& state) {
+  VectorXd y;
+  AllocationReporter allocations(&state);
+  int i = 0;
+  for (auto _ : state) {
+    NextVars(i++);
+    constraint_->Eval(vars_, &y);
+    benchmark::DoNotOptimize(y);
+  }
+}
+BENCHMARK_REGISTER_F(DirconFixture, DynamicConstraintValue)->Apply(Configure);
+
+BENCHMARK_DEFINE_F(DirconFixture, DynamicConstraintGradient)(
+    benchmark::State& state) {
+  AutoDiffVecXd y;
+  AllocationReporter allocations(&state);
+  int i = 0;
+  for (auto _ : state) {
+    NextVars(i++);
+    AutoDiffVecXd vars = drake::math::initializeAutoDiff(vars_);
+    constraint_->Eval(vars, &y);
+    benchmark::DoNotOptimize(y);
+  }
+}
+BENCHMARK_REGISTER_F(DirconFixture, DynamicConstraintGradient)
+    ->Apply(Configure);
+
+// One control tick of the walking controller, standing: the discrete updates
+// of the finite state machine, trajectory generators and OSC, as an
+// LcmDrivenLoop runs them on each state message, then the command
+// (OperationalSpaceControl::SolveQp)
+void BM_OscWalkingController(benchmark::State& state) {
+  cassie::osc::OSCWalkingControllerDiagram controller;
+  const auto& plant = controller.get_plant_w_springs();
+  VectorXd q = StandingPositions(plant);
+  OutputVector<double> robot_output(q,
+                                    VectorXd::Zero(plant.num_velocities()),
+                                    VectorXd::Zero(plant.num_actuators()));
+  auto context = controller.CreateDefaultContext();
+  auto& input = context->FixInputPort(
+      controller.get_input_port_state().get_index(), robot_output);
+  auto output = controller.get_output_port_control().Allocate();
+  auto events = controller.AllocateCompositeEventCollection();
+  auto discrete_state = controller.AllocateDiscreteVariables();
+
+  AllocationReporter allocations(&state);
+  int i = 0;
+  for (auto _ : state) {
+    // The controller is clocked by the state timestamp
+    const double t = 2e-3 * i++;
+    static_cast<OutputVector<double>*>(input.GetMutableVectorData<double>())
+        ->set_timestamp(t);
+    context->SetTime(t);
+    controller.GetPerStepEvents(*context, events.get());
+    controller.CalcDiscreteVariableUpdates(
+        *context, events->get_discrete_update_events(), discrete_state.get());
+    context->get_mutable_discrete_state().SetFrom(*discrete_state);
+    controller.get_output_port_control().Calc(*context, output.get());
+    benchmark::DoNotOptimize(output);
+  }
+}
+BENCHMARK(BM_OscWalkingController)->Apply(Configure);
+
+// One step of the floating base state estimator (contact estimation and EKF),
+// standing still with the pelvis level
+void BM_CassieRbtStateEstimator(benchmark::State& state) {
+  RigidBodyTree<double> tree;
+  buildCassieTree(tree, "examples/Cassie/urdf/cassie_v2.urdf",
+                  drake::multibody::joints::kQuaternion);
+  drake::multibody::AddFlatTerrainToWorld(&tree, 100, 0.2);
+  systems::CassieRbtStateEstimator estimator(tree, true);
+
+  cassie_out_t cassie_out{};
+  for (auto* leg : {&cassie_out.leftLeg, &cassie_out.rightLeg}) {
+    leg->hipPitchDrive.position = 0.366;
+    leg->kneeDrive.position = -0.6305;
+    leg->tarsusJoint.position = 0.8389;
+    leg->footDrive.position = -1.4;
+  }
+  cassie_out.leftLeg.hipRollDrive.position = -0.084;
+  cassie_out.rightLeg.hipRollDrive.position = 0.084;
+  cassie_out.pelvis.vectorNav.orientation[0] = 1;
+  cassie_out.pelvis.vectorNav.linearAcceleration[2] = 9.81;
+
+  auto context = estimator.CreateDefaultContext();
+  context->FixInputPort(0, drake::AbstractValue::Make(cassie_out));
+  estimator.setInitialImuPosition(context.get(), Vector3d(0, 0, 1));
+  auto events = estimator.AllocateCompositeEventCollection();
+  auto next_state = context->CloneState();
+
+  AllocationReporter allocations(&state);
+  double t = 0;
+  for (auto _ : state) {
+    t += 5e-4;
+    context->SetTime(t);
+    estimator.GetPerStepEvents(*context, events.get());
+    estimator.CalcUnrestrictedUpdate(
+        *context, events->get_unrestricted_update_events(), next_state.get());
+    context->get_mutable_state().SetFrom(*next_state);
+  }
+}
+BENCHMARK(BM_CassieRbtStateEstimator)->Apply(Configure);
+
+// Conversions between the state and lcmt_robot_output, as done by the
+// simulators (RobotOutputSender) and the controllers (RobotOutputReceiver)
+class RobotLcmFixture : public CassieFixture {};
+
+BENCHMARK_DEFINE_F(RobotLcmFixture, RobotOutputSender)(
+    benchmark::State& state) {
+  systems::RobotOutputSender sender(*plant_);
+  auto context = sender.CreateDefaultContext();
+  VectorXd x(plant_->num_positions() + plant_->num_velocities());
+  x << q_, v_;
+  context->FixInputPort(sender.get_input_port_state().get_index(), x);
+  auto output = sender.get_output_port(0).Allocate();
+
+  AllocationReporter allocations(&state);
+  for (auto _ : state) {
+    sender.get_output_port(0).Calc(*context, output.get());
+    benchmark::DoNotOptimize(output);
+  }
+}
+BENCHMARK_REGISTER_F(RobotLcmFixture, RobotOutputSender)->Apply(Configure);
+
+BENCHMARK_DEFINE_F(RobotLcmFixture, RobotOutputReceiver)(
+    benchmark::State& state) {
+  systems::RobotOutputSender sender(*plant_);
+  auto sender_context = sender.CreateDefaultContext();
+  VectorXd x(plant_->num_positions() + plant_->num_velocities());
+  x << q_, v_;
+  sender_context->FixInputPort(sender.get_input_port_state().get_index(), x);
+  const auto& message =
+      sender.get_output_port(0).Eval<lcmt_robot_output>(*sender_context);
+
+  systems::RobotOutputReceiver receiver(*plant_);
+  auto context = receiver.CreateDefaultContext();
+  context->FixInputPort(0, drake::AbstractValue::Make(message));
+  auto output = receiver.get_output_port(0).Allocate();
+
+  AllocationReporter allocations(&state);
+  for (auto _ : state) {
+    receiver.get_output_port(0).Calc(*context, output.get());
+    benchmark::DoNotOptimize(output);
+  }
+}
+BENCHMARK_REGISTER_F(RobotLcmFixture, RobotOutputReceiver)->Apply(Configure);
+
+}  // namespace
+}  // namespace dairlib
+
+BENCHMARK_MAIN();
@@ -0,0 +1,150 @@
+#include <chrono>
+#include <iostream>
+#include <memory>
+#include <string>
+
+#include <gflags/gflags.h>
+
+#include "dairlib/lcmt_pd_config.hpp"
+#include "examples/Cassie/cassie_utils.h"
+#include "systems/controllers/fixed_size_controllers.h"
+#include "systems/controllers/linear_controller.h"
+#include "systems/controllers/pd_config_lcm.h"
+
+// Compares the cost of the controllers selectable in run_pd_controller:
+// the dynamic-size LinearController, FixedSizeLinearController, and
+// FixedSizeJointPDController. Also times PDConfigReceiver's conversion of a
+// new lcmt_pd_config message into each of its outputs.
+
+DEFINE_int32(num_reps, 100000, "Number of evaluations per implementation");
+DEFINE_bool(floating_base, true, "Fixed or floating base model");
+
+namespace dairlib {
+namespace {
+
+using drake::AbstractValue;
+using drake::multibody::MultibodyPlant;
+using drake::systems::BasicVector;
+using drake::systems::LeafSystem;
+using Eigen::VectorXd;
+
+typedef std::chrono::steady_clock my_clock;
+
+void PrintTiming(const std::string& name, my_clock::duration duration) {
+  double ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+      duration).count();
+  std::cout << name << ": " << FLAGS_num_reps << "x took " << ns / 1e6
+            << " milliseconds. " << ns / FLAGS_num_reps << " nanoseconds per."
+            << std::endl;
+}
+
+// Times CalcOutput of a controller with fixed state and configuration inputs
+void BenchmarkController(const std::string& name,
+                         const LeafSystem<double>& controller,
+                         const systems::OutputVector<double>& state,
+                         const BasicVector<double>& config) {
+  auto context = controller.CreateDefaultContext();
+  context->FixInputPort(0, state);
+  context->FixInputPort(1, config);
+  auto output = controller.AllocateOutput();
+  double checksum = 0;
+
+  auto start = my_clock::now();
+  for (int i = 0; i < FLAGS_num_reps; i++) {
+    controller.CalcOutput(*context, output.get());
+    checksum += output->get_vector_data(0)->GetAtIndex(0);
+  }
+  PrintTiming(name, my_clock::now() - start);
+  std::cout << "  (u_0 checksum " << checksum / FLAGS_num_reps << ")"
+            << std::endl;
+}
+
+template <int kNumPositions, int kNumVelocities>
+int DoBenchmark(const MultibodyPlant<double>& plant) {
+  constexpr int kNumInputs = kCassieNumActuators;
+  DRAKE_DEMAND(plant.num_positions() == kNumPositions);
+  DRAKE_DEMAND(plant.num_velocities() == kNumVelocities);
+  DRAKE_DEMAND(plant.num_actuators() == kNumInputs);
+
+  systems::PDConfigReceiver receiver(plant);
+
+  // PD on every motor
+  dairlib::lcmt_pd_config msg;
+  msg.num_joints = kNumInputs;
+  for (int i = 0; i < kNumInputs; i++) {
+    msg.joint_names.push_back(plant.get_joint_actuator(
+        drake::multibody::JointActuatorIndex(i)).name());
+    msg.kp.push_back(20 + i);
+    msg.kd.push_back(2 + 0.1 * i);
+    msg.desired_position.push_back(0.1 * i);
+    msg.desired_velocity.push_back(0);
+  }
+
+  // Config conversion, with a new message every time
+  auto receiver_context = receiver.CreateDefaultContext();
+  auto config = receiver.get_output_port_config().Allocate();
+  auto gains = receiver.get_output_port_joint_gains().Allocate();
+  auto start = my_clock::now();
+  for (int i = 0; i < FLAGS_num_reps; i++) {
+    msg.kp[0] = i;
+    receiver_context->FixInputPort(
+        0, AbstractValue::Make<dairlib::lcmt_pd_config>(msg));
+    receiver.get_output_port_config().Calc(*receiver_context, config.get());
+  }
+  PrintTiming("(PDConfigReceiver) dense LinearConfig",
+              my_clock::now() - start);
+  start = my_clock::now();
+  for (int i = 0; i < FLAGS_num_reps; i++) {
+    msg.kp[0] = i;
+    receiver_context->FixInputPort(
+        0, AbstractValue::Make<dairlib::lcmt_pd_config>(msg));
+    receiver.get_output_port_joint_gains().Calc(*receiver_context,
+                                                gains.get());
+  }
+  PrintTiming("(PDConfigReceiver) JointPDGains", my_clock::now() - start);
+
+  VectorXd q = VectorXd::Zero(kNumPositions);
+  if (kNumPositions != kNumVelocities) q(0) = 1;  // unit quaternion
+  VectorXd v = VectorXd::LinSpaced(kNumVelocities, -1, 1);
+  systems::OutputVector<double> state(q, v, VectorXd::Zero(kNumInputs));
+
+  systems::LinearController dynamic_controller(kNumPositions, kNumVelocities,
+                                               kNumInputs);
+  systems::FixedSizeLinearController<kNumPositions, kNumVelocities,
+                                     kNumInputs> fixed_controller;
+  systems::FixedSizeJointPDController<kNumPositions, kNumVelocities,
+                                      kNumInputs>
+      pd_controller(receiver.actuator_to_position_index(),
+                    receiver.actuator_to_velocity_index());
+
+  const auto& config_vec = config->get_value<BasicVector<double>>();
+  const auto& gains_vec = gains->get_value<BasicVector<double>>();
+  BenchmarkController("(LinearController) dynamic", dynamic_controller, state,
+                      config_vec);
+  BenchmarkController("(FixedSizeLinearController)", fixed_controller, state,
+                      config_vec);
+  BenchmarkController("(FixedSizeJointPDController)", pd_controller, state,
+                      gains_vec);
+  return 0;
+}
+
+int do_main() {
+  MultibodyPlant<double> plant(1.0);
+  addCassieMultibody(&plant, nullptr, FLAGS_floating_base);
+  plant.Finalize();
+
+  if (FLAGS_floating_base) {
+    return DoBenchmark<kCassieFloatingBaseNumPositions,
+                       kCassieFloatingBaseNumVelocities>(plant);
+  }
+  return DoBenchmark<kCassieFixedBaseNumPositions,
+                     kCassieFixedBaseNumVelocities>(plant);
+}
+
+}  // namespace
+}  // namespace dairlib
+
+int main(int argc, char* argv[]) {
+  gflags::ParseCommandLineFlags(&argc, &argv, true);
+  return dairlib::do_main();
+}
@@ -0,0 +1,70 @@
+#include <memory>
+
+#include <gtest/gtest.h>
+
+#include "examples/Cassie/cassie_lipm_initial_guess.h"
+#include "examples/Cassie/cassie_utils.h"
+
+#include "drake/multibody/plant/multibody_plant.h"
+
+namespace dairlib {
+namespace {
+
+using drake::multibody::BodyIndex;
+using drake::multibody::MultibodyPlant;
+using Eigen::Vector3d;
+
+class CassieLipmInitialGuessTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    plant_ = std::make_unique<MultibodyPlant<double>>(0.0);
+    addCassieMultibody(plant_.get(), nullptr, true,
+                       "examples/Cassie/urdf/cassie_fixed_springs.urdf",
+                       false, false);
+    plant_->Finalize();
+  }
+
+  Vector3d CenterOfMass(const Eigen::VectorXd& x) {
+    auto context = plant_->CreateDefaultContext();
+    plant_->SetPositionsAndVelocities(context.get(), x);
+    return plant_->CalcCenterOfMassPosition(*context);
+  }
+
+  std::unique_ptr<MultibodyPlant<double>> plant_;
+};
+
+TEST_F(CassieLipmInitialGuessTest, WalkingStep) {
+  LipmGaitParameters gait;
+  const int num_knots = 16;
+  const auto guess = CassieLipmWalkingGuess(*plant_, gait, num_knots);
+  ASSERT_EQ(guess.x.cols(), num_knots);
+  ASSERT_EQ(guess.u.cols(), num_knots);
+  ASSERT_EQ(guess.lambda.rows(), 8);
+  EXPECT_LT(guess.max_kinematic_residual, 1e-6);
+
+  // The center of mass moves a stride, from between the feet to between the
+  // feet, at the LIPM height
+  const Vector3d com_start = CenterOfMass(guess.x.col(0));
+  const Vector3d com_end = CenterOfMass(guess.x.col(num_knots - 1));
+  EXPECT_TRUE(com_start.isApprox(Vector3d(0, 0, gait.com_height), 1e-2));
+  EXPECT_TRUE(com_end.isApprox(
+      Vector3d(gait.stride_length, 0, gait.com_height), 1e-2));
+
+  // The LIPM keeps the center of mass at a constant height, so the stance
+  // foot carries the weight (the four-bar forces are internal)
+  double mass = 0;
+  for (BodyIndex i(0); i < plant_->num_bodies(); ++i) {
+    mass += plant_->get_body(i).get_default_mass();
+  }
+  const int mid = num_knots / 2;
+  EXPECT_NEAR(guess.lambda(2, mid) + guess.lambda(5, mid), 9.81 * mass,
+              0.05 * 9.81 * mass);
+}
+
+}  // namespace
+}  // namespace dairlib
+
+int main(int argc, char** argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,101 @@
+#include "examples/Cassie/cassie_rollouts.h"
+
+#include <cmath>
+#include <cstdlib>
+#include <string>
+
+#include <gtest/gtest.h>
+
+namespace dairlib {
+namespace {
+
+RolloutPerturbationRanges TestRanges() {
+  RolloutPerturbationRanges ranges;
+  ranges.max_push_force = 50;
+  ranges.min_push_time = 0.02;
+  ranges.max_push_time = 0.05;
+  ranges.push_duration = 0.02;
+  ranges.max_drop_height = 0.01;
+  ranges.min_mu = 0.6;
+  ranges.max_mu = 1.0;
+  ranges.max_mass_deviation = 0.1;
+  ranges.sensor_noise = 1e-3;
+  return ranges;
+}
+
+// The conditions of a trial only depend on its index and the base seed
+TEST(CassieRolloutsTest, SampleConditions) {
+  auto ranges = TestRanges();
+  auto c1 = SampleRolloutConditions(ranges, 3, 7);
+  auto c2 = SampleRolloutConditions(ranges, 3, 7);
+  auto c3 = SampleRolloutConditions(ranges, 4, 7);
+  EXPECT_EQ(c1.seed, c2.seed);
+  EXPECT_TRUE(c1.push_force == c2.push_force);
+  EXPECT_EQ(c1.mu, c2.mu);
+  EXPECT_EQ(c1.mass_scale, c2.mass_scale);
+  EXPECT_NE(c1.seed, c3.seed);
+  EXPECT_NE(c1.mu, c3.mu);
+
+  EXPECT_LE(c1.push_force.norm(), ranges.max_push_force);
+  EXPECT_GE(c1.push_time, ranges.min_push_time);
+  EXPECT_LE(c1.push_time, ranges.max_push_time);
+  EXPECT_GE(c1.drop_height, 0);
+  EXPECT_LE(c1.drop_height, ranges.max_drop_height);
+  EXPECT_GE(c1.mu, ranges.min_mu);
+  EXPECT_LE(c1.mu, ranges.max_mu);
+  EXPECT_LE(std::abs(c1.mass_scale - 1), ranges.max_mass_deviation);
+}
+
+// The results do not depend on the number of threads
+TEST(CassieRolloutsTest, ThreadCountInvariance) {
+  CassieRolloutRunner runner(CassieClosedLoopSimOptions(), TestRanges(), 0.1);
+  auto serial = runner.Run(3, 1, 11);
+  auto parallel = runner.Run(3, 3, 11);
+  ASSERT_EQ(serial.size(), 3);
+  ASSERT_EQ(parallel.size(), 3);
+  for (int i = 0; i < 3; i++) {
+    EXPECT_EQ(serial[i].conditions.trial, i);
+    EXPECT_EQ(parallel[i].conditions.trial, i);
+    EXPECT_EQ(serial[i].success, parallel[i].success);
+    EXPECT_EQ(serial[i].end_time, parallel[i].end_time);
+    EXPECT_EQ(serial[i].rms_height_error, parallel[i].rms_height_error);
+    EXPECT_EQ(serial[i].max_tilt, parallel[i].max_tilt);
+    EXPECT_TRUE(serial[i].final_position == parallel[i].final_position);
+  }
+  // The perturbations are small, the robot is still standing
+  EXPECT_TRUE(serial[0].success);
+}
+
+// Branches forked from a snapshot start at the time of the snapshot
+TEST(CassieRolloutsTest, Branches) {
+  const char* tmp_dir = std::getenv("TEST_TMPDIR");
+  const std::string filename =
+      std::string(tmp_dir ? tmp_dir : "/tmp") + "/rollout_snapshot.bin";
+  CassieClosedLoopSimOptions options;
+  CassieClosedLoopSim sim(options);
+  sim.SetInitialState(sim.CalcStandingPositions(1.0),
+                      Eigen::VectorXd::Zero(sim.get_plant().num_velocities()));
+  sim.AdvanceTo(0.05);
+  sim.SaveSnapshot(filename);
+
+  auto ranges = TestRanges();
+  ranges.sensor_noise = 0;
+  CassieRolloutRunner runner(options, ranges, 0.05);
+  auto results = runner.RunBranches(filename, 2, 2, 5);
+  ASSERT_EQ(results.size(), 2);
+  for (const auto& result : results) {
+    EXPECT_TRUE(result.success);
+    EXPECT_NEAR(result.start_time, 0.05, 1e-12);
+    EXPECT_NEAR(result.end_time, 0.1, 1e-12);
+    // The pelvis is near the origin, where it stood
+    EXPECT_LT(result.final_position.norm(), 0.2);
+  }
+}
+
+}  // namespace
+}  // namespace dairlib
+
+int main(int argc, char** argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,142 @@
+#include "examples/Cassie/cassie_udp_sim.h"
+
+#include <arpa/inet.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <thread>
+
+#include <gtest/gtest.h>
+
+#include "examples/Cassie/datatypes/cassie_out_t.h"
+#include "examples/Cassie/datatypes/cassie_user_in_t.h"
+
+namespace dairlib {
+namespace {
+
+// Stand-in for the robot stack: answers every state packet with a command
+class Responder {
+ public:
+  Responder(int state_port, int command_port) {
+    socket_ = socket(AF_INET, SOCK_DGRAM, 0);
+    struct sockaddr_in address;
+    memset(&address, 0, sizeof(address));
+    address.sin_family = AF_INET;
+    address.sin_port = htons(state_port);
+    inet_aton("127.0.0.1", &address.sin_addr);
+    EXPECT_GE(bind(socket_, (const struct sockaddr*)&address, sizeof(address)),
+              0);
+    memset(&command_address_, 0, sizeof(command_address_));
+    command_address_.sin_family = AF_INET;
+    command_address_.sin_port = htons(command_port);
+    inet_aton("127.0.0.1", &command_address_.sin_addr);
+    thread_ = std::thread([this]() { Respond(); });
+  }
+
+  ~Responder() {
+    stop_ = true;
+    thread_.join();
+    close(socket_);
+  }
+
+  int num_states() const { return num_states_; }
+  const cassie_out_t& first_state() const { return first_state_; }
+
+ private:
+  void Respond() {
+    unsigned char state[2 + CASSIE_OUT_T_LEN];
+    unsigned char command[2 + CASSIE_USER_IN_T_LEN];
+    cassie_user_in_t cassie_in{};
+    pollfd fd{socket_, POLLIN, 0};
+    while (!stop_) {
+      if (poll(&fd, 1, 10) <= 0) continue;
+      if (recv(socket_, state, sizeof(state), 0) != sizeof(state)) continue;
+      if (num_states_ == 0) unpack_cassie_out_t(&state[2], &first_state_);
+      num_states_++;
+      // As on the robot: own sequence number, then the state's looped back
+      command[0] = ++seq_num_out_;
+      command[1] = state[0];
+      pack_cassie_user_in_t(&cassie_in, &command[2]);
+      sendto(socket_, command, sizeof(command), 0,
+             (struct sockaddr*)&command_address_, sizeof(command_address_));
+    }
+  }
+
+  int socket_;
+  struct sockaddr_in command_address_;
+  std::thread thread_;
+  std::atomic<bool> stop_{false};
+  std::atomic<int> num_states_{0};
+  cassie_out_t first_state_{};
+  unsigned char seq_num_out_ = 0;
+};
+
+TEST(CassieUdpSimTest, Lockstep) {
+  CassieUdpSimOptions options;
+  options.output_port = 25201;
+  options.input_port = 25200;
+  options.lockstep = true;
+  CassieUdpSim sim(options);
+  sim.SetStandingState(1.0);
+
+  Responder responder(options.output_port, options.input_port);
+  sim.Run(0.05);
+
+  const auto& stats = sim.get_stats();
+  EXPECT_GE(stats.packets_sent, 100);
+  EXPECT_LE(stats.packets_sent, 101);
+  EXPECT_EQ(stats.commands_received, stats.packets_sent);
+  EXPECT_EQ(stats.missed_commands, 0);
+  EXPECT_EQ(stats.packets_discarded, 0);
+  EXPECT_EQ(stats.latencies.size(), stats.packets_sent);
+  EXPECT_EQ(responder.num_states(), stats.packets_sent);
+
+  // The robot is standing still at the start
+  EXPECT_NEAR(
+      responder.first_state().pelvis.vectorNav.linearAcceleration[2], 9.81,
+      1e-6);
+}
+
+// Packets paced to the wall clock: the run takes (at least) its simulated
+// duration, and the waits end at the period deadlines, not on millisecond
+// boundaries
+TEST(CassieUdpSimTest, Realtime) {
+  CassieUdpSimOptions options;
+  options.output_port = 25203;
+  options.input_port = 25202;
+  options.lockstep = false;
+  // One plant step per period, so that the simulation keeps up with the
+  // wall clock
+  options.sim_dt = options.period;
+  CassieUdpSim sim(options);
+  sim.SetStandingState(1.0);
+
+  Responder responder(options.output_port, options.input_port);
+  const auto start = std::chrono::steady_clock::now();
+  sim.Run(0.05);
+  const double wall_time =
+      std::chrono::duration<double>(std::chrono::steady_clock::now() - start)
+          .count();
+
+  const auto& stats = sim.get_stats();
+  EXPECT_GE(stats.packets_sent, 100);
+  EXPECT_LE(stats.packets_sent, 101);
+  EXPECT_GE(wall_time, 0.05);
+  EXPECT_LT(wall_time, 0.1);
+  // Rounding the waits up to whole milliseconds overruns every other period
+  EXPECT_LT(stats.overruns, stats.packets_sent / 4);
+  EXPECT_GT(stats.commands_received, 0);
+  EXPECT_EQ(stats.packets_discarded, 0);
+}
+
+}  // namespace
+}  // namespace dairlib
+
+int main(int argc, char** argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,118 @@
+#include "examples/Cassie/closed_loop_sim.h"
+
+#include <cstdlib>
+#include <string>
+
+#include <gtest/gtest.h>
+
+namespace dairlib {
+namespace {
+
+using Eigen::VectorXd;
+
+class CassieClosedLoopSimTest : public ::testing::Test {
+ protected:
+  // Runs a closed loop simulation from a standing pose and returns the
+  // final state
+  VectorXd Run(const CassieClosedLoopSimOptions& options, double end_time) {
+    CassieClosedLoopSim sim(options);
+    if (q_init_.size() == 0) {
+      q_init_ = sim.CalcStandingPositions(1.0);
+    }
+    sim.SetInitialState(q_init_,
+                        VectorXd::Zero(sim.get_plant().num_velocities()));
+    sim.AdvanceTo(end_time);
+    EXPECT_EQ(sim.get_time(), end_time);
+    return sim.GetState();
+  }
+
+  VectorXd q_init_;
+};
+
+// Two simulations from the same initial state are bitwise identical
+TEST_F(CassieClosedLoopSimTest, Deterministic) {
+  CassieClosedLoopSimOptions options;
+  VectorXd x1 = Run(options, 0.1);
+  VectorXd x2 = Run(options, 0.1);
+  EXPECT_TRUE(x1 == x2);
+  // The robot is still standing
+  EXPECT_GT(x1(6), 0.8);
+}
+
+TEST_F(CassieClosedLoopSimTest, GroundTruthStateWithLatency) {
+  CassieClosedLoopSimOptions options;
+  options.use_state_estimator = false;
+  options.control_latency = 2 * options.control_period;
+  VectorXd x1 = Run(options, 0.1);
+  VectorXd x2 = Run(options, 0.1);
+  EXPECT_TRUE(x1 == x2);
+  EXPECT_GT(x1(6), 0.8);
+}
+
+// The estimator and the controller are updated by periodic events, not on
+// every step of the plant
+TEST_F(CassieClosedLoopSimTest, NoPerStepUpdates) {
+  CassieClosedLoopSim sim{CassieClosedLoopSimOptions()};
+  const auto& diagram = sim.get_diagram();
+  auto events = diagram.AllocateCompositeEventCollection();
+  diagram.GetPerStepEvents(sim.get_mutable_simulator().get_context(),
+                           events.get());
+  EXPECT_FALSE(events->get_discrete_update_events().HasEvents());
+  EXPECT_FALSE(events->get_unrestricted_update_events().HasEvents());
+}
+
+// A simulation restored from a snapshot continues exactly as the one that
+// saved it
+TEST_F(CassieClosedLoopSimTest, Snapshot) {
+  const char* tmp_dir = std::getenv("TEST_TMPDIR");
+  const std::string filename =
+      std::string(tmp_dir ? tmp_dir : "/tmp") + "/closed_loop_snapshot.bin";
+  CassieClosedLoopSimOptions options;
+
+  CassieClosedLoopSim sim(options);
+  VectorXd q_init = sim.CalcStandingPositions(1.0);
+  sim.SetInitialState(q_init,
+                      VectorXd::Zero(sim.get_plant().num_velocities()));
+  sim.AdvanceTo(0.05);
+  sim.SaveSnapshot(filename);
+  sim.AdvanceTo(0.1);
+
+  CassieClosedLoopSim restored_sim(options);
+  restored_sim.LoadSnapshot(filename);
+  EXPECT_EQ(restored_sim.get_time(), 0.05);
+  restored_sim.AdvanceTo(0.1);
+  EXPECT_TRUE(sim.GetState() == restored_sim.GetState());
+}
+
+// The reduced fidelity model is seen by the controller with the layout of the
+// full model, and stays close to it while standing
+TEST_F(CassieClosedLoopSimTest, ReducedFidelity) {
+  CassieClosedLoopSimOptions options;
+  options.fidelity = CassieSimFidelity::kReduced;
+  CassieClosedLoopSim sim(options);
+  CassieClosedLoopSim full_sim{CassieClosedLoopSimOptions()};
+  EXPECT_LT(sim.get_plant().num_positions(),
+            full_sim.get_plant().num_positions());
+  sim.SetInitialState(sim.CalcStandingPositions(1.0),
+                      VectorXd::Zero(sim.get_plant().num_velocities()));
+  EXPECT_EQ(sim.GetFullState().size(),
+            full_sim.get_plant().num_positions() +
+                full_sim.get_plant().num_velocities());
+  sim.AdvanceTo(0.1);
+  EXPECT_GT(sim.GetState()(6), 0.8);
+
+  SimFidelityGap gap = CompareSimFidelity(CassieClosedLoopSimOptions(), 1.0,
+                                          0.1, 0.01);
+  EXPECT_EQ(gap.times.size(), 10u);
+  EXPECT_LT(gap.max_pelvis_position_error(), 0.05);
+  EXPECT_GT(gap.full_wall_time, 0);
+  EXPECT_GT(gap.reduced_wall_time, 0);
+}
+
+}  // namespace
+}  // namespace dairlib
+
+int main(int argc, char** argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
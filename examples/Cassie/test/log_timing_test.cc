@@ -1,48 +1,93 @@
+#include <fstream>
 #include <iostream>
-#include <Eigen/Dense>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
 #include <gflags/gflags.h>
 #include "lcm/lcm-cpp.hpp"
 
+#include "lcm/lcm_log_timing.h"
+
 DEFINE_string(file, "", "Log file name.");
-DEFINE_int64(max_count, 5000, "Max number of messages to read.");
-
-// A quick script to test the frequency of messages in an LCM log.
-// Intended to be run with a log that has only one channel in it. Could
-// easily be modified to first check against a desired channel name, see
-// dispatcher_log_timing_test.cc for an example of this.
-// Prints out the mean and standard deviation of the delta-times
-int main(int argc, char* argv[]) {
+DEFINE_int64(max_count, 0,
+             "Max number of messages to read (0 reads the whole log).");
+DEFINE_string(channels, "",
+              "Comma separated list of the channels to analyze (all the "
+              "channels of the log if empty).");
+DEFINE_string(latency, "CASSIE_STATE:CASSIE_INPUT,CASSIE_STATE:OSC_DEBUG",
+              "Comma separated list of INPUT_CHANNEL:OUTPUT_CHANNEL pairs, "
+              "whose output messages are matched to the input message with "
+              "the same utime to measure the end to end latency.");
+DEFINE_double(gap_factor, 3,
+              "Intervals longer than gap_factor times the median interval of "
+              "a channel are counted as gaps.");
+DEFINE_string(json, "", "File to write the statistics to, as JSON.");
+
+namespace dairlib {
+
+std::vector<std::string> Split(const std::string& list) {
+  std::vector<std::string> items;
+  std::stringstream stream(list);
+  std::string item;
+  while (std::getline(stream, item, ',')) {
+    if (!item.empty()) items.push_back(item);
+  }
+  return items;
+}
+
+// Timing and causality of the messages of an LCM log: for every channel, the
+// rate, the distribution of the intervals between messages, the gaps, and the
+// repeated or out of order utimes; for every pair of channels in --latency,
+// the distribution of the time between logging a message (e.g. a state) and
+// logging the first message computed from it (e.g. the command with the same
+// utime).
+// The utime is decoded from the dairlib message types which start with it
+// (e.g. lcmt_robot_output, lcmt_robot_input, lcmt_osc_output, lcmt_cassie_out).
+int do_main(int argc, char* argv[]) {
   gflags::ParseCommandLineFlags(&argc, &argv, true);
   lcm::LogFile log(FLAGS_file, "r");
-  
-  auto event = log.readNextEvent();
-
-  double time = event->timestamp;
-  double last_time = time;
-  event = log.readNextEvent();
-  time = event->timestamp;
-
-  Eigen::VectorXd times(FLAGS_max_count);
-  Eigen::VectorXd dt(FLAGS_max_count);
-  int count = 0;
-
-  while (event != NULL &&
-         count < FLAGS_max_count) {
-    time = event->timestamp;
-    times(count) = time;
-    dt(count) = time - last_time;
-    last_time = time;
-    count++;
-    event = log.readNextEvent();
+  if (!log.good()) {
+    std::cerr << "Unable to open " << FLAGS_file << std::endl;
+    return 1;
+  }
+
+  LogTimingAnalyzer analyzer(FLAGS_gap_factor);
+  int64_t count = 0;
+  for (auto event = log.readNextEvent();
+       event != NULL && (FLAGS_max_count <= 0 || count < FLAGS_max_count);
+       event = log.readNextEvent(), count++) {
+    LogEvent log_event;
+    log_event.channel = event->channel;
+    log_event.timestamp = event->timestamp;
+    log_event.has_utime =
+        DecodeUtime(event->data, event->datalen, &log_event.utime);
+    analyzer.Add(log_event);
   }
 
-  if (count < FLAGS_max_count) {
-    times.conservativeResize(count);
-    dt.conservativeResize(count);
+  auto channels = Split(FLAGS_channels);
+  if (channels.empty()) channels = analyzer.channels();
+  std::vector<std::pair<std::string, std::string>> latency_pairs;
+  for (const auto& pair : Split(FLAGS_latency)) {
+    auto separator = pair.find(':');
+    if (separator == std::string::npos) {
+      std::cerr << "Expected INPUT_CHANNEL:OUTPUT_CHANNEL, got " << pair
+                << std::endl;
+      return 1;
+    }
+    latency_pairs.emplace_back(pair.substr(0, separator),
+                               pair.substr(separator + 1));
   }
 
-  auto std_dev = std::sqrt(
-      (dt.rowwise() - dt.colwise().mean()).squaredNorm()/(dt.size() - 1));
-  std::cout << "dt (microseconds) mean: " << dt.mean() << " std_dev: " <<
-      std_dev << std::endl;
+  analyzer.Print(channels, latency_pairs, &std::cout);
+  if (!FLAGS_json.empty()) {
+    std::ofstream json(FLAGS_json);
+    analyzer.WriteJson(channels, latency_pairs, &json);
+  }
+  return 0;
 }
+
+}  // namespace dairlib
+
+int main(int argc, char* argv[]) { return dairlib::do_main(argc, argv); }
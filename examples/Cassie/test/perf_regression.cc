@@ -0,0 +1,514 @@
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <limits.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <gflags/gflags.h>
+#include "lcm/lcm-cpp.hpp"
+
+#include "common/perf_regression.h"
+#include "dairlib/lcmt_cassie_out.hpp"
+#include "dairlib/lcmt_robot_input.hpp"
+#include "dairlib/lcmt_robot_output.hpp"
+#include "examples/Cassie/cassie_rbt_state_estimator.h"
+#include "examples/Cassie/cassie_utils.h"
+#include "examples/Cassie/closed_loop_sim.h"
+#include "examples/Cassie/networking/cassie_output_receiver.h"
+#include "examples/Cassie/osc/osc_walking_controller_diagram.h"
+#include "systems/goldilocks_models/file_utils.h"
+#include "systems/primitives/subvector_pass_through.h"
+#include "systems/robot_lcm_systems.h"
+
+#include "drake/multibody/rigid_body_tree_construction.h"
+#include "drake/systems/analysis/simulator.h"
+#include "drake/systems/framework/diagram.h"
+#include "drake/systems/framework/diagram_builder.h"
+
+/**
+  Performance regression harness. Runs a fixed set of workloads, writes their
+  timings (percentiles, in us) and solver iteration counts as JSON, and
+  compares them with a checked-in baseline. Exits with 1 if a metric is slower
+  (or higher) than its baseline by more than its tolerance band, if a
+  workload fails (e.g. its process crashes), or if a metric has no baseline
+  (unless --allow_missing_baseline).
+
+  The checked-in baseline only holds the tolerance bands until it is
+  bootstrapped: recording it with --update_baseline on the reference machine
+  (below) is a setup step. Until then the comparison is skipped, and only
+  failing workloads make the gate fail.
+
+  Workloads:
+   - log_replay: the lcmt_cassie_out messages of a recorded log through the
+     state estimator (as dispatcher_robot_out) and the OSC walking controller
+     (as run_osc_walking_controller), timing each message.
+   - closed_loop_sim: CassieClosedLoopSim walking in place from standing.
+   - dircon_walking: run_dircon_walking with an iteration cap, timing the
+     solve and counting the SNOPT major iterations.
+   - sgd_iteration: one goldilocks SGD iteration of the planar walker
+     (runSGDIter, the sample solve and linearization of runSGD) from
+     z_save.csv with an iteration cap, timing the solve and counting the
+     SNOPT major iterations.
+
+  Typical use, on the reference machine:
+    bazel run -c opt examples/Cassie:perf_regression -- --log=<log>
+  and, to bootstrap the baseline or after an intended change of the
+  performance, to record it:
+    bazel run -c opt examples/Cassie:perf_regression -- --log=<log> \
+      --update_baseline
+  The baselines are only meaningful on the machine they were recorded on.
+*/
+
+namespace dairlib {
+
+DEFINE_string(workloads,
+              "log_replay,closed_loop_sim,dircon_walking,sgd_iteration",
+              "Comma separated list of the workloads to run");
+DEFINE_string(baseline, "examples/Cassie/test/perf_baseline.json",
+              "Baseline to compare with");
+DEFINE_bool(update_baseline, false,
+            "Write the results to the baseline (keeping its tolerances) "
+            "instead of comparing with it");
+DEFINE_bool(allow_missing_baseline, false,
+            "Don't fail on metrics without a baseline value");
+DEFINE_string(output, "", "File to write the results to, as JSON");
+DEFINE_int32(repetitions, 3,
+             "Repetitions of the closed_loop_sim, dircon_walking and "
+             "sgd_iteration workloads");
+
+// log_replay
+DEFINE_string(log, "", "LCM log of a walking experiment (simulated or not)");
+DEFINE_string(channel_cassie_out, "CASSIE_OUTPUT",
+              "Channel of the lcmt_cassie_out messages in the log");
+DEFINE_int32(max_messages, 10000, "Maximum number of messages to replay");
+DEFINE_double(init_imu_height, 0.969223,
+              "Height of the IMU the EKF is initialized with");
+
+// closed_loop_sim
+DEFINE_double(sim_time, 1.0, "Simulated time of the closed loop simulation");
+
+// dircon_walking
+DEFINE_string(dircon_binary, "examples/Cassie/run_dircon_walking",
+              "run_dircon_walking executable");
+DEFINE_int32(dircon_max_iter, 50, "SNOPT major iterations limit");
+DEFINE_string(snopt_print_file, "/tmp/perf_regression_snopt.out",
+              "SNOPT log of the dircon_walking workload");
+
+// sgd_iteration
+DEFINE_string(sgd_binary, "examples/PlanarWalker/runSGDIter",
+              "runSGDIter executable");
+DEFINE_string(sgd_model_directory, "examples/PlanarWalker",
+              "Directory of PlanarWalkerWithTorso.urdf and z_save.csv, which "
+              "runSGDIter runs in");
+DEFINE_string(sgd_directory, "/tmp/perf_regression_sgd/",
+              "Directory of the weights, initial guess and outputs of the "
+              "sgd_iteration workload");
+DEFINE_int32(sgd_max_iter, 50, "SNOPT major iterations limit");
+
+namespace {
+
+using drake::systems::DiagramBuilder;
+using drake::systems::Simulator;
+using std::chrono::duration;
+using std::chrono::steady_clock;
+using std::string;
+using std::vector;
+
+double SecondsSince(steady_clock::time_point start) {
+  return duration<double>(steady_clock::now() - start).count();
+}
+
+PerfWorkloadResult RunLogReplay() {
+  PerfWorkloadResult result;
+  result.name = "log_replay";
+  if (FLAGS_log.empty()) {
+    result.skipped = "no --log";
+    return result;
+  }
+  lcm::LogFile log(FLAGS_log, "r");
+  if (!log.good()) {
+    result.skipped = "unable to open " + FLAGS_log;
+    return result;
+  }
+  // Decode the messages first, so that only their processing is timed
+  vector<lcmt_cassie_out> messages;
+  for (auto event = log.readNextEvent();
+       event != NULL &&
+       static_cast<int>(messages.size()) < FLAGS_max_messages;
+       event = log.readNextEvent()) {
+    if (event->channel != FLAGS_channel_cassie_out) continue;
+    lcmt_cassie_out message;
+    if (message.decode(event->data, 0, event->datalen) > 0) {
+      messages.push_back(message);
+    }
+  }
+  if (messages.empty()) {
+    result.skipped = "no " + FLAGS_channel_cassie_out + " message in the log";
+    return result;
+  }
+
+  // State estimation, as in dispatcher_robot_out
+  auto tree = makeCassieTreePointer("examples/Cassie/urdf/cassie_v2.urdf",
+                                    drake::multibody::joints::kQuaternion);
+  drake::multibody::AddFlatTerrainToWorld(tree.get(), 100, 0.2);
+  DiagramBuilder<double> estimator_builder;
+  auto input_receiver =
+      estimator_builder.AddSystem<systems::CassieOutputReceiver>();
+  auto state_estimator =
+      estimator_builder.AddSystem<systems::CassieRbtStateEstimator>(
+          *tree, true /*floating base*/);
+  auto robot_output_sender =
+      estimator_builder.AddSystem<systems::RobotOutputSender>(*tree, true);
+  auto state_passthrough =
+      estimator_builder.AddSystem<systems::SubvectorPassThrough>(
+          state_estimator->get_output_port(0).size(), 0,
+          robot_output_sender->get_input_port_state().size());
+  auto effort_passthrough =
+      estimator_builder.AddSystem<systems::SubvectorPassThrough>(
+          state_estimator->get_output_port(0).size(),
+          robot_output_sender->get_input_port_state().size(),
+          robot_output_sender->get_input_port_effort().size());
+  estimator_builder.Connect(input_receiver->get_output_port(0),
+                            state_estimator->get_input_port(0));
+  estimator_builder.Connect(state_estimator->get_output_port(0),
+                            state_passthrough->get_input_port());
+  estimator_builder.Connect(state_passthrough->get_output_port(),
+                            robot_output_sender->get_input_port_state());
+  estimator_builder.Connect(state_estimator->get_output_port(0),
+                            effort_passthrough->get_input_port());
+  estimator_builder.Connect(effort_passthrough->get_output_port(),
+                            robot_output_sender->get_input_port_effort());
+  auto estimator_diagram = estimator_builder.Build();
+  Simulator<double> estimator_simulator(*estimator_diagram);
+  auto& estimator_diagram_context = estimator_simulator.get_mutable_context();
+
+  // Controller, as in run_osc_walking_controller
+  DiagramBuilder<double> controller_builder;
+  auto controller =
+      controller_builder.AddSystem<cassie::osc::OSCWalkingControllerDiagram>();
+  auto state_receiver =
+      controller_builder.AddSystem<systems::RobotOutputReceiver>(
+          controller->get_plant_w_springs());
+  auto command_sender =
+      controller_builder.AddSystem<systems::RobotCommandSender>(
+          controller->get_plant_w_springs());
+  controller_builder.Connect(state_receiver->get_output_port(0),
+                             controller->get_input_port_state());
+  controller_builder.Connect(controller->get_output_port_control(),
+                             command_sender->get_input_port(0));
+  auto controller_diagram = controller_builder.Build();
+  Simulator<double> controller_simulator(*controller_diagram);
+  auto& controller_diagram_context = controller_simulator.get_mutable_context();
+
+  // Initialize with the first message
+  const double t0 = messages[0].utime * 1e-6;
+  estimator_diagram_context.SetTime(t0);
+  auto& cassie_out_value = input_receiver->get_input_port(0).FixValue(
+      &estimator_diagram->GetMutableSubsystemContext(
+          *input_receiver, &estimator_diagram_context),
+      messages[0]);
+  auto& state_estimator_context = estimator_diagram->GetMutableSubsystemContext(
+      *state_estimator, &estimator_diagram_context);
+  state_estimator->setPreviousTime(&state_estimator_context, t0);
+  state_estimator->setInitialImuPosition(
+      &state_estimator_context,
+      Eigen::Vector3d(0.0318638, 0, FLAGS_init_imu_height));
+  state_estimator->setInitialImuQuaternion(&state_estimator_context,
+                                           Eigen::Vector4d(1, 0, 0, 0));
+  state_estimator->setPreviousImuMeasurement(&state_estimator_context,
+                                             Eigen::VectorXd::Zero(6));
+  const auto& robot_output_port = robot_output_sender->get_output_port(0);
+  const auto& robot_output_context = estimator_diagram->GetSubsystemContext(
+      *robot_output_sender, estimator_diagram_context);
+  controller_diagram_context.SetTime(t0);
+  auto& robot_output_value = state_receiver->get_input_port(0).FixValue(
+      &controller_diagram->GetMutableSubsystemContext(
+          *state_receiver, &controller_diagram_context),
+      robot_output_port.Eval<lcmt_robot_output>(robot_output_context));
+  const auto& command_port = command_sender->get_output_port(0);
+  const auto& command_context = controller_diagram->GetSubsystemContext(
+      *command_sender, controller_diagram_context);
+
+  auto& estimator_times = result.timings["estimator"];
+  auto& controller_times = result.timings["controller"];
+  int num_replayed = 0;
+  for (const auto& message : messages) {
+    const double t = message.utime * 1e-6;
+    // Skip the messages out of order, as the simulators can't go back
+    if (t <= estimator_diagram_context.get_time()) continue;
+
+    auto start = steady_clock::now();
+    cassie_out_value.GetMutableData()->set_value(message);
+    estimator_simulator.AdvanceTo(t);
+    const auto& robot_output =
+        robot_output_port.Eval<lcmt_robot_output>(robot_output_context);
+    estimator_times.push_back(SecondsSince(start));
+
+    start = steady_clock::now();
+    robot_output_value.GetMutableData()->set_value(robot_output);
+    controller_simulator.AdvanceTo(t);
+    command_port.Eval<lcmt_robot_input>(command_context);
+    controller_times.push_back(SecondsSince(start));
+    num_replayed++;
+  }
+  result.counts["messages"] = num_replayed;
+  return result;
+}
+
+PerfWorkloadResult RunClosedLoopSim() {
+  PerfWorkloadResult result;
+  result.name = "closed_loop_sim";
+  for (int i = 0; i < FLAGS_repetitions; i++) {
+    CassieClosedLoopSim sim;
+    sim.SetInitialState(
+        sim.CalcStandingPositions(1.0),
+        Eigen::VectorXd::Zero(sim.get_plant().num_velocities()));
+    auto start = steady_clock::now();
+    sim.AdvanceTo(FLAGS_sim_time);
+    result.timings["advance"].push_back(SecondsSince(start));
+    // The simulation is deterministic, so is its number of steps
+    result.counts["simulator_steps"] =
+        sim.get_mutable_simulator().get_num_steps_taken();
+  }
+  return result;
+}
+
+// Returns the number after label in the first line of text containing it, or
+// -1
+double FindNumberAfter(const string& text, const string& label) {
+  auto position = text.find(label);
+  if (position == string::npos) return -1;
+  std::stringstream stream(text.substr(position + label.size()));
+  double value = -1;
+  stream >> value;
+  return stream.fail() ? -1 : value;
+}
+
+// Runs command, appending its standard output to output. Returns an empty
+// string if it exits with 0, or else what went wrong.
+string RunProcess(const string& command, string* output) {
+  FILE* pipe = popen(command.c_str(), "r");
+  if (!pipe) return "unable to run " + command;
+  char buffer[4096];
+  size_t size;
+  while ((size = fread(buffer, 1, sizeof(buffer), pipe)) > 0) {
+    output->append(buffer, size);
+  }
+  const int status = pclose(pipe);
+  if (status == -1) return "unable to wait for " + command;
+  if (WIFSIGNALED(status)) {
+    return command + " killed by signal " + std::to_string(WTERMSIG(status));
+  }
+  if (WEXITSTATUS(status) != 0) {
+    return command + " exited with " + std::to_string(WEXITSTATUS(status));
+  }
+  return "";
+}
+
+// Major iterations in a SNOPT print file, or -1
+double ReadSnoptMajorIterations(const string& print_file) {
+  std::ifstream file(print_file);
+  std::stringstream log;
+  log << file.rdbuf();
+  return FindNumberAfter(log.str(), "No. of major iterations");
+}
+
+PerfWorkloadResult RunDirconWalking() {
+  PerfWorkloadResult result;
+  result.name = "dircon_walking";
+  const string command = FLAGS_dircon_binary +
+                         " --visualize=false --max_iter=" +
+                         std::to_string(FLAGS_dircon_max_iter) +
+                         " --snopt_print_file=" + FLAGS_snopt_print_file;
+  for (int i = 0; i < FLAGS_repetitions; i++) {
+    std::remove(FLAGS_snopt_print_file.c_str());
+    auto start = steady_clock::now();
+    string output;
+    result.failed = RunProcess(command, &output);
+    if (!result.failed.empty()) return result;
+    result.timings["process"].push_back(SecondsSince(start));
+
+    const double solve_time = FindNumberAfter(output, "Solve time:");
+    if (solve_time >= 0) result.timings["solve"].push_back(solve_time);
+    const double iterations = ReadSnoptMajorIterations(FLAGS_snopt_print_file);
+    if (iterations >= 0) result.counts["major_iterations"] = iterations;
+  }
+  return result;
+}
+
+PerfWorkloadResult RunSgdIteration() {
+  PerfWorkloadResult result;
+  result.name = "sgd_iteration";
+  // The inputs of the first iteration of runSGD: its initial weights, and
+  // the initial guess z_save.csv
+  const string& directory = FLAGS_sgd_directory;
+  if (mkdir(directory.c_str(), 0755) != 0 && errno != EEXIST) {
+    result.failed = "unable to create " + directory;
+    return result;
+  }
+  Eigen::MatrixXd theta = Eigen::MatrixXd::Zero(2, 10);
+  theta(0, 0) = -0.1;
+  theta(0, 3) = 1.0;
+  theta(1, 1) = 1;
+  goldilocks_models::writeCSV(directory + "theta.csv", theta);
+  {
+    std::ifstream init_file(FLAGS_sgd_model_directory + "/z_save.csv");
+    std::ofstream init_copy(directory + "z_save.csv");
+    init_copy << init_file.rdbuf();
+  }
+
+  // runSGDIter reads the URDF from its working directory
+  char cwd[PATH_MAX];
+  if (!getcwd(cwd, sizeof(cwd))) {
+    result.failed = "unable to get the working directory";
+    return result;
+  }
+  const string binary = FLAGS_sgd_binary[0] == '/'
+                            ? FLAGS_sgd_binary
+                            : string(cwd) + "/" + FLAGS_sgd_binary;
+  const string command = "cd " + FLAGS_sgd_model_directory + " && " + binary +
+                         " --visualize=false --length=0.3 --duration=1" +
+                         " --iter=" + std::to_string(FLAGS_sgd_max_iter) +
+                         " --dir=" + directory +
+                         " --init=z_save.csv --weights=theta.csv";
+  const string print_file = directory + "snopt.out";
+  for (int i = 0; i < FLAGS_repetitions; i++) {
+    std::remove(print_file.c_str());
+    auto start = steady_clock::now();
+    string output;
+    result.failed = RunProcess(command, &output);
+    if (!result.failed.empty()) return result;
+    result.timings["process"].push_back(SecondsSince(start));
+
+    const double solve_time = FindNumberAfter(output, "Solve time:");
+    if (solve_time >= 0) result.timings["solve"].push_back(solve_time);
+    const double iterations = ReadSnoptMajorIterations(print_file);
+    if (iterations >= 0) result.counts["major_iterations"] = iterations;
+  }
+  return result;
+}
+
+vector<string> Split(const string& list) {
+  vector<string> items;
+  std::stringstream stream(list);
+  string item;
+  while (std::getline(stream, item, ',')) {
+    if (!item.empty()) items.push_back(item);
+  }
+  return items;
+}
+
+}  // namespace
+
+int do_main(int argc, char* argv[]) {
+  gflags::ParseCommandLineFlags(&argc, &argv, true);
+
+  vector<PerfWorkloadResult> results;
+  for (const auto& workload : Split(FLAGS_workloads)) {
+    std::cout << "Running " << workload << std::endl;
+    if (workload == "log_replay") {
+      results.push_back(RunLogReplay());
+    } else if (workload == "closed_loop_sim") {
+      results.push_back(RunClosedLoopSim());
+    } else if (workload == "dircon_walking") {
+      results.push_back(RunDirconWalking());
+    } else if (workload == "sgd_iteration") {
+      results.push_back(RunSgdIteration());
+    } else {
+      std::cerr << "Unknown workload " << workload << std::endl;
+      return 2;
+    }
+    if (!results.back().skipped.empty()) {
+      std::cout << "Skipped " << workload << ": " << results.back().skipped
+                << std::endl;
+    }
+    if (!results.back().failed.empty()) {
+      std::cerr << "Failed " << workload << ": " << results.back().failed
+                << std::endl;
+    }
+  }
+
+  std::stringstream baseline_json;
+  std::ifstream baseline_file(FLAGS_baseline);
+  if (baseline_file.good()) baseline_json << baseline_file.rdbuf();
+  PerfBaseline baseline;
+  try {
+    if (!baseline_json.str().empty()) {
+      baseline = ParsePerfBaseline(baseline_json.str());
+    }
+  } catch (const std::runtime_error& e) {
+    std::cerr << FLAGS_baseline << ": " << e.what() << std::endl;
+    return 2;
+  }
+
+  if (!FLAGS_output.empty()) {
+    std::ofstream output(FLAGS_output);
+    WritePerfResultsJson(results, baseline.tolerance,
+                         baseline.workload_tolerances, &output);
+  }
+  if (FLAGS_update_baseline) {
+    for (const auto& result : results) {
+      if (!result.failed.empty()) {
+        std::cerr << "Not updating the baseline, as " << result.name
+                  << " failed" << std::endl;
+        return 1;
+      }
+    }
+    // Under bazel run, write to the source tree rather than the runfiles
+    const char* workspace = std::getenv("BUILD_WORKSPACE_DIRECTORY");
+    const string path =
+        workspace ? string(workspace) + "/" + FLAGS_baseline : FLAGS_baseline;
+    std::ofstream output(path);
+    WritePerfResultsJson(results, baseline.tolerance,
+                         baseline.workload_tolerances, &output);
+    std::cout << "Updated " << path << std::endl;
+    return 0;
+  }
+
+  if (baseline.values.empty()) {
+    const bool any_failed =
+        std::any_of(results.begin(), results.end(),
+                    [](const PerfWorkloadResult& result) {
+                      return !result.failed.empty();
+                    });
+    std::cout << "Skipping the comparison: no baseline recorded in "
+              << FLAGS_baseline << ". Bootstrap it with --update_baseline on "
+              << "the reference machine." << std::endl;
+    return any_failed ? 1 : 0;
+  }
+
+  const auto comparisons = ComparePerfResults(results, baseline);
+  const int num_regressions = PrintPerfComparison(comparisons, &std::cout);
+  const int num_missing = std::count_if(
+      comparisons.begin(), comparisons.end(), [](const PerfComparison& c) {
+        return c.status == PerfComparison::Status::kNoBaseline;
+      });
+  if (num_regressions > 0) {
+    std::cout << num_regressions << " regression(s)" << std::endl;
+  }
+  if (num_missing > 0) {
+    std::cout << num_missing << " metric(s) without a baseline, record them "
+              << "with --update_baseline on the reference machine"
+              << std::endl;
+  }
+  if (num_regressions > 0 ||
+      (num_missing > 0 && !FLAGS_allow_missing_baseline)) {
+    return 1;
+  }
+  return 0;
+}
+
+}  // namespace dairlib
+
+int main(int argc, char* argv[]) { return dairlib::do_main(argc, argv); }
@@ -8,9 +8,14 @@ DEFINE_string(dir, "data/", "Save directory");
 DEFINE_string(init, "z_save.csv", "File name for initial guess");
 DEFINE_string(weights, "theta.csv", "File name for weights guess");
 DEFINE_string(prefix, "", "Output prefix for results");
+DEFINE_bool(visualize, true, "Play the solution back in the drake visualizer");
+DEFINE_string(fallback_init, "",
+              "File name for the initial guess of a second solve, if the "
+              "solve from init fails");
 
 int main(int argc, char* argv[]) {
   gflags::ParseCommandLineFlags(&argc, &argv, true);
   dairlib::goldilocks_models::sgdIter(FLAGS_length, FLAGS_duration, FLAGS_iter, 
-    FLAGS_dir, FLAGS_init, FLAGS_weights, FLAGS_prefix);
+    FLAGS_dir, FLAGS_init, FLAGS_weights, FLAGS_prefix, FLAGS_visualize,
+    FLAGS_fallback_init);
 }
\ No newline at end of file
@@ -19,6 +19,7 @@
 #include "common/find_resource.h"
 #include "systems/primitives/subvector_pass_through.h"
 #include "solvers/optimization_utils.h"
+#include "solvers/structured_sqp_solver.h"
 #include "systems/trajectory_optimization/dircon_position_data.h"
 #include "systems/trajectory_optimization/dircon_kinematic_data_set.h"
 #include "systems/trajectory_optimization/hybrid_dircon.h"
@@ -30,6 +31,9 @@
 DEFINE_double(strideLength, 0.1, "The stride length.");
 DEFINE_double(duration, 1, "The stride duration");
 DEFINE_bool(autodiff, false, "Double or autodiff version");
+DEFINE_string(solver, "snopt",
+              "snopt, or sqp for the structured SQP solver, which factors "
+              "the KKT system knot by knot");
 
 using drake::multibody::MultibodyPlant;
 using drake::geometry::SceneGraph;
@@ -222,11 +226,25 @@ shared_ptr<HybridDircon<T>> runDircon(
       visualizer_poses, "base");
 
   auto start = std::chrono::high_resolution_clock::now();
-  const auto result = Solve(*trajopt, trajopt->initial_guess());
+  drake::solvers::MathematicalProgramResult result;
+  if (FLAGS_solver == "sqp") {
+    solvers::StructuredSqpOptions sqp_options;
+    sqp_options.verbose = true;
+    const auto sqp_result = solvers::SolveWithStructuredSqp(
+        *trajopt, trajopt->GetDecisionVariableStages(),
+        trajopt->initial_guess(), sqp_options, &result);
+    std::cout << "SQP iterations: " << sqp_result.iterations
+              << ", QP iterations: " << sqp_result.qp_iterations
+              << ", KKT size: " << sqp_result.kkt_size
+              << ", border: " << sqp_result.kkt_border << std::endl;
+  } else {
+    result = Solve(*trajopt, trajopt->initial_guess());
+  }
   auto finish = std::chrono::high_resolution_clock::now();
   std::chrono::duration<double> elapsed = finish - start;
   std::cout << "Solve time:" << elapsed.count() <<std::endl;
   std::cout << "Cost:" << result.get_optimal_cost() <<std::endl;
+  std::cout << to_string(result.get_solution_result()) << std::endl;
 
   // systems::trajectory_optimization::checkConstraints(trajopt.get(), result);
 
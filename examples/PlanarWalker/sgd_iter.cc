@@ -2,9 +2,21 @@
 
 #include <gflags/gflags.h>
 
+#include <libgen.h>
+#include <limits.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <algorithm>
 #include <memory>
 #include <chrono>
-
+#include <cstdio>
+#include <fstream>
+#include <iomanip>
+#include <map>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
 
 
 #include "drake/multibody/rigid_body_tree_construction.h"
@@ -60,7 +72,9 @@ using systems::trajectory_optimization::DirconKinConstraintType;
 shared_ptr<HybridDircon<double>> sgdIter(double stride_length, double duration,
                                          int iter, string directory,
                                          string init_file, string weights_file,
-                                         string output_prefix) {
+                                         string output_prefix,
+                                         bool visualize,
+                                         string fallback_init_file) {
   RigidBodyTree<double> tree;
   drake::parsers::urdf::AddModelInstanceFromUrdfFileToWorld(
       "PlanarWalkerWithTorso.urdf", drake::multibody::joints::kFixed, &tree);
@@ -165,8 +179,12 @@ shared_ptr<HybridDircon<double>> sgdIter(double stride_length, double duration,
 
   trajopt->AddDurationBounds(duration, duration);
 
+  // SNOPT appends to its print file, and the log of a previous run with the
+  // same prefix would be counted by sgdIterMajorIterations
+  const string print_file = directory + output_prefix + "snopt.out";
+  std::remove(print_file.c_str());
   trajopt->SetSolverOption(drake::solvers::SnoptSolver::id(),
-                           "Print file", "snopt.out");
+                           "Print file", print_file);
   trajopt->SetSolverOption(drake::solvers::SnoptSolver::id(),
                            "Major iterations limit", iter);
 
@@ -266,12 +284,23 @@ shared_ptr<HybridDircon<double>> sgdIter(double stride_length, double duration,
   }
 
   auto start = std::chrono::high_resolution_clock::now();
-  const auto result = Solve(*trajopt, trajopt->initial_guess());
+  auto result = Solve(*trajopt, trajopt->initial_guess());
+  // Single write, as the samples of a batch are solved concurrently
+  std::stringstream summary;
+  if (!result.is_success() && !fallback_init_file.empty()) {
+    summary << output_prefix << "Solve from " << init_file << " failed ("
+            << to_string(result.get_solution_result()) << "), solving from "
+            << fallback_init_file << std::endl;
+    MatrixXd z0 = readCSV(directory + fallback_init_file);
+    trajopt->SetInitialGuessForAllVariables(z0);
+    result = Solve(*trajopt, trajopt->initial_guess());
+  }
   auto finish = std::chrono::high_resolution_clock::now();
   std::chrono::duration<double> elapsed = finish - start;
   // trajopt->PrintSolution();
-  std::cout << "Solve time:" << elapsed.count() <<std::endl;
-  std::cout << "Cost:" << result.get_optimal_cost() <<std::endl;
+  summary << output_prefix << "Solve time:" << elapsed.count() << std::endl
+          << output_prefix << "Cost:" << result.get_optimal_cost() << std::endl;
+  std::cout << summary.str();
 
   // systems::trajectory_optimization::checkConstraints(trajopt.get());
 
@@ -315,6 +344,10 @@ shared_ptr<HybridDircon<double>> sgdIter(double stride_length, double duration,
   writeCSV(directory + output_prefix + string("w.csv"), w);
   writeCSV(directory + output_prefix + string("z.csv"), z);
 
+  if (!visualize) {
+    return trajopt;
+  }
+
   // visualizer
   drake::lcm::DrakeLcm lcm;
   drake::systems::DiagramBuilder<double> builder;
@@ -339,6 +372,112 @@ shared_ptr<HybridDircon<double>> sgdIter(double stride_length, double duration,
   return trajopt;
 }
 
+int sgdIterMajorIterations(const string& directory,
+                           const string& output_prefix) {
+  const string label = "No. of major iterations";
+  std::ifstream file(directory + output_prefix + "snopt.out");
+  string line;
+  int total = -1;
+  while (std::getline(file, line)) {
+    auto position = line.find(label);
+    if (position == string::npos) continue;
+    std::stringstream stream(line.substr(position + label.size()));
+    int iterations;
+    if (stream >> iterations) total = std::max(total, 0) + iterations;
+  }
+  return total;
+}
+
+void sgdIterBatch(const vector<SgdIterSample>& samples, int iter,
+                  const string& directory, const string& weights_file,
+                  int num_threads, bool visualize,
+                  const string& sgd_iter_binary) {
+  if (num_threads <= 0) {
+    num_threads = std::max(1u, std::thread::hardware_concurrency());
+  }
+  // Playbacks of concurrent samples would interleave in the visualizer
+  if (visualize) num_threads = 1;
+  string binary = sgd_iter_binary;
+  if (binary.empty()) {
+    // runSGDIter, next to the running executable
+    char path[PATH_MAX];
+    const ssize_t length = readlink("/proc/self/exe", path, sizeof(path) - 1);
+    if (length < 0) {
+      throw std::runtime_error("Unable to find the runSGDIter executable");
+    }
+    path[length] = '\0';
+    binary = string(dirname(path)) + "/runSGDIter";
+  }
+
+  auto flag = [](const string& name, const auto& value) {
+    std::stringstream stream;
+    stream << std::setprecision(17) << std::boolalpha << "--" << name << "="
+           << value;
+    return stream.str();
+  };
+
+  // Running sample of each child process
+  std::map<pid_t, int> running;
+  vector<string> failures;
+  auto wait_for_one = [&]() {
+    int status;
+    const pid_t pid = waitpid(-1, &status, 0);
+    if (pid < 0) {
+      throw std::runtime_error("Unable to wait for the samples");
+    }
+    auto it = running.find(pid);
+    if (it == running.end()) return;
+    const string& prefix = samples[it->second].output_prefix;
+    if (WIFSIGNALED(status)) {
+      failures.push_back(prefix + " killed by signal " +
+                         std::to_string(WTERMSIG(status)));
+    } else if (WEXITSTATUS(status) != 0) {
+      failures.push_back(prefix + " exited with " +
+                         std::to_string(WEXITSTATUS(status)));
+    }
+    running.erase(it);
+  };
+
+  for (int i = 0; i < static_cast<int>(samples.size()); i++) {
+    while (static_cast<int>(running.size()) >= num_threads) wait_for_one();
+    const SgdIterSample& sample = samples[i];
+    const vector<string> args = {
+        binary,
+        flag("length", sample.stride_length),
+        flag("duration", sample.duration),
+        flag("iter", iter),
+        flag("dir", directory),
+        flag("init", sample.init_file),
+        flag("weights", weights_file),
+        flag("prefix", sample.output_prefix),
+        flag("fallback_init", sample.fallback_init_file),
+        flag("visualize", visualize)};
+    vector<char*> argv;
+    for (const auto& arg : args) argv.push_back(const_cast<char*>(arg.c_str()));
+    argv.push_back(nullptr);
+
+    std::cout.flush();
+    const pid_t pid = fork();
+    if (pid < 0) {
+      throw std::runtime_error("Unable to start the solve of " +
+                               sample.output_prefix);
+    }
+    if (pid == 0) {
+      execv(binary.c_str(), argv.data());
+      std::cerr << "Unable to run " << binary << std::endl;
+      _exit(127);
+    }
+    running[pid] = i;
+  }
+  while (!running.empty()) wait_for_one();
+
+  if (!failures.empty()) {
+    string message = "Failed samples:";
+    for (const auto& failure : failures) message += "\n  " + failure;
+    throw std::runtime_error(message);
+  }
+}
+
 }  // namespace goldilocks_models
 }  // namespace dairlib
 
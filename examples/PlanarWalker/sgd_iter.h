@@ -1,14 +1,54 @@
 #pragma once
 
 #include <string>
+#include <vector>
+
 #include "attic/systems/trajectory_optimization/hybrid_dircon.h"
 
 namespace dairlib {
 namespace goldilocks_models  {
 
+/// Solves the gait optimization of one sample, and writes its solution and
+/// linearization to directory + output_prefix + "{A,B,H,lb,ub,w,y,z}.csv"
+/// (and its SNOPT log to directory + output_prefix + "snopt.out").
+/// @param visualize play the solution back in the drake visualizer
+/// @param fallback_init_file initial guess of a second solve, if the solve
+///   from init_file fails
 std::shared_ptr<systems::trajectory_optimization::HybridDircon<double>> sgdIter(
     double stride_length, double duration, int iter, std::string directory,
-    std::string init_file, std::string weights_file, std::string output_prefix);
+    std::string init_file, std::string weights_file, std::string output_prefix,
+    bool visualize = true, std::string fallback_init_file = "");
+
+/// Total number of SNOPT major iterations of the solves of a sample by
+/// sgdIter() (the fallback solve included), read from its SNOPT log; -1 if
+/// the log has none.
+int sgdIterMajorIterations(const std::string& directory,
+                           const std::string& output_prefix);
+
+/// Sample of an SGD batch
+struct SgdIterSample {
+  double stride_length;
+  double duration;
+  std::string init_file;
+  std::string output_prefix;
+  std::string fallback_init_file;
+};
+
+/// Runs sgdIter() for each sample of a batch, each in its own runSGDIter
+/// process, num_threads at a time (0 uses all the hardware threads). SNOPT
+/// keeps its state in process globals, so the solves can only run
+/// concurrently in separate processes. The samples share nothing but the
+/// weights and write their own files, so the results don't depend on the
+/// number of processes. With visualize, the samples run one at a time, so
+/// that their playbacks don't interleave.
+/// @param sgd_iter_binary path of runSGDIter (if empty, the one next to the
+///   running executable)
+/// @throws std::runtime_error if a sample process fails
+void sgdIterBatch(const std::vector<SgdIterSample>& samples, int iter,
+                  const std::string& directory,
+                  const std::string& weights_file, int num_threads,
+                  bool visualize = false,
+                  const std::string& sgd_iter_binary = "");
 
 }  // namespace goldilocks_models
 }  // namespace dairlib
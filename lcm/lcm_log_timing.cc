@@ -0,0 +1,250 @@
+#include "lcm/lcm_log_timing.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <unordered_map>
+#include <unordered_set>
+
+#include "dairlib/lcmt_cassie_in.hpp"
+#include "dairlib/lcmt_cassie_out.hpp"
+#include "dairlib/lcmt_controller_switch.hpp"
+#include "dairlib/lcmt_osc_output.hpp"
+#include "dairlib/lcmt_pd_config.hpp"
+#include "dairlib/lcmt_robot_input.hpp"
+#include "dairlib/lcmt_robot_output.hpp"
+
+namespace dairlib {
+
+using std::string;
+using std::vector;
+
+bool DecodeUtime(const void* data, int size, int64_t* utime) {
+  // Message types whose first field is the int64_t time stamp
+  static const std::unordered_set<uint64_t> utime_types = {
+      static_cast<uint64_t>(lcmt_cassie_in::getHash()),
+      static_cast<uint64_t>(lcmt_cassie_out::getHash()),
+      static_cast<uint64_t>(lcmt_controller_switch::getHash()),
+      static_cast<uint64_t>(lcmt_osc_output::getHash()),
+      static_cast<uint64_t>(lcmt_pd_config::getHash()),
+      static_cast<uint64_t>(lcmt_robot_input::getHash()),
+      static_cast<uint64_t>(lcmt_robot_output::getHash()),
+  };
+  if (size < 16) return false;
+  // LCM encodes the fingerprint of the type, then the fields, big endian
+  const uint8_t* bytes = static_cast<const uint8_t*>(data);
+  uint64_t fingerprint = 0;
+  uint64_t value = 0;
+  for (int i = 0; i < 8; i++) {
+    fingerprint = (fingerprint << 8) | bytes[i];
+    value = (value << 8) | bytes[8 + i];
+  }
+  if (!utime_types.count(fingerprint)) return false;
+  *utime = static_cast<int64_t>(value);
+  return true;
+}
+
+DistributionStats CalcDistributionStats(vector<double> values) {
+  DistributionStats stats;
+  stats.count = values.size();
+  if (values.empty()) return stats;
+  std::sort(values.begin(), values.end());
+  double sum = 0;
+  double sum_squares = 0;
+  for (double value : values) {
+    sum += value;
+    sum_squares += value * value;
+  }
+  stats.mean = sum / values.size();
+  stats.std_dev = std::sqrt(
+      std::max(0.0, sum_squares / values.size() - stats.mean * stats.mean));
+  // Nearest rank percentiles
+  auto percentile = [&values](double p) {
+    int rank = std::ceil(p * values.size()) - 1;
+    return values[std::min(std::max(rank, 0),
+                           static_cast<int>(values.size()) - 1)];
+  };
+  stats.min = values.front();
+  stats.p50 = percentile(0.5);
+  stats.p90 = percentile(0.9);
+  stats.p99 = percentile(0.99);
+  stats.p999 = percentile(0.999);
+  stats.max = values.back();
+  return stats;
+}
+
+void LogTimingAnalyzer::Add(const LogEvent& event) {
+  events_[event.channel].push_back(event);
+}
+
+vector<string> LogTimingAnalyzer::channels() const {
+  vector<string> names;
+  for (const auto& channel : events_) {
+    names.push_back(channel.first);
+  }
+  return names;
+}
+
+ChannelTimingStats LogTimingAnalyzer::CalcChannelStats(
+    const string& channel) const {
+  ChannelTimingStats stats;
+  stats.channel = channel;
+  auto it = events_.find(channel);
+  if (it == events_.end()) return stats;
+  const vector<LogEvent>& events = it->second;
+
+  stats.count = events.size();
+  stats.duration =
+      1e-6 * (events.back().timestamp - events.front().timestamp);
+  if (stats.duration > 0) stats.rate = (stats.count - 1) / stats.duration;
+
+  vector<double> dt;
+  vector<double> log_delay;
+  const LogEvent* previous = nullptr;
+  int64_t max_utime = 0;
+  for (int i = 0; i < static_cast<int>(events.size()); i++) {
+    if (i > 0) dt.push_back(events[i].timestamp - events[i - 1].timestamp);
+    if (!events[i].has_utime) continue;
+    log_delay.push_back(events[i].timestamp - events[i].utime);
+    if (previous) {
+      if (events[i].utime == previous->utime) {
+        stats.num_duplicate_utimes++;
+      } else if (events[i].utime < max_utime) {
+        stats.num_out_of_order_utimes++;
+      }
+    }
+    if (!previous || events[i].utime > max_utime) max_utime = events[i].utime;
+    previous = &events[i];
+  }
+
+  stats.dt = CalcDistributionStats(dt);
+  for (double interval : dt) {
+    if (interval > gap_factor_ * stats.dt.p50) stats.num_gaps++;
+  }
+  stats.max_gap = stats.dt.max;
+  stats.log_delay = CalcDistributionStats(log_delay);
+  return stats;
+}
+
+LatencyStats LogTimingAnalyzer::CalcLatencyStats(
+    const string& input_channel, const string& output_channel) const {
+  LatencyStats stats;
+  stats.input_channel = input_channel;
+  stats.output_channel = output_channel;
+  auto input = events_.find(input_channel);
+  auto output = events_.find(output_channel);
+  if (input == events_.end() || output == events_.end()) return stats;
+
+  // Log time of the first input message of each utime
+  std::unordered_map<int64_t, int64_t> input_times;
+  for (const auto& event : input->second) {
+    if (event.has_utime) input_times.emplace(event.utime, event.timestamp);
+  }
+
+  vector<double> latencies;
+  std::unordered_set<int64_t> answered;
+  for (const auto& event : output->second) {
+    if (!event.has_utime) continue;
+    auto input_time = input_times.find(event.utime);
+    if (input_time == input_times.end()) {
+      stats.num_unmatched++;
+    } else if (!answered.insert(event.utime).second) {
+      stats.num_repeated++;
+    } else {
+      stats.num_matched++;
+      latencies.push_back(event.timestamp - input_time->second);
+    }
+  }
+  stats.num_unanswered = input_times.size() - answered.size();
+  stats.latency = CalcDistributionStats(latencies);
+  return stats;
+}
+
+namespace {
+
+void PrintDistribution(const string& name, const DistributionStats& stats,
+                       double scale, std::ostream* out) {
+  *out << "  " << std::left << std::setw(12) << name << std::right
+       << std::fixed << std::setprecision(3) << " mean "
+       << scale * stats.mean << ", std " << scale * stats.std_dev << ", min "
+       << scale * stats.min << ", p50 " << scale * stats.p50 << ", p90 "
+       << scale * stats.p90 << ", p99 " << scale * stats.p99 << ", p99.9 "
+       << scale * stats.p999 << ", max " << scale * stats.max << std::endl;
+}
+
+void WriteJsonDistribution(const DistributionStats& stats,
+                           std::ostream* out) {
+  *out << "{\"count\": " << stats.count << ", \"mean\": " << stats.mean
+       << ", \"std\": " << stats.std_dev << ", \"min\": " << stats.min
+       << ", \"p50\": " << stats.p50 << ", \"p90\": " << stats.p90
+       << ", \"p99\": " << stats.p99 << ", \"p999\": " << stats.p999
+       << ", \"max\": " << stats.max << "}";
+}
+
+}  // namespace
+
+void LogTimingAnalyzer::Print(
+    const vector<string>& channels,
+    const vector<std::pair<string, string>>& latency_pairs,
+    std::ostream* out) const {
+  for (const auto& channel : channels) {
+    auto stats = CalcChannelStats(channel);
+    *out << channel << ": " << stats.count << " messages, " << std::fixed
+         << std::setprecision(1) << stats.rate << " Hz, " << stats.num_gaps
+         << " gaps, " << stats.num_duplicate_utimes << " duplicate and "
+         << stats.num_out_of_order_utimes << " out of order utimes"
+         << std::endl;
+    PrintDistribution("dt (ms)", stats.dt, 1e-3, out);
+    if (stats.log_delay.count > 0) {
+      PrintDistribution("delay (ms)", stats.log_delay, 1e-3, out);
+    }
+  }
+  for (const auto& pair : latency_pairs) {
+    auto stats = CalcLatencyStats(pair.first, pair.second);
+    *out << pair.first << " -> " << pair.second << ": " << stats.num_matched
+         << " matched, " << stats.num_unmatched << " unmatched, "
+         << stats.num_unanswered << " unanswered, " << stats.num_repeated
+         << " repeated" << std::endl;
+    PrintDistribution("latency (ms)", stats.latency, 1e-3, out);
+  }
+}
+
+void LogTimingAnalyzer::WriteJson(
+    const vector<string>& channels,
+    const vector<std::pair<string, string>>& latency_pairs,
+    std::ostream* out) const {
+  *out << std::setprecision(12) << "{\n  \"channels\": [";
+  for (int i = 0; i < static_cast<int>(channels.size()); i++) {
+    auto stats = CalcChannelStats(channels[i]);
+    *out << (i ? ",\n" : "\n") << "    {\"channel\": \"" << stats.channel
+         << "\", \"count\": " << stats.count
+         << ", \"duration\": " << stats.duration
+         << ", \"rate\": " << stats.rate
+         << ", \"num_gaps\": " << stats.num_gaps
+         << ", \"max_gap\": " << stats.max_gap
+         << ", \"num_duplicate_utimes\": " << stats.num_duplicate_utimes
+         << ", \"num_out_of_order_utimes\": "
+         << stats.num_out_of_order_utimes << ",\n     \"dt\": ";
+    WriteJsonDistribution(stats.dt, out);
+    *out << ",\n     \"log_delay\": ";
+    WriteJsonDistribution(stats.log_delay, out);
+    *out << "}";
+  }
+  *out << "\n  ],\n  \"latencies\": [";
+  for (int i = 0; i < static_cast<int>(latency_pairs.size()); i++) {
+    auto stats = CalcLatencyStats(latency_pairs[i].first,
+                                  latency_pairs[i].second);
+    *out << (i ? ",\n" : "\n") << "    {\"input_channel\": \""
+         << stats.input_channel << "\", \"output_channel\": \""
+         << stats.output_channel << "\", \"num_matched\": "
+         << stats.num_matched << ", \"num_unmatched\": " << stats.num_unmatched
+         << ", \"num_unanswered\": " << stats.num_unanswered
+         << ", \"num_repeated\": " << stats.num_repeated
+         << ",\n     \"latency\": ";
+    WriteJsonDistribution(stats.latency, out);
+    *out << "}";
+  }
+  *out << "\n  ]\n}" << std::endl;
+}
+
+}  // namespace dairlib
@@ -0,0 +1,112 @@
+#pragma once
+
+#include <cstdint>
+#include <map>
+#include <ostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace dairlib {
+
+/// Timing of a message in an LCM log. Times are in microseconds.
+struct LogEvent {
+  std::string channel;
+  /// Time the message was logged
+  int64_t timestamp = 0;
+  /// utime field of the message, if its type has one
+  bool has_utime = false;
+  int64_t utime = 0;
+};
+
+/// Returns the utime field of an encoded LCM message, if it is one of the
+/// dairlib message types (which all start with int64_t utime)
+bool DecodeUtime(const void* data, int size, int64_t* utime);
+
+/// Percentiles of a distribution
+struct DistributionStats {
+  int64_t count = 0;
+  double mean = 0;
+  double std_dev = 0;
+  double min = 0;
+  double p50 = 0;
+  double p90 = 0;
+  double p99 = 0;
+  double p999 = 0;
+  double max = 0;
+};
+
+DistributionStats CalcDistributionStats(std::vector<double> values);
+
+/// Timing of the messages of one channel
+struct ChannelTimingStats {
+  std::string channel;
+  int64_t count = 0;
+  /// Time between the first and last messages (s) and average rate (Hz)
+  double duration = 0;
+  double rate = 0;
+  /// Time between consecutive messages (us)
+  DistributionStats dt;
+  /// Intervals longer than gap_factor times the median interval, and the
+  /// longest interval (us)
+  int64_t num_gaps = 0;
+  double max_gap = 0;
+  /// Messages whose utime is the same as the previous message's, or earlier
+  /// than the latest one before
+  int64_t num_duplicate_utimes = 0;
+  int64_t num_out_of_order_utimes = 0;
+  /// Difference between the logged time and the utime (us), e.g. the delay
+  /// of the publisher for messages stamped with a wall clock
+  DistributionStats log_delay;
+};
+
+/// Latency between the messages of an input channel and the messages of an
+/// output channel computed from them, matched by utime (the controllers stamp
+/// their outputs with the utime of the state they were computed from)
+struct LatencyStats {
+  std::string input_channel;
+  std::string output_channel;
+  /// Output messages matched to an input message
+  int64_t num_matched = 0;
+  /// Output messages whose utime is not the one of any input message
+  int64_t num_unmatched = 0;
+  /// Input messages to which no output message was matched
+  int64_t num_unanswered = 0;
+  /// Output messages with the same utime as an earlier output (only the first
+  /// is used)
+  int64_t num_repeated = 0;
+  /// Time between logging the input and the first output matched to it (us)
+  DistributionStats latency;
+};
+
+/// LogTimingAnalyzer computes the timing statistics of the channels of an
+/// LCM log, and the end to end latency between pairs of channels.
+class LogTimingAnalyzer {
+ public:
+  explicit LogTimingAnalyzer(double gap_factor = 3) : gap_factor_(gap_factor) {}
+
+  /// Adds a message. Messages are added in the order of the log.
+  void Add(const LogEvent& event);
+
+  std::vector<std::string> channels() const;
+  ChannelTimingStats CalcChannelStats(const std::string& channel) const;
+  LatencyStats CalcLatencyStats(const std::string& input_channel,
+                                const std::string& output_channel) const;
+
+  /// Prints the statistics of the channels and latencies
+  void Print(const std::vector<std::string>& channels,
+             const std::vector<std::pair<std::string, std::string>>&
+                 latency_pairs,
+             std::ostream* out) const;
+  /// Writes the statistics as JSON
+  void WriteJson(const std::vector<std::string>& channels,
+                 const std::vector<std::pair<std::string, std::string>>&
+                     latency_pairs,
+                 std::ostream* out) const;
+
+ private:
+  const double gap_factor_;
+  std::map<std::string, std::vector<LogEvent>> events_;
+};
+
+}  // namespace dairlib
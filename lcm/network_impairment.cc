@@ -0,0 +1,81 @@
+#include "lcm/network_impairment.h"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include <utility>
+
+namespace dairlib {
+
+using JitterDistribution = NetworkImpairmentParams::JitterDistribution;
+
+JitterDistribution ParseJitterDistribution(const std::string& name) {
+  if (name == "uniform") return JitterDistribution::kUniform;
+  if (name == "gaussian") return JitterDistribution::kGaussian;
+  if (name == "exponential") return JitterDistribution::kExponential;
+  throw std::invalid_argument("Unknown jitter distribution: " + name);
+}
+
+NetworkImpairment::NetworkImpairment(const NetworkImpairmentParams& params)
+    : params_(params), generator_(params.seed) {}
+
+std::vector<double> NetworkImpairment::Apply(double receive_time) {
+  // All the draws are made for every packet, so that the impairment of a
+  // packet doesn't depend on the outcome of the ones before
+  const bool drop = uniform_(generator_) < params_.drop_probability;
+  const bool duplicate = uniform_(generator_) < params_.duplicate_probability;
+  const bool hold = uniform_(generator_) < params_.reorder_probability;
+  const double delay = DrawDelay();
+  const double duplicate_delay = DrawDelay();
+
+  std::vector<double> delivery_times;
+  if (drop) return delivery_times;
+  delivery_times.push_back(receive_time + delay +
+                           (hold ? params_.reorder_delay : 0));
+  if (duplicate) {
+    delivery_times.push_back(receive_time + duplicate_delay);
+  }
+  if (params_.keep_order) {
+    for (auto& time : delivery_times) {
+      time = std::max(time, last_delivery_time_);
+      last_delivery_time_ = time;
+    }
+  }
+  return delivery_times;
+}
+
+double NetworkImpairment::DrawDelay() {
+  double jitter = 0;
+  const double u = uniform_(generator_);
+  switch (params_.jitter_distribution) {
+    case JitterDistribution::kUniform:
+      jitter = params_.jitter * (2 * u - 1);
+      break;
+    case JitterDistribution::kGaussian: {
+      // Box-Muller, with a second uniform draw
+      const double v = uniform_(generator_);
+      jitter = params_.jitter * std::sqrt(-2 * std::log(1 - u)) *
+               std::cos(2 * M_PI * v);
+      break;
+    }
+    case JitterDistribution::kExponential:
+      jitter = -params_.jitter * std::log(1 - u);
+      break;
+  }
+  return std::max(0.0, params_.delay + jitter);
+}
+
+void DelayQueue::Push(DelayedPacket packet) {
+  queue_.push(Entry{std::move(packet), num_pushed_++});
+}
+
+bool DelayQueue::PopDue(double now, DelayedPacket* packet) {
+  if (queue_.empty() || queue_.top().packet.delivery_time > now) {
+    return false;
+  }
+  *packet = queue_.top().packet;
+  queue_.pop();
+  return true;
+}
+
+}  // namespace dairlib
@@ -0,0 +1,110 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <queue>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace dairlib {
+
+/// Impairment of a network link, applied independently to every packet.
+/// Times are in seconds.
+struct NetworkImpairmentParams {
+  enum class JitterDistribution { kUniform, kGaussian, kExponential };
+
+  /// Constant transport delay
+  double delay = 0;
+  /// Random delay added to the constant delay. jitter is the half width of
+  /// the uniform distribution, or the standard deviation of the Gaussian
+  /// distribution (truncated at zero), or the mean of the exponential
+  /// distribution.
+  double jitter = 0;
+  JitterDistribution jitter_distribution = JitterDistribution::kUniform;
+  /// Probability that a packet is lost
+  double drop_probability = 0;
+  /// Probability that a packet is delivered twice (the copy gets its own
+  /// delay)
+  double duplicate_probability = 0;
+  /// Probability that a packet is held back by reorder_delay, so that the
+  /// packets received after it overtake it
+  double reorder_probability = 0;
+  double reorder_delay = 0.005;
+  /// Deliver the packets in the order they were received, even if their
+  /// delays would make them overtake each other (jitter and reordering then
+  /// only delay the packets behind)
+  bool keep_order = false;
+  /// Seed of the random impairment
+  unsigned int seed = 0;
+};
+
+/// Parses "uniform", "gaussian" or "exponential"
+NetworkImpairmentParams::JitterDistribution ParseJitterDistribution(
+    const std::string& name);
+
+/// NetworkImpairment draws the impairment of the packets of one link. The
+/// random draws only depend on the seed and the number of packets before, so
+/// a link with the same sequence of packets is impaired identically.
+class NetworkImpairment {
+ public:
+  explicit NetworkImpairment(const NetworkImpairmentParams& params);
+
+  /// Returns the delivery times of the copies of a packet received at
+  /// receive_time: none if it is dropped, two if it is duplicated
+  std::vector<double> Apply(double receive_time);
+
+ private:
+  double DrawDelay();
+
+  const NetworkImpairmentParams params_;
+  std::mt19937 generator_;
+  std::uniform_real_distribution<double> uniform_{0, 1};
+  double last_delivery_time_ = 0;
+};
+
+/// Packet waiting in a DelayQueue
+struct DelayedPacket {
+  /// Index of the link (e.g. LCM channel or UDP port) of the packet
+  int link = 0;
+  /// Index of the packet on its link, in order of reception
+  int64_t sequence = 0;
+  /// Index of the copy of the packet (0 unless it was duplicated)
+  int copy = 0;
+  double receive_time = 0;
+  double delivery_time = 0;
+  std::vector<uint8_t> data;
+};
+
+/// Queue of delayed packets, released in order of delivery time (and of
+/// reception for equal delivery times)
+class DelayQueue {
+ public:
+  void Push(DelayedPacket packet);
+
+  /// Removes the next packet into *packet if it is due at time now
+  bool PopDue(double now, DelayedPacket* packet);
+
+  bool empty() const { return queue_.empty(); }
+  /// Delivery time of the next packet
+  double next_delivery_time() const {
+    return queue_.top().packet.delivery_time;
+  }
+
+ private:
+  struct Entry {
+    DelayedPacket packet;
+    int64_t order;
+    bool operator>(const Entry& other) const {
+      if (packet.delivery_time != other.packet.delivery_time) {
+        return packet.delivery_time > other.packet.delivery_time;
+      }
+      return order > other.order;
+    }
+  };
+
+  std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry>> queue_;
+  int64_t num_pushed_ = 0;
+};
+
+}  // namespace dairlib
@@ -0,0 +1,337 @@
+#include <arpa/inet.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <gflags/gflags.h>
+#include "lcm/lcm-cpp.hpp"
+
+#include "lcm/network_impairment.h"
+
+/**
+  Relays LCM channels and UDP ports through an impaired link, to measure how
+  the controllers degrade with the transport. Every relayed packet gets a
+  delay (constant plus random jitter), and may be dropped, duplicated or held
+  back so that later packets overtake it. The impairment is drawn from a seeded
+  generator per link, and every packet is logged with the impairment actually
+  applied.
+
+  LCM channels are relayed on the same LCM URL under another name, e.g.
+  --channels=CASSIE_STATE_SIMULATION:CASSIE_STATE_DELAYED, with the controller
+  listening to CASSIE_STATE_DELAYED (see its --channel_x). UDP packets are
+  received on one port and forwarded to another, e.g. --udp=25001:25011 with
+  dispatcher_robot_out listening on port 25011.
+*/
+
+namespace dairlib {
+
+DEFINE_string(lcm_url, "udpm://239.255.76.67:7667?ttl=0", "LCM URL");
+DEFINE_string(channels, "",
+              "Comma separated list of LCM channels to relay, as "
+              "INPUT_CHANNEL:OUTPUT_CHANNEL");
+DEFINE_string(udp, "",
+              "Comma separated list of UDP ports to relay, as "
+              "LISTEN_PORT:FORWARD_PORT");
+DEFINE_string(udp_address, "127.0.0.1",
+              "IPv4 address the UDP ports are bound and forwarded to");
+
+DEFINE_double(delay, 0, "Constant delay (s)");
+DEFINE_double(jitter, 0, "Scale of the random delay (s)");
+DEFINE_string(jitter_distribution, "uniform",
+              "uniform (jitter is the half width), gaussian (jitter is the "
+              "standard deviation) or exponential (jitter is the mean)");
+DEFINE_double(drop, 0, "Probability that a packet is lost");
+DEFINE_double(duplicate, 0, "Probability that a packet is delivered twice");
+DEFINE_double(reorder, 0,
+              "Probability that a packet is held back by reorder_delay");
+DEFINE_double(reorder_delay, 0.005, "Hold back time of reordered packets");
+DEFINE_bool(keep_order, false,
+            "Deliver the packets of each link in the order they were "
+            "received");
+DEFINE_int32(seed, 0, "Seed of the impairment");
+DEFINE_string(log_file, "",
+              "CSV file logging the impairment applied to every packet");
+DEFINE_double(end_time, 0, "Duration of the relay (0 runs forever)");
+
+namespace {
+
+using std::chrono::duration;
+using std::chrono::steady_clock;
+
+// Packets of one relayed channel or port
+struct Link {
+  std::string name;
+  // LCM output channel, or UDP socket and forward address
+  std::string output_channel;
+  int socket = -1;
+  struct sockaddr_in forward_address;
+
+  std::unique_ptr<NetworkImpairment> impairment;
+  int64_t num_received = 0;
+  int64_t max_sent_sequence = -1;
+  int64_t num_dropped = 0;
+  int64_t num_duplicated = 0;
+  int64_t num_reordered = 0;
+  int64_t num_sent = 0;
+  double sum_delay = 0;
+};
+
+std::vector<std::pair<std::string, std::string>> ParsePairs(
+    const std::string& list) {
+  std::vector<std::pair<std::string, std::string>> pairs;
+  std::stringstream stream(list);
+  std::string item;
+  while (std::getline(stream, item, ',')) {
+    if (item.empty()) continue;
+    auto separator = item.find(':');
+    if (separator == std::string::npos) {
+      throw std::invalid_argument("Expected INPUT:OUTPUT, got " + item);
+    }
+    pairs.emplace_back(item.substr(0, separator), item.substr(separator + 1));
+  }
+  return pairs;
+}
+
+class ImpairmentProxy {
+ public:
+  ImpairmentProxy(const NetworkImpairmentParams& params, lcm::LCM* lcm)
+      : params_(params), lcm_(lcm), start_(steady_clock::now()) {
+    if (!FLAGS_log_file.empty()) {
+      log_.open(FLAGS_log_file);
+      log_ << "link,sequence,copy,event,receive_time,delivery_time,send_time"
+           << std::endl;
+    }
+  }
+
+  void AddLcmChannel(const std::string& input, const std::string& output) {
+    Link& link = AddLink("lcm:" + input);
+    link.output_channel = output;
+    const int index = links_.size() - 1;
+    lcm_->subscribe(input, &ImpairmentProxy::HandleLcm, this);
+    lcm_channels_[input] = index;
+  }
+
+  void AddUdpPort(int listen_port, int forward_port) {
+    Link& link = AddLink("udp:" + std::to_string(listen_port));
+    link.socket = socket(AF_INET, SOCK_DGRAM, 0);
+    if (link.socket < 0) throw std::runtime_error("Unable to open socket");
+    struct sockaddr_in listen_address;
+    memset(&listen_address, 0, sizeof(listen_address));
+    listen_address.sin_family = AF_INET;
+    listen_address.sin_port = htons(listen_port);
+    inet_aton(FLAGS_udp_address.c_str(), &listen_address.sin_addr);
+    if (bind(link.socket, (const struct sockaddr*)&listen_address,
+             sizeof(listen_address)) < 0) {
+      throw std::runtime_error("Unable to bind port " +
+                               std::to_string(listen_port));
+    }
+    memset(&link.forward_address, 0, sizeof(link.forward_address));
+    link.forward_address.sin_family = AF_INET;
+    link.forward_address.sin_port = htons(forward_port);
+    inet_aton(FLAGS_udp_address.c_str(), &link.forward_address.sin_addr);
+  }
+
+  void Run(double end_time) {
+    std::vector<struct pollfd> fds;
+    fds.push_back({lcm_->getFileno(), POLLIN, 0});
+    for (const auto& link : links_) {
+      if (link.socket >= 0) fds.push_back({link.socket, POLLIN, 0});
+    }
+    std::vector<uint8_t> buffer(65536);
+
+    while (end_time <= 0 || now() < end_time) {
+      // Wait for a packet, or until the next delivery (at most 100 ms, to
+      // check end_time). The timeout of ppoll is in nanoseconds, so that
+      // delayed packets are released at their delivery time instead of the
+      // next whole millisecond.
+      double timeout = 0.1;
+      if (!queue_.empty()) {
+        timeout = std::max(
+            0.0, std::min(timeout, queue_.next_delivery_time() - now()));
+      }
+      struct timespec timeout_spec = {0, std::lround(1e9 * timeout)};
+      if (ppoll(fds.data(), fds.size(), &timeout_spec, nullptr) > 0) {
+        if (fds[0].revents & POLLIN) lcm_->handleTimeout(0);
+        int fd_index = 1;
+        for (int i = 0; i < static_cast<int>(links_.size()); i++) {
+          if (links_[i].socket < 0) continue;
+          if (fds[fd_index++].revents & POLLIN) {
+            ssize_t size =
+                recv(links_[i].socket, buffer.data(), buffer.size(), 0);
+            if (size >= 0) {
+              Receive(i, std::vector<uint8_t>(buffer.begin(),
+                                              buffer.begin() + size));
+            }
+          }
+        }
+      }
+
+      DelayedPacket packet;
+      while (queue_.PopDue(now(), &packet)) {
+        Send(packet);
+      }
+    }
+  }
+
+  void PrintSummary() const {
+    for (const auto& link : links_) {
+      std::cout << link.name << ": received " << link.num_received
+                << ", dropped " << link.num_dropped << ", duplicated "
+                << link.num_duplicated << ", reordered " << link.num_reordered
+                << ", mean delay "
+                << (link.num_sent ? 1e3 * link.sum_delay / link.num_sent : 0)
+                << " ms" << std::endl;
+    }
+  }
+
+ private:
+  Link& AddLink(const std::string& name) {
+    links_.emplace_back();
+    Link& link = links_.back();
+    link.name = name;
+    // Each link has its own generator, so that its impairment doesn't depend
+    // on the traffic of the others
+    NetworkImpairmentParams params = params_;
+    std::seed_seq seed_sequence{static_cast<int>(params_.seed),
+                                static_cast<int>(links_.size())};
+    std::vector<unsigned int> seed(1);
+    seed_sequence.generate(seed.begin(), seed.end());
+    params.seed = seed[0];
+    link.impairment = std::make_unique<NetworkImpairment>(params);
+    return link;
+  }
+
+  void HandleLcm(const lcm::ReceiveBuffer* rbuf, const std::string& channel) {
+    const uint8_t* data = static_cast<const uint8_t*>(rbuf->data);
+    Receive(lcm_channels_.at(channel),
+            std::vector<uint8_t>(data, data + rbuf->data_size));
+  }
+
+  void Receive(int link_index, std::vector<uint8_t> data) {
+    Link& link = links_[link_index];
+    const double receive_time = now();
+    const int64_t sequence = link.num_received++;
+    auto delivery_times = link.impairment->Apply(receive_time);
+    if (delivery_times.empty()) {
+      link.num_dropped++;
+      Log(link, sequence, 0, "drop", receive_time, NAN, NAN);
+      return;
+    }
+    if (delivery_times.size() > 1) link.num_duplicated++;
+    for (int copy = 0; copy < static_cast<int>(delivery_times.size());
+         copy++) {
+      DelayedPacket packet;
+      packet.link = link_index;
+      packet.sequence = sequence;
+      packet.copy = copy;
+      packet.receive_time = receive_time;
+      packet.delivery_time = delivery_times[copy];
+      packet.data = data;
+      queue_.Push(std::move(packet));
+    }
+  }
+
+  void Send(const DelayedPacket& packet) {
+    Link& link = links_[packet.link];
+    if (link.socket >= 0) {
+      sendto(link.socket, packet.data.data(), packet.data.size(), 0,
+             (struct sockaddr*)&link.forward_address,
+             sizeof(link.forward_address));
+    } else {
+      lcm_->publish(link.output_channel, packet.data.data(),
+                    packet.data.size());
+    }
+    const double send_time = now();
+    std::string event = packet.copy > 0 ? "duplicate" : "deliver";
+    if (packet.sequence < link.max_sent_sequence) {
+      event = "reordered";
+      link.num_reordered++;
+    }
+    link.max_sent_sequence = std::max(link.max_sent_sequence, packet.sequence);
+    link.num_sent++;
+    link.sum_delay += send_time - packet.receive_time;
+    Log(link, packet.sequence, packet.copy, event, packet.receive_time,
+        packet.delivery_time, send_time);
+  }
+
+  void Log(const Link& link, int64_t sequence, int copy,
+           const std::string& event, double receive_time,
+           double delivery_time, double send_time) {
+    if (!log_.is_open()) return;
+    log_ << link.name << "," << sequence << "," << copy << "," << event << ","
+         << receive_time << "," << delivery_time << "," << send_time << "\n";
+  }
+
+  double now() const {
+    return duration<double>(steady_clock::now() - start_).count();
+  }
+
+  const NetworkImpairmentParams params_;
+  lcm::LCM* lcm_;
+  const steady_clock::time_point start_;
+  // Links are only added before Run(), the references to them stay valid
+  std::vector<Link> links_;
+  std::map<std::string, int> lcm_channels_;
+  DelayQueue queue_;
+  std::ofstream log_;
+};
+
+}  // namespace
+
+int do_main(int argc, char* argv[]) {
+  gflags::ParseCommandLineFlags(&argc, &argv, true);
+
+  NetworkImpairmentParams params;
+  params.delay = FLAGS_delay;
+  params.jitter = FLAGS_jitter;
+  params.jitter_distribution =
+      ParseJitterDistribution(FLAGS_jitter_distribution);
+  params.drop_probability = FLAGS_drop;
+  params.duplicate_probability = FLAGS_duplicate;
+  params.reorder_probability = FLAGS_reorder;
+  params.reorder_delay = FLAGS_reorder_delay;
+  params.keep_order = FLAGS_keep_order;
+  params.seed = FLAGS_seed;
+
+  lcm::LCM lcm(FLAGS_lcm_url);
+  if (!lcm.good()) {
+    std::cerr << "Unable to initialize LCM" << std::endl;
+    return 1;
+  }
+  auto channels = ParsePairs(FLAGS_channels);
+  auto ports = ParsePairs(FLAGS_udp);
+  if (channels.empty() && ports.empty()) {
+    std::cerr << "Nothing to relay, set --channels and/or --udp" << std::endl;
+    return 1;
+  }
+
+  ImpairmentProxy proxy(params, &lcm);
+  for (const auto& channel : channels) {
+    proxy.AddLcmChannel(channel.first, channel.second);
+  }
+  for (const auto& port : ports) {
+    proxy.AddUdpPort(std::stoi(port.first), std::stoi(port.second));
+  }
+  proxy.Run(FLAGS_end_time);
+  proxy.PrintSummary();
+
+  return 0;
+}
+
+}  // namespace dairlib
+
+int main(int argc, char* argv[]) { return dairlib::do_main(argc, argv); }
@@ -0,0 +1,110 @@
+#include "lcm/lcm_log_timing.h"
+
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "dairlib/lcmt_robot_output.hpp"
+#include "dairlib/lcmt_saved_traj.hpp"
+
+namespace dairlib {
+namespace {
+
+LogEvent Event(const std::string& channel, int64_t timestamp, int64_t utime) {
+  LogEvent event;
+  event.channel = channel;
+  event.timestamp = timestamp;
+  event.has_utime = true;
+  event.utime = utime;
+  return event;
+}
+
+GTEST_TEST(LcmLogTimingTest, DecodeUtime) {
+  lcmt_robot_output message;
+  message.utime = 1234567890123;
+  message.num_positions = 0;
+  message.num_velocities = 0;
+  message.num_efforts = 0;
+  std::vector<uint8_t> data(message.getEncodedSize());
+  message.encode(data.data(), 0, data.size());
+  int64_t utime = 0;
+  EXPECT_TRUE(DecodeUtime(data.data(), data.size(), &utime));
+  EXPECT_EQ(utime, message.utime);
+
+  // Types without a leading utime are not decoded
+  lcmt_saved_traj traj;
+  traj.num_trajectories = 0;
+  data.resize(traj.getEncodedSize());
+  traj.encode(data.data(), 0, data.size());
+  EXPECT_FALSE(DecodeUtime(data.data(), data.size(), &utime));
+}
+
+GTEST_TEST(LcmLogTimingTest, Distribution) {
+  std::vector<double> values;
+  for (int i = 1; i <= 1000; i++) values.push_back(1001 - i);
+  auto stats = CalcDistributionStats(values);
+  EXPECT_EQ(stats.count, 1000);
+  EXPECT_DOUBLE_EQ(stats.mean, 500.5);
+  EXPECT_EQ(stats.min, 1);
+  EXPECT_EQ(stats.p50, 500);
+  EXPECT_EQ(stats.p90, 900);
+  EXPECT_EQ(stats.p99, 990);
+  EXPECT_EQ(stats.p999, 999);
+  EXPECT_EQ(stats.max, 1000);
+}
+
+GTEST_TEST(LcmLogTimingTest, ChannelStats) {
+  LogTimingAnalyzer analyzer;
+  // 1 kHz, with a 5 ms gap, a repeated and an out of order message
+  std::vector<int64_t> timestamps = {100,  1100, 2100,  3100,
+                                     4100, 9100, 10100, 11100};
+  std::vector<int64_t> utimes = {0, 1000, 2000, 2000, 3000, 8000, 7000, 9000};
+  for (int i = 0; i < static_cast<int>(utimes.size()); i++) {
+    analyzer.Add(Event("STATE", timestamps[i], utimes[i]));
+  }
+  auto stats = analyzer.CalcChannelStats("STATE");
+  EXPECT_EQ(stats.count, 8);
+  EXPECT_EQ(stats.num_gaps, 1);
+  EXPECT_EQ(stats.max_gap, 5000);
+  EXPECT_EQ(stats.dt.p50, 1000);
+  EXPECT_EQ(stats.num_duplicate_utimes, 1);
+  EXPECT_EQ(stats.num_out_of_order_utimes, 1);
+  EXPECT_NEAR(stats.duration, 0.011, 1e-12);
+  EXPECT_NEAR(stats.rate, 7 / 0.011, 1e-9);
+  EXPECT_EQ(analyzer.CalcChannelStats("OTHER").count, 0);
+}
+
+GTEST_TEST(LcmLogTimingTest, Latency) {
+  LogTimingAnalyzer analyzer;
+  for (int i = 0; i < 10; i++) {
+    analyzer.Add(Event("STATE", 1000 * i, 1000 * i));
+    // Every other state gets a command, 300 us later, sent twice for i = 4
+    if (i % 2 == 0) analyzer.Add(Event("INPUT", 1000 * i + 300, 1000 * i));
+    if (i == 4) analyzer.Add(Event("INPUT", 1000 * i + 600, 1000 * i));
+  }
+  // Command computed from a state which isn't in the log
+  analyzer.Add(Event("INPUT", 20000, 15500));
+
+  auto stats = analyzer.CalcLatencyStats("STATE", "INPUT");
+  EXPECT_EQ(stats.num_matched, 5);
+  EXPECT_EQ(stats.num_repeated, 1);
+  EXPECT_EQ(stats.num_unmatched, 1);
+  EXPECT_EQ(stats.num_unanswered, 5);
+  EXPECT_EQ(stats.latency.min, 300);
+  EXPECT_EQ(stats.latency.max, 300);
+
+  std::stringstream json;
+  analyzer.WriteJson(analyzer.channels(), {{"STATE", "INPUT"}}, &json);
+  EXPECT_NE(json.str().find("\"num_matched\": 5"), std::string::npos);
+  EXPECT_NE(json.str().find("\"channel\": \"STATE\""), std::string::npos);
+}
+
+}  // namespace
+}  // namespace dairlib
+
+int main(int argc, char** argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
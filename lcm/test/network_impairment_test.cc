@@ -0,0 +1,113 @@
+#include "lcm/network_impairment.h"
+
+#include <cmath>
+
+#include <gtest/gtest.h>
+
+namespace dairlib {
+namespace {
+
+using JitterDistribution = NetworkImpairmentParams::JitterDistribution;
+
+NetworkImpairmentParams TestParams() {
+  NetworkImpairmentParams params;
+  params.delay = 0.01;
+  params.jitter = 0.002;
+  params.drop_probability = 0.1;
+  params.duplicate_probability = 0.05;
+  params.reorder_probability = 0.05;
+  params.seed = 7;
+  return params;
+}
+
+// The same seed gives the same impairment
+TEST(NetworkImpairmentTest, Deterministic) {
+  NetworkImpairment impairment1(TestParams());
+  NetworkImpairment impairment2(TestParams());
+  auto params = TestParams();
+  params.seed = 8;
+  NetworkImpairment impairment3(params);
+  bool all_equal = true;
+  for (int i = 0; i < 1000; i++) {
+    auto times1 = impairment1.Apply(i * 5e-4);
+    EXPECT_EQ(times1, impairment2.Apply(i * 5e-4));
+    all_equal = all_equal && (times1 == impairment3.Apply(i * 5e-4));
+  }
+  EXPECT_FALSE(all_equal);
+}
+
+TEST(NetworkImpairmentTest, Statistics) {
+  const int n = 20000;
+  for (auto distribution :
+       {JitterDistribution::kUniform, JitterDistribution::kGaussian,
+        JitterDistribution::kExponential}) {
+    auto params = TestParams();
+    params.reorder_probability = 0;
+    params.jitter_distribution = distribution;
+    NetworkImpairment impairment(params);
+    int num_dropped = 0;
+    int num_duplicated = 0;
+    double sum_delay = 0;
+    int num_delivered = 0;
+    for (int i = 0; i < n; i++) {
+      auto times = impairment.Apply(i);
+      num_dropped += times.empty();
+      num_duplicated += (times.size() == 2);
+      for (double time : times) {
+        EXPECT_GE(time, i);
+        sum_delay += time - i;
+        num_delivered++;
+      }
+    }
+    EXPECT_NEAR(num_dropped / static_cast<double>(n), 0.1, 0.01);
+    EXPECT_NEAR(num_duplicated / static_cast<double>(n), 0.9 * 0.05, 0.01);
+    // The exponential jitter is only positive
+    double expected_delay =
+        distribution == JitterDistribution::kExponential ? 0.012 : 0.01;
+    EXPECT_NEAR(sum_delay / num_delivered, expected_delay, 1e-4);
+  }
+}
+
+TEST(NetworkImpairmentTest, KeepOrder) {
+  auto params = TestParams();
+  params.jitter = 0.01;
+  params.keep_order = true;
+  NetworkImpairment impairment(params);
+  double last_time = 0;
+  for (int i = 0; i < 1000; i++) {
+    for (double time : impairment.Apply(i * 1e-3)) {
+      EXPECT_GE(time, last_time);
+      last_time = time;
+    }
+  }
+}
+
+TEST(NetworkImpairmentTest, DelayQueue) {
+  DelayQueue queue;
+  for (int i = 0; i < 3; i++) {
+    DelayedPacket packet;
+    packet.sequence = i;
+    packet.delivery_time = (i == 0) ? 2 : 1;
+    queue.Push(packet);
+  }
+  DelayedPacket packet;
+  EXPECT_FALSE(queue.PopDue(0.5, &packet));
+  EXPECT_EQ(queue.next_delivery_time(), 1);
+  // Packets with the same delivery time keep their order
+  ASSERT_TRUE(queue.PopDue(1, &packet));
+  EXPECT_EQ(packet.sequence, 1);
+  ASSERT_TRUE(queue.PopDue(1, &packet));
+  EXPECT_EQ(packet.sequence, 2);
+  EXPECT_FALSE(queue.PopDue(1.5, &packet));
+  ASSERT_TRUE(queue.PopDue(3, &packet));
+  EXPECT_EQ(packet.sequence, 0);
+  EXPECT_TRUE(queue.empty());
+}
+
+}  // namespace
+}  // namespace dairlib
+
+int main(int argc, char** argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,144 @@
+#include "multibody/kinematic/kinematic_projector.h"
+
+#include <algorithm>
+#include <limits>
+
+namespace dairlib {
+namespace multibody {
+
+using drake::multibody::JointIndex;
+using Eigen::MatrixXd;
+using Eigen::VectorXd;
+
+namespace {
+
+// Levenberg-Marquardt damping: initial, smallest, and largest before giving up
+constexpr double kInitialDamping = 1e-6;
+constexpr double kMinDamping = 1e-12;
+constexpr double kMaxDamping = 1e6;
+
+}  // namespace
+
+KinematicProjector::KinematicProjector(
+    const KinematicEvaluatorSet<double>& evaluators, double tolerance,
+    int max_iterations)
+    : plant_(evaluators.plant()),
+      evaluators_(evaluators),
+      context_(plant_.CreateDefaultContext()),
+      tolerance_(tolerance),
+      max_iterations_(max_iterations),
+      fixed_(plant_.num_velocities(), false),
+      limited_position_(plant_.num_velocities(), -1),
+      lower_limit_(VectorXd::Constant(
+          plant_.num_velocities(), -std::numeric_limits<double>::infinity())),
+      upper_limit_(VectorXd::Constant(
+          plant_.num_velocities(), std::numeric_limits<double>::infinity())) {
+  for (JointIndex i(0); i < plant_.num_joints(); ++i) {
+    const auto& joint = plant_.get_joint(i);
+    // Revolute and prismatic joints, whose positions and velocities match
+    if (joint.num_positions() != joint.num_velocities()) continue;
+    for (int k = 0; k < joint.num_velocities(); k++) {
+      const int v = joint.velocity_start() + k;
+      limited_position_[v] = joint.position_start() + k;
+      lower_limit_(v) = joint.position_lower_limits()(k);
+      upper_limit_(v) = joint.position_upper_limits()(k);
+    }
+  }
+  for (const auto& index : plant_.GetFloatingBaseBodies()) {
+    const auto& body = plant_.get_body(index);
+    if (body.has_quaternion_dofs()) {
+      quaternion_start_.push_back(body.floating_positions_start());
+    }
+  }
+}
+
+void KinematicProjector::FixVelocity(int index) {
+  DRAKE_DEMAND(0 <= index && index < plant_.num_velocities());
+  fixed_[index] = true;
+}
+
+void KinematicProjector::Clamp(VectorXd* q) const {
+  for (int start : quaternion_start_) {
+    q->segment(start, 4).normalize();
+  }
+  if (!joint_limits_enabled_) return;
+  for (int v = 0; v < plant_.num_velocities(); v++) {
+    const int p = limited_position_[v];
+    if (p >= 0) {
+      (*q)(p) = std::min(std::max((*q)(p), lower_limit_(v)), upper_limit_(v));
+    }
+  }
+}
+
+KinematicProjectionResult KinematicProjector::Project(const VectorXd& q_guess) {
+  DRAKE_DEMAND(q_guess.size() == plant_.num_positions());
+  const int n_v = plant_.num_velocities();
+  const int m = evaluators_.count_active();
+
+  VectorXd q = q_guess;
+  Clamp(&q);
+  plant_.SetPositions(context_.get(), q);
+  VectorXd phi = evaluators_.EvalActive(*context_);
+
+  double damping = kInitialDamping;
+  VectorXd dv(n_v);
+  VectorXd qdot(plant_.num_positions());
+  int iteration = 0;
+  while (m > 0 && iteration < max_iterations_ &&
+         phi.lpNorm<Eigen::Infinity>() > tolerance_ &&
+         damping < kMaxDamping) {
+    iteration++;
+    const MatrixXd J = evaluators_.EvalActiveJacobian(*context_);
+
+    // Minimum norm step of the free velocities. A joint at a limit that the
+    // step pushes past it is held for this step, and the step recomputed.
+    std::vector<bool> held = fixed_;
+    while (true) {
+      MatrixXd J_free = J;
+      for (int i = 0; i < n_v; i++) {
+        if (held[i]) J_free.col(i).setZero();
+      }
+      const MatrixXd JJt =
+          J_free * J_free.transpose() + damping * MatrixXd::Identity(m, m);
+      dv = -J_free.transpose() * JJt.ldlt().solve(phi);
+
+      bool changed = false;
+      if (joint_limits_enabled_) {
+        for (int i = 0; i < n_v; i++) {
+          const int p = limited_position_[i];
+          if (held[i] || p < 0) continue;
+          if ((q(p) <= lower_limit_(i) && dv(i) < 0) ||
+              (q(p) >= upper_limit_(i) && dv(i) > 0)) {
+            held[i] = true;
+            changed = true;
+          }
+        }
+      }
+      if (!changed) break;
+    }
+
+    plant_.MapVelocityToQDot(*context_, dv, &qdot);
+    VectorXd q_new = q + qdot;
+    Clamp(&q_new);
+    plant_.SetPositions(context_.get(), q_new);
+    VectorXd phi_new = evaluators_.EvalActive(*context_);
+    if (phi_new.squaredNorm() < phi.squaredNorm()) {
+      q = q_new;
+      phi = phi_new;
+      damping = std::max(damping / 10, kMinDamping);
+    } else {
+      plant_.SetPositions(context_.get(), q);
+      damping *= 10;
+    }
+  }
+
+  KinematicProjectionResult result;
+  result.q = q;
+  result.residual = phi.norm();
+  result.iterations = iteration;
+  result.success = m == 0 || phi.lpNorm<Eigen::Infinity>() <= tolerance_;
+  return result;
+}
+
+}  // namespace multibody
+}  // namespace dairlib
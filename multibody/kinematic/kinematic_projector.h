@@ -0,0 +1,72 @@
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include "multibody/kinematic/kinematic_evaluator_set.h"
+
+namespace dairlib {
+namespace multibody {
+
+struct KinematicProjectionResult {
+  Eigen::VectorXd q;
+  /// Norm of phi(q) at the returned configuration
+  double residual;
+  int iterations;
+  bool success;
+};
+
+/// Projects configurations onto the manifold phi(q) = 0 of the active rows
+/// of a KinematicEvaluatorSet (e.g. the Cassie four-bar loop closures), with
+/// damped Gauss-Newton (Levenberg-Marquardt) steps
+///   dv = -J' (J J' + mu I)^-1 phi
+/// which are the minimum norm corrections, so the result stays close to the
+/// guess. Joint limits are respected by clamping, and the joints at a limit
+/// that a step would push past it are removed from that step (active set).
+///
+/// Unlike a MultibodyProgram with a KinematicPositionConstraint, there is no
+/// NLP solver involved, so a projection takes a few evaluations of phi and J
+/// and is usable in loop or to repair many initial guesses.
+/// Not thread safe, as the projector owns the context it evaluates with.
+class KinematicProjector {
+ public:
+  /// @param evaluators the constraints, which must outlive the projector
+  /// @param tolerance maximum absolute value of phi at a solution
+  /// @param max_iterations
+  explicit KinematicProjector(const KinematicEvaluatorSet<double>& evaluators,
+                              double tolerance = 1e-10,
+                              int max_iterations = 20);
+
+  /// Keeps a velocity (and its position, e.g. the floating base) unchanged
+  /// by the projection
+  void FixVelocity(int index);
+
+  /// Enables or disables the joint limits (enabled by default)
+  void set_joint_limits_enabled(bool enabled) {
+    joint_limits_enabled_ = enabled;
+  }
+
+  KinematicProjectionResult Project(const Eigen::VectorXd& q_guess);
+
+ private:
+  // Clamps the limited positions, and normalizes the quaternions
+  void Clamp(Eigen::VectorXd* q) const;
+
+  const drake::multibody::MultibodyPlant<double>& plant_;
+  const KinematicEvaluatorSet<double>& evaluators_;
+  std::unique_ptr<drake::systems::Context<double>> context_;
+  const double tolerance_;
+  const int max_iterations_;
+  bool joint_limits_enabled_ = true;
+  std::vector<bool> fixed_;
+  // Position of each velocity of a joint with limits (-1 if none), and its
+  // limits
+  std::vector<int> limited_position_;
+  Eigen::VectorXd lower_limit_;
+  Eigen::VectorXd upper_limit_;
+  // First position of each quaternion floating base
+  std::vector<int> quaternion_start_;
+};
+
+}  // namespace multibody
+}  // namespace dairlib
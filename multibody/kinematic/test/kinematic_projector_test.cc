@@ -0,0 +1,98 @@
+#include <memory>
+
+#include <gtest/gtest.h>
+
+#include "examples/Cassie/cassie_utils.h"
+#include "multibody/kinematic/kinematic_projector.h"
+#include "multibody/multibody_utils.h"
+
+#include "drake/multibody/plant/multibody_plant.h"
+
+namespace dairlib {
+namespace multibody {
+namespace {
+
+using drake::multibody::MultibodyPlant;
+using Eigen::VectorXd;
+
+class KinematicProjectorTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    plant_ = std::make_unique<MultibodyPlant<double>>(0.0);
+    addCassieMultibody(plant_.get(), nullptr, true,
+                       "examples/Cassie/urdf/cassie_fixed_springs.urdf",
+                       false, false);
+    plant_->Finalize();
+
+    left_loop_ = std::make_unique<DistanceEvaluator<double>>(
+        LeftLoopClosureEvaluator(*plant_));
+    right_loop_ = std::make_unique<DistanceEvaluator<double>>(
+        RightLoopClosureEvaluator(*plant_));
+    evaluators_ = std::make_unique<KinematicEvaluatorSet<double>>(*plant_);
+    evaluators_->add_evaluator(left_loop_.get());
+    evaluators_->add_evaluator(right_loop_.get());
+
+    // Perturbed neutral standing pose, which violates the four-bar closures
+    auto positions_map = makeNameToPositionsMap(*plant_);
+    std::srand(0);
+    q_guess_ = VectorXd::Zero(plant_->num_positions());
+    q_guess_(positions_map.at("base_qw")) = 1;
+    q_guess_(positions_map.at("base_z")) = 1;
+    for (const std::string side : {"_left", "_right"}) {
+      q_guess_(positions_map.at("hip_pitch" + side)) = 1;
+      q_guess_(positions_map.at("knee" + side)) = -2;
+      q_guess_(positions_map.at("ankle_joint" + side)) = 2;
+      q_guess_(positions_map.at("toe" + side)) = -2;
+    }
+    q_guess_.tail(plant_->num_positions() - 7) +=
+        0.05 * VectorXd::Random(plant_->num_positions() - 7);
+  }
+
+  std::unique_ptr<MultibodyPlant<double>> plant_;
+  std::unique_ptr<DistanceEvaluator<double>> left_loop_;
+  std::unique_ptr<DistanceEvaluator<double>> right_loop_;
+  std::unique_ptr<KinematicEvaluatorSet<double>> evaluators_;
+  VectorXd q_guess_;
+};
+
+TEST_F(KinematicProjectorTest, LoopClosure) {
+  KinematicProjector projector(*evaluators_);
+  const auto result = projector.Project(q_guess_);
+  ASSERT_TRUE(result.success);
+  EXPECT_LE(result.iterations, 10);
+
+  auto context = plant_->CreateDefaultContext();
+  plant_->SetPositions(context.get(), result.q);
+  EXPECT_LT(evaluators_->EvalActive(*context).lpNorm<Eigen::Infinity>(),
+            1e-10);
+  // The loop closures don't involve the floating base
+  EXPECT_TRUE(result.q.head(7).isApprox(q_guess_.head(7)));
+  EXPECT_TRUE((result.q.array() >=
+               plant_->GetPositionLowerLimits().array()).all());
+  EXPECT_TRUE((result.q.array() <=
+               plant_->GetPositionUpperLimits().array()).all());
+}
+
+TEST_F(KinematicProjectorTest, FixedVelocity) {
+  // With the knees held, the closures are satisfied by the other joints
+  auto positions_map = makeNameToPositionsMap(*plant_);
+  auto velocities_map = makeNameToVelocitiesMap(*plant_);
+  KinematicProjector projector(*evaluators_);
+  projector.FixVelocity(velocities_map.at("knee_leftdot"));
+  projector.FixVelocity(velocities_map.at("knee_rightdot"));
+  const auto result = projector.Project(q_guess_);
+  ASSERT_TRUE(result.success);
+  for (const std::string name : {"knee_left", "knee_right"}) {
+    EXPECT_EQ(result.q(positions_map.at(name)),
+              q_guess_(positions_map.at(name)));
+  }
+}
+
+}  // namespace
+}  // namespace multibody
+}  // namespace dairlib
+
+int main(int argc, char** argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
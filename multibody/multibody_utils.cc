@@ -258,6 +258,29 @@ bool JointsWithinLimits(const MultibodyPlant<double>& plant,
 }
 
 
+template <typename T>
+Eigen::MatrixXd CreateStateMap(const MultibodyPlant<T>& plant_from,
+                               const MultibodyPlant<T>& plant_to) {
+  const int n_q_from = plant_from.num_positions();
+  const int n_q_to = plant_to.num_positions();
+  Eigen::MatrixXd map = Eigen::MatrixXd::Zero(
+      n_q_to + plant_to.num_velocities(),
+      n_q_from + plant_from.num_velocities());
+  auto positions_from = makeNameToPositionsMap(plant_from);
+  for (const auto& name_and_index : makeNameToPositionsMap(plant_to)) {
+    auto it = positions_from.find(name_and_index.first);
+    if (it != positions_from.end()) map(name_and_index.second, it->second) = 1;
+  }
+  auto velocities_from = makeNameToVelocitiesMap(plant_from);
+  for (const auto& name_and_index : makeNameToVelocitiesMap(plant_to)) {
+    auto it = velocities_from.find(name_and_index.first);
+    if (it != velocities_from.end()) {
+      map(n_q_to + name_and_index.second, n_q_from + it->second) = 1;
+    }
+  }
+  return map;
+}
+
 template <typename T>
 bool isQuaternion(const MultibodyPlant<T>& plant) {
   auto unordered_index_set = plant.GetFloatingBaseBodies();
@@ -279,6 +302,8 @@ template map<string, int> makeNameToVelocitiesMap<double>(const MultibodyPlant<d
 template map<string, int> makeNameToVelocitiesMap<AutoDiffXd>(const MultibodyPlant<AutoDiffXd>& plant);  // NOLINT
 template map<string, int> makeNameToActuatorsMap<double>(const MultibodyPlant<double>& plant);  // NOLINT
 template map<string, int> makeNameToActuatorsMap<AutoDiffXd>(const MultibodyPlant<AutoDiffXd>& plant);  // NOLINT
+template Eigen::MatrixXd CreateStateMap(const MultibodyPlant<double>& plant_from, const MultibodyPlant<double>& plant_to);  // NOLINT
+template Eigen::MatrixXd CreateStateMap(const MultibodyPlant<AutoDiffXd>& plant_from, const MultibodyPlant<AutoDiffXd>& plant_to);  // NOLINT
 template void addFlatTerrain<double>(MultibodyPlant<double>* plant, SceneGraph<double>* scene_graph, double mu_static, double mu_kinetic, Eigen::Vector3d normal_W);   // NOLINT
 template VectorX<double> getInput(const MultibodyPlant<double>& plant, const Context<double>& context);  // NOLINT
 template VectorX<AutoDiffXd> getInput(const MultibodyPlant<AutoDiffXd>& plant, const Context<AutoDiffXd>& context);  // NOLINT
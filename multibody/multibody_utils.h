@@ -50,6 +50,15 @@ template <typename T>
 std::map<std::string, int> makeNameToActuatorsMap(
     const drake::multibody::MultibodyPlant<T>& plant);
 
+/// Builds the matrix mapping the state of plant_from to the state of plant_to,
+/// by position and velocity names. The positions and velocities of plant_to
+/// which are not in plant_from (e.g. the spring joints, for a model with fixed
+/// springs) are set to zero.
+template <typename T>
+Eigen::MatrixXd CreateStateMap(
+    const drake::multibody::MultibodyPlant<T>& plant_from,
+    const drake::multibody::MultibodyPlant<T>& plant_to);
+
 // TODO: The following two functions need to be implemented as a part of
 // RBT/Multibody and not as separate functions that take in RBTs. Make the
 // change once the codebase shifts to using multibody.
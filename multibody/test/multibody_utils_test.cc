@@ -58,6 +58,42 @@ TEST_F(MultibodyUtilsTest, ContextTest) {
   EXPECT_EQ(u, u_context);
 }
 
+// The state of a model with fixed springs maps to the state of the model with
+// springs, by name, with zero spring deflections
+TEST_F(MultibodyUtilsTest, StateMapTest) {
+  drake::geometry::SceneGraph<double> scene_graph;
+  MultibodyPlant<double> plant_fixed_springs(0.0);
+  Parser parser(&plant_fixed_springs, &scene_graph);
+  parser.AddModelFromFile(FindResourceOrThrow(
+      "examples/Cassie/urdf/cassie_fixed_springs.urdf"));
+  plant_fixed_springs.Finalize();
+
+  Eigen::MatrixXd map = CreateStateMap(plant_fixed_springs, plant_);
+  const int n_q = plant_fixed_springs.num_positions();
+  VectorXd x = VectorXd::LinSpaced(
+      n_q + plant_fixed_springs.num_velocities(), 1, 2);
+  VectorXd x_springs = map * x;
+  ASSERT_EQ(x_springs.size(), plant_.num_positions() + plant_.num_velocities());
+
+  auto positions = makeNameToPositionsMap(plant_fixed_springs);
+  auto velocities = makeNameToVelocitiesMap(plant_fixed_springs);
+  auto positions_springs = makeNameToPositionsMap(plant_);
+  auto velocities_springs = makeNameToVelocitiesMap(plant_);
+  for (const auto& name_and_index : positions) {
+    EXPECT_EQ(x_springs(positions_springs.at(name_and_index.first)),
+              x(name_and_index.second));
+  }
+  for (const auto& name_and_index : velocities) {
+    EXPECT_EQ(x_springs(plant_.num_positions() +
+                        velocities_springs.at(name_and_index.first)),
+              x(n_q + name_and_index.second));
+  }
+  EXPECT_EQ(x_springs(positions_springs.at("knee_joint_left")), 0);
+  EXPECT_EQ(x_springs(plant_.num_positions() +
+                      velocities_springs.at("ankle_spring_joint_rightdot")),
+            0);
+}
+
 }  // namespace
 }  // namespace multibody
 }  // namespace dairlib
@@ -0,0 +1,324 @@
+#include "solvers/kkt_polish.h"
+
+#include <algorithm>
+#include <cmath>
+#include <memory>
+#include <vector>
+
+#include <Eigen/Sparse>
+
+#include "drake/math/autodiff.h"
+#include "drake/math/autodiff_gradient.h"
+
+namespace dairlib {
+namespace solvers {
+
+using drake::AutoDiffVecXd;
+using drake::math::autoDiffToGradientMatrix;
+using drake::math::autoDiffToValueMatrix;
+using drake::math::initializeAutoDiff;
+using drake::solvers::EvaluatorBase;
+using drake::solvers::LinearConstraint;
+using drake::solvers::LinearCost;
+using drake::solvers::MathematicalProgram;
+using drake::solvers::VectorXDecisionVariable;
+using Eigen::MatrixXd;
+using Eigen::VectorXd;
+using std::vector;
+
+namespace {
+
+using Triplets = vector<Eigen::Triplet<double>>;
+
+// Cost or constraint of the program, with the indices of its variables
+struct Evaluator {
+  std::shared_ptr<EvaluatorBase> evaluator;
+  vector<int> vars;
+  // Whether its second derivatives vanish
+  bool linear;
+  // Bounds of a constraint
+  VectorXd lb;
+  VectorXd ub;
+};
+
+struct ActiveRow {
+  // Constraint and row within it
+  int constraint;
+  int row;
+  double bound;
+  // -1 at a lower bound, 1 at an upper bound, 0 for an equality
+  int side;
+};
+
+VectorXd Gather(const VectorXd& x, const vector<int>& vars) {
+  VectorXd x_b(vars.size());
+  for (int i = 0; i < x_b.size(); i++) x_b(i) = x(vars[i]);
+  return x_b;
+}
+
+void EvalWithJacobian(const EvaluatorBase& evaluator, const VectorXd& x_b,
+                      VectorXd* y, MatrixXd* dy_dx) {
+  AutoDiffVecXd y_val;
+  evaluator.Eval(initializeAutoDiff(x_b), &y_val);
+  *y = autoDiffToValueMatrix(y_val);
+  *dy_dx = autoDiffToGradientMatrix(y_val, x_b.size());
+}
+
+// Adds the Hessian of w' f(x), by central differences of the Jacobian of f
+// at x. The Jacobians may themselves be forward differences (as in
+// NonlinearConstraint<double>), so the step is relative and much larger
+// than theirs, and the truncation error of central differences stays small.
+void AddHessian(const Evaluator& e, const VectorXd& x, const VectorXd& w,
+                double step, Triplets* H) {
+  const int n = e.vars.size();
+  VectorXd x_b = Gather(x, e.vars);
+  VectorXd y;
+  MatrixXd J_plus;
+  MatrixXd J_minus;
+  MatrixXd hessian(n, n);
+  for (int j = 0; j < n; j++) {
+    const double x_j = x_b(j);
+    const double h = step * std::max(1.0, std::abs(x_j));
+    x_b(j) = x_j + h;
+    EvalWithJacobian(*e.evaluator, x_b, &y, &J_plus);
+    x_b(j) = x_j - h;
+    EvalWithJacobian(*e.evaluator, x_b, &y, &J_minus);
+    x_b(j) = x_j;
+    hessian.col(j) = (J_plus - J_minus).transpose() * w / (2 * h);
+  }
+  hessian = 0.5 * (hessian + hessian.transpose()).eval();
+  for (int i = 0; i < n; i++) {
+    for (int j = 0; j < n; j++) {
+      if (hessian(i, j) != 0) {
+        H->emplace_back(e.vars[i], e.vars[j], hessian(i, j));
+      }
+    }
+  }
+}
+
+// Solves [H A'; A -delta I] [dx; lambda] = [-g; -c] with a sparse LU
+bool SolveKkt(const Triplets& H, const Triplets& A, const VectorXd& g,
+              const VectorXd& c, double delta, VectorXd* dx,
+              VectorXd* lambda) {
+  const int n = g.size();
+  const int m = c.size();
+  Triplets K = H;
+  for (const auto& t : A) {
+    K.emplace_back(n + t.row(), t.col(), t.value());
+    K.emplace_back(t.col(), n + t.row(), t.value());
+  }
+  for (int i = 0; i < m; i++) K.emplace_back(n + i, n + i, -delta);
+  // Duplicate entries are summed
+  Eigen::SparseMatrix<double> M(n + m, n + m);
+  M.setFromTriplets(K.begin(), K.end());
+
+  Eigen::SparseLU<Eigen::SparseMatrix<double>> lu;
+  lu.compute(M);
+  if (lu.info() != Eigen::Success) return false;
+  VectorXd rhs(n + m);
+  rhs << -g, -c;
+  const VectorXd solution = lu.solve(rhs);
+  if (lu.info() != Eigen::Success || !solution.allFinite()) return false;
+  *dx = solution.head(n);
+  *lambda = solution.tail(m);
+  return true;
+}
+
+}  // namespace
+
+KktPolishResult PolishKktSolution(const MathematicalProgram& prog,
+                                  const VectorXd& x,
+                                  const KktPolishOptions& options) {
+  const int n = prog.num_vars();
+  auto indices = [&prog](const VectorXDecisionVariable& vars) {
+    vector<int> ret(vars.size());
+    for (int i = 0; i < vars.size(); i++) {
+      ret[i] = prog.FindDecisionVariableIndex(vars(i));
+    }
+    return ret;
+  };
+  vector<Evaluator> costs;
+  for (const auto& binding : prog.GetAllCosts()) {
+    costs.push_back(
+        {binding.evaluator(), indices(binding.variables()),
+         dynamic_cast<const LinearCost*>(binding.evaluator().get()) !=
+             nullptr});
+  }
+  // Includes the bounding boxes, each of their rows being a constraint
+  vector<Evaluator> constraints;
+  vector<int> row_start;
+  int num_rows = 0;
+  for (const auto& binding : prog.GetAllConstraints()) {
+    constraints.push_back(
+        {binding.evaluator(), indices(binding.variables()),
+         dynamic_cast<const LinearConstraint*>(binding.evaluator().get()) !=
+             nullptr,
+         binding.evaluator()->lower_bound(),
+         binding.evaluator()->upper_bound()});
+    row_start.push_back(num_rows);
+    num_rows += binding.evaluator()->num_constraints();
+  }
+
+  KktPolishResult result;
+  result.x = x;
+  result.lambda = VectorXd::Zero(num_rows);
+
+  vector<VectorXd> y(constraints.size());
+  vector<MatrixXd> J(constraints.size());
+  auto linearize_constraints = [&]() {
+    for (size_t i = 0; i < constraints.size(); i++) {
+      EvalWithJacobian(*constraints[i].evaluator,
+                       Gather(result.x, constraints[i].vars), &y[i], &J[i]);
+    }
+  };
+  linearize_constraints();
+
+  // Active set of the loose solution
+  vector<ActiveRow> active;
+  vector<bool> is_active(num_rows, false);
+  for (size_t i = 0; i < constraints.size(); i++) {
+    const VectorXd& lb = constraints[i].lb;
+    const VectorXd& ub = constraints[i].ub;
+    for (int r = 0; r < lb.size(); r++) {
+      const double to_lb = y[i](r) - lb(r);
+      const double to_ub = ub(r) - y[i](r);
+      if (lb(r) == ub(r)) {
+        active.push_back({static_cast<int>(i), r, lb(r), 0});
+      } else if (std::min(to_lb, to_ub) <= options.active_tolerance) {
+        if (to_lb <= to_ub) {
+          active.push_back({static_cast<int>(i), r, lb(r), -1});
+        } else {
+          active.push_back({static_cast<int>(i), r, ub(r), 1});
+        }
+      } else {
+        continue;
+      }
+      is_active[row_start[i] + r] = true;
+    }
+  }
+  const int m = active.size();
+  result.num_active = m;
+
+  VectorXd lambda = VectorXd::Zero(m);
+  vector<MatrixXd> cost_J(costs.size());
+  for (int iteration = 0;; iteration++) {
+    double cost = 0;
+    VectorXd g = VectorXd::Zero(n);
+    for (size_t i = 0; i < costs.size(); i++) {
+      VectorXd f;
+      EvalWithJacobian(*costs[i].evaluator, Gather(result.x, costs[i].vars),
+                       &f, &cost_J[i]);
+      cost += f(0);
+      for (size_t j = 0; j < costs[i].vars.size(); j++) {
+        g(costs[i].vars[j]) += cost_J[i](0, j);
+      }
+    }
+
+    Triplets A;
+    VectorXd c(m);
+    for (int k = 0; k < m; k++) {
+      const ActiveRow& row = active[k];
+      const Evaluator& e = constraints[row.constraint];
+      c(k) = y[row.constraint](row.row) - row.bound;
+      for (size_t j = 0; j < e.vars.size(); j++) {
+        const double a = J[row.constraint](row.row, j);
+        if (a != 0) A.emplace_back(k, e.vars[j], a);
+      }
+    }
+
+    // The inactive rows, strictly inside their bounds at the loose solution,
+    // must stay feasible
+    double inactive_violation = 0;
+    for (size_t i = 0; i < constraints.size(); i++) {
+      const VectorXd& lb = constraints[i].lb;
+      const VectorXd& ub = constraints[i].ub;
+      for (int r = 0; r < lb.size(); r++) {
+        if (is_active[row_start[i] + r]) continue;
+        inactive_violation = std::max(
+            {inactive_violation, lb(r) - y[i](r), y[i](r) - ub(r)});
+      }
+    }
+    if (inactive_violation > options.feasibility_tolerance) {
+      result.status = KktPolishResult::Status::kActiveSetChanged;
+      break;
+    }
+
+    VectorXd dx;
+    if (iteration == 0) {
+      // Least squares multipliers, min |g + A' lambda|
+      Triplets I;
+      for (int i = 0; i < n; i++) I.emplace_back(i, i, 1);
+      if (!SolveKkt(I, A, g, VectorXd::Zero(m), options.dual_regularization,
+                    &dx, &lambda)) {
+        break;
+      }
+    }
+
+    VectorXd gradient_lagrangian = g;
+    for (const auto& t : A) {
+      gradient_lagrangian(t.col()) += t.value() * lambda(t.row());
+    }
+    result.cost = cost;
+    result.iterations = iteration;
+    result.constraint_violation =
+        m > 0 ? c.lpNorm<Eigen::Infinity>() : 0;
+    result.stationarity = gradient_lagrangian.lpNorm<Eigen::Infinity>();
+    const double optimality_scale =
+        std::max(1.0, n > 0 ? g.lpNorm<Eigen::Infinity>() : 0);
+    if (result.constraint_violation <= options.feasibility_tolerance &&
+        result.stationarity <=
+            options.optimality_tolerance * optimality_scale) {
+      result.status = KktPolishResult::Status::kConverged;
+      for (int k = 0; k < m; k++) {
+        if (active[k].side * lambda(k) <
+            -options.optimality_tolerance * optimality_scale) {
+          result.status = KktPolishResult::Status::kActiveSetChanged;
+        }
+      }
+      break;
+    }
+    if (iteration == options.max_iterations) break;
+
+    // Hessian of the Lagrangian
+    Triplets H;
+    for (size_t i = 0; i < costs.size(); i++) {
+      if (!costs[i].linear) {
+        AddHessian(costs[i], result.x, VectorXd::Ones(1),
+                   options.finite_difference_step, &H);
+      }
+    }
+    vector<VectorXd> weights(constraints.size());
+    for (int k = 0; k < m; k++) {
+      const ActiveRow& row = active[k];
+      if (constraints[row.constraint].linear) continue;
+      VectorXd& w = weights[row.constraint];
+      if (w.size() == 0) w = VectorXd::Zero(y[row.constraint].size());
+      w(row.row) = lambda(k);
+    }
+    for (size_t i = 0; i < constraints.size(); i++) {
+      if (weights[i].size() > 0 && !weights[i].isZero()) {
+        AddHessian(constraints[i], result.x, weights[i],
+                   options.finite_difference_step, &H);
+      }
+    }
+    // Variables outside of the active constraints and without curvature
+    // would make the KKT matrix singular; the step leaves them in place
+    for (int i = 0; i < n; i++) {
+      H.emplace_back(i, i, options.dual_regularization);
+    }
+
+    if (!SolveKkt(H, A, g, c, options.dual_regularization, &dx, &lambda)) {
+      break;
+    }
+    result.x += dx;
+    linearize_constraints();
+  }
+
+  for (int k = 0; k < m; k++) {
+    result.lambda(row_start[active[k].constraint] + active[k].row) = lambda(k);
+  }
+  return result;
+}
+
+}  // namespace solvers
+}  // namespace dairlib
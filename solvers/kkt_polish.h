@@ -0,0 +1,74 @@
+#pragma once
+
+#include "drake/solvers/mathematical_program.h"
+
+namespace dairlib {
+namespace solvers {
+
+struct KktPolishOptions {
+  /// Distance to its bound under which an inequality constraint (or a
+  /// bounding box) is in the active set, typically a bit more than the
+  /// tolerance of the loose solve
+  double active_tolerance = 1e-4;
+  /// Maximum constraint violation at a solution
+  double feasibility_tolerance = 1e-10;
+  /// Maximum norm of the gradient of the Lagrangian at a solution, relative
+  /// to the cost gradient (and at least 1)
+  double optimality_tolerance = 1e-8;
+  int max_iterations = 10;
+  /// Regularization of the constraint block of the KKT matrix, which keeps
+  /// it nonsingular with redundant active constraints
+  double dual_regularization = 1e-12;
+  /// Step (relative to the variables, and at least absolute) of the central
+  /// differences of the Jacobians giving the Hessian. Jacobians by forward
+  /// differences, as in NonlinearConstraint<double> (step 1e-8), are only
+  /// accurate to about 1e-8, so the step should be about the square root of
+  /// theirs.
+  double finite_difference_step = 1e-4;
+};
+
+struct KktPolishResult {
+  enum class Status {
+    kConverged,
+    /// An inactive constraint got violated, or an active inequality got a
+    /// multiplier of the wrong sign: the NLP solver should take over
+    kActiveSetChanged,
+    /// Iteration limit, or singular KKT matrix
+    kNotConverged
+  };
+
+  Status status = Status::kNotConverged;
+  Eigen::VectorXd x;
+  /// Multipliers of the constraint rows, in the order of GetAllConstraints()
+  /// as in LinearizeConstraints (positive at an upper bound, negative at a
+  /// lower bound, zero if inactive)
+  Eigen::VectorXd lambda;
+  double cost = 0;
+  double constraint_violation = 0;
+  double stationarity = 0;
+  int iterations = 0;
+  int num_active = 0;
+
+  bool is_success() const { return status == Status::kConverged; }
+};
+
+/// Refines a loosely converged solution of prog, e.g. from SNOPT with large
+/// major tolerances, to high accuracy.
+/// The active set is read off x (equality constraints, and the inequality
+/// rows within active_tolerance of a bound), then fixed: each iteration is a
+/// Newton step on the KKT conditions of the equality constrained problem
+///   [H  A'] [dx    ]   [-g]
+///   [A  0 ] [lambda] = [-c]
+/// where H is the Hessian of the Lagrangian (by central differences of the
+/// Jacobians, binding by binding), A the Jacobian of the active rows and c
+/// their distance to the bound. Convergence is quadratic, so a few steps
+/// replace the slow terminal phase of the NLP solver.
+///
+/// If the active set guess turns out wrong, the result is kActiveSetChanged
+/// and the caller should fall back to the NLP solver, warm started from x.
+KktPolishResult PolishKktSolution(
+    const drake::solvers::MathematicalProgram& prog, const Eigen::VectorXd& x,
+    const KktPolishOptions& options = KktPolishOptions());
+
+}  // namespace solvers
+}  // namespace dairlib
@@ -0,0 +1,124 @@
+#include "solvers/lazy_constraints.h"
+
+#include <algorithm>
+#include <limits>
+
+#include "drake/solvers/solve.h"
+
+namespace dairlib {
+namespace solvers {
+
+using drake::solvers::Binding;
+using drake::solvers::BoundingBoxConstraint;
+using drake::solvers::Constraint;
+using drake::solvers::MathematicalProgram;
+using drake::solvers::MathematicalProgramResult;
+using drake::solvers::SolutionResult;
+using Eigen::VectorXd;
+using std::vector;
+
+namespace {
+
+// Largest violation of the bounds of a constraint at x (negative inside the
+// bounds)
+double Violation(const MathematicalProgram& prog,
+                 const Binding<Constraint>& binding, const VectorXd& x) {
+  const VectorXd y = prog.EvalBinding(binding, x);
+  const auto& c = binding.evaluator();
+  double violation = -std::numeric_limits<double>::infinity();
+  for (int i = 0; i < y.size(); i++) {
+    violation = std::max({violation, c->lower_bound()(i) - y(i),
+                          y(i) - c->upper_bound()(i)});
+  }
+  return violation;
+}
+
+}  // namespace
+
+bool IsInequalityConstraint(const Binding<Constraint>& binding) {
+  const auto& c = binding.evaluator();
+  if (dynamic_cast<const BoundingBoxConstraint*>(c.get())) return false;
+  return c->num_constraints() > 0 &&
+         (c->lower_bound().array() < c->upper_bound().array()).all();
+}
+
+MathematicalProgramResult SolveWithLazyConstraints(
+    const MathematicalProgram& prog, const VectorXd& initial_guess,
+    const LazyConstraintOptions& options, LazyConstraintStatistics* statistics,
+    const std::function<bool(const Binding<Constraint>&)>& is_lazy) {
+  LazyConstraintStatistics local_statistics;
+  if (!statistics) statistics = &local_statistics;
+  *statistics = LazyConstraintStatistics();
+
+  vector<Binding<Constraint>> required;
+  vector<Binding<Constraint>> lazy;
+  for (const auto& binding : prog.GetAllConstraints()) {
+    if (is_lazy(binding)) {
+      lazy.push_back(binding);
+    } else {
+      required.push_back(binding);
+    }
+  }
+  statistics->num_lazy_constraints_total = lazy.size();
+
+  // Seed set
+  vector<bool> added(lazy.size(), false);
+  for (size_t i = 0; i < lazy.size(); i++) {
+    added[i] = Violation(prog, lazy[i], initial_guess) > -options.seed_margin;
+  }
+
+  MathematicalProgramResult result;
+  VectorXd x = initial_guess;
+  while (true) {
+    MathematicalProgram round_prog;
+    round_prog.AddDecisionVariables(prog.decision_variables());
+    for (const auto& scaling : prog.GetVariableScaling()) {
+      round_prog.SetVariableScaling(prog.decision_variable(scaling.first),
+                                    scaling.second);
+    }
+    for (const auto& binding : prog.GetAllCosts()) {
+      round_prog.AddCost(binding);
+    }
+    int num_rows = 0;
+    for (const auto& binding : required) {
+      round_prog.AddConstraint(binding);
+      num_rows += binding.evaluator()->num_constraints();
+    }
+    int num_lazy = 0;
+    for (size_t i = 0; i < lazy.size(); i++) {
+      if (added[i]) {
+        round_prog.AddConstraint(lazy[i]);
+        num_rows += lazy[i].evaluator()->num_constraints();
+        num_lazy++;
+      }
+    }
+    statistics->rounds++;
+    statistics->num_lazy_constraints.push_back(num_lazy);
+    statistics->num_constraint_rows.push_back(num_rows);
+
+    result = drake::solvers::Solve(round_prog, x, prog.solver_options());
+    x = result.get_x_val();
+
+    int num_violated = 0;
+    for (size_t i = 0; i < lazy.size(); i++) {
+      if (!added[i] &&
+          Violation(prog, lazy[i], x) > options.violation_tolerance) {
+        added[i] = true;
+        num_violated++;
+      }
+    }
+    if (num_violated == 0) {
+      statistics->converged = true;
+      break;
+    }
+    if (statistics->rounds == options.max_rounds) {
+      // The solution violates constraints of prog
+      result.set_solution_result(SolutionResult::kIterationLimit);
+      break;
+    }
+  }
+  return result;
+}
+
+}  // namespace solvers
+}  // namespace dairlib
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <functional>
+#include <vector>
+
+#include "drake/solvers/mathematical_program.h"
+#include "drake/solvers/mathematical_program_result.h"
+
+namespace dairlib {
+namespace solvers {
+
+struct LazyConstraintOptions {
+  /// Violation above which a constraint left out of the program is added
+  double violation_tolerance = 1e-6;
+  /// The lazy constraints violated, or within this distance of a bound, at
+  /// the initial guess are part of the first program
+  double seed_margin = 0;
+  int max_rounds = 20;
+};
+
+struct LazyConstraintStatistics {
+  /// Number of solves
+  int rounds = 0;
+  /// Number of lazy constraints (bindings) of the program of each round, and
+  /// total number of constraint rows of that program
+  std::vector<int> num_lazy_constraints;
+  std::vector<int> num_constraint_rows;
+  /// Number of lazy constraints of the full program
+  int num_lazy_constraints_total = 0;
+  /// Whether the last solution satisfies all the lazy constraints
+  bool converged = false;
+};
+
+/// Whether all the rows of a constraint are inequalities (e.g. friction cones
+/// or linear inequalities), the default lazy constraints. Bounding boxes are
+/// excluded: they are cheap variable bounds for the solver rather than
+/// constraint rows, and some keep the program well posed (e.g. the positive
+/// timesteps of HybridDircon).
+bool IsInequalityConstraint(
+    const drake::solvers::Binding<drake::solvers::Constraint>& binding);
+
+/// Solves prog by constraint screening: the first program has all the costs
+/// and the constraints for which is_lazy is false (dynamics, kinematic
+/// equalities, ...), plus the lazy constraints violated at the initial guess.
+/// Each round adds the lazy constraints violated by the solution and
+/// re-solves from it, until none is violated. Lazy constraints are never
+/// removed, so the rounds terminate. If lazy constraints are still violated
+/// after options.max_rounds, the result is a kIterationLimit failure.
+///
+/// The programs of the rounds share the decision variables of prog, so the
+/// returned result can be queried with them (GetSolution, and e.g.
+/// HybridDircon::GetStateSamples). They use the solver options and variable
+/// scaling of prog, but not its visualization callbacks.
+drake::solvers::MathematicalProgramResult SolveWithLazyConstraints(
+    const drake::solvers::MathematicalProgram& prog,
+    const Eigen::VectorXd& initial_guess,
+    const LazyConstraintOptions& options = LazyConstraintOptions(),
+    LazyConstraintStatistics* statistics = nullptr,
+    const std::function<bool(
+        const drake::solvers::Binding<drake::solvers::Constraint>&)>&
+        is_lazy = IsInequalityConstraint);
+
+}  // namespace solvers
+}  // namespace dairlib
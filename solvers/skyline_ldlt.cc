@@ -0,0 +1,147 @@
+#include "solvers/skyline_ldlt.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "drake/common/drake_assert.h"
+
+using Eigen::MatrixXd;
+using Eigen::VectorXd;
+using std::vector;
+
+namespace dairlib {
+namespace solvers {
+
+BorderedSkylineLdlt::BorderedSkylineLdlt(const vector<int>& first_column,
+                                         int num_border)
+    : n_(first_column.size()),
+      m_(num_border),
+      f_(first_column),
+      row_start_(n_ + 1, 0),
+      d_(n_),
+      B_(n_, m_),
+      C_(m_, m_) {
+  for (int i = 0; i < n_; i++) {
+    DRAKE_DEMAND(0 <= f_[i] && f_[i] <= i);
+    row_start_[i + 1] = row_start_[i] + i - f_[i] + 1;
+  }
+  values_.resize(row_start_[n_]);
+  SetZero();
+}
+
+void BorderedSkylineLdlt::SetZero() {
+  std::fill(values_.begin(), values_.end(), 0);
+  B_.setZero();
+  C_.setZero();
+}
+
+void BorderedSkylineLdlt::Add(int i, int j, double value) {
+  if (i < j) std::swap(i, j);
+  DRAKE_ASSERT(0 <= j && i < size());
+  if (i >= n_ && j >= n_) {
+    C_(i - n_, j - n_) += value;
+    if (i != j) C_(j - n_, i - n_) += value;
+  } else if (i >= n_) {
+    B_(j, i - n_) += value;
+  } else {
+    DRAKE_ASSERT(j >= f_[i]);
+    entry(i, j) += value;
+  }
+}
+
+double BorderedSkylineLdlt::Get(int i, int j) const {
+  if (i < j) std::swap(i, j);
+  if (i >= n_ && j >= n_) return C_(i - n_, j - n_);
+  if (i >= n_) return B_(j, i - n_);
+  return j >= f_[i] ? entry(i, j) : 0;
+}
+
+bool BorderedSkylineLdlt::Factorize(double pivot_tolerance) {
+  num_positive_ = 0;
+  num_negative_ = 0;
+
+  // Row by row: with y(j) = L(i, j) D(j),
+  //   y(j) = A(i, j) - sum_k y(k) L(j, k)   for f(i) <= j < i
+  //   D(i) = A(i, i) - sum_j y(j) L(i, j)
+  // where the sums run over the columns k of both skylines.
+  for (int i = 0; i < n_; i++) {
+    double* row_i = &values_[row_start_[i]] - f_[i];
+    for (int j = f_[i]; j < i; j++) {
+      const int k0 = std::max(f_[i], f_[j]);
+      const double* row_j = &values_[row_start_[j]] - f_[j];
+      double sum = 0;
+      for (int k = k0; k < j; k++) {
+        sum += row_i[k] * row_j[k];
+      }
+      row_i[j] -= sum;
+    }
+    double d = row_i[i];
+    for (int j = f_[i]; j < i; j++) {
+      const double y = row_i[j];
+      row_i[j] = y / d_(j);
+      d -= y * row_i[j];
+    }
+    if (!(std::abs(d) > pivot_tolerance)) return false;
+    d_(i) = d;
+    row_i[i] = 1;
+    (d > 0 ? num_positive_ : num_negative_)++;
+  }
+
+  if (m_ > 0) {
+    A_inv_B_ = B_;
+    for (int j = 0; j < m_; j++) {
+      SolveSkyline(A_inv_B_.col(j).data());
+    }
+    // The Schur complement is quasi-definite when K is, and is factored
+    // with symmetric pivoting
+    S_ldlt_.compute(C_ - B_.transpose() * A_inv_B_);
+    if (S_ldlt_.info() != Eigen::Success) return false;
+    const VectorXd& D = S_ldlt_.vectorD();
+    for (int j = 0; j < m_; j++) {
+      if (!(std::abs(D(j)) > pivot_tolerance)) return false;
+      (D(j) > 0 ? num_positive_ : num_negative_)++;
+    }
+  }
+  return true;
+}
+
+void BorderedSkylineLdlt::SolveSkyline(double* x) const {
+  // L z = b
+  for (int i = 0; i < n_; i++) {
+    const double* row_i = &values_[row_start_[i]] - f_[i];
+    double sum = 0;
+    for (int k = f_[i]; k < i; k++) {
+      sum += row_i[k] * x[k];
+    }
+    x[i] -= sum;
+  }
+  // D y = z
+  for (int i = 0; i < n_; i++) {
+    x[i] /= d_(i);
+  }
+  // L' x = y, column by column
+  for (int i = n_ - 1; i >= 0; i--) {
+    const double* row_i = &values_[row_start_[i]] - f_[i];
+    const double x_i = x[i];
+    for (int k = f_[i]; k < i; k++) {
+      x[k] -= row_i[k] * x_i;
+    }
+  }
+}
+
+VectorXd BorderedSkylineLdlt::Solve(const VectorXd& b) const {
+  DRAKE_DEMAND(b.size() == size());
+  VectorXd x = b;
+  SolveSkyline(x.data());
+  if (m_ > 0) {
+    // S y = b_C - B' A^-1 b_A, and x_A = A^-1 b_A - A^-1 B y
+    const VectorXd r = b.tail(m_) - B_.transpose() * x.head(n_);
+    const VectorXd y = S_ldlt_.solve(r);
+    x.head(n_) -= A_inv_B_ * y;
+    x.tail(m_) = y;
+  }
+  return x;
+}
+
+}  // namespace solvers
+}  // namespace dairlib
@@ -0,0 +1,89 @@
+#pragma once
+
+#include <vector>
+
+#include <Eigen/Dense>
+
+namespace dairlib {
+namespace solvers {
+
+/// LDL' factorization of a symmetric matrix
+///   K = [A   B]
+///       [B'  C]
+/// whose leading n x n block A has a skyline (variable band) structure: row i
+/// of its lower triangle is zero left of a first column f(i). The border B, C
+/// of m rows and columns is dense.
+///
+/// The factors of A stay within its skyline, so for a band of width b the
+/// factorization takes O(n b^2) operations and O(n b) memory, instead of the
+/// O(n^3) of a dense one. This is the structure of the KKT matrix of a
+/// trajectory optimization ordered knot by knot, where the variables shared by
+/// all the knots and the constraints linking distant knots (e.g. periodicity)
+/// form the border. The border is eliminated through its Schur complement
+/// C - B' A^-1 B, at an extra cost of O(n b m + m^3).
+///
+/// A is factored without pivoting, which is stable for quasi-definite
+/// matrices [H J'; J -D] (H and D positive definite), such as regularized KKT
+/// matrices, in any symmetric ordering. The inertia (number of positive and
+/// negative eigenvalues) of K is reported, to detect a Hessian that isn't
+/// positive definite on the null space of the constraints.
+class BorderedSkylineLdlt {
+ public:
+  /// @param first_column f(i) <= i for each row i of A
+  /// @param num_border number m of rows and columns of the border
+  BorderedSkylineLdlt(const std::vector<int>& first_column, int num_border);
+
+  int size() const { return n_ + m_; }
+  int num_border() const { return m_; }
+  /// Number of entries stored for the lower triangle of A
+  int num_skyline_entries() const { return values_.size(); }
+
+  /// Zeroes the matrix (before assembling a new one with the same structure)
+  void SetZero();
+  /// Adds value to K(i, j) and K(j, i) (once if i == j). Entries of A must be
+  /// within its skyline.
+  void Add(int i, int j, double value);
+  /// K(i, j), for i >= j, before the factorization
+  double Get(int i, int j) const;
+
+  /// Factors the matrix in place. Returns false if a pivot is zero (or below
+  /// pivot_tolerance in magnitude), in which case K is singular (or nearly
+  /// so) in this ordering.
+  bool Factorize(double pivot_tolerance = 1e-300);
+
+  /// Solves K x = b after Factorize()
+  Eigen::VectorXd Solve(const Eigen::VectorXd& b) const;
+
+  /// Inertia of K, after Factorize()
+  int num_positive_eigenvalues() const { return num_positive_; }
+  int num_negative_eigenvalues() const { return num_negative_; }
+
+ private:
+  // L(i, j) of A, or A(i, j) before the factorization (j <= i)
+  double& entry(int i, int j) { return values_[row_start_[i] + j - f_[i]]; }
+  double entry(int i, int j) const {
+    return values_[row_start_[i] + j - f_[i]];
+  }
+
+  // Solves A x = b in place, after the factorization
+  void SolveSkyline(double* x) const;
+
+  const int n_;
+  const int m_;
+  std::vector<int> f_;
+  std::vector<int> row_start_;
+  std::vector<double> values_;
+  Eigen::VectorXd d_;
+  Eigen::MatrixXd B_;
+  Eigen::MatrixXd C_;
+
+  // A^-1 B and the factorization of the Schur complement
+  Eigen::MatrixXd A_inv_B_;
+  Eigen::LDLT<Eigen::MatrixXd> S_ldlt_;
+
+  int num_positive_ = 0;
+  int num_negative_ = 0;
+};
+
+}  // namespace solvers
+}  // namespace dairlib
@@ -0,0 +1,980 @@
+#include "solvers/structured_sqp.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <limits>
+#include <memory>
+
+#include "drake/common/drake_assert.h"
+#include "solvers/skyline_ldlt.h"
+
+using Eigen::MatrixXd;
+using Eigen::VectorXd;
+using std::vector;
+
+namespace dairlib {
+namespace solvers {
+
+using Block = StructuredNlp::Block;
+
+StructuredNlp::StructuredNlp(int num_vars)
+    : stages_(num_vars, -1),
+      x_lb_(VectorXd::Constant(num_vars,
+                               -std::numeric_limits<double>::infinity())),
+      x_ub_(VectorXd::Constant(num_vars,
+                               std::numeric_limits<double>::infinity())) {}
+
+void StructuredNlp::SetStage(int var, int stage) {
+  DRAKE_DEMAND(0 <= var && var < num_vars() && stage >= -1);
+  stages_[var] = stage;
+}
+
+void StructuredNlp::AddBounds(int var, double lb, double ub) {
+  DRAKE_DEMAND(0 <= var && var < num_vars());
+  x_lb_(var) = std::max(x_lb_(var), lb);
+  x_ub_(var) = std::min(x_ub_(var), ub);
+}
+
+void StructuredNlp::AddCost(const vector<int>& vars, Function function) {
+  Block block;
+  block.vars = vars;
+  block.function = std::move(function);
+  costs_.push_back(std::move(block));
+}
+
+void StructuredNlp::AddQuadraticCost(const vector<int>& vars,
+                                     const MatrixXd& Q, const VectorXd& b) {
+  DRAKE_DEMAND(Q.rows() == static_cast<int>(vars.size()) &&
+               Q.cols() == Q.rows() && b.size() == Q.rows());
+  const MatrixXd Q_sym = 0.5 * (Q + Q.transpose());
+  Block block;
+  block.vars = vars;
+  block.function = [Q_sym, b](const VectorXd& x, VectorXd* y,
+                              MatrixXd* dy_dx) {
+    *y = VectorXd::Constant(1, 0.5 * x.dot(Q_sym * x) + b.dot(x));
+    if (dy_dx) *dy_dx = (Q_sym * x + b).transpose();
+  };
+  block.hessian = Q_sym;
+  costs_.push_back(std::move(block));
+}
+
+void StructuredNlp::AddConstraint(const vector<int>& vars, const VectorXd& lb,
+                                  const VectorXd& ub, Function function) {
+  DRAKE_DEMAND(lb.size() == ub.size());
+  Block block;
+  block.vars = vars;
+  block.function = std::move(function);
+  block.lb = lb;
+  block.ub = ub;
+  constraints_.push_back(std::move(block));
+}
+
+void StructuredNlp::AddLinearConstraint(const vector<int>& vars,
+                                        const MatrixXd& A, const VectorXd& lb,
+                                        const VectorXd& ub) {
+  DRAKE_DEMAND(A.cols() == static_cast<int>(vars.size()) &&
+               A.rows() == lb.size());
+  AddConstraint(vars, lb, ub,
+                [A](const VectorXd& x, VectorXd* y, MatrixXd* dy_dx) {
+                  *y = A * x;
+                  if (dy_dx) *dy_dx = A;
+                });
+  constraints_.back().linear = true;
+}
+
+namespace {
+
+enum class RowType { kEquality, kInequality, kFree };
+
+// Values, derivatives and curvature of the program at a point
+struct Evaluation {
+  double cost = 0;
+  VectorXd gradient;
+  VectorXd constraints;
+  vector<MatrixXd> jacobians;
+  vector<MatrixXd> cost_hessians;
+  // Hessians of the constraints weighted by their multipliers (empty for
+  // linear blocks, blocks coupling distant stages, or with Gauss-Newton)
+  vector<MatrixXd> constraint_hessians;
+};
+
+struct QpSolution {
+  VectorXd d;
+  VectorXd lambda;
+  VectorXd lambda_x;
+  // Sum of the elastic variables, i.e. violation of the linearized
+  // constraints
+  double elastic = 0;
+  int iterations = 0;
+  bool converged = false;
+};
+
+// Primal-dual step of the interior point method
+struct Direction {
+  VectorXd d, y, sl, zl, su, zu, tl, wl, tu, wu, ep, qp, em, qm;
+};
+
+VectorXd Gather(const VectorXd& x, const vector<int>& vars) {
+  VectorXd x_block(vars.size());
+  for (size_t i = 0; i < vars.size(); i++) x_block(i) = x(vars[i]);
+  return x_block;
+}
+
+// Largest step in (0, alpha] keeping v + step * dv >= 0 where mask is set
+double MaxStep(const VectorXd& v, const VectorXd& dv,
+               const vector<bool>& mask, double alpha) {
+  for (int i = 0; i < v.size(); i++) {
+    if (mask[i] && dv(i) < 0) alpha = std::min(alpha, -v(i) / dv(i));
+  }
+  return alpha;
+}
+
+class StructuredSqp {
+ public:
+  StructuredSqp(const StructuredNlp& nlp, const StructuredSqpOptions& options);
+
+  StructuredSqpResult Solve(const VectorXd& x0);
+
+ private:
+  void Evaluate(const VectorXd& x, bool derivatives, const VectorXd* lambda,
+                Evaluation* eval) const;
+  // Violation of the constraints, as a sum (l1) or a maximum
+  double Violation(const VectorXd& c, bool l1) const;
+
+  VectorXd MultiplyHessian(const Evaluation& eval, const VectorXd& d) const;
+  VectorXd MultiplyJacobian(const Evaluation& eval, const VectorXd& d) const;
+  VectorXd MultiplyJacobianTranspose(const Evaluation& eval,
+                                     const VectorXd& lambda) const;
+
+  // Assembles and factors the KKT matrix
+  //   [H + delta I + W_x   J']
+  //   [J                   -D]
+  // increasing delta until its inertia is (n, p). D is floored at a small
+  // regularization.
+  bool FactorKkt(const Evaluation& eval, const VectorXd& D,
+                 const VectorXd& W_x);
+  // Solves the KKT system, with iterative refinement of the floor on D
+  void SolveKkt(const Evaluation& eval, const VectorXd& D, const VectorXd& W_x,
+                const VectorXd& rhs_d, const VectorXd& rhs_lambda,
+                VectorXd* d, VectorXd* lambda) const;
+
+  // Solves min g'd + 1/2 d'(H + delta I)d s.t. lb <= c + J d <= ub,
+  // x_lb <= x + d <= x_ub, with the constraints made elastic. The constraint
+  // values c replace those of eval.
+  void SolveQp(const VectorXd& x, const Evaluation& eval, const VectorXd& c,
+               QpSolution* qp);
+
+  const StructuredSqpOptions options_;
+  vector<Block> costs_;
+  vector<Block> constraints_;
+  VectorXd x_lb_;
+  VectorXd x_ub_;
+  int n_ = 0;
+  int p_ = 0;
+  int num_nlp_rows_ = 0;
+
+  vector<int> row_start_;
+  VectorXd row_lb_;
+  VectorXd row_ub_;
+  vector<RowType> row_type_;
+  vector<bool> row_has_lb_;
+  vector<bool> row_has_ub_;
+  vector<bool> var_has_lb_;
+  vector<bool> var_has_ub_;
+  // Whether the Hessian of a constraint block fits in the KKT structure
+  vector<bool> curvature_fits_;
+
+  vector<int> var_position_;
+  vector<int> row_position_;
+  std::unique_ptr<BorderedSkylineLdlt> kkt_;
+  // Proximal term of the QP subproblems, adapted to the line search like a
+  // Levenberg-Marquardt damping, and increased to correct the inertia
+  double damping_ = 1;
+  double delta_;
+  // Floor on the diagonal of the rows of the KKT matrix
+  const double delta_c_ = 1e-9;
+};
+
+StructuredSqp::StructuredSqp(const StructuredNlp& nlp,
+                             const StructuredSqpOptions& options)
+    : options_(options),
+      costs_(nlp.costs()),
+      constraints_(nlp.constraints()),
+      x_lb_(nlp.x_lb()),
+      x_ub_(nlp.x_ub()),
+      n_(nlp.num_vars()),
+      delta_(options.primal_regularization) {
+  damping_ = std::max(damping_, options_.primal_regularization);
+  vector<int> stage = nlp.stages();
+
+  for (const auto& block : constraints_) num_nlp_rows_ += block.lb.size();
+  // Fixed variables become equality rows, which keeps the interior of the
+  // bounds of the others nonempty
+  var_has_lb_.assign(n_, false);
+  var_has_ub_.assign(n_, false);
+  for (int i = 0; i < n_; i++) {
+    DRAKE_DEMAND(x_lb_(i) <= x_ub_(i));
+    if (x_lb_(i) == x_ub_(i)) {
+      constraints_.push_back(Block());
+      auto& block = constraints_.back();
+      block.vars = {i};
+      block.function = [](const VectorXd& x, VectorXd* y, MatrixXd* dy_dx) {
+        *y = x;
+        if (dy_dx) *dy_dx = MatrixXd::Identity(1, 1);
+      };
+      block.lb = x_lb_.segment(i, 1);
+      block.ub = x_ub_.segment(i, 1);
+      block.linear = true;
+    } else {
+      var_has_lb_[i] = std::isfinite(x_lb_(i));
+      var_has_ub_[i] = std::isfinite(x_ub_(i));
+    }
+  }
+
+  for (const auto& block : constraints_) {
+    row_start_.push_back(p_);
+    p_ += block.lb.size();
+  }
+  row_lb_.resize(p_);
+  row_ub_.resize(p_);
+  for (size_t b = 0; b < constraints_.size(); b++) {
+    row_lb_.segment(row_start_[b], constraints_[b].lb.size()) =
+        constraints_[b].lb;
+    row_ub_.segment(row_start_[b], constraints_[b].ub.size()) =
+        constraints_[b].ub;
+  }
+  row_type_.resize(p_);
+  row_has_lb_.assign(p_, false);
+  row_has_ub_.assign(p_, false);
+  for (int i = 0; i < p_; i++) {
+    DRAKE_DEMAND(row_lb_(i) <= row_ub_(i));
+    if (row_lb_(i) == row_ub_(i)) {
+      row_type_[i] = RowType::kEquality;
+    } else if (std::isinf(row_lb_(i)) && std::isinf(row_ub_(i))) {
+      row_type_[i] = RowType::kFree;
+    } else {
+      row_type_[i] = RowType::kInequality;
+      row_has_lb_[i] = std::isfinite(row_lb_(i));
+      row_has_ub_[i] = std::isfinite(row_ub_(i));
+    }
+  }
+
+  // Range of the stages of the variables of a block
+  auto stage_range = [&stage](const Block& block, int* min_stage,
+                              int* max_stage) {
+    *min_stage = std::numeric_limits<int>::max();
+    *max_stage = -1;
+    for (int var : block.vars) {
+      if (stage[var] < 0) continue;
+      *min_stage = std::min(*min_stage, stage[var]);
+      *max_stage = std::max(*max_stage, stage[var]);
+    }
+  };
+
+  // Costs coupling distant stages move their variables to the border
+  int min_stage, max_stage;
+  for (const auto& block : costs_) {
+    stage_range(block, &min_stage, &max_stage);
+    if (max_stage >= 0 && max_stage > min_stage + 1) {
+      for (int var : block.vars) stage[var] = -1;
+    }
+  }
+
+  // Each constraint block goes in the first stage of its variables, or in
+  // the border if it couples distant stages
+  int num_stages = 0;
+  for (int var = 0; var < n_; var++) {
+    num_stages = std::max(num_stages, stage[var] + 1);
+  }
+  vector<vector<int>> stage_vars(num_stages);
+  vector<vector<int>> stage_blocks(num_stages);
+  vector<int> border_vars;
+  vector<int> border_blocks;
+  for (int var = 0; var < n_; var++) {
+    if (stage[var] >= 0) {
+      stage_vars[stage[var]].push_back(var);
+    } else {
+      border_vars.push_back(var);
+    }
+  }
+  // The curvature of a constraint fits unless it couples distant stages
+  // (the border is dense)
+  curvature_fits_.assign(constraints_.size(), false);
+  for (size_t b = 0; b < constraints_.size(); b++) {
+    stage_range(constraints_[b], &min_stage, &max_stage);
+    curvature_fits_[b] = max_stage < 0 || max_stage <= min_stage + 1;
+    if (max_stage >= 0 && max_stage <= min_stage + 1) {
+      stage_blocks[min_stage].push_back(b);
+    } else {
+      border_blocks.push_back(b);
+    }
+  }
+
+  // Stage by stage ordering of the KKT matrix: the variables of the stage,
+  // then its constraints
+  var_position_.assign(n_, -1);
+  row_position_.assign(p_, -1);
+  int position = 0;
+  for (int s = 0; s < num_stages; s++) {
+    for (int var : stage_vars[s]) var_position_[var] = position++;
+    for (int b : stage_blocks[s]) {
+      for (int i = 0; i < constraints_[b].lb.size(); i++) {
+        row_position_[row_start_[b] + i] = position++;
+      }
+    }
+  }
+  const int num_banded = position;
+  for (int var : border_vars) var_position_[var] = position++;
+  for (int b : border_blocks) {
+    for (int i = 0; i < constraints_[b].lb.size(); i++) {
+      row_position_[row_start_[b] + i] = position++;
+    }
+  }
+
+  // Skyline of the banded part
+  vector<int> first_column(num_banded);
+  for (int i = 0; i < num_banded; i++) first_column[i] = i;
+  auto couple = [&](int i, int j) {
+    if (i >= num_banded || j >= num_banded) return;
+    if (i < j) std::swap(i, j);
+    first_column[i] = std::min(first_column[i], j);
+  };
+  for (const auto& block : costs_) {
+    for (int v1 : block.vars) {
+      for (int v2 : block.vars) couple(var_position_[v1], var_position_[v2]);
+    }
+  }
+  const bool exact = options_.hessian == StructuredSqpOptions::Hessian::kExact;
+  for (size_t b = 0; b < constraints_.size(); b++) {
+    const auto& block = constraints_[b];
+    for (int i = 0; i < block.lb.size(); i++) {
+      for (int var : block.vars) {
+        couple(row_position_[row_start_[b] + i], var_position_[var]);
+      }
+    }
+    if (exact && curvature_fits_[b] && !block.linear) {
+      for (int v1 : block.vars) {
+        for (int v2 : block.vars) couple(var_position_[v1], var_position_[v2]);
+      }
+    }
+  }
+  kkt_ = std::make_unique<BorderedSkylineLdlt>(first_column,
+                                               n_ + p_ - num_banded);
+}
+
+void StructuredSqp::Evaluate(const VectorXd& x, bool derivatives,
+                             const VectorXd* lambda, Evaluation* eval) const {
+  eval->cost = 0;
+  eval->constraints.resize(p_);
+  if (derivatives) {
+    eval->gradient = VectorXd::Zero(n_);
+    eval->jacobians.resize(constraints_.size());
+    eval->cost_hessians.resize(costs_.size());
+    eval->constraint_hessians.assign(constraints_.size(), MatrixXd());
+  }
+
+  // Hessian of w'f by central differences of the Jacobian, which may itself
+  // be a forward difference
+  const double step = options_.finite_difference_step;
+  auto hessian = [step](const Block& block, const VectorXd& x_block,
+                        const VectorXd& w) {
+    const int k = x_block.size();
+    MatrixXd H(k, k);
+    VectorXd x_step = x_block;
+    VectorXd y;
+    MatrixXd jacobian_plus;
+    MatrixXd jacobian_minus;
+    for (int j = 0; j < k; j++) {
+      const double h = step * std::max(1.0, std::abs(x_block(j)));
+      x_step(j) = x_block(j) + h;
+      block.function(x_step, &y, &jacobian_plus);
+      x_step(j) = x_block(j) - h;
+      block.function(x_step, &y, &jacobian_minus);
+      H.col(j) = (jacobian_plus - jacobian_minus).transpose() * w / (2 * h);
+      x_step(j) = x_block(j);
+    }
+    return MatrixXd(0.5 * (H + H.transpose()));
+  };
+
+  VectorXd y;
+  MatrixXd jacobian;
+  for (size_t b = 0; b < costs_.size(); b++) {
+    const auto& block = costs_[b];
+    const VectorXd x_block = Gather(x, block.vars);
+    block.function(x_block, &y, derivatives ? &jacobian : nullptr);
+    DRAKE_ASSERT(y.size() == 1);
+    eval->cost += y(0);
+    if (!derivatives) continue;
+    for (size_t i = 0; i < block.vars.size(); i++) {
+      eval->gradient(block.vars[i]) += jacobian(0, i);
+    }
+    eval->cost_hessians[b] =
+        block.hessian.size() > 0
+            ? block.hessian
+            : hessian(block, x_block, VectorXd::Ones(1));
+  }
+
+  const bool exact = options_.hessian == StructuredSqpOptions::Hessian::kExact;
+  for (size_t b = 0; b < constraints_.size(); b++) {
+    const auto& block = constraints_[b];
+    const int m = block.lb.size();
+    const VectorXd x_block = Gather(x, block.vars);
+    block.function(x_block, &y, derivatives ? &eval->jacobians[b] : nullptr);
+    DRAKE_ASSERT(y.size() == m);
+    eval->constraints.segment(row_start_[b], m) = y;
+    if (!derivatives || !exact || !lambda || block.linear ||
+        !curvature_fits_[b]) {
+      continue;
+    }
+    const VectorXd w = lambda->segment(row_start_[b], m);
+    if (w.isZero()) continue;
+    eval->constraint_hessians[b] = hessian(block, x_block, w);
+  }
+}
+
+double StructuredSqp::Violation(const VectorXd& c, bool l1) const {
+  double violation = 0;
+  for (int i = 0; i < p_; i++) {
+    const double v =
+        std::max(0.0, std::max(row_lb_(i) - c(i), c(i) - row_ub_(i)));
+    violation = l1 ? violation + v : std::max(violation, v);
+  }
+  return violation;
+}
+
+VectorXd StructuredSqp::MultiplyHessian(const Evaluation& eval,
+                                        const VectorXd& d) const {
+  VectorXd Hd = VectorXd::Zero(n_);
+  auto multiply = [&](const vector<int>& vars, const MatrixXd& H) {
+    if (H.size() == 0) return;
+    const VectorXd Hd_block = H * Gather(d, vars);
+    for (size_t i = 0; i < vars.size(); i++) Hd(vars[i]) += Hd_block(i);
+  };
+  for (size_t b = 0; b < costs_.size(); b++) {
+    multiply(costs_[b].vars, eval.cost_hessians[b]);
+  }
+  for (size_t b = 0; b < constraints_.size(); b++) {
+    multiply(constraints_[b].vars, eval.constraint_hessians[b]);
+  }
+  return Hd;
+}
+
+VectorXd StructuredSqp::MultiplyJacobian(const Evaluation& eval,
+                                         const VectorXd& d) const {
+  VectorXd Jd(p_);
+  for (size_t b = 0; b < constraints_.size(); b++) {
+    Jd.segment(row_start_[b], constraints_[b].lb.size()) =
+        eval.jacobians[b] * Gather(d, constraints_[b].vars);
+  }
+  return Jd;
+}
+
+VectorXd StructuredSqp::MultiplyJacobianTranspose(
+    const Evaluation& eval, const VectorXd& lambda) const {
+  VectorXd Jt_lambda = VectorXd::Zero(n_);
+  for (size_t b = 0; b < constraints_.size(); b++) {
+    const auto& vars = constraints_[b].vars;
+    const VectorXd product =
+        eval.jacobians[b].transpose() *
+        lambda.segment(row_start_[b], constraints_[b].lb.size());
+    for (size_t i = 0; i < vars.size(); i++) Jt_lambda(vars[i]) += product(i);
+  }
+  return Jt_lambda;
+}
+
+bool StructuredSqp::FactorKkt(const Evaluation& eval, const VectorXd& D,
+                              const VectorXd& W_x) {
+  auto add_hessian = [this](const vector<int>& vars, const MatrixXd& H) {
+    for (int a = 0; a < H.rows(); a++) {
+      for (int b = 0; b <= a; b++) {
+        const int i = var_position_[vars[a]];
+        const int j = var_position_[vars[b]];
+        // A variable repeated in the block gets both symmetric entries
+        kkt_->Add(i, j, (i == j && a != b) ? 2 * H(a, b) : H(a, b));
+      }
+    }
+  };
+
+  while (true) {
+    kkt_->SetZero();
+    for (size_t b = 0; b < costs_.size(); b++) {
+      add_hessian(costs_[b].vars, eval.cost_hessians[b]);
+    }
+    for (size_t b = 0; b < constraints_.size(); b++) {
+      add_hessian(constraints_[b].vars, eval.constraint_hessians[b]);
+      const auto& vars = constraints_[b].vars;
+      const MatrixXd& J = eval.jacobians[b];
+      for (int i = 0; i < J.rows(); i++) {
+        const int row = row_start_[b] + i;
+        if (row_type_[row] == RowType::kFree) continue;
+        for (int a = 0; a < J.cols(); a++) {
+          kkt_->Add(row_position_[row], var_position_[vars[a]], J(i, a));
+        }
+      }
+    }
+    for (int var = 0; var < n_; var++) {
+      kkt_->Add(var_position_[var], var_position_[var], delta_ + W_x(var));
+    }
+    for (int row = 0; row < p_; row++) {
+      kkt_->Add(row_position_[row], row_position_[row],
+                -std::max(D(row), delta_c_));
+    }
+
+    if (kkt_->Factorize() && kkt_->num_positive_eigenvalues() == n_ &&
+        kkt_->num_negative_eigenvalues() == p_) {
+      return true;
+    }
+    // The Hessian isn't positive definite on the null space of the
+    // constraints
+    if (delta_ > 1e10) return false;
+    delta_ = std::max(1e-4, 10 * delta_);
+  }
+}
+
+void StructuredSqp::SolveKkt(const Evaluation& eval, const VectorXd& D,
+                             const VectorXd& W_x, const VectorXd& rhs_d,
+                             const VectorXd& rhs_lambda, VectorXd* d,
+                             VectorXd* lambda) const {
+  VectorXd residual_d = rhs_d;
+  VectorXd residual_lambda = rhs_lambda;
+  *d = VectorXd::Zero(n_);
+  *lambda = VectorXd::Zero(p_);
+  VectorXd rhs(n_ + p_);
+  for (int refinement = 0; refinement < 3; refinement++) {
+    for (int var = 0; var < n_; var++) {
+      rhs(var_position_[var]) = residual_d(var);
+    }
+    for (int row = 0; row < p_; row++) {
+      rhs(row_position_[row]) = residual_lambda(row);
+    }
+    const VectorXd solution = kkt_->Solve(rhs);
+    for (int var = 0; var < n_; var++) {
+      (*d)(var) += solution(var_position_[var]);
+    }
+    for (int row = 0; row < p_; row++) {
+      (*lambda)(row) += solution(row_position_[row]);
+    }
+
+    // Residual of the system without the floor on D
+    VectorXd lambda_bound = *lambda;
+    for (int row = 0; row < p_; row++) {
+      if (row_type_[row] == RowType::kFree) lambda_bound(row) = 0;
+    }
+    residual_d = rhs_d - MultiplyHessian(eval, *d) - delta_ * *d -
+                 W_x.cwiseProduct(*d) -
+                 MultiplyJacobianTranspose(eval, lambda_bound);
+    residual_lambda = rhs_lambda - MultiplyJacobian(eval, *d) +
+                      D.cwiseProduct(*lambda);
+    for (int row = 0; row < p_; row++) {
+      if (row_type_[row] == RowType::kFree) {
+        residual_lambda(row) = rhs_lambda(row) + (*lambda)(row);
+      }
+    }
+    const double scale = 1 + std::max(rhs_d.lpNorm<Eigen::Infinity>(),
+                                      rhs_lambda.lpNorm<Eigen::Infinity>());
+    if (std::max(residual_d.lpNorm<Eigen::Infinity>(),
+                 residual_lambda.lpNorm<Eigen::Infinity>()) < 1e-12 * scale) {
+      break;
+    }
+  }
+}
+
+void StructuredSqp::SolveQp(const VectorXd& x, const Evaluation& eval,
+                            const VectorXd& c, QpSolution* qp) {
+  delta_ = damping_;
+  const double tol = 1e-2 * std::min(options_.feasibility_tolerance,
+                                     options_.optimality_tolerance);
+  const double gradient_scale = 1 + eval.gradient.lpNorm<Eigen::Infinity>();
+  const double nu = options_.elastic_weight * gradient_scale;
+
+  // The rows are elastic: lb <= J d + e_p - e_m <= ub, with e_p, e_m >= 0 at
+  // a cost nu (e_p + e_m), which keeps the QP feasible (and bounds the
+  // multipliers by nu)
+  const VectorXd lb = row_lb_ - c;
+  const VectorXd ub = row_ub_ - c;
+  const VectorXd d_lb = x_lb_ - x;
+  const VectorXd d_ub = x_ub_ - x;
+
+  // Slacks s (t for the variable bounds) and their multipliers z (w), and
+  // the multipliers q of the elastic variables. The multipliers of the
+  // inequality rows are lambda = z_u - z_l, and those of the variable bounds
+  // lambda_x = w_u - w_l. Unused slacks are 1 with a zero multiplier.
+  const double kappa = 1e-2;
+  VectorXd d = VectorXd::Zero(n_);
+  VectorXd y = VectorXd::Zero(p_);
+  VectorXd sl = VectorXd::Ones(p_), zl = VectorXd::Zero(p_);
+  VectorXd su = VectorXd::Ones(p_), zu = VectorXd::Zero(p_);
+  VectorXd tl = VectorXd::Ones(n_), wl = VectorXd::Zero(n_);
+  VectorXd tu = VectorXd::Ones(n_), wu = VectorXd::Zero(n_);
+  VectorXd ep = VectorXd::Ones(p_), qp_ = VectorXd::Zero(p_);
+  VectorXd em = VectorXd::Ones(p_), qm = VectorXd::Zero(p_);
+  vector<bool> elastic(p_);
+  int num_pairs = 0;
+  for (int i = 0; i < p_; i++) {
+    elastic[i] = row_type_[i] != RowType::kFree;
+    if (elastic[i]) {
+      ep(i) = em(i) = 1 / nu;
+      qp_(i) = qm(i) = nu;
+      num_pairs += 2;
+    }
+    if (row_has_lb_[i]) {
+      sl(i) = std::max(-lb(i), kappa);
+      zl(i) = 1;
+      num_pairs++;
+    }
+    if (row_has_ub_[i]) {
+      su(i) = std::max(ub(i), kappa);
+      zu(i) = 1;
+      num_pairs++;
+    }
+  }
+  for (int i = 0; i < n_; i++) {
+    if (var_has_lb_[i]) {
+      tl(i) = std::max(-d_lb(i), kappa);
+      wl(i) = 1;
+      num_pairs++;
+    }
+    if (var_has_ub_[i]) {
+      tu(i) = std::max(d_ub(i), kappa);
+      wu(i) = 1;
+      num_pairs++;
+    }
+  }
+  auto mask = [](const VectorXd& v, const vector<bool>& used) {
+    VectorXd masked = v;
+    for (int i = 0; i < v.size(); i++) {
+      if (!used[i]) masked(i) = 0;
+    }
+    return masked;
+  };
+  auto multipliers = [&]() {
+    VectorXd lambda = zu - zl;
+    for (int i = 0; i < p_; i++) {
+      if (row_type_[i] == RowType::kEquality) lambda(i) = y(i);
+    }
+    return lambda;
+  };
+  auto complementarity = [&](double alpha, const Direction* step) {
+    auto dot = [&](const VectorXd& s, const VectorXd& ds, const VectorXd& z,
+                   const VectorXd& dz) {
+      return step ? (s + alpha * ds).dot(z + alpha * dz) : s.dot(z);
+    };
+    const Direction zero;
+    const Direction& dir = step ? *step : zero;
+    return dot(sl, dir.sl, zl, dir.zl) + dot(su, dir.su, zu, dir.zu) +
+           dot(tl, dir.tl, wl, dir.wl) + dot(tu, dir.tu, wu, dir.wu) +
+           dot(ep, dir.ep, qp_, dir.qp) + dot(em, dir.em, qm, dir.qm);
+  };
+
+  qp->converged = false;
+  for (qp->iterations = 0; qp->iterations < options_.max_qp_iterations;
+       qp->iterations++) {
+    const VectorXd lambda = multipliers();
+    // Linearized values of the rows, relative to c
+    const VectorXd v = MultiplyJacobian(eval, d) + mask(ep - em, elastic);
+    const VectorXd r_d = MultiplyHessian(eval, d) + delta_ * d +
+                         eval.gradient +
+                         MultiplyJacobianTranspose(eval, lambda) + wu - wl;
+    const VectorXd r_ep = mask(VectorXd::Constant(p_, nu) + lambda - qp_,
+                               elastic);
+    const VectorXd r_em = mask(VectorXd::Constant(p_, nu) - lambda - qm,
+                               elastic);
+    VectorXd r_e = VectorXd::Zero(p_);
+    for (int i = 0; i < p_; i++) {
+      if (row_type_[i] == RowType::kEquality) r_e(i) = v(i) - lb(i);
+    }
+    const VectorXd r_l = mask(v - lb - sl, row_has_lb_);
+    const VectorXd r_u = mask(ub - v - su, row_has_ub_);
+    const VectorXd r_tl = mask(d - d_lb - tl, var_has_lb_);
+    const VectorXd r_tu = mask(d_ub - d - tu, var_has_ub_);
+    const double mu = num_pairs == 0 ? 0 : complementarity(0, nullptr) /
+                                               num_pairs;
+    const double dual_residual =
+        std::max(r_d.lpNorm<Eigen::Infinity>(),
+                 std::max(r_ep.lpNorm<Eigen::Infinity>(),
+                          r_em.lpNorm<Eigen::Infinity>()));
+    const double primal_residual = std::max(
+        std::max(r_e.lpNorm<Eigen::Infinity>(),
+                 std::max(r_l.lpNorm<Eigen::Infinity>(),
+                          r_u.lpNorm<Eigen::Infinity>())),
+        std::max(r_tl.lpNorm<Eigen::Infinity>(),
+                 r_tu.lpNorm<Eigen::Infinity>()));
+    if (dual_residual <= tol * gradient_scale && primal_residual <= tol &&
+        mu <= tol) {
+      qp->converged = true;
+      break;
+    }
+
+    // Eliminating the slacks, the elastic variables and their multipliers,
+    // each row has
+    //   J dd - D dlambda = rhs
+    // with D = E + 1 / W for the inequality rows and D = E for the equality
+    // rows, E = e_p / q_p + e_m / q_m and W = z_l / s_l + z_u / s_u
+    const VectorXd W = mask(zl.cwiseQuotient(sl), row_has_lb_) +
+                       mask(zu.cwiseQuotient(su), row_has_ub_);
+    const VectorXd W_x = mask(wl.cwiseQuotient(tl), var_has_lb_) +
+                         mask(wu.cwiseQuotient(tu), var_has_ub_);
+    const VectorXd E = mask(ep.cwiseQuotient(qp_) + em.cwiseQuotient(qm),
+                            elastic);
+    VectorXd D = E;
+    for (int i = 0; i < p_; i++) {
+      if (row_type_[i] == RowType::kInequality) {
+        D(i) += 1 / std::max(W(i), 1e-20);
+      } else if (row_type_[i] == RowType::kFree) {
+        D(i) = 1;
+      }
+    }
+    if (!FactorKkt(eval, D, W_x)) break;
+
+    // Newton step towards s z = tau for each pair of slack and multiplier
+    auto direction = [&](const Direction& tau) {
+      const VectorXd rho =
+          mask(tau.su.cwiseQuotient(su) - zu -
+                   zu.cwiseQuotient(su).cwiseProduct(r_u),
+               row_has_ub_) -
+          mask(tau.sl.cwiseQuotient(sl) - zl -
+                   zl.cwiseQuotient(sl).cwiseProduct(r_l),
+               row_has_lb_);
+      const VectorXd rho_x =
+          mask(tau.tu.cwiseQuotient(tu) - wu -
+                   wu.cwiseQuotient(tu).cwiseProduct(r_tu),
+               var_has_ub_) -
+          mask(tau.tl.cwiseQuotient(tl) - wl -
+                   wl.cwiseQuotient(tl).cwiseProduct(r_tl),
+               var_has_lb_);
+      // de_p - de_m = a - E dlambda
+      const VectorXd a =
+          mask(tau.ep.cwiseQuotient(qp_) - ep -
+                   ep.cwiseQuotient(qp_).cwiseProduct(r_ep) -
+                   (tau.em.cwiseQuotient(qm) - em -
+                    em.cwiseQuotient(qm).cwiseProduct(r_em)),
+               elastic);
+      VectorXd rhs_lambda = VectorXd::Zero(p_);
+      for (int i = 0; i < p_; i++) {
+        if (row_type_[i] == RowType::kEquality) {
+          rhs_lambda(i) = -r_e(i) - a(i);
+        } else if (row_type_[i] == RowType::kInequality) {
+          rhs_lambda(i) = -rho(i) / std::max(W(i), 1e-20) - a(i);
+        }
+      }
+      Direction step;
+      SolveKkt(eval, D, W_x, -r_d - rho_x, rhs_lambda, &step.d, &step.y);
+      step.qp = mask(step.y + r_ep, elastic);
+      step.ep = mask(tau.ep.cwiseQuotient(qp_) - ep -
+                         ep.cwiseQuotient(qp_).cwiseProduct(step.qp),
+                     elastic);
+      step.qm = mask(r_em - step.y, elastic);
+      step.em = mask(tau.em.cwiseQuotient(qm) - em -
+                         em.cwiseQuotient(qm).cwiseProduct(step.qm),
+                     elastic);
+      const VectorXd dv = MultiplyJacobian(eval, step.d) + step.ep - step.em;
+      step.sl = mask(dv + r_l, row_has_lb_);
+      step.zl = mask(tau.sl.cwiseQuotient(sl) - zl -
+                         zl.cwiseQuotient(sl).cwiseProduct(step.sl),
+                     row_has_lb_);
+      step.su = mask(r_u - dv, row_has_ub_);
+      step.zu = mask(tau.su.cwiseQuotient(su) - zu -
+                         zu.cwiseQuotient(su).cwiseProduct(step.su),
+                     row_has_ub_);
+      step.tl = mask(step.d + r_tl, var_has_lb_);
+      step.wl = mask(tau.tl.cwiseQuotient(tl) - wl -
+                         wl.cwiseQuotient(tl).cwiseProduct(step.tl),
+                     var_has_lb_);
+      step.tu = mask(r_tu - step.d, var_has_ub_);
+      step.wu = mask(tau.tu.cwiseQuotient(tu) - wu -
+                         wu.cwiseQuotient(tu).cwiseProduct(step.tu),
+                     var_has_ub_);
+      return step;
+    };
+    auto step_length = [&](const Direction& step, double fraction) {
+      double alpha = 1 / fraction;
+      alpha = MaxStep(sl, step.sl, row_has_lb_, alpha);
+      alpha = MaxStep(zl, step.zl, row_has_lb_, alpha);
+      alpha = MaxStep(su, step.su, row_has_ub_, alpha);
+      alpha = MaxStep(zu, step.zu, row_has_ub_, alpha);
+      alpha = MaxStep(tl, step.tl, var_has_lb_, alpha);
+      alpha = MaxStep(wl, step.wl, var_has_lb_, alpha);
+      alpha = MaxStep(tu, step.tu, var_has_ub_, alpha);
+      alpha = MaxStep(wu, step.wu, var_has_ub_, alpha);
+      alpha = MaxStep(ep, step.ep, elastic, alpha);
+      alpha = MaxStep(qp_, step.qp, elastic, alpha);
+      alpha = MaxStep(em, step.em, elastic, alpha);
+      alpha = MaxStep(qm, step.qm, elastic, alpha);
+      return fraction * alpha;
+    };
+
+    // Mehrotra predictor-corrector
+    Direction tau;
+    tau.sl = tau.su = tau.ep = tau.em = VectorXd::Zero(p_);
+    tau.tl = tau.tu = VectorXd::Zero(n_);
+    Direction step = direction(tau);
+    if (num_pairs > 0) {
+      const double alpha_affine = step_length(step, 1);
+      const double mu_affine =
+          complementarity(alpha_affine, &step) / num_pairs;
+      const double sigma_mu = std::pow(mu_affine / mu, 3) * mu;
+      auto target = [sigma_mu](const VectorXd& ds, const VectorXd& dz,
+                               const vector<bool>& used) {
+        VectorXd t = VectorXd::Constant(ds.size(), sigma_mu) -
+                     ds.cwiseProduct(dz);
+        for (int i = 0; i < t.size(); i++) {
+          if (!used[i]) t(i) = 0;
+        }
+        return t;
+      };
+      tau.sl = target(step.sl, step.zl, row_has_lb_);
+      tau.su = target(step.su, step.zu, row_has_ub_);
+      tau.tl = target(step.tl, step.wl, var_has_lb_);
+      tau.tu = target(step.tu, step.wu, var_has_ub_);
+      tau.ep = target(step.ep, step.qp, elastic);
+      tau.em = target(step.em, step.qm, elastic);
+      step = direction(tau);
+    }
+    const double alpha = num_pairs > 0 ? step_length(step, 0.995) : 1;
+    d += alpha * step.d;
+    // Only the equality rows keep y, the others derive their multipliers
+    y += alpha * step.y;
+    sl += alpha * step.sl;
+    zl += alpha * step.zl;
+    su += alpha * step.su;
+    zu += alpha * step.zu;
+    tl += alpha * step.tl;
+    wl += alpha * step.wl;
+    tu += alpha * step.tu;
+    wu += alpha * step.wu;
+    ep += alpha * step.ep;
+    qp_ += alpha * step.qp;
+    em += alpha * step.em;
+    qm += alpha * step.qm;
+  }
+
+  damping_ = delta_;
+  qp->d = d;
+  qp->lambda = multipliers();
+  qp->lambda_x = wu - wl;
+  qp->elastic = mask(ep + em, elastic).sum();
+}
+
+StructuredSqpResult StructuredSqp::Solve(const VectorXd& x0) {
+  DRAKE_DEMAND(x0.size() == n_);
+  StructuredSqpResult result;
+  result.kkt_size = kkt_->size();
+  result.kkt_entries = kkt_->num_skyline_entries() +
+                       kkt_->num_border() * (kkt_->size() - kkt_->num_border());
+  result.kkt_border = kkt_->num_border();
+
+  VectorXd x = x0.cwiseMax(x_lb_).cwiseMin(x_ub_);
+  VectorXd lambda = VectorXd::Zero(p_);
+  VectorXd lambda_x = VectorXd::Zero(n_);
+  double penalty = 0;
+
+  Evaluation eval;
+  Evaluation trial;
+  QpSolution qp;
+  QpSolution correction;
+  for (result.iterations = 0;; result.iterations++) {
+    Evaluate(x, true, &lambda, &eval);
+    const double violation = Violation(eval.constraints, false);
+    const double violation_l1 = Violation(eval.constraints, true);
+    const double stationarity =
+        (eval.gradient + MultiplyJacobianTranspose(eval, lambda) + lambda_x)
+            .lpNorm<Eigen::Infinity>();
+    result.cost = eval.cost;
+    result.constraint_violation = violation;
+    result.stationarity = stationarity;
+    const double gradient_scale =
+        std::max(1.0, eval.gradient.lpNorm<Eigen::Infinity>());
+    if (stationarity <= options_.optimality_tolerance * gradient_scale) {
+      // Otherwise a stationary point of the elastic problem, which locally
+      // minimizes the constraint violation
+      result.status = violation <= options_.feasibility_tolerance
+                          ? StructuredSqpResult::Status::kSolved
+                          : StructuredSqpResult::Status::kInfeasible;
+      break;
+    }
+    if (result.iterations == options_.max_iterations) {
+      result.status = StructuredSqpResult::Status::kIterationLimit;
+      break;
+    }
+
+    SolveQp(x, eval, eval.constraints, &qp);
+    result.qp_iterations += qp.iterations;
+
+    // l1 merit function cost + penalty * violation, with the penalty above
+    // the multipliers. The penalty decreases (Powell's update) once large
+    // multipliers of the first iterations vanish, which would otherwise leave
+    // the line search blind to the cost.
+    const double lambda_max = 1.1 * qp.lambda.lpNorm<Eigen::Infinity>();
+    penalty = std::max(lambda_max, 0.5 * (penalty + lambda_max));
+    const double merit = eval.cost + penalty * violation_l1;
+    const double slope = std::min(
+        0.0, eval.gradient.dot(qp.d) -
+                 penalty * std::max(0.0, violation_l1 - qp.elastic));
+    auto sufficient_decrease = [&](const VectorXd& x_trial, double alpha) {
+      Evaluate(x_trial, false, nullptr, &trial);
+      return trial.cost + penalty * Violation(trial.constraints, true) <=
+             merit + 1e-4 * alpha * slope;
+    };
+
+    double alpha = 1;
+    bool accepted = false;
+    VectorXd x_trial = (x + qp.d).cwiseMax(x_lb_).cwiseMin(x_ub_);
+    if (sufficient_decrease(x_trial, 1)) {
+      accepted = true;
+    } else if (Violation(trial.constraints, true) > violation_l1) {
+      // Second order correction of the full step, against the Maratos
+      // effect: the step of the QP linearized at x with the constraint
+      // values of x + d
+      SolveQp(x, eval,
+              trial.constraints - MultiplyJacobian(eval, qp.d), &correction);
+      result.qp_iterations += correction.iterations;
+      x_trial = (x + correction.d).cwiseMax(x_lb_).cwiseMin(x_ub_);
+      accepted = sufficient_decrease(x_trial, 1);
+    }
+    for (int i = 0; i < 40 && !accepted; i++) {
+      alpha /= 2;
+      x_trial = (x + alpha * qp.d).cwiseMax(x_lb_).cwiseMin(x_ub_);
+      accepted = sufficient_decrease(x_trial, alpha) ||
+                 // Steps at the precision of the variables
+                 alpha * qp.d.lpNorm<Eigen::Infinity>() <=
+                     1e-14 * (1 + x.lpNorm<Eigen::Infinity>());
+    }
+    if (options_.verbose) {
+      std::cout << "sqp " << result.iterations << ": cost " << eval.cost
+                << ", violation " << violation << ", stationarity "
+                << stationarity << ", qp iterations " << qp.iterations
+                << (qp.converged ? "" : " (not converged)") << ", step "
+                << alpha << ", regularization " << delta_ << std::endl;
+    }
+    if (!accepted) {
+      result.status = StructuredSqpResult::Status::kLineSearchFailed;
+      break;
+    }
+    if (alpha == 1) {
+      damping_ = std::max(options_.primal_regularization, damping_ / 10);
+    } else if (alpha < 0.1) {
+      damping_ *= 10;
+    }
+    x = x_trial;
+    // Full step of the multipliers, which are those of the QP at x
+    lambda = qp.lambda;
+    lambda_x = qp.lambda_x;
+  }
+
+  result.x = x;
+  result.lambda = lambda.head(num_nlp_rows_);
+  return result;
+}
+
+}  // namespace
+
+StructuredSqpResult SolveStructuredSqp(const StructuredNlp& nlp,
+                                       const VectorXd& x0,
+                                       const StructuredSqpOptions& options) {
+  StructuredSqp sqp(nlp, options);
+  return sqp.Solve(x0);
+}
+
+}  // namespace solvers
+}  // namespace dairlib
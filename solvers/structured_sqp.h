@@ -0,0 +1,168 @@
+#pragma once
+
+#include <functional>
+#include <string>
+#include <vector>
+
+#include <Eigen/Dense>
+
+namespace dairlib {
+namespace solvers {
+
+/// Nonlinear program whose costs and constraints are each a function of a few
+/// decision variables, and whose variables are grouped in stages, e.g. the
+/// knot points of a trajectory optimization
+///   min  sum_i f_i(x_i)
+///   s.t. lb_j <= c_j(x_j) <= ub_j
+///        x_lb <= x <= x_ub
+/// where x_i, x_j are subsets of x.
+///
+/// Constraints on the variables of one stage, or of two consecutive ones,
+/// keep the KKT matrix banded. The other constraints (e.g. periodicity), and
+/// the variables without a stage (e.g. shared by all the knots), are handled
+/// as a dense border, which should stay small.
+class StructuredNlp {
+ public:
+  /// Evaluates y = f(x), and its Jacobian if dy_dx isn't null
+  using Function = std::function<void(const Eigen::VectorXd& x,
+                                      Eigen::VectorXd* y,
+                                      Eigen::MatrixXd* dy_dx)>;
+
+  struct Block {
+    std::vector<int> vars;
+    Function function;
+    Eigen::VectorXd lb;
+    Eigen::VectorXd ub;
+    /// Constant Hessian of a quadratic cost (empty otherwise)
+    Eigen::MatrixXd hessian;
+    /// Whether the function is linear (no curvature)
+    bool linear = false;
+  };
+
+  explicit StructuredNlp(int num_vars);
+
+  int num_vars() const { return x_lb_.size(); }
+
+  /// Stage of a variable, from 0. Variables without a stage (-1, the
+  /// default) are part of the border.
+  void SetStage(int var, int stage);
+  const std::vector<int>& stages() const { return stages_; }
+
+  /// Intersects the bounds of a variable with [lb, ub]
+  void AddBounds(int var, double lb, double ub);
+  const Eigen::VectorXd& x_lb() const { return x_lb_; }
+  const Eigen::VectorXd& x_ub() const { return x_ub_; }
+
+  /// Adds a scalar cost
+  void AddCost(const std::vector<int>& vars, Function function);
+  /// Adds the cost 1/2 x' Q x + b' x, with its exact Hessian
+  void AddQuadraticCost(const std::vector<int>& vars, const Eigen::MatrixXd& Q,
+                        const Eigen::VectorXd& b);
+
+  void AddConstraint(const std::vector<int>& vars, const Eigen::VectorXd& lb,
+                     const Eigen::VectorXd& ub, Function function);
+  /// Adds lb <= A x <= ub
+  void AddLinearConstraint(const std::vector<int>& vars,
+                           const Eigen::MatrixXd& A, const Eigen::VectorXd& lb,
+                           const Eigen::VectorXd& ub);
+
+  const std::vector<Block>& costs() const { return costs_; }
+  const std::vector<Block>& constraints() const { return constraints_; }
+
+ private:
+  std::vector<int> stages_;
+  Eigen::VectorXd x_lb_;
+  Eigen::VectorXd x_ub_;
+  std::vector<Block> costs_;
+  std::vector<Block> constraints_;
+};
+
+struct StructuredSqpOptions {
+  enum class Hessian {
+    /// Hessian of the costs only, i.e. constraint curvature ignored (converges
+    /// linearly when the constraints are curved at the solution, but each
+    /// iteration is cheap and the QPs are convex)
+    kGaussNewton,
+    /// Hessian of the Lagrangian, by central differences of the Jacobian of
+    /// each constraint (two function evaluations per variable of the
+    /// block).
+    /// Constraints coupling distant stages (typically linear, e.g.
+    /// periodicity) are still treated as in kGaussNewton.
+    kExact
+  };
+
+  Hessian hessian = Hessian::kExact;
+  int max_iterations = 200;
+  /// Maximum constraint violation at a solution
+  double feasibility_tolerance = 1e-6;
+  /// Maximum norm of the gradient of the Lagrangian at a solution, relative
+  /// to the cost gradient (and at least 1)
+  double optimality_tolerance = 1e-6;
+  /// Interior point iterations per QP subproblem
+  int max_qp_iterations = 50;
+  /// Penalty on the violation of the linearized constraints in the QP
+  /// subproblems, relative to the cost gradient (and at least 1). The
+  /// constraints are elastic, as in SNOPT, so that a subproblem stays
+  /// feasible when its linearization isn't.
+  double elastic_weight = 1e4;
+  /// Minimum proximal term added to the Hessian, which damps the steps
+  /// without changing the solution. The term is adapted to the line search
+  /// (larger after short steps, down to this value after full ones).
+  double primal_regularization = 1e-8;
+  /// Step (relative to the variables, and at least absolute) of the central
+  /// differences of the Jacobians giving the Hessian. Jacobians by forward
+  /// differences (e.g. of a NonlinearConstraint<double>, step 1e-8) are only
+  /// accurate to about 1e-8, so the step should be about the square root of
+  /// theirs.
+  double finite_difference_step = 1e-4;
+  bool verbose = false;
+};
+
+struct StructuredSqpResult {
+  enum class Status {
+    kSolved,
+    kIterationLimit,
+    kLineSearchFailed,
+    /// Local minimum of the constraint violation
+    kInfeasible
+  };
+
+  Status status = Status::kIterationLimit;
+  Eigen::VectorXd x;
+  /// Multipliers of the constraints, one per row in the order of the blocks
+  /// (positive at an upper bound, negative at a lower bound)
+  Eigen::VectorXd lambda;
+  double cost = 0;
+  /// Maximum violation of the constraints
+  double constraint_violation = 0;
+  /// Maximum norm of the gradient of the Lagrangian
+  double stationarity = 0;
+  int iterations = 0;
+  int qp_iterations = 0;
+  /// Size of the KKT matrix, number of its entries stored and size of its
+  /// dense border
+  int kkt_size = 0;
+  int kkt_entries = 0;
+  int kkt_border = 0;
+
+  bool is_success() const { return status == Status::kSolved; }
+};
+
+/// Solves the program with a line search SQP. Each QP subproblem is solved by
+/// a primal-dual interior point method, whose Newton steps factor the KKT
+/// matrix ordered stage by stage with a skyline LDL' (BorderedSkylineLdlt).
+/// The cost of an iteration grows linearly with the number of stages, like
+/// a Riccati recursion, instead of relying on a general sparse factorization
+/// to rediscover the structure. Steps are accepted by a backtracking line
+/// search on the l1 merit function.
+///
+/// There is no feasibility restoration phase: from a point where the
+/// linearized constraints are infeasible, the iterates minimize the
+/// constraint violation, and may stop at a local minimum of it.
+StructuredSqpResult SolveStructuredSqp(const StructuredNlp& nlp,
+                                       const Eigen::VectorXd& x0,
+                                       const StructuredSqpOptions& options =
+                                           StructuredSqpOptions());
+
+}  // namespace solvers
+}  // namespace dairlib
@@ -0,0 +1,142 @@
+#include "solvers/structured_sqp_solver.h"
+
+#include <cmath>
+#include <memory>
+
+#include "drake/math/autodiff.h"
+#include "drake/math/autodiff_gradient.h"
+#include "drake/solvers/solver_id.h"
+
+namespace dairlib {
+namespace solvers {
+
+using drake::AutoDiffVecXd;
+using drake::math::autoDiffToGradientMatrix;
+using drake::math::autoDiffToValueMatrix;
+using drake::math::initializeAutoDiff;
+using drake::solvers::BoundingBoxConstraint;
+using drake::solvers::EvaluatorBase;
+using drake::solvers::LinearConstraint;
+using drake::solvers::LinearCost;
+using drake::solvers::MathematicalProgram;
+using drake::solvers::MathematicalProgramResult;
+using drake::solvers::QuadraticCost;
+using drake::solvers::SolutionResult;
+using drake::solvers::VectorXDecisionVariable;
+using Eigen::MatrixXd;
+using Eigen::VectorXd;
+using std::vector;
+
+namespace {
+
+vector<int> VariableIndices(const MathematicalProgram& prog,
+                            const VectorXDecisionVariable& vars) {
+  vector<int> indices(vars.size());
+  for (int i = 0; i < vars.size(); i++) {
+    indices[i] = prog.FindDecisionVariableIndex(vars(i));
+  }
+  return indices;
+}
+
+// Evaluates a cost or constraint, and its gradient with AutoDiff
+StructuredNlp::Function MakeFunction(std::shared_ptr<EvaluatorBase> evaluator) {
+  return [evaluator](const VectorXd& x, VectorXd* y, MatrixXd* dy_dx) {
+    if (!dy_dx) {
+      evaluator->Eval(x, y);
+      return;
+    }
+    AutoDiffVecXd y_val;
+    evaluator->Eval(initializeAutoDiff(x), &y_val);
+    *y = autoDiffToValueMatrix(y_val);
+    *dy_dx = autoDiffToGradientMatrix(y_val, x.size());
+  };
+}
+
+}  // namespace
+
+StructuredNlp MakeStructuredNlp(const MathematicalProgram& prog,
+                                const vector<int>& variable_stages) {
+  DRAKE_DEMAND(static_cast<int>(variable_stages.size()) == prog.num_vars());
+  StructuredNlp nlp(prog.num_vars());
+  for (int i = 0; i < prog.num_vars(); i++) {
+    nlp.SetStage(i, variable_stages[i]);
+  }
+
+  for (const auto& binding : prog.GetAllCosts()) {
+    const vector<int> vars = VariableIndices(prog, binding.variables());
+    const int n = vars.size();
+    if (auto cost = dynamic_cast<const QuadraticCost*>(
+            binding.evaluator().get())) {
+      // The constant term doesn't change the solution
+      nlp.AddQuadraticCost(vars, cost->Q(), cost->b());
+    } else if (auto cost = dynamic_cast<const LinearCost*>(
+                   binding.evaluator().get())) {
+      nlp.AddQuadraticCost(vars, MatrixXd::Zero(n, n), cost->a());
+    } else {
+      nlp.AddCost(vars, MakeFunction(binding.evaluator()));
+    }
+  }
+
+  for (const auto& binding : prog.GetAllConstraints()) {
+    const vector<int> vars = VariableIndices(prog, binding.variables());
+    const auto& constraint = binding.evaluator();
+    if (dynamic_cast<const BoundingBoxConstraint*>(constraint.get())) {
+      for (int i = 0; i < static_cast<int>(vars.size()); i++) {
+        nlp.AddBounds(vars[i], constraint->lower_bound()(i),
+                      constraint->upper_bound()(i));
+      }
+    } else if (auto linear = dynamic_cast<const LinearConstraint*>(
+                   constraint.get())) {
+      // Includes LinearEqualityConstraint
+      nlp.AddLinearConstraint(vars, MatrixXd(linear->A()),
+                              constraint->lower_bound(),
+                              constraint->upper_bound());
+    } else {
+      nlp.AddConstraint(vars, constraint->lower_bound(),
+                        constraint->upper_bound(), MakeFunction(constraint));
+    }
+  }
+  return nlp;
+}
+
+StructuredSqpResult SolveWithStructuredSqp(
+    const MathematicalProgram& prog, const vector<int>& variable_stages,
+    const VectorXd& initial_guess, const StructuredSqpOptions& options,
+    MathematicalProgramResult* result) {
+  VectorXd x0 = initial_guess;
+  for (int i = 0; i < x0.size(); i++) {
+    if (std::isnan(x0(i))) x0(i) = 0;
+  }
+  const StructuredSqpResult sqp_result = SolveStructuredSqp(
+      MakeStructuredNlp(prog, variable_stages), x0, options);
+
+  double cost = 0;
+  for (const auto& binding : prog.GetAllCosts()) {
+    cost += prog.EvalBinding(binding, sqp_result.x)(0);
+  }
+
+  SolutionResult solution_result;
+  switch (sqp_result.status) {
+    case StructuredSqpResult::Status::kSolved:
+      solution_result = SolutionResult::kSolutionFound;
+      break;
+    case StructuredSqpResult::Status::kIterationLimit:
+      solution_result = SolutionResult::kIterationLimit;
+      break;
+    case StructuredSqpResult::Status::kInfeasible:
+      solution_result = SolutionResult::kInfeasibleConstraints;
+      break;
+    default:
+      solution_result = SolutionResult::kUnknownError;
+  }
+
+  result->set_decision_variable_index(prog.decision_variable_index());
+  result->set_x_val(sqp_result.x);
+  result->set_optimal_cost(cost);
+  result->set_solution_result(solution_result);
+  result->set_solver_id(drake::solvers::SolverId("StructuredSqp"));
+  return sqp_result;
+}
+
+}  // namespace solvers
+}  // namespace dairlib
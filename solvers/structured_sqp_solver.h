@@ -0,0 +1,33 @@
+#pragma once
+
+#include <vector>
+
+#include "solvers/structured_sqp.h"
+
+#include "drake/solvers/mathematical_program.h"
+#include "drake/solvers/mathematical_program_result.h"
+
+namespace dairlib {
+namespace solvers {
+
+/// Converts a MathematicalProgram into a StructuredNlp.
+/// Bounding box constraints become variable bounds, linear costs and
+/// constraints keep their exact derivatives, and the other costs and
+/// constraints are differentiated with AutoDiff.
+/// @param variable_stages stage of each decision variable, in the order of
+/// prog.decision_variables() (-1 for the dense border), e.g. from
+/// HybridDircon::GetDecisionVariableStages()
+StructuredNlp MakeStructuredNlp(const drake::solvers::MathematicalProgram& prog,
+                                const std::vector<int>& variable_stages);
+
+/// Solves the program with SolveStructuredSqp and writes the solution into
+/// result, as drake::solvers::Solve would (NaN entries of the initial guess
+/// are set to 0). The costs and solve statistics are in the returned value.
+StructuredSqpResult SolveWithStructuredSqp(
+    const drake::solvers::MathematicalProgram& prog,
+    const std::vector<int>& variable_stages,
+    const Eigen::VectorXd& initial_guess, const StructuredSqpOptions& options,
+    drake::solvers::MathematicalProgramResult* result);
+
+}  // namespace solvers
+}  // namespace dairlib
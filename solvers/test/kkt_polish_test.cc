@@ -0,0 +1,117 @@
+#include <cmath>
+#include <limits>
+#include <memory>
+
+#include <gtest/gtest.h>
+
+#include "solvers/kkt_polish.h"
+#include "solvers/nonlinear_constraint.h"
+
+#include "drake/solvers/mathematical_program.h"
+
+namespace dairlib {
+namespace solvers {
+namespace {
+
+using drake::AutoDiffXd;
+using drake::VectorX;
+using drake::solvers::MathematicalProgram;
+using Eigen::MatrixXd;
+using Eigen::Vector2d;
+using Eigen::VectorXd;
+
+// x' x <= 1
+class DiskConstraint : public NonlinearConstraint<AutoDiffXd> {
+ public:
+  DiskConstraint()
+      : NonlinearConstraint<AutoDiffXd>(
+            1, 2,
+            VectorXd::Constant(1, -std::numeric_limits<double>::infinity()),
+            VectorXd::Ones(1)) {}
+
+  void EvaluateConstraint(const Eigen::Ref<const VectorX<AutoDiffXd>>& x,
+                          VectorX<AutoDiffXd>* y) const override {
+    y->resize(1);
+    (*y)(0) = x(0) * x(0) + x(1) * x(1);
+  }
+};
+
+// x' x <= 1, with its gradient by forward differences
+class NumericalDiskConstraint : public NonlinearConstraint<double> {
+ public:
+  NumericalDiskConstraint()
+      : NonlinearConstraint<double>(
+            1, 2,
+            VectorXd::Constant(1, -std::numeric_limits<double>::infinity()),
+            VectorXd::Ones(1)) {}
+
+  void EvaluateConstraint(const Eigen::Ref<const VectorXd>& x,
+                          VectorXd* y) const override {
+    y->resize(1);
+    (*y)(0) = x(0) * x(0) + x(1) * x(1);
+  }
+};
+
+TEST(KktPolishTest, Converges) {
+  // min |x - (2, 1)|^2 s.t. x' x <= 1, -5 <= x <= 5
+  MathematicalProgram prog;
+  auto x = prog.NewContinuousVariables(2, "x");
+  prog.AddQuadraticCost(2 * MatrixXd::Identity(2, 2), Vector2d(-4, -2), x);
+  prog.AddConstraint(std::make_shared<DiskConstraint>(), x);
+  prog.AddBoundingBoxConstraint(-5, 5, x);
+
+  // Loose solution
+  const Vector2d x_opt = Vector2d(2, 1) / std::sqrt(5);
+  const auto result = PolishKktSolution(prog, x_opt + Vector2d(1e-3, -2e-3));
+  ASSERT_TRUE(result.is_success());
+  EXPECT_EQ(result.num_active, 1);
+  EXPECT_LE(result.iterations, 4);
+  EXPECT_LT((result.x - x_opt).norm(), 1e-9);
+  // Stationarity 2 (x - (2, 1)) + 2 lambda x = 0, and the bounding box
+  // multipliers are zero
+  EXPECT_NEAR(result.lambda.maxCoeff(), std::sqrt(5) - 1, 1e-8);
+  EXPECT_NEAR(result.lambda.minCoeff(), 0, 1e-12);
+}
+
+TEST(KktPolishTest, NumericalGradient) {
+  // As in Converges, with a constraint whose Jacobian is only accurate to
+  // about its differencing step, so is the stationarity
+  MathematicalProgram prog;
+  auto x = prog.NewContinuousVariables(2, "x");
+  prog.AddQuadraticCost(2 * MatrixXd::Identity(2, 2), Vector2d(-4, -2), x);
+  prog.AddConstraint(std::make_shared<NumericalDiskConstraint>(), x);
+  prog.AddBoundingBoxConstraint(-5, 5, x);
+
+  KktPolishOptions options;
+  options.optimality_tolerance = 1e-6;
+  const Vector2d x_opt = Vector2d(2, 1) / std::sqrt(5);
+  const auto result =
+      PolishKktSolution(prog, x_opt + Vector2d(1e-3, -2e-3), options);
+  ASSERT_TRUE(result.is_success());
+  EXPECT_EQ(result.num_active, 1);
+  // The Hessian of the constraint is accurate, so convergence is still
+  // quadratic
+  EXPECT_LE(result.iterations, 4);
+  EXPECT_LT((result.x - x_opt).norm(), 1e-6);
+  EXPECT_NEAR(result.lambda.maxCoeff(), std::sqrt(5) - 1, 1e-6);
+}
+
+TEST(KktPolishTest, ActiveSetChanged) {
+  // min (x - 0.5)^2 s.t. x <= 1, from a point that looks at the bound
+  MathematicalProgram prog;
+  auto x = prog.NewContinuousVariables(1, "x");
+  prog.AddQuadraticCost(2 * MatrixXd::Identity(1, 1), VectorXd::Constant(1, -1),
+                        x);
+  prog.AddBoundingBoxConstraint(-5, 1, x);
+  const auto result = PolishKktSolution(prog, VectorXd::Constant(1, 0.99995));
+  EXPECT_EQ(result.status, KktPolishResult::Status::kActiveSetChanged);
+}
+
+}  // namespace
+}  // namespace solvers
+}  // namespace dairlib
+
+int main(int argc, char** argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
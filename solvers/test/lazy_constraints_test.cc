@@ -0,0 +1,67 @@
+#include <gtest/gtest.h>
+
+#include "solvers/lazy_constraints.h"
+
+#include "drake/solvers/mathematical_program.h"
+
+namespace dairlib {
+namespace solvers {
+namespace {
+
+using drake::solvers::MathematicalProgram;
+using Eigen::MatrixXd;
+using Eigen::VectorXd;
+
+TEST(LazyConstraintsTest, AddsViolatedConstraints) {
+  // min |x - t|^2 s.t. x_i <= 1 (one linear inequality each), x_4 = x_5,
+  // -10 <= x_1 <= 0.25
+  MathematicalProgram prog;
+  auto x = prog.NewContinuousVariables(6, "x");
+  VectorXd t(6);
+  t << 2, 0.5, 2, 0.5, 2, 0.5;
+  prog.AddQuadraticErrorCost(MatrixXd::Identity(6, 6), t, x);
+  for (int i = 0; i < 6; i++) {
+    prog.AddLinearConstraint(MatrixXd::Ones(1, 1), VectorXd::Constant(1, -10),
+                             VectorXd::Ones(1), x.segment(i, 1));
+  }
+  prog.AddLinearEqualityConstraint(x(4) - x(5) == 0);
+  prog.AddBoundingBoxConstraint(-10, 0.25, x(1));
+
+  LazyConstraintStatistics statistics;
+  const auto result = SolveWithLazyConstraints(prog, VectorXd::Zero(6),
+                                               LazyConstraintOptions(),
+                                               &statistics);
+  ASSERT_TRUE(result.is_success());
+  VectorXd x_expected(6);
+  x_expected << 1, 0.25, 1, 0.5, 1, 1;
+  EXPECT_TRUE(result.GetSolution(x).isApprox(x_expected, 1e-4));
+
+  // The bounding box isn't lazy. The first solve, without the inequalities,
+  // violates those of x_0, x_2, x_4 and x_5, and the second one with them is
+  // feasible
+  EXPECT_TRUE(statistics.converged);
+  EXPECT_EQ(statistics.num_lazy_constraints_total, 6);
+  ASSERT_EQ(statistics.rounds, 2);
+  EXPECT_EQ(statistics.num_lazy_constraints[0], 0);
+  EXPECT_EQ(statistics.num_constraint_rows[0], 2);
+  EXPECT_EQ(statistics.num_lazy_constraints[1], 4);
+  EXPECT_EQ(statistics.num_constraint_rows[1], 6);
+
+  // Out of rounds, with violated inequalities
+  LazyConstraintOptions options;
+  options.max_rounds = 1;
+  const auto truncated =
+      SolveWithLazyConstraints(prog, VectorXd::Zero(6), options, &statistics);
+  EXPECT_FALSE(truncated.is_success());
+  EXPECT_FALSE(statistics.converged);
+  EXPECT_EQ(statistics.rounds, 1);
+}
+
+}  // namespace
+}  // namespace solvers
+}  // namespace dairlib
+
+int main(int argc, char** argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
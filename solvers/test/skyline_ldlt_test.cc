@@ -0,0 +1,130 @@
+#include <gtest/gtest.h>
+
+#include "solvers/skyline_ldlt.h"
+
+namespace dairlib {
+namespace solvers {
+namespace {
+
+using Eigen::MatrixXd;
+using Eigen::VectorXd;
+using std::vector;
+
+// Quasi-definite KKT matrix [H J'; J -D] of a chain of stages, each with
+// nx variables and nc constraints on its own variables and the previous
+// stage's, ordered stage by stage, plus a border of m dense rows
+MatrixXd MakeChainKkt(int num_stages, int nx, int nc, int m,
+                      vector<int>* first_column) {
+  std::srand(1);
+  const int stage_size = nx + nc;
+  const int n = num_stages * stage_size;
+  MatrixXd K = MatrixXd::Zero(n + m, n + m);
+  for (int s = 0; s < num_stages; s++) {
+    const int x = s * stage_size;
+    const int c = x + nx;
+    const MatrixXd L = MatrixXd::Random(nx, nx);
+    K.block(x, x, nx, nx) = L * L.transpose() + MatrixXd::Identity(nx, nx);
+    K.block(c, x, nc, nx) = MatrixXd::Random(nc, nx);
+    if (s > 0) {
+      K.block(c, x - stage_size, nc, nx) = MatrixXd::Random(nc, nx);
+    }
+    K.block(c, c, nc, nc) = -1e-3 * MatrixXd::Identity(nc, nc);
+  }
+  // Border constraints on the variables of all the stages
+  for (int s = 0; s < num_stages; s++) {
+    K.block(n, s * stage_size, m, nx) = MatrixXd::Random(m, nx);
+  }
+  K.bottomRightCorner(m, m) = -1e-3 * MatrixXd::Identity(m, m);
+  K = K.triangularView<Eigen::Lower>();
+  K = K + K.transpose() - MatrixXd(K.diagonal().asDiagonal());
+
+  first_column->clear();
+  for (int i = 0; i < n; i++) {
+    int j = 0;
+    while (K(i, j) == 0) j++;
+    first_column->push_back(j);
+  }
+  return K;
+}
+
+BorderedSkylineLdlt Assemble(const MatrixXd& K,
+                             const vector<int>& first_column) {
+  const int n = first_column.size();
+  BorderedSkylineLdlt ldlt(first_column, K.rows() - n);
+  for (int i = 0; i < K.rows(); i++) {
+    for (int j = 0; j <= i; j++) {
+      if (K(i, j) != 0) ldlt.Add(i, j, K(i, j));
+    }
+  }
+  return ldlt;
+}
+
+TEST(SkylineLdltTest, Solve) {
+  vector<int> first_column;
+  const MatrixXd K = MakeChainKkt(10, 6, 4, 0, &first_column);
+  auto ldlt = Assemble(K, first_column);
+  // The skyline only covers two stages
+  EXPECT_LT(ldlt.num_skyline_entries(), 10 * 10 * 20);
+  EXPECT_EQ(ldlt.Get(7, 2), K(7, 2));
+
+  ASSERT_TRUE(ldlt.Factorize());
+  const VectorXd b = VectorXd::Random(K.rows());
+  const VectorXd x = ldlt.Solve(b);
+  EXPECT_LT((K * x - b).norm(), 1e-8 * b.norm());
+  EXPECT_EQ(ldlt.num_positive_eigenvalues(), 10 * 6);
+  EXPECT_EQ(ldlt.num_negative_eigenvalues(), 10 * 4);
+}
+
+TEST(SkylineLdltTest, Border) {
+  vector<int> first_column;
+  const MatrixXd K = MakeChainKkt(8, 5, 3, 4, &first_column);
+  auto ldlt = Assemble(K, first_column);
+  EXPECT_EQ(ldlt.num_border(), 4);
+
+  ASSERT_TRUE(ldlt.Factorize());
+  const VectorXd b = VectorXd::Random(K.rows());
+  const VectorXd x = ldlt.Solve(b);
+  EXPECT_LT((K * x - b).norm(), 1e-8 * b.norm());
+  EXPECT_EQ(ldlt.num_positive_eigenvalues(), 8 * 5);
+  EXPECT_EQ(ldlt.num_negative_eigenvalues(), 8 * 3 + 4);
+
+  // Reassembling the same structure
+  ldlt.SetZero();
+  for (int i = 0; i < K.rows(); i++) {
+    for (int j = 0; j <= i; j++) {
+      if (K(i, j) != 0) ldlt.Add(i, j, 2 * K(i, j));
+    }
+  }
+  ASSERT_TRUE(ldlt.Factorize());
+  EXPECT_LT((2 * K * ldlt.Solve(b) - b).norm(), 1e-8 * b.norm());
+}
+
+TEST(SkylineLdltTest, Inertia) {
+  // Indefinite Hessian: one negative curvature direction not removed by the
+  // constraints
+  vector<int> first_column = {0, 0, 0};
+  BorderedSkylineLdlt ldlt(first_column, 0);
+  ldlt.Add(0, 0, 1);
+  ldlt.Add(1, 1, -1);
+  ldlt.Add(2, 0, 1);
+  ldlt.Add(2, 2, -1e-8);
+  ASSERT_TRUE(ldlt.Factorize());
+  EXPECT_EQ(ldlt.num_positive_eigenvalues(), 1);
+  EXPECT_EQ(ldlt.num_negative_eigenvalues(), 2);
+}
+
+TEST(SkylineLdltTest, ZeroPivot) {
+  vector<int> first_column = {0, 1};
+  BorderedSkylineLdlt ldlt(first_column, 0);
+  ldlt.Add(0, 0, 1);
+  EXPECT_FALSE(ldlt.Factorize());
+}
+
+}  // namespace
+}  // namespace solvers
+}  // namespace dairlib
+
+int main(int argc, char** argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,178 @@
+#include <cmath>
+
+#include <gtest/gtest.h>
+
+#include "solvers/structured_sqp.h"
+
+namespace dairlib {
+namespace solvers {
+namespace {
+
+using Eigen::MatrixXd;
+using Eigen::VectorXd;
+
+TEST(StructuredSqpTest, Circle) {
+  // min x + y s.t. x^2 + y^2 = 2, with no stages (all border)
+  StructuredNlp nlp(2);
+  nlp.AddLinearConstraint({0, 1}, MatrixXd::Zero(0, 2), VectorXd(0),
+                          VectorXd(0));
+  nlp.AddQuadraticCost({0, 1}, MatrixXd::Zero(2, 2), VectorXd::Ones(2));
+  nlp.AddConstraint({0, 1}, VectorXd::Constant(1, 2), VectorXd::Constant(1, 2),
+                    [](const VectorXd& x, VectorXd* y, MatrixXd* dy_dx) {
+                      *y = VectorXd::Constant(1, x.squaredNorm());
+                      if (dy_dx) *dy_dx = 2 * x.transpose();
+                    });
+  const auto result = SolveStructuredSqp(nlp, Eigen::Vector2d(1, 0.5));
+  ASSERT_TRUE(result.is_success());
+  EXPECT_TRUE(result.x.isApprox(Eigen::Vector2d(-1, -1), 1e-6));
+  // Stationarity 1 + 2 lambda x = 0
+  EXPECT_NEAR(result.lambda(0), 0.5, 1e-6);
+  EXPECT_EQ(result.kkt_border, 3);
+}
+
+TEST(StructuredSqpTest, NumericalJacobian) {
+  // Circle, with the Jacobian of the constraint by forward differences as in
+  // NonlinearConstraint<double>, so only accurate to about its step
+  StructuredNlp nlp(2);
+  nlp.AddQuadraticCost({0, 1}, MatrixXd::Zero(2, 2), VectorXd::Ones(2));
+  auto f = [](const VectorXd& x) {
+    return VectorXd::Constant(1, x.squaredNorm());
+  };
+  nlp.AddConstraint({0, 1}, VectorXd::Constant(1, 2), VectorXd::Constant(1, 2),
+                    [f](const VectorXd& x, VectorXd* y, MatrixXd* dy_dx) {
+                      *y = f(x);
+                      if (!dy_dx) return;
+                      const double eps = 1e-8;
+                      dy_dx->resize(1, 2);
+                      for (int i = 0; i < 2; i++) {
+                        VectorXd x_plus = x;
+                        x_plus(i) += eps;
+                        dy_dx->col(i) = (f(x_plus) - *y) / eps;
+                      }
+                    });
+  const auto result = SolveStructuredSqp(nlp, Eigen::Vector2d(1, 0.5));
+  ASSERT_TRUE(result.is_success());
+  EXPECT_TRUE(result.x.isApprox(Eigen::Vector2d(-1, -1), 1e-6));
+  EXPECT_NEAR(result.lambda(0), 0.5, 1e-6);
+}
+
+TEST(StructuredSqpTest, Bounds) {
+  // min (x - 2)^2 + (y + 1)^2 + z^2 s.t. x <= 1, 0 <= y <= 3, z = 0.5
+  StructuredNlp nlp(3);
+  for (int i = 0; i < 3; i++) nlp.SetStage(i, i);
+  nlp.AddQuadraticCost({0, 1, 2}, 2 * MatrixXd::Identity(3, 3),
+                       Eigen::Vector3d(-4, 2, 0));
+  nlp.AddBounds(0, -10, 1);
+  nlp.AddBounds(1, 0, 3);
+  nlp.AddBounds(2, 0.5, 0.5);
+  const auto result = SolveStructuredSqp(nlp, Eigen::Vector3d(-5, 2, 0));
+  ASSERT_TRUE(result.is_success());
+  EXPECT_TRUE(result.x.isApprox(Eigen::Vector3d(1, 0, 0.5), 1e-6));
+}
+
+// Pendulum swing up with N knots of state (theta, omega) and input u, and a
+// timestep h shared by all the knots (border): min sum u^2 + h s.t.
+//   theta_{k+1} = theta_k + h omega_k
+//   omega_{k+1} = omega_k + h (u_k - sin(theta_k))
+//   |u| <= 0.3, 0.05 <= h <= 0.5, theta_0 = 0, omega_0 = 0, omega_N = 0
+//   theta_N - theta_0 = pi (coupling distant knots, also border)
+int theta(int k) { return 3 * k; }
+int omega(int k) { return 3 * k + 1; }
+int u(int k) { return 3 * k + 2; }
+
+StructuredNlp MakePendulumNlp(int num_knots) {
+  const int h = 3 * num_knots;
+  StructuredNlp nlp(3 * num_knots + 1);
+  for (int k = 0; k < num_knots; k++) {
+    for (int var : {theta(k), omega(k), u(k)}) nlp.SetStage(var, k);
+    nlp.AddBounds(u(k), -0.3, 0.3);
+    nlp.AddQuadraticCost({u(k)}, 2 * MatrixXd::Identity(1, 1),
+                         VectorXd::Zero(1));
+  }
+  nlp.AddBounds(h, 0.05, 0.5);
+  nlp.AddBounds(theta(0), 0, 0);
+  nlp.AddBounds(omega(0), 0, 0);
+  nlp.AddBounds(omega(num_knots - 1), 0, 0);
+  nlp.AddQuadraticCost({h}, MatrixXd::Zero(1, 1), VectorXd::Ones(1));
+  for (int k = 0; k + 1 < num_knots; k++) {
+    nlp.AddConstraint(
+        {theta(k), omega(k), u(k), theta(k + 1), omega(k + 1), h},
+        VectorXd::Zero(2), VectorXd::Zero(2),
+        [](const VectorXd& x, VectorXd* y, MatrixXd* dy_dx) {
+          const double h = x(5);
+          *y = Eigen::Vector2d(x(3) - x(0) - h * x(1),
+                               x(4) - x(1) - h * (x(2) - std::sin(x(0))));
+          if (dy_dx) {
+            dy_dx->resize(2, 6);
+            *dy_dx << -1, -h, 0, 1, 0, -x(1), h * std::cos(x(0)), -1, -h, 0,
+                1, -(x(2) - std::sin(x(0)));
+          }
+        });
+  }
+  MatrixXd A(1, 2);
+  A << -1, 1;
+  nlp.AddLinearConstraint({theta(0), theta(num_knots - 1)}, A,
+                          VectorXd::Constant(1, M_PI),
+                          VectorXd::Constant(1, M_PI));
+  return nlp;
+}
+
+VectorXd PendulumInitialGuess(int num_knots) {
+  VectorXd x0 = VectorXd::Zero(3 * num_knots + 1);
+  for (int k = 0; k < num_knots; k++) {
+    x0(theta(k)) = M_PI * k / (num_knots - 1);
+  }
+  x0(3 * num_knots) = 0.2;
+  return x0;
+}
+
+TEST(StructuredSqpTest, Pendulum) {
+  const int num_knots = 40;
+  const auto nlp = MakePendulumNlp(num_knots);
+  StructuredSqpOptions options;
+  const auto exact =
+      SolveStructuredSqp(nlp, PendulumInitialGuess(num_knots), options);
+  ASSERT_TRUE(exact.is_success());
+  EXPECT_LT(exact.constraint_violation, 1e-6);
+  // The timestep and the constraint on theta_N - theta_0 form the border
+  EXPECT_EQ(exact.kkt_border, 2);
+
+  // The input saturates
+  const VectorXd inputs = exact.x(Eigen::seqN(2, num_knots, 3));
+  EXPECT_NEAR(inputs.cwiseAbs().maxCoeff(), 0.3, 1e-6);
+
+  // From a nearby point, Gauss-Newton converges to the same solution (more
+  // slowly)
+  options.hessian = StructuredSqpOptions::Hessian::kGaussNewton;
+  options.max_iterations = 1000;
+  VectorXd x0 = exact.x;
+  for (int k = 0; k < num_knots; k++) x0(u(k)) *= 0.9;
+  const auto gauss_newton = SolveStructuredSqp(nlp, x0, options);
+  ASSERT_TRUE(gauss_newton.is_success());
+  EXPECT_NEAR(gauss_newton.cost, exact.cost, 1e-5 * exact.cost);
+  EXPECT_TRUE(gauss_newton.x.isApprox(exact.x, 1e-3));
+}
+
+TEST(StructuredSqpTest, LinearGrowth) {
+  // The KKT factorization stores a band, which grows linearly with the
+  // number of knots
+  StructuredSqpOptions options;
+  options.max_iterations = 0;
+  const auto short_horizon =
+      SolveStructuredSqp(MakePendulumNlp(50), PendulumInitialGuess(50),
+                         options);
+  const auto long_horizon =
+      SolveStructuredSqp(MakePendulumNlp(100), PendulumInitialGuess(100),
+                         options);
+  EXPECT_EQ(long_horizon.kkt_border, short_horizon.kkt_border);
+  EXPECT_LT(long_horizon.kkt_entries, 2.1 * short_horizon.kkt_entries);
+}
+
+}  // namespace
+}  // namespace solvers
+}  // namespace dairlib
+
+int main(int argc, char** argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -39,7 +39,8 @@ CPTrajGenerator::CPTrajGenerator(
     double desired_final_foot_height,
     double desired_final_vertical_foot_velocity, double max_CoM_to_CP_dist,
     bool add_extra_control, bool is_feet_collision_avoid,
-    bool is_using_predicted_com, double cp_offset, double center_line_offset)
+    bool is_using_predicted_com, double cp_offset, double center_line_offset,
+    double update_period)
     : plant_(plant),
       left_right_support_fsm_states_(left_right_support_fsm_states),
       mid_foot_height_(mid_foot_height),
@@ -85,7 +86,12 @@ CPTrajGenerator::CPTrajGenerator(
                                   &CPTrajGenerator::CalcTrajs);
 
   // State variables inside this controller block
-  DeclarePerStepDiscreteUpdateEvent(&CPTrajGenerator::DiscreteVariableUpdate);
+  if (update_period > 0) {
+    DeclarePeriodicDiscreteUpdateEvent(
+        update_period, 0, &CPTrajGenerator::DiscreteVariableUpdate);
+  } else {
+    DeclarePerStepDiscreteUpdateEvent(&CPTrajGenerator::DiscreteVariableUpdate);
+  }
   // The swing foot position in the beginning of the swing phase
   prev_td_swing_foot_idx_ = this->DeclareDiscreteState(3);
   // The time of the last touch down
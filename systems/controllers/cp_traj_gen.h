@@ -40,6 +40,7 @@ namespace systems {
 ///     (use predicted center of mass position at touchdown to calculate CP)
 /// - CP offset (to avoid foot collision)
 /// - center line offset (used to restrict the CP within an area)
+/// - period of the discrete update (every simulator step if zero)
 
 class CPTrajGenerator : public drake::systems::LeafSystem<double> {
  public:
@@ -54,7 +55,8 @@ class CPTrajGenerator : public drake::systems::LeafSystem<double> {
                   double desired_final_vertical_foot_velocity,
                   double max_CoM_to_CP_dist, bool add_extra_control,
                   bool is_feet_collision_avoid, bool is_using_predicted_com,
-                  double cp_offset, double center_line_offset);
+                  double cp_offset, double center_line_offset,
+                  double update_period = 0);
 
   const drake::systems::InputPort<double>& get_input_port_state() const {
     return this->get_input_port(state_port_);
@@ -1,5 +1,7 @@
 #include "systems/controllers/endeffector_position_controller.h"
 
+#include <sstream>
+
 namespace dairlib{
 namespace systems{
 
@@ -8,7 +10,8 @@ EndEffectorPositionController::EndEffectorPositionController(
 	Eigen::Vector3d ee_contact_frame, double k_p, double k_omega)
 	: plant_(plant), plant_world_frame_(plant_.world_frame()),
 	ee_contact_frame_(ee_contact_frame),
-	ee_joint_frame_(plant_.GetFrameByName(ee_frame_name)){
+	ee_joint_frame_(plant_.GetFrameByName(ee_frame_name)),
+	warning_print_limiter_(kMinWarningPrintPeriod) {
 
   // Set up this block's input and output ports
   // Input port values will be accessed via EvalVectorInput() later
@@ -78,12 +81,17 @@ void EndEffectorPositionController::CalcOutputTwist(
   double linear_speed_limit = 3.0;
   double currVel = diff.norm();
 
+  // Speed limit warnings are printed asynchronously and rate limited, since
+  // this runs every control tick
   if (currVel > linear_speed_limit || currVel < -linear_speed_limit) {
       diff = diff * (linear_speed_limit/currVel);
-      std::cout << "Warning: desired end effector velocity: " << currVel;
-      std::cout << " exceeded limit of " << linear_speed_limit << std::endl;
-      currVel = diff.norm();
-      std::cout << "Set end effector velocity to " << currVel << std::endl;
+      if (warning_print_limiter_.Ready()) {
+        std::ostringstream out;
+        out << "Warning: desired end effector velocity: " << currVel
+            << " exceeded limit of " << linear_speed_limit << "\n"
+            << "Set end effector velocity to " << diff.norm();
+        AsyncDebugSink::Default().Log(out.str());
+      }
   }
 
   // Limit maximum commanded angular velocity
@@ -91,11 +99,14 @@ void EndEffectorPositionController::CalcOutputTwist(
   double currAngVel = angularVelocityWF.norm();
   if (currAngVel > angular_speed_limit || currAngVel < -angular_speed_limit) {
       angularVelocityWF = angularVelocityWF * (angular_speed_limit/currAngVel);
-      std::cout << "Warning: desired end effector velocity: " << currAngVel;
-      std::cout << " exceeded limit of " << angular_speed_limit << std::endl;
-      currAngVel = angularVelocityWF.norm();
-      std::cout << "Set end effector angular velocity to " << currAngVel;
-      std::cout << std::endl;
+      if (warning_print_limiter_.Ready()) {
+        std::ostringstream out;
+        out << "Warning: desired end effector velocity: " << currAngVel
+            << " exceeded limit of " << angular_speed_limit << "\n"
+            << "Set end effector angular velocity to "
+            << angularVelocityWF.norm();
+        AsyncDebugSink::Default().Log(out.str());
+      }
   }
 
   MatrixXd twist(6, 1);
@@ -1,5 +1,6 @@
 #pragma once
 
+#include "common/async_debug_sink.h"
 #include "systems/framework/timestamped_vector.h"
 #include "drake/systems/framework/leaf_system.h"
 #include "drake/systems/framework/basic_vector.h"
@@ -62,6 +63,9 @@ class EndEffectorPositionController : public LeafSystem<double> {
    const Frame<double>& plant_world_frame_;
    Eigen::Vector3d ee_contact_frame_;
    const Frame<double>& ee_joint_frame_;
+   // Speed limit warnings are printed at most once per period [s]
+   static constexpr double kMinWarningPrintPeriod = 0.5;
+   DebugRateLimiter warning_print_limiter_;
    double k_p_;
    double k_omega_;
    int joint_position_measured_port_;
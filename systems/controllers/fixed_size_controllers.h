@@ -0,0 +1,276 @@
+#pragma once
+
+#include <array>
+#include <vector>
+
+#include "drake/systems/framework/leaf_system.h"
+#include "systems/controllers/affine_controller.h"
+#include "systems/controllers/linear_controller.h"
+#include "systems/framework/output_vector.h"
+
+namespace dairlib {
+namespace systems {
+
+/// Compile-time-sized counterparts of LinearController and AffineController,
+/// plus a joint-space PD controller with diagonal-block gains.
+///
+/// The dynamic controllers copy the robot state into a fresh VectorXd and
+/// multiply it by a MatrixXd every tick. The classes here instead map the
+/// input port data directly onto fixed-size Eigen types, so CalcControl does
+/// no heap allocation and Eigen can unroll the products. The port layout is
+/// identical to the dynamic versions, so they are drop-in replacements.
+///
+/// Note that we implement the classes only in the header file because the
+/// dimensions are only known by the instantiating executable (see
+/// examples/Cassie/cassie_utils.h for Cassie's dimensions).
+
+/// FixedSizeLinearController computes u = K (x_desired - x) using a
+/// LinearConfig for (K, x_desired), like LinearController.
+template <int kNumPositions, int kNumVelocities, int kNumInputs>
+class FixedSizeLinearController : public drake::systems::LeafSystem<double> {
+ public:
+  static constexpr int kNumStates = kNumPositions + kNumVelocities;
+  using StateVector = Eigen::Matrix<double, kNumStates, 1>;
+  using InputVector = Eigen::Matrix<double, kNumInputs, 1>;
+  using GainMatrix = Eigen::Matrix<double, kNumInputs, kNumStates>;
+
+  FixedSizeLinearController() {
+    output_input_port_ =
+        this->DeclareVectorInputPort(OutputVector<double>(
+                                         kNumPositions, kNumVelocities,
+                                         kNumInputs))
+            .get_index();
+    config_input_port_ =
+        this->DeclareVectorInputPort(LinearConfig(kNumStates, kNumInputs))
+            .get_index();
+    this->DeclareVectorOutputPort(
+        TimestampedVector<double>(kNumInputs),
+        &FixedSizeLinearController::CalcControl);
+  }
+
+  const drake::systems::InputPort<double>& get_input_port_config() const {
+    return this->get_input_port(config_input_port_);
+  }
+
+  const drake::systems::InputPort<double>& get_input_port_output() const {
+    return this->get_input_port(output_input_port_);
+  }
+
+ private:
+  void CalcControl(const drake::systems::Context<double>& context,
+                   TimestampedVector<double>* control) const {
+    const auto* output = (OutputVector<double>*)this->EvalVectorInput(
+        context, output_input_port_);
+    const auto* config = dynamic_cast<const LinearConfig*>(
+        this->EvalVectorInput(context, config_input_port_));
+    DRAKE_THROW_UNLESS(config->GetK().rows() == kNumInputs);
+    DRAKE_THROW_UNLESS(config->GetK().cols() == kNumStates);
+
+    // OutputVector stores the state at the head of its data
+    Eigen::Map<const StateVector> x(output->get_value().data());
+    Eigen::Map<const StateVector> x_des(config->GetDesiredState().data());
+    Eigen::Map<const GainMatrix> K(config->GetK().data());
+    Eigen::Map<InputVector> u(control->get_mutable_value().data());
+
+    u.noalias() = K * (x_des - x);
+    control->set_timestamp(output->get_timestamp());
+  }
+
+  int output_input_port_;
+  int config_input_port_;
+};
+
+/// FixedSizeAffineController computes u = K (x_desired - x) + E using an
+/// AffineParams for (K, E, x_desired), like AffineController.
+template <int kNumPositions, int kNumVelocities, int kNumInputs>
+class FixedSizeAffineController : public drake::systems::LeafSystem<double> {
+ public:
+  static constexpr int kNumStates = kNumPositions + kNumVelocities;
+  using StateVector = Eigen::Matrix<double, kNumStates, 1>;
+  using InputVector = Eigen::Matrix<double, kNumInputs, 1>;
+  using GainMatrix = Eigen::Matrix<double, kNumInputs, kNumStates>;
+
+  FixedSizeAffineController() {
+    input_port_info_index_ =
+        this->DeclareVectorInputPort(OutputVector<double>(
+                                         kNumPositions, kNumVelocities,
+                                         kNumInputs))
+            .get_index();
+    input_port_params_index_ =
+        this->DeclareVectorInputPort(AffineParams(kNumStates, kNumInputs))
+            .get_index();
+    output_port_control_index_ =
+        this->DeclareVectorOutputPort(
+                TimestampedVector<double>(kNumInputs),
+                &FixedSizeAffineController::CalcControl)
+            .get_index();
+  }
+
+  const drake::systems::InputPort<double>& get_input_port_params() const {
+    return this->get_input_port(input_port_params_index_);
+  }
+
+  const drake::systems::InputPort<double>& get_input_port_info() const {
+    return this->get_input_port(input_port_info_index_);
+  }
+
+  const drake::systems::OutputPort<double>& get_output_port_control() const {
+    return this->get_output_port(output_port_control_index_);
+  }
+
+ private:
+  void CalcControl(const drake::systems::Context<double>& context,
+                   TimestampedVector<double>* control) const {
+    const auto* info = (OutputVector<double>*)this->EvalVectorInput(
+        context, input_port_info_index_);
+    const auto* params = dynamic_cast<const AffineParams*>(
+        this->EvalVectorInput(context, input_port_params_index_));
+
+    // AffineParams stores x = [K; E; desired_state] contiguously
+    const double* data = params->get_value().data();
+    Eigen::Map<const GainMatrix> K(data);
+    Eigen::Map<const InputVector> E(data + kNumInputs * kNumStates);
+    Eigen::Map<const StateVector> x_des(data + kNumInputs * kNumStates +
+                                        kNumInputs);
+    Eigen::Map<const StateVector> x(info->get_value().data());
+    Eigen::Map<InputVector> u(control->get_mutable_value().data());
+
+    u.noalias() = K * (x_des - x);
+    u += E;
+    control->set_timestamp(info->get_timestamp());
+  }
+
+  int input_port_info_index_;
+  int input_port_params_index_;
+  int output_port_control_index_;
+};
+
+/// JointPDGains stores a per-actuator PD configuration, for robots where each
+/// actuator drives exactly one joint (position and velocity coordinate).
+/// This is the diagonal-block form of a LinearConfig: K has only the two
+/// entries (kp, kd) per row, so only 4 * num_actuators values are stored.
+/// Uses Eigen Maps to map the vector data, in this order
+///   x = [kp; kd; desired_position; desired_velocity]
+class JointPDGains : public TimestampedVector<double> {
+ public:
+  explicit JointPDGains(int num_actuators)
+      : TimestampedVector<double>(4 * num_actuators),
+        num_actuators_(num_actuators),
+        kp_(get_mutable_data().data(), num_actuators),
+        kd_(get_mutable_data().data() + num_actuators, num_actuators),
+        desired_position_(get_mutable_data().data() + 2 * num_actuators,
+                          num_actuators),
+        desired_velocity_(get_mutable_data().data() + 3 * num_actuators,
+                          num_actuators) {}
+
+  int get_num_actuators() const { return num_actuators_; }
+
+  const Eigen::Map<Eigen::VectorXd>& get_kp() const { return kp_; }
+  const Eigen::Map<Eigen::VectorXd>& get_kd() const { return kd_; }
+  const Eigen::Map<Eigen::VectorXd>& get_desired_position() const {
+    return desired_position_;
+  }
+  const Eigen::Map<Eigen::VectorXd>& get_desired_velocity() const {
+    return desired_velocity_;
+  }
+
+  Eigen::Map<Eigen::VectorXd>& get_mutable_kp() { return kp_; }
+  Eigen::Map<Eigen::VectorXd>& get_mutable_kd() { return kd_; }
+  Eigen::Map<Eigen::VectorXd>& get_mutable_desired_position() {
+    return desired_position_;
+  }
+  Eigen::Map<Eigen::VectorXd>& get_mutable_desired_velocity() {
+    return desired_velocity_;
+  }
+
+ private:
+  JointPDGains* DoClone() const override {
+    return new JointPDGains(num_actuators_);
+  }
+
+  int num_actuators_;
+  Eigen::Map<Eigen::VectorXd> kp_;
+  Eigen::Map<Eigen::VectorXd> kd_;
+  Eigen::Map<Eigen::VectorXd> desired_position_;
+  Eigen::Map<Eigen::VectorXd> desired_velocity_;
+};
+
+/// FixedSizeJointPDController computes, for every actuator i,
+///   u_i = kp_i (q_des_i - q[q_ind_i]) + kd_i (v_des_i - v[v_ind_i])
+/// from a JointPDGains input. This is equivalent to LinearController with the
+/// dense K built by PDConfigReceiver, but costs O(num_inputs) per tick.
+/// The actuator-to-joint index maps are fixed at construction, typically from
+/// PDConfigReceiver::actuator_to_position_index() and
+/// actuator_to_velocity_index(). Actuators with a negative position index
+/// (e.g. those on quaternion joints) get no position feedback.
+template <int kNumPositions, int kNumVelocities, int kNumInputs>
+class FixedSizeJointPDController : public drake::systems::LeafSystem<double> {
+ public:
+  using InputVector = Eigen::Matrix<double, kNumInputs, 1>;
+
+  FixedSizeJointPDController(const std::vector<int>& position_index,
+                             const std::vector<int>& velocity_index) {
+    DRAKE_THROW_UNLESS(position_index.size() == kNumInputs);
+    DRAKE_THROW_UNLESS(velocity_index.size() == kNumInputs);
+    for (int i = 0; i < kNumInputs; i++) {
+      DRAKE_THROW_UNLESS(position_index[i] < kNumPositions);
+      DRAKE_THROW_UNLESS(velocity_index[i] >= 0 &&
+                         velocity_index[i] < kNumVelocities);
+      position_index_[i] = position_index[i];
+      velocity_index_[i] = velocity_index[i];
+    }
+
+    output_input_port_ =
+        this->DeclareVectorInputPort(OutputVector<double>(
+                                         kNumPositions, kNumVelocities,
+                                         kNumInputs))
+            .get_index();
+    gains_input_port_ =
+        this->DeclareVectorInputPort(JointPDGains(kNumInputs)).get_index();
+    this->DeclareVectorOutputPort(
+        TimestampedVector<double>(kNumInputs),
+        &FixedSizeJointPDController::CalcControl);
+  }
+
+  const drake::systems::InputPort<double>& get_input_port_gains() const {
+    return this->get_input_port(gains_input_port_);
+  }
+
+  const drake::systems::InputPort<double>& get_input_port_output() const {
+    return this->get_input_port(output_input_port_);
+  }
+
+ private:
+  void CalcControl(const drake::systems::Context<double>& context,
+                   TimestampedVector<double>* control) const {
+    const auto* output = (OutputVector<double>*)this->EvalVectorInput(
+        context, output_input_port_);
+    const double* q = output->get_value().data();
+    const double* v = q + kNumPositions;
+
+    // JointPDGains stores [kp; kd; desired_position; desired_velocity]
+    const double* gains = this->EvalVectorInput(context, gains_input_port_)
+                              ->get_value().data();
+    Eigen::Map<const InputVector> kp(gains);
+    Eigen::Map<const InputVector> kd(gains + kNumInputs);
+    Eigen::Map<const InputVector> q_des(gains + 2 * kNumInputs);
+    Eigen::Map<const InputVector> v_des(gains + 3 * kNumInputs);
+
+    Eigen::Map<InputVector> u(control->get_mutable_value().data());
+    for (int i = 0; i < kNumInputs; i++) {
+      u(i) = kd(i) * (v_des(i) - v[velocity_index_[i]]);
+      if (position_index_[i] >= 0) {
+        u(i) += kp(i) * (q_des(i) - q[position_index_[i]]);
+      }
+    }
+    control->set_timestamp(output->get_timestamp());
+  }
+
+  std::array<int, kNumInputs> position_index_;
+  std::array<int, kNumInputs> velocity_index_;
+  int output_input_port_;
+  int gains_input_port_;
+};
+
+}  // namespace systems
+}  // namespace dairlib
@@ -47,9 +47,13 @@ class LinearConfig : public TimestampedVector<double> {
         num_states_(num_states), num_inputs_(num_inputs) {};
 
     //Getters and setters
-    VectorXd GetDesiredState() const {return desired_state_;};
+    const VectorXd& GetDesiredState() const {return desired_state_;};
 
-    MatrixXd GetK() const {return K_;};
+    const MatrixXd& GetK() const {return K_;};
+
+    VectorXd& GetMutableDesiredState() {return desired_state_;};
+
+    MatrixXd& GetMutableK() {return K_;};
 
     void SetDesiredState(VectorXd desired_state) {
       desired_state_ = desired_state;
@@ -61,7 +65,10 @@ class LinearConfig : public TimestampedVector<double> {
 
   private:
     LinearConfig* DoClone() const override {
-      return new LinearConfig(num_states_, num_inputs_);
+      auto clone = new LinearConfig(num_states_, num_inputs_);
+      clone->SetDesiredState(desired_state_);
+      clone->SetK(K_);
+      return clone;
     }
 
     int num_states_;
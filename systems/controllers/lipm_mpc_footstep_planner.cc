@@ -0,0 +1,416 @@
+#include "systems/controllers/lipm_mpc_footstep_planner.h"
+
+#include <math.h>
+#include <algorithm>
+#include <chrono>
+
+using std::vector;
+using std::chrono::duration;
+using std::chrono::steady_clock;
+
+using Eigen::Matrix2d;
+using Eigen::MatrixXd;
+using Eigen::Quaterniond;
+using Eigen::Vector2d;
+using Eigen::Vector3d;
+using Eigen::VectorXd;
+
+using drake::multibody::Frame;
+using drake::multibody::JacobianWrtVariable;
+using drake::multibody::MultibodyPlant;
+using drake::systems::BasicVector;
+using drake::systems::Context;
+using drake::systems::DiscreteValues;
+using drake::systems::EventStatus;
+
+namespace dairlib {
+namespace systems {
+
+/**** LipmFootstepMpc ****/
+LipmFootstepMpc::LipmFootstepMpc(const LipmFootstepMpcParams& params)
+    : params_(params) {
+  DRAKE_DEMAND(params.horizon >= 1);
+  DRAKE_DEMAND(params.step_duration > 0);
+  DRAKE_DEMAND(params.min_step_width <= params.max_step_width);
+  DRAKE_DEMAND(params.max_step_length >= 0);
+  DRAKE_DEMAND(params.dcm_weight >= 0 && params.step_weight > 0);
+  DRAKE_DEMAND(params.max_iterations >= 1);
+}
+
+LipmFootstepMpc::WarmStart LipmFootstepMpc::MakeWarmStart() const {
+  WarmStart warm_start;
+  warm_start.steps = Eigen::Matrix2Xd::Zero(2, params_.horizon);
+  return warm_start;
+}
+
+LipmFootstepMpc::Solution LipmFootstepMpc::Solve(
+    double omega, double time_to_touchdown, const Vector2d& dcm,
+    const Vector2d& desired_velocity, bool first_step_is_left,
+    WarmStart* warm_start) const {
+  const auto start = steady_clock::now();
+  DRAKE_DEMAND(omega > 0);
+
+  const int n = params_.horizon;
+  const double T = params_.step_duration;
+  const double e = exp(omega * T);
+  DRAKE_DEMAND(warm_start->steps.cols() == n);
+
+  // Condensed dynamics. With b_k the DCM relative to p_k at the start of step
+  // k, b_(k+1) = e * b_k - d_(k+1), so the DCM offsets at the end of the
+  // steps are
+  //   beta_k = e * b_k = e^k * b_1' - sum_(j<=k) e^(k-j+1) d_j,
+  // where b_1' is the DCM offset from the current stance foot at touchdown.
+  MatrixXd G = MatrixXd::Zero(n, n);
+  for (int k = 0; k < n; k++) {
+    for (int j = 0; j <= k; j++) {
+      G(k, j) = pow(e, k - j + 1);
+    }
+  }
+  const MatrixXd H = params_.dcm_weight * G.transpose() * G +
+                     params_.step_weight * MatrixXd::Identity(n, n);
+
+  Solution solution;
+  solution.footsteps.resize(2, n);
+  solution.dcm_at_touchdown = exp(omega * time_to_touchdown) * dcm;
+
+  if (warm_start->valid &&
+      first_step_is_left != warm_start->first_step_is_left) {
+    ShiftWarmStart(warm_start);
+  }
+
+  VectorXd f(n), beta_nom(n), d_nom(n), g(n), lb(n), ub(n), x(n);
+  vector<BoundState> bound_state(n);
+  solution.converged = true;
+  for (int axis = 0; axis < 2; axis++) {
+    // Nominal periodic gait. Lateral steps alternate between the two sides,
+    // so the nominal DCM offsets do too.
+    const double v = desired_velocity(axis);
+    for (int k = 0; k < n; k++) {
+      // +1 if step k places the left foot
+      const double side = ((k % 2 == 0) == first_step_is_left) ? 1 : -1;
+      const double w = (axis == 0) ? 0 : side * params_.nominal_step_width;
+      f(k) = pow(e, k + 1) * solution.dcm_at_touchdown(axis);
+      d_nom(k) = w + v * T;
+      beta_nom(k) = e * (v * T / (e - 1) - w / (e + 1));
+      if (axis == 0) {
+        lb(k) = -params_.max_step_length;
+        ub(k) = params_.max_step_length;
+      } else if (side > 0) {
+        lb(k) = params_.min_step_width;
+        ub(k) = params_.max_step_width;
+      } else {
+        lb(k) = -params_.max_step_width;
+        ub(k) = -params_.min_step_width;
+      }
+    }
+    g = -params_.dcm_weight * G.transpose() * (f - beta_nom) -
+        params_.step_weight * d_nom;
+
+    // Warm start, made consistent with the current bounds
+    x = warm_start->valid ? VectorXd(warm_start->steps.row(axis).transpose())
+                          : d_nom;
+    for (int k = 0; k < n; k++) {
+      if (x(k) <= lb(k)) {
+        x(k) = lb(k);
+        bound_state[k] = kLower;
+      } else if (x(k) >= ub(k)) {
+        x(k) = ub(k);
+        bound_state[k] = kUpper;
+      } else {
+        bound_state[k] = kFree;
+      }
+    }
+
+    int iterations = 0;
+    solution.converged &= SolveBoxQp(H, g, lb, ub, &x, &bound_state,
+                                     &iterations);
+    solution.iterations += iterations;
+
+    warm_start->steps.row(axis) = x.transpose();
+
+    // Footsteps relative to the current stance foot
+    double p = 0;
+    for (int k = 0; k < n; k++) {
+      p += x(k);
+      solution.footsteps(axis, k) = p;
+    }
+  }
+  warm_start->first_step_is_left = first_step_is_left;
+  warm_start->valid = true;
+
+  solution.solve_time = duration<double>(steady_clock::now() - start).count();
+  return solution;
+}
+
+bool LipmFootstepMpc::SolveBoxQp(const MatrixXd& H, const VectorXd& g,
+                                 const VectorXd& lb, const VectorXd& ub,
+                                 VectorXd* x, vector<BoundState>* bound_state,
+                                 int* iterations) const {
+  const int n = x->size();
+  vector<int> free_indices;
+  free_indices.reserve(n);
+  VectorXd step(n);
+
+  while (true) {
+    if (*iterations >= params_.max_iterations) {
+      return false;
+    }
+    (*iterations)++;
+
+    // Minimize over the free variables, with the others fixed at their bounds
+    free_indices.clear();
+    for (int i = 0; i < n; i++) {
+      if ((*bound_state)[i] == kFree) free_indices.push_back(i);
+    }
+    const int n_free = free_indices.size();
+    step.setZero();
+    if (n_free > 0) {
+      MatrixXd H_free(n_free, n_free);
+      VectorXd rhs(n_free);
+      for (int i = 0; i < n_free; i++) {
+        const int row = free_indices[i];
+        rhs(i) = -g(row);
+        for (int j = 0; j < n; j++) {
+          if ((*bound_state)[j] != kFree) rhs(i) -= H(row, j) * (*x)(j);
+        }
+        for (int j = 0; j < n_free; j++) {
+          H_free(i, j) = H(row, free_indices[j]);
+        }
+      }
+      VectorXd x_free = H_free.llt().solve(rhs);
+      for (int i = 0; i < n_free; i++) {
+        step(free_indices[i]) = x_free(i) - (*x)(free_indices[i]);
+      }
+    }
+
+    if (step.norm() > 1e-12 * (1 + x->norm())) {
+      // Move toward the minimizer, stopping at the first bound hit
+      double alpha = 1;
+      int blocking = -1;
+      BoundState blocking_state = kFree;
+      for (int i : free_indices) {
+        if (step(i) < 0 && (*x)(i) + step(i) < lb(i)) {
+          double alpha_i = (lb(i) - (*x)(i)) / step(i);
+          if (alpha_i < alpha) {
+            alpha = alpha_i;
+            blocking = i;
+            blocking_state = kLower;
+          }
+        } else if (step(i) > 0 && (*x)(i) + step(i) > ub(i)) {
+          double alpha_i = (ub(i) - (*x)(i)) / step(i);
+          if (alpha_i < alpha) {
+            alpha = alpha_i;
+            blocking = i;
+            blocking_state = kUpper;
+          }
+        }
+      }
+      *x += alpha * step;
+      if (blocking >= 0) {
+        (*x)(blocking) =
+            (blocking_state == kLower) ? lb(blocking) : ub(blocking);
+        (*bound_state)[blocking] = blocking_state;
+        continue;
+      }
+    }
+
+    // At the minimizer of the working set. Release the bound with the most
+    // negative multiplier, if any. The tolerance is relative to the scale of
+    // H, which grows quickly with the horizon.
+    VectorXd gradient = H * (*x) + g;
+    int release = -1;
+    double min_multiplier = -1e-10 * H.diagonal().maxCoeff();
+    for (int i = 0; i < n; i++) {
+      double multiplier = 0;
+      if ((*bound_state)[i] == kLower) {
+        multiplier = gradient(i);
+      } else if ((*bound_state)[i] == kUpper) {
+        multiplier = -gradient(i);
+      }
+      if (multiplier < min_multiplier) {
+        min_multiplier = multiplier;
+        release = i;
+      }
+    }
+    if (release < 0) {
+      return true;
+    }
+    (*bound_state)[release] = kFree;
+  }
+}
+
+void LipmFootstepMpc::ShiftWarmStart(WarmStart* warm_start) const {
+  const int n = params_.horizon;
+  auto& steps = warm_start->steps;
+  for (int axis = 0; axis < 2; axis++) {
+    // The new last step is on the same side as the old second to last one
+    double last = (n >= 2) ? steps(axis, n - 2) : 0;
+    for (int k = 0; k < n - 1; k++) {
+      steps(axis, k) = steps(axis, k + 1);
+    }
+    steps(axis, n - 1) = last;
+  }
+}
+
+/**** LipmMpcFootstepPlanner ****/
+LipmMpcFootstepPlanner::LipmMpcFootstepPlanner(
+    const MultibodyPlant<double>& plant,
+    const vector<int>& left_right_support_fsm_states,
+    const vector<std::pair<const Vector3d, const Frame<double>&>>&
+        left_right_foot,
+    const LipmFootstepMpcParams& params, double update_period)
+    : plant_(plant),
+      world_(plant.world_frame()),
+      left_right_support_fsm_states_(left_right_support_fsm_states),
+      mpc_(params) {
+  this->set_name("lipm_mpc_footstep_planner");
+
+  DRAKE_DEMAND(left_right_support_fsm_states.size() == 2);
+  DRAKE_DEMAND(left_right_foot.size() == 2);
+
+  // Input/Output Setup
+  state_port_ =
+      this->DeclareVectorInputPort(OutputVector<double>(plant.num_positions(),
+                                                        plant.num_velocities(),
+                                                        plant.num_actuators()))
+          .get_index();
+  fsm_info_port_ =
+      this->DeclareVectorInputPort(FiniteStateMachineInfo()).get_index();
+  xy_port_ = this->DeclareVectorInputPort(BasicVector<double>(2)).get_index();
+  deviation_port_ =
+      this->DeclareVectorOutputPort(
+              BasicVector<double>(2),
+              &LipmMpcFootstepPlanner::CalcDeviationFromCp)
+          .get_index();
+  footsteps_port_ =
+      this->DeclareVectorOutputPort(BasicVector<double>(2 * params.horizon),
+                                    &LipmMpcFootstepPlanner::CalcFootsteps)
+          .get_index();
+
+  // The plan is updated once per step (or period), and both outputs read
+  // from it
+  if (update_period > 0) {
+    DeclarePeriodicDiscreteUpdateEvent(
+        update_period, 0, &LipmMpcFootstepPlanner::DiscreteVariableUpdate);
+  } else {
+    DeclarePerStepDiscreteUpdateEvent(
+        &LipmMpcFootstepPlanner::DiscreteVariableUpdate);
+  }
+  deviation_idx_ = this->DeclareDiscreteState(2);
+  footsteps_idx_ = this->DeclareDiscreteState(2 * params.horizon);
+  warm_start_idx_ = this->DeclareDiscreteState(2 * params.horizon + 2);
+
+  for (int i = 0; i < 2; i++) {
+    stance_foot_map_.insert(
+        {left_right_support_fsm_states.at(i), left_right_foot.at(i)});
+  }
+
+  // Create context
+  context_ = plant_.CreateDefaultContext();
+}
+
+EventStatus LipmMpcFootstepPlanner::DiscreteVariableUpdate(
+    const Context<double>& context,
+    DiscreteValues<double>* discrete_state) const {
+  const auto* fsm_info = (FiniteStateMachineInfo*)this->EvalVectorInput(
+      context, fsm_info_port_);
+  auto deviation =
+      discrete_state->get_mutable_vector(deviation_idx_).get_mutable_value();
+
+  // Only plan during single support
+  auto stance_foot = stance_foot_map_.find(fsm_info->get_fsm_state());
+  if (stance_foot == stance_foot_map_.end()) {
+    deviation.setZero();
+    return EventStatus::Succeeded();
+  }
+
+  // Read in current state and desired velocity
+  const OutputVector<double>* robot_output =
+      (OutputVector<double>*)this->EvalVectorInput(context, state_port_);
+  const BasicVector<double>* des_hor_vel_output =
+      (BasicVector<double>*)this->EvalVectorInput(context, xy_port_);
+  VectorXd q = robot_output->GetPositions();
+  VectorXd v = robot_output->GetVelocities();
+  plant_.SetPositions(context_.get(), q);
+
+  // Stance foot, center of mass and DCM
+  Vector3d stance_foot_pos;
+  plant_.CalcPointsPositions(*context_, stance_foot->second.second,
+                             stance_foot->second.first, world_,
+                             &stance_foot_pos);
+  Vector3d CoM = plant_.CalcCenterOfMassPosition(*context_);
+  MatrixXd J_com(3, plant_.num_velocities());
+  plant_.CalcJacobianCenterOfMassTranslationalVelocity(
+      *context_, JacobianWrtVariable::kV, world_, world_, &J_com);
+  Vector3d dCoM = J_com * v;
+  double com_height = CoM(2) - stance_foot_pos(2);
+  DRAKE_DEMAND(com_height > 0);
+  double omega = sqrt(9.81 / com_height);
+  Vector2d dcm = CoM.head(2) + dCoM.head(2) / omega - stance_foot_pos.head(2);
+
+  // Heading frame
+  Quaterniond quat(q(0), q(1), q(2), q(3));
+  Vector3d pelvis_heading_vec = quat.toRotationMatrix().col(0);
+  double yaw = atan2(pelvis_heading_vec(1), pelvis_heading_vec(0));
+  Matrix2d R;
+  R << cos(yaw), -sin(yaw), sin(yaw), cos(yaw);
+
+  bool first_step_is_left =
+      (fsm_info->get_fsm_state() == left_right_support_fsm_states_[1]);
+  auto warm_start = GetWarmStart(context);
+  const auto solution = mpc_.Solve(
+      omega, std::max(0.0, fsm_info->get_time_to_switch()),
+      R.transpose() * dcm, des_hor_vel_output->get_value(),
+      first_step_is_left, &warm_start);
+  SetWarmStart(warm_start,
+               &discrete_state->get_mutable_vector(warm_start_idx_));
+
+  deviation = R * (solution.footsteps.col(0) - solution.dcm_at_touchdown);
+  auto footsteps =
+      discrete_state->get_mutable_vector(footsteps_idx_).get_mutable_value();
+  for (int k = 0; k < solution.footsteps.cols(); k++) {
+    footsteps.segment<2>(2 * k) =
+        stance_foot_pos.head(2) + R * solution.footsteps.col(k);
+  }
+  return EventStatus::Succeeded();
+}
+
+LipmFootstepMpc::WarmStart LipmMpcFootstepPlanner::GetWarmStart(
+    const Context<double>& context) const {
+  const int n = mpc_.params().horizon;
+  const auto state = context.get_discrete_state(warm_start_idx_).get_value();
+  auto warm_start = mpc_.MakeWarmStart();
+  for (int axis = 0; axis < 2; axis++) {
+    warm_start.steps.row(axis) = state.segment(axis * n, n).transpose();
+  }
+  warm_start.first_step_is_left = state(2 * n) != 0;
+  warm_start.valid = state(2 * n + 1) != 0;
+  return warm_start;
+}
+
+void LipmMpcFootstepPlanner::SetWarmStart(
+    const LipmFootstepMpc::WarmStart& warm_start,
+    BasicVector<double>* state) const {
+  const int n = mpc_.params().horizon;
+  auto value = state->get_mutable_value();
+  for (int axis = 0; axis < 2; axis++) {
+    value.segment(axis * n, n) = warm_start.steps.row(axis).transpose();
+  }
+  value(2 * n) = warm_start.first_step_is_left;
+  value(2 * n + 1) = warm_start.valid;
+}
+
+void LipmMpcFootstepPlanner::CalcDeviationFromCp(
+    const Context<double>& context, BasicVector<double>* output) const {
+  output->get_mutable_value() =
+      context.get_discrete_state(deviation_idx_).get_value();
+}
+
+void LipmMpcFootstepPlanner::CalcFootsteps(const Context<double>& context,
+                                           BasicVector<double>* output) const {
+  output->get_mutable_value() =
+      context.get_discrete_state(footsteps_idx_).get_value();
+}
+
+}  // namespace systems
+}  // namespace dairlib
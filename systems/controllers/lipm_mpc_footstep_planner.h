@@ -0,0 +1,221 @@
+#pragma once
+
+#include <map>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include <Eigen/Dense>
+
+#include "systems/controllers/scheduled_fsm.h"
+#include "systems/framework/output_vector.h"
+
+#include "drake/multibody/plant/multibody_plant.h"
+#include "drake/systems/framework/leaf_system.h"
+
+namespace dairlib {
+namespace systems {
+
+/// Parameters of LipmFootstepMpc. Lengths are in meters, times in seconds.
+struct LipmFootstepMpcParams {
+  /// Number of planned footsteps
+  int horizon = 3;
+  /// Duration of each planned step
+  double step_duration = 0.35;
+  /// Nominal lateral distance between the feet
+  double nominal_step_width = 0.2;
+  /// Kinematic limits on the step displacement (from the previous footstep)
+  /// in the heading frame
+  double max_step_length = 0.4;
+  double min_step_width = 0.1;
+  double max_step_width = 0.45;
+  /// Cost weights on the DCM offset at the end of each step, and on the
+  /// deviation of each step from the nominal (periodic) gait
+  double dcm_weight = 1;
+  double step_weight = 0.1;
+  /// Hard limit on the active-set iterations per axis. A solve that hits it
+  /// returns its current (feasible) iterate. The limit bounds the solve time
+  /// without making the plan depend on the load of the machine.
+  int max_iterations = 20;
+};
+
+/// LipmFootstepMpc plans the next `horizon` footsteps of a linear inverted
+/// pendulum (LIPM) walker with a small QP.
+///
+/// With the divergent component of motion (DCM) xi = c + cdot / omega and the
+/// stance foot p_k, the LIPM dynamics over a step of duration T are
+///   xi(T) = p_k + e^(omega T) (xi(0) - p_k).
+/// The decision variables are the step displacements d_k = p_k - p_(k-1),
+/// k = 1..N, so that the kinematic limits are simple bounds. The DCM is
+/// eliminated (condensed formulation), and the two horizontal axes of the
+/// heading frame are independent QPs of size N
+///   min_d  sum_k  dcm_weight * (xi_end,k - p_k - xi_nom,k)^2
+///               + step_weight * (d_k - d_nom,k)^2
+///   s.t.   d_lb <= d <= d_ub
+/// where xi_nom and d_nom describe the periodic gait at the desired velocity.
+///
+/// The QPs are solved with a primal active-set method, warm started from the
+/// active set of the previous solve (shifted by one step after a touchdown).
+/// Every iterate is feasible, so hitting max_iterations still yields a usable
+/// plan. The warm start is passed in by the caller, so that Solve is a pure
+/// function of its arguments.
+class LipmFootstepMpc {
+ public:
+  /// Solver state carried from one solve to the next. The active set is the
+  /// set of steps at their bounds.
+  struct WarmStart {
+    /// Step displacements of the last solve, one row per axis (2 x horizon)
+    Eigen::Matrix2Xd steps;
+    bool first_step_is_left = false;
+    /// False until the first solve
+    bool valid = false;
+  };
+
+  struct Solution {
+    /// Planned footsteps relative to the current stance foot, in the heading
+    /// frame (2 x horizon)
+    Eigen::Matrix2Xd footsteps;
+    /// DCM relative to the stance foot at the end of the current step
+    Eigen::Vector2d dcm_at_touchdown;
+    int iterations = 0;
+    /// Wall-clock time of the solve, for diagnostics only
+    double solve_time = 0;
+    bool converged = false;
+  };
+
+  explicit LipmFootstepMpc(const LipmFootstepMpcParams& params);
+
+  /// An empty warm start, for the first solve
+  WarmStart MakeWarmStart() const;
+
+  /// @param omega LIPM natural frequency, sqrt(g / CoM height)
+  /// @param time_to_touchdown remaining duration of the current stance
+  /// @param dcm DCM relative to the stance foot, in the heading frame
+  /// @param desired_velocity desired CoM velocity, in the heading frame
+  /// @param first_step_is_left true if the first planned step places the left
+  ///   foot (i.e. the robot is in right stance)
+  /// @param warm_start the solver state of the previous solve, updated in
+  ///   place
+  Solution Solve(double omega, double time_to_touchdown,
+                 const Eigen::Vector2d& dcm,
+                 const Eigen::Vector2d& desired_velocity,
+                 bool first_step_is_left, WarmStart* warm_start) const;
+
+  const LipmFootstepMpcParams& params() const { return params_; }
+
+ private:
+  enum BoundState { kFree = 0, kLower = 1, kUpper = 2 };
+
+  // Solves min 0.5 x'Hx + g'x s.t. lb <= x <= ub from the warm start in x and
+  // bound_state. Returns false if the iteration limit was hit.
+  bool SolveBoxQp(const Eigen::MatrixXd& H, const Eigen::VectorXd& g,
+                  const Eigen::VectorXd& lb, const Eigen::VectorXd& ub,
+                  Eigen::VectorXd* x, std::vector<BoundState>* bound_state,
+                  int* iterations) const;
+
+  // Drops the first step of the warm start after a touchdown
+  void ShiftWarmStart(WarmStart* warm_start) const;
+
+  const LipmFootstepMpcParams params_;
+};
+
+/// LipmMpcFootstepPlanner runs LipmFootstepMpc every control tick.
+///
+/// It is a drop-in replacement for cassie::osc::DeviationFromCapturePoint:
+/// output port 0 is the 2D deviation of the first planned footstep from the
+/// capture point at the end of the current stance (the capture point that
+/// CPTrajGenerator computes with the predicted CoM), in the world frame. The
+/// second output is the whole plan, as the world frame xy positions of the
+/// `horizon` footsteps.
+///
+/// Inputs:
+///  - state of the robot (quaternion floating base)
+///  - FiniteStateMachineInfo from ScheduledFiniteStateMachine, for the stance
+///    foot and the time to touchdown
+///  - desired horizontal velocity in the pelvis heading frame (as for
+///    DeviationFromCapturePoint)
+///
+/// Outside of the single support states, the output is zero.
+///
+/// The warm start of the MPC is part of the discrete state, so the plan only
+/// depends on the context (and a cloned context replays the same plans).
+///
+/// Constructor:
+///  @param plant, MultibodyPlant of the robot
+///  @param left_right_support_fsm_states, fsm states of left/right stance
+///  @param left_right_foot, left/right contact point and body frame
+///  @param params, parameters of the MPC
+///  @param update_period, period of the replanning (every simulator step if
+///    zero)
+class LipmMpcFootstepPlanner : public drake::systems::LeafSystem<double> {
+ public:
+  LipmMpcFootstepPlanner(
+      const drake::multibody::MultibodyPlant<double>& plant,
+      const std::vector<int>& left_right_support_fsm_states,
+      const std::vector<std::pair<const Eigen::Vector3d,
+                                  const drake::multibody::Frame<double>&>>&
+          left_right_foot,
+      const LipmFootstepMpcParams& params = LipmFootstepMpcParams(),
+      double update_period = 0);
+
+  const drake::systems::InputPort<double>& get_input_port_state() const {
+    return this->get_input_port(state_port_);
+  }
+  const drake::systems::InputPort<double>& get_input_port_fsm_info() const {
+    return this->get_input_port(fsm_info_port_);
+  }
+  const drake::systems::InputPort<double>& get_input_port_des_hor_vel() const {
+    return this->get_input_port(xy_port_);
+  }
+  const drake::systems::OutputPort<double>& get_output_port_deviation_from_cp()
+      const {
+    return this->get_output_port(deviation_port_);
+  }
+  const drake::systems::OutputPort<double>& get_output_port_footsteps() const {
+    return this->get_output_port(footsteps_port_);
+  }
+
+  const LipmFootstepMpc& get_mpc() const { return mpc_; }
+
+ private:
+  drake::systems::EventStatus DiscreteVariableUpdate(
+      const drake::systems::Context<double>& context,
+      drake::systems::DiscreteValues<double>* discrete_state) const;
+
+  void CalcDeviationFromCp(const drake::systems::Context<double>& context,
+                           drake::systems::BasicVector<double>* output) const;
+  void CalcFootsteps(const drake::systems::Context<double>& context,
+                     drake::systems::BasicVector<double>* output) const;
+
+  int state_port_;
+  int fsm_info_port_;
+  int xy_port_;
+  int deviation_port_;
+  int footsteps_port_;
+
+  // Copies the warm start to and from its discrete state vector
+  LipmFootstepMpc::WarmStart GetWarmStart(
+      const drake::systems::Context<double>& context) const;
+  void SetWarmStart(const LipmFootstepMpc::WarmStart& warm_start,
+                    drake::systems::BasicVector<double>* state) const;
+
+  // Discrete state: the deviation from the capture point and the footsteps
+  // of the last plan, and the warm start of the MPC (steps, then the
+  // first_step_is_left and valid flags)
+  int deviation_idx_;
+  int footsteps_idx_;
+  int warm_start_idx_;
+
+  const drake::multibody::MultibodyPlant<double>& plant_;
+  const drake::multibody::BodyFrame<double>& world_;
+  std::vector<int> left_right_support_fsm_states_;
+  std::map<int, std::pair<const Eigen::Vector3d,
+                          const drake::multibody::Frame<double>&>>
+      stance_foot_map_;
+
+  const LipmFootstepMpc mpc_;
+  std::unique_ptr<drake::systems::Context<double>> context_;
+};
+
+}  // namespace systems
+}  // namespace dairlib
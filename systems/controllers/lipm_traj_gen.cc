@@ -21,7 +21,6 @@ using drake::systems::EventStatus;
 
 using drake::multibody::JacobianWrtVariable;
 using drake::multibody::MultibodyPlant;
-using drake::trajectories::ExponentialPlusPiecewisePolynomial;
 using drake::trajectories::PiecewisePolynomial;
 
 namespace dairlib {
@@ -33,7 +32,8 @@ LIPMTrajGenerator::LIPMTrajGenerator(
     const vector<double>& unordered_state_durations,
     const vector<vector<std::pair<
         const Eigen::Vector3d, const drake::multibody::Frame<double>&>>>&
-        contact_points_in_each_state)
+        contact_points_in_each_state,
+    double update_period)
     : plant_(plant),
       desired_com_height_(desired_com_height),
       unordered_fsm_states_(unordered_fsm_states),
@@ -54,18 +54,21 @@ LIPMTrajGenerator::LIPMTrajGenerator(
                                                         plant.num_actuators()))
           .get_index();
   fsm_port_ = this->DeclareVectorInputPort(BasicVector<double>(1)).get_index();
-  // Provide an instance to allocate the memory first (for the output)
-  PiecewisePolynomial<double> pp_part(VectorXd(0));
-  MatrixXd K = MatrixXd::Ones(0, 0);
-  MatrixXd A = MatrixXd::Identity(0, 0);
-  MatrixXd alpha = MatrixXd::Ones(0, 0);
-  ExponentialPlusPiecewisePolynomial<double> exp(K, A, alpha, pp_part);
+  // Provide an instance to allocate the memory first (for the output). The
+  // parameterized type lets the OSC evaluate it with one segment lookup.
+  controllers::ParameterizedExponentialPlusPiecewisePolynomial exp;
   drake::trajectories::Trajectory<double>& traj_inst = exp;
   this->DeclareAbstractOutputPort("lipm_traj", traj_inst,
                                   &LIPMTrajGenerator::CalcTraj);
 
   // Discrete state event
-  DeclarePerStepDiscreteUpdateEvent(&LIPMTrajGenerator::DiscreteVariableUpdate);
+  if (update_period > 0) {
+    DeclarePeriodicDiscreteUpdateEvent(
+        update_period, 0, &LIPMTrajGenerator::DiscreteVariableUpdate);
+  } else {
+    DeclarePerStepDiscreteUpdateEvent(
+        &LIPMTrajGenerator::DiscreteVariableUpdate);
+  }
   // The time of the last touch down
   prev_td_time_idx_ = this->DeclareDiscreteState(1);
   // The last state of FSM
@@ -218,10 +221,10 @@ void LIPMTrajGenerator::CalcTraj(
   alpha << 1, 1;
 
   // Assign traj
-  auto exp_pp_traj = (ExponentialPlusPiecewisePolynomial<double>*)dynamic_cast<
-      ExponentialPlusPiecewisePolynomial<double>*>(traj);
-  *exp_pp_traj =
-      ExponentialPlusPiecewisePolynomial<double>(K, A, alpha, pp_part);
+  auto exp_pp_traj = dynamic_cast<
+      controllers::ParameterizedExponentialPlusPiecewisePolynomial*>(traj);
+  *exp_pp_traj = controllers::ParameterizedExponentialPlusPiecewisePolynomial(
+      K, A, alpha, pp_part);
 }
 
 }  // namespace systems
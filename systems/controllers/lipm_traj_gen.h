@@ -7,6 +7,7 @@
 
 #include "multibody/multibody_utils.h"
 #include "systems/controllers/control_utils.h"
+#include "systems/controllers/osc/trajectory_evaluation.h"
 #include "systems/framework/output_vector.h"
 
 namespace dairlib {
@@ -28,7 +29,9 @@ namespace systems {
 ///         body frame> pairs of plant for calculating the stance foot
 ///         position (of each state in unordered_fsm_states). If there are two
 ///         or more pairs, we get the average of the positions.
-/// The last three parameters must have the same size.
+///  @param update_period, period of the discrete update (every simulator step
+///         if zero)
+/// The fsm states, durations and contact points must have the same size.
 
 class LIPMTrajGenerator : public drake::systems::LeafSystem<double> {
  public:
@@ -38,7 +41,8 @@ class LIPMTrajGenerator : public drake::systems::LeafSystem<double> {
       const std::vector<double>& unordered_state_durations,
       const std::vector<std::vector<std::pair<
           const Eigen::Vector3d, const drake::multibody::Frame<double>&>>>&
-          contact_points_in_each_state);
+          contact_points_in_each_state,
+      double update_period = 0);
 
   const drake::systems::InputPort<double>& get_input_port_state() const {
     return this->get_input_port(state_port_);
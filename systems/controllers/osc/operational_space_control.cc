@@ -2,6 +2,7 @@
 #include <drake/multibody/plant/multibody_plant.h>
 #include "common/eigen_utils.h"
 #include "multibody/multibody_utils.h"
+#include "systems/framework/system_tracer.h"
 #include "drake/common/text_logging.h"
 
 using std::cout;
@@ -40,7 +41,8 @@ static const int SPACE_DIM = 3;
 OperationalSpaceControl::OperationalSpaceControl(
     const MultibodyPlant<double>& plant_w_spr,
     const MultibodyPlant<double>& plant_wo_spr,
-    bool used_with_finite_state_machine, bool print_tracking_info)
+    bool used_with_finite_state_machine, bool print_tracking_info,
+    double update_period)
     : plant_w_spr_(plant_w_spr),
       plant_wo_spr_(plant_wo_spr),
       world_w_spr_(plant_w_spr_.world_frame()),
@@ -68,8 +70,13 @@ OperationalSpaceControl::OperationalSpaceControl(
         this->DeclareVectorInputPort(BasicVector<double>(1)).get_index();
 
     // Discrete update to record the last state event time
-    DeclarePerStepDiscreteUpdateEvent(
-        &OperationalSpaceControl::DiscreteVariableUpdate);
+    if (update_period > 0) {
+      DeclarePeriodicDiscreteUpdateEvent(
+          update_period, 0, &OperationalSpaceControl::DiscreteVariableUpdate);
+    } else {
+      DeclarePerStepDiscreteUpdateEvent(
+          &OperationalSpaceControl::DiscreteVariableUpdate);
+    }
     prev_fsm_state_idx_ = this->DeclareDiscreteState(-0.1 * VectorXd::Ones(1));
     prev_event_time_idx_ = this->DeclareDiscreteState(VectorXd::Zero(1));
   }
@@ -189,6 +196,7 @@ void OperationalSpaceControl::AddTrackingData(OscTrackingData* tracking_data,
                                               double t_lb, double t_ub) {
   tracking_data_vec_->push_back(tracking_data);
   fixed_position_vec_.push_back(VectorXd::Zero(0));
+  fixed_position_traj_vec_.emplace_back();
   t_s_vec_.push_back(t_lb);
   t_e_vec_.push_back(t_ub);
 
@@ -211,6 +219,7 @@ void OperationalSpaceControl::AddConstTrackingData(
     double t_ub) {
   tracking_data_vec_->push_back(tracking_data);
   fixed_position_vec_.push_back(v);
+  fixed_position_traj_vec_.emplace_back(v);
   t_s_vec_.push_back(t_lb);
   t_e_vec_.push_back(t_ub);
 }
@@ -372,6 +381,7 @@ void OperationalSpaceControl::Build() {
 drake::systems::EventStatus OperationalSpaceControl::DiscreteVariableUpdate(
     const drake::systems::Context<double>& context,
     drake::systems::DiscreteValues<double>* discrete_state) const {
+  TraceScope trace("update", this->get_name(), "DiscreteVariableUpdate");
   const BasicVector<double>* fsm_output =
       (BasicVector<double>*)this->EvalVectorInput(context, fsm_port_);
   VectorXd fsm_state = fsm_output->get_value();
@@ -539,10 +549,10 @@ VectorXd OperationalSpaceControl::SolveQp(
 
     // Check whether or not it is a constant trajectory, and update TrackingData
     if (fixed_position_vec_.at(i).size() != 0) {
-      // Create constant trajectory and update
-      tracking_data->Update(
-          x_w_spr, *context_w_spr_, x_wo_spr, *context_wo_spr_,
-          PiecewisePolynomial<double>(fixed_position_vec_.at(i)), t, fsm_state);
+      // Update with the constant trajectory
+      tracking_data->Update(x_w_spr, *context_w_spr_, x_wo_spr,
+                            *context_wo_spr_, fixed_position_traj_vec_.at(i),
+                            t, fsm_state);
     } else {
       // Read in traj from input port
       string traj_name = tracking_data->GetName();
@@ -579,7 +589,11 @@ VectorXd OperationalSpaceControl::SolveQp(
   }
 
   // Solve the QP
-  const MathematicalProgramResult result = Solve(*prog_);
+  MathematicalProgramResult result;
+  {
+    TraceScope trace("solve", this->get_name(), "Solve");
+    result = Solve(*prog_);
+  }
   SolutionResult solution_result = result.get_solution_result();
   if (print_tracking_info_) {
     cout << "\n" << to_string(solution_result) << endl;
@@ -656,6 +670,7 @@ VectorXd OperationalSpaceControl::SolveQp(
 
 void OperationalSpaceControl::AssignOscLcmOutput(
     const Context<double>& context, dairlib::lcmt_osc_output* output) const {
+  TraceScope trace("calc", this->get_name(), "AssignOscLcmOutput");
   auto state =
       (OutputVector<double>*)this->EvalVectorInput(context, state_port_);
   auto fsm_output =
@@ -698,6 +713,7 @@ void OperationalSpaceControl::AssignOscLcmOutput(
 void OperationalSpaceControl::CalcOptimalInput(
     const drake::systems::Context<double>& context,
     systems::TimestampedVector<double>* control) const {
+  TraceScope trace("calc", this->get_name(), "CalcOptimalInput");
   // Read in current state and time
   const OutputVector<double>* robot_output =
       (OutputVector<double>*)this->EvalVectorInput(context, state_port_);
@@ -83,6 +83,10 @@ namespace dairlib::systems::controllers {
 ///   4. (if the users created desired trajectory blocks by themselves) connect
 ///      `OperationalSpaceControl`'s input ports to corresponding output ports
 ///      of the trajectory source.
+///
+/// With a finite state machine, the time of the last fsm state switch is
+/// recorded by a discrete update, every `update_period` seconds (or every
+/// simulator step if zero).
 
 class OperationalSpaceControl : public drake::systems::LeafSystem<double> {
  public:
@@ -90,7 +94,7 @@ class OperationalSpaceControl : public drake::systems::LeafSystem<double> {
       const drake::multibody::MultibodyPlant<double>& plant_w_spr,
       const drake::multibody::MultibodyPlant<double>& plant_wo_spr,
       bool used_with_finite_state_machine = true,
-      bool print_tracking_info = false);
+      bool print_tracking_info = false, double update_period = 0);
 
   const drake::systems::OutputPort<double>& get_osc_output_port() const {
     return this->get_output_port(osc_output_port_);
@@ -268,6 +272,9 @@ class OperationalSpaceControl : public drake::systems::LeafSystem<double> {
 
   // Fixed position of constant trajectories
   std::vector<Eigen::VectorXd> fixed_position_vec_;
+  // The same constant trajectories, built once rather than every update
+  std::vector<drake::trajectories::PiecewisePolynomial<double>>
+      fixed_position_traj_vec_;
 
   // Set a period during which we apply control (Unit: seconds)
   // Let t be the elapsed time since fsm switched to a new state.
@@ -4,6 +4,7 @@
 #include <algorithm>
 #include <drake/multibody/plant/multibody_plant.h>
 #include "multibody/multibody_utils.h"
+#include "systems/controllers/osc/trajectory_evaluation.h"
 
 using std::cout;
 using std::endl;
@@ -52,9 +53,7 @@ bool OscTrackingData::Update(
   if (track_at_current_state_) {
     // Careful: must update y_des_ before calling UpdateYAndError()
     // Update desired output
-    y_des_ = traj.value(t);
-    ydot_des_ = traj.MakeDerivative(1)->value(t);
-    yddot_des_ = traj.MakeDerivative(2)->value(t);
+    EvalTrajectoryDerivatives(traj, t, &y_des_, &ydot_des_, &yddot_des_);
 
     // Update feedback output (Calling virtual methods)
     UpdateYAndError(x_w_spr, context_w_spr);
@@ -0,0 +1,137 @@
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <gflags/gflags.h>
+
+#include "systems/controllers/osc/trajectory_evaluation.h"
+
+// Compares evaluating the desired trajectories of the Cassie walking
+// controller's tracking set (see run_osc_walking_controller.cc) with
+//   value(), MakeDerivative(1)->value(), MakeDerivative(2)->value()
+// against EvalTrajectoryDerivatives().
+
+DEFINE_int32(num_reps, 100000, "Number of controller ticks to evaluate");
+
+namespace dairlib {
+namespace systems {
+namespace controllers {
+namespace {
+
+using drake::trajectories::PiecewisePolynomial;
+using drake::trajectories::Trajectory;
+using Eigen::MatrixXd;
+using Eigen::VectorXd;
+using std::vector;
+
+typedef std::chrono::steady_clock my_clock;
+
+void PrintTiming(const std::string& name, my_clock::duration duration) {
+  double ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+      duration).count();
+  std::cout << name << ": " << FLAGS_num_reps << "x took " << ns / 1e6
+            << " milliseconds. " << ns / FLAGS_num_reps << " nanoseconds per."
+            << std::endl;
+}
+
+// Trajectories shaped like the outputs of LIPMTrajGenerator,
+// CPTrajGenerator, the heading trajectory generator and the constant
+// trajectories of the walking controller
+vector<std::unique_ptr<Trajectory<double>>> MakeWalkingTrackingSet() {
+  vector<std::unique_ptr<Trajectory<double>>> trajs;
+
+  // lipm_traj: exponential plus a one-segment cubic
+  vector<double> com_breaks = {0, 0.35};
+  vector<MatrixXd> com_knots(com_breaks.size(), MatrixXd::Zero(3, 1));
+  com_knots[0] << 0.01, -0.1, 0.9;
+  com_knots[1] << 0.01, -0.1, 0.89;
+  auto com_pp =
+      PiecewisePolynomial<double>::CubicWithContinuousSecondDerivatives(
+          com_breaks, com_knots, MatrixXd::Zero(3, 1), MatrixXd::Zero(3, 1));
+  double omega = sqrt(9.81 / 0.89);
+  MatrixXd K(3, 2);
+  K << 0.02, -0.01, 0.03, 0.01, 0, 0;
+  MatrixXd A(2, 2);
+  A << omega, 0, 0, -omega;
+  MatrixXd alpha = MatrixXd::Ones(2, 1);
+  trajs.push_back(
+      std::make_unique<ParameterizedExponentialPlusPiecewisePolynomial>(
+          K, A, alpha, com_pp));
+
+  // swing_ft_traj: three-segment cubic
+  vector<double> swing_breaks = {0, 0.15, 0.25, 0.35};
+  vector<MatrixXd> swing_knots(swing_breaks.size(), MatrixXd::Zero(3, 1));
+  swing_knots[1] << 0.1, 0.02, 0.1;
+  swing_knots[2] << 0.2, 0.03, 0.08;
+  swing_knots[3] << 0.3, 0.03, 0;
+  trajs.push_back(std::make_unique<PiecewisePolynomial<double>>(
+      PiecewisePolynomial<double>::CubicWithContinuousSecondDerivatives(
+          swing_breaks, swing_knots, MatrixXd::Zero(3, 1),
+          MatrixXd::Zero(3, 1))));
+
+  // pelvis_balance_traj and pelvis_heading_traj: quaternion first order holds
+  vector<double> heading_breaks = {0, 0.35};
+  vector<MatrixXd> heading_knots(heading_breaks.size(), MatrixXd::Zero(4, 1));
+  heading_knots[0] << 1, 0, 0, 0;
+  heading_knots[1] << 0.995, 0, 0, 0.0998;
+  for (int i = 0; i < 2; i++) {
+    trajs.push_back(std::make_unique<PiecewisePolynomial<double>>(
+        PiecewisePolynomial<double>::FirstOrderHold(heading_breaks,
+                                                    heading_knots)));
+  }
+
+  // swing_toe_traj and swing_hip_yaw_traj: constants
+  for (int i = 0; i < 2; i++) {
+    trajs.push_back(std::make_unique<PiecewisePolynomial<double>>(
+        VectorXd::Constant(1, -1.5)));
+  }
+  return trajs;
+}
+
+int do_main() {
+  auto trajs = MakeWalkingTrackingSet();
+  vector<VectorXd> y(trajs.size());
+  vector<VectorXd> ydot(trajs.size());
+  vector<VectorXd> yddot(trajs.size());
+  double checksum = 0;
+
+  auto start = my_clock::now();
+  for (int i = 0; i < FLAGS_num_reps; i++) {
+    double t = 0.35 * i / FLAGS_num_reps;
+    for (unsigned int j = 0; j < trajs.size(); j++) {
+      y[j] = trajs[j]->value(t);
+      ydot[j] = trajs[j]->MakeDerivative(1)->value(t);
+      yddot[j] = trajs[j]->MakeDerivative(2)->value(t);
+      checksum += yddot[j](0);
+    }
+  }
+  PrintTiming("value() and MakeDerivative()", my_clock::now() - start);
+
+  start = my_clock::now();
+  for (int i = 0; i < FLAGS_num_reps; i++) {
+    double t = 0.35 * i / FLAGS_num_reps;
+    for (unsigned int j = 0; j < trajs.size(); j++) {
+      EvalTrajectoryDerivatives(*trajs[j], t, &y[j], &ydot[j], &yddot[j]);
+      checksum -= yddot[j](0);
+    }
+  }
+  PrintTiming("EvalTrajectoryDerivatives()", my_clock::now() - start);
+
+  // Zero (up to rounding) if the two agree
+  std::cout << "  (yddot checksum " << checksum / FLAGS_num_reps << ")"
+            << std::endl;
+  return 0;
+}
+
+}  // namespace
+}  // namespace controllers
+}  // namespace systems
+}  // namespace dairlib
+
+int main(int argc, char* argv[]) {
+  gflags::ParseCommandLineFlags(&argc, &argv, true);
+  return dairlib::systems::controllers::do_main();
+}
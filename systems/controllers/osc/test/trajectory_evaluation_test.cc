@@ -0,0 +1,164 @@
+#include <memory>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "systems/controllers/osc/trajectory_evaluation.h"
+#include "drake/common/test_utilities/eigen_matrix_compare.h"
+
+namespace dairlib {
+namespace systems {
+namespace controllers {
+namespace {
+
+using drake::trajectories::ExponentialPlusPiecewisePolynomial;
+using drake::trajectories::PiecewisePolynomial;
+using drake::trajectories::Trajectory;
+using Eigen::MatrixXd;
+using Eigen::VectorXd;
+using std::vector;
+
+const double kTolerance = 1e-10;
+
+// Compares against value() and MakeDerivative(), at times inside and outside
+// of the time span of the trajectory
+void CheckAgainstTrajectory(const Trajectory<double>& traj) {
+  VectorXd y, ydot, yddot;
+  const double start = traj.start_time();
+  const double end = traj.end_time();
+  for (double t : {start - 0.1, start, 0.3 * start + 0.7 * end,
+                   0.5 * (start + end), end, end + 0.1}) {
+    EvalTrajectoryDerivatives(traj, t, &y, &ydot, &yddot);
+    EXPECT_TRUE(drake::CompareMatrices(y, traj.value(t), kTolerance));
+    EXPECT_TRUE(drake::CompareMatrices(
+        ydot, traj.MakeDerivative(1)->value(t), kTolerance));
+    EXPECT_TRUE(drake::CompareMatrices(
+        yddot, traj.MakeDerivative(2)->value(t), kTolerance));
+  }
+}
+
+TEST(TrajectoryEvaluationTest, CubicSpline) {
+  vector<double> breaks = {0, 0.2, 0.35, 0.5};
+  vector<MatrixXd> knots(breaks.size(), MatrixXd::Zero(3, 1));
+  knots[1] << 0.1, 0.05, 0.1;
+  knots[2] << 0.2, -0.05, 0.12;
+  knots[3] << 0.3, 0, 0.05;
+  auto pp = PiecewisePolynomial<double>::CubicWithContinuousSecondDerivatives(
+      breaks, knots, MatrixXd::Zero(3, 1), MatrixXd::Zero(3, 1));
+  CheckAgainstTrajectory(pp);
+}
+
+TEST(TrajectoryEvaluationTest, FirstOrderHold) {
+  vector<double> breaks = {1, 2, 4};
+  vector<MatrixXd> knots(breaks.size(), MatrixXd::Zero(4, 1));
+  knots[0] << 1, 0, 0, 0;
+  knots[1] << 0.9, 0.1, 0.2, 0.3;
+  knots[2] << 0.5, 0.5, 0.5, 0.5;
+  CheckAgainstTrajectory(PiecewisePolynomial<double>::FirstOrderHold(
+      breaks, knots));
+}
+
+TEST(TrajectoryEvaluationTest, Constant) {
+  VectorXd value(2);
+  value << -0.3, 1.2;
+  PiecewisePolynomial<double> pp(value);
+
+  VectorXd y, ydot, yddot;
+  EvalTrajectoryDerivatives(pp, 12.3, &y, &ydot, &yddot);
+  EXPECT_TRUE(drake::CompareMatrices(y, value, kTolerance));
+  EXPECT_TRUE(drake::CompareMatrices(ydot, VectorXd::Zero(2), kTolerance));
+  EXPECT_TRUE(drake::CompareMatrices(yddot, VectorXd::Zero(2), kTolerance));
+}
+
+TEST(TrajectoryEvaluationTest, ExponentialPlusPiecewisePolynomial) {
+  // Same structure as the LIPM CoM trajectory
+  vector<double> breaks = {0.1, 0.45};
+  vector<MatrixXd> knots(breaks.size(), MatrixXd::Zero(3, 1));
+  knots[0] << 0.02, -0.1, 0.9;
+  knots[1] << 0.02, -0.1, 0.89;
+  auto pp_part =
+      PiecewisePolynomial<double>::CubicWithContinuousSecondDerivatives(
+          breaks, knots, MatrixXd::Zero(3, 1), MatrixXd::Zero(3, 1));
+  double omega = 3.3;
+  MatrixXd K(3, 2);
+  K << 0.01, -0.02, 0.03, 0.005, 0, 0;
+  MatrixXd A(2, 2);
+  A << omega, 0, 0, -omega;
+  MatrixXd alpha(2, 1);
+  alpha << 1, 1;
+  ExponentialPlusPiecewisePolynomial<double> exp_pp(K, A, alpha, pp_part);
+
+  VectorXd y, ydot, yddot;
+  const Trajectory<double>& traj = exp_pp;
+  for (double t : {0.1, 0.2, 0.45}) {
+    EvalTrajectoryDerivatives(traj, t, &y, &ydot, &yddot);
+    EXPECT_TRUE(drake::CompareMatrices(y, traj.value(t), kTolerance));
+    EXPECT_TRUE(drake::CompareMatrices(
+        ydot, traj.MakeDerivative(1)->value(t), kTolerance));
+    EXPECT_TRUE(drake::CompareMatrices(
+        yddot, traj.MakeDerivative(2)->value(t), kTolerance));
+  }
+}
+
+// Two segments, so that the exponential restarts at the second break
+TEST(TrajectoryEvaluationTest, ParameterizedExponential) {
+  vector<double> breaks = {0.1, 0.3, 0.45};
+  vector<MatrixXd> knots(breaks.size(), MatrixXd::Zero(3, 1));
+  knots[0] << 0.02, -0.1, 0.9;
+  knots[1] << 0.03, -0.12, 0.91;
+  knots[2] << 0.02, -0.1, 0.89;
+  auto pp_part =
+      PiecewisePolynomial<double>::CubicWithContinuousSecondDerivatives(
+          breaks, knots, MatrixXd::Zero(3, 1), MatrixXd::Zero(3, 1));
+  double omega = 3.3;
+  MatrixXd K(3, 2);
+  K << 0.01, -0.02, 0.03, 0.005, 0, 0;
+  MatrixXd A(2, 2);
+  A << omega, 0, 0, -omega;
+  MatrixXd alpha(2, 2);
+  alpha << 1, 0.5, 1, -0.7;
+  ParameterizedExponentialPlusPiecewisePolynomial exp_pp(K, A, alpha,
+                                                         pp_part);
+
+  // Clones keep the type, as in abstract output ports
+  const std::unique_ptr<Trajectory<double>> traj = exp_pp.Clone();
+  ASSERT_NE(
+      dynamic_cast<const ParameterizedExponentialPlusPiecewisePolynomial*>(
+          traj.get()),
+      nullptr);
+  VectorXd y, ydot, yddot;
+  for (double t : {0.1, 0.2, 0.3, 0.4, 0.45}) {
+    EvalTrajectoryDerivatives(*traj, t, &y, &ydot, &yddot);
+    EXPECT_TRUE(drake::CompareMatrices(y, exp_pp.value(t), kTolerance));
+    EXPECT_TRUE(drake::CompareMatrices(
+        ydot, exp_pp.derivative(1).value(t), kTolerance));
+    EXPECT_TRUE(drake::CompareMatrices(
+        yddot, exp_pp.derivative(2).value(t), kTolerance));
+  }
+}
+
+// The output vectors are reused when they already have the right size
+TEST(TrajectoryEvaluationTest, ReusesStorage) {
+  vector<double> breaks = {0, 1};
+  vector<MatrixXd> knots = {MatrixXd::Zero(3, 1), MatrixXd::Ones(3, 1)};
+  auto pp = PiecewisePolynomial<double>::FirstOrderHold(breaks, knots);
+
+  VectorXd y(3), ydot(3), yddot(3);
+  const double* y_data = y.data();
+  const double* ydot_data = ydot.data();
+  const double* yddot_data = yddot.data();
+  EvalTrajectoryDerivatives(pp, 0.5, &y, &ydot, &yddot);
+  EXPECT_EQ(y.data(), y_data);
+  EXPECT_EQ(ydot.data(), ydot_data);
+  EXPECT_EQ(yddot.data(), yddot_data);
+}
+
+}  // namespace
+}  // namespace controllers
+}  // namespace systems
+}  // namespace dairlib
+
+int main(int argc, char** argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,156 @@
+#include "systems/controllers/osc/trajectory_evaluation.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include <unsupported/Eigen/MatrixFunctions>
+
+using drake::trajectories::ExponentialPlusPiecewisePolynomial;
+using drake::trajectories::PiecewisePolynomial;
+using drake::trajectories::Trajectory;
+using Eigen::MatrixXd;
+using Eigen::VectorXd;
+
+namespace dairlib::systems::controllers {
+
+namespace {
+
+void EvalGenericTrajectoryDerivatives(const Trajectory<double>& traj, double t,
+                                      VectorXd* y, VectorXd* ydot,
+                                      VectorXd* yddot) {
+  *y = traj.value(t);
+  *ydot = traj.MakeDerivative(1)->value(t);
+  *yddot = traj.MakeDerivative(2)->value(t);
+}
+
+// Evaluates the polynomials of a segment of traj (and their derivatives) at
+// t, clamped to the trajectory as in PiecewisePolynomial::value()
+void EvalSegmentDerivatives(const PiecewisePolynomial<double>& traj,
+                            int segment_index, double t, VectorXd* y,
+                            VectorXd* ydot, VectorXd* yddot) {
+  const int n = traj.rows();
+  y->resize(n);
+  ydot->resize(n);
+  yddot->resize(n);
+
+  t = std::min(std::max(t, traj.start_time()), traj.end_time());
+  const double s = t - traj.start_time(segment_index);
+
+  for (int i = 0; i < n; i++) {
+    double value = 0;
+    double first_derivative = 0;
+    double second_derivative = 0;
+    for (const auto& monomial :
+         traj.getPolynomial(segment_index, i, 0).GetMonomials()) {
+      const double c = monomial.coefficient;
+      const int p = monomial.terms.empty() ? 0 : monomial.terms[0].power;
+      // Constant and linear terms are special-cased so that constant
+      // trajectories (whose segment starts at -inf) never multiply by s
+      if (p == 0) {
+        value += c;
+      } else if (p == 1) {
+        value += c * s;
+        first_derivative += c;
+      } else {
+        const double s_pow = std::pow(s, p - 2);
+        value += c * s_pow * s * s;
+        first_derivative += c * p * s_pow * s;
+        second_derivative += c * p * (p - 1) * s_pow;
+      }
+    }
+    (*y)(i) = value;
+    (*ydot)(i) = first_derivative;
+    (*yddot)(i) = second_derivative;
+  }
+}
+
+}  // namespace
+
+void EvalTrajectoryDerivatives(const Trajectory<double>& traj, double t,
+                               VectorXd* y, VectorXd* ydot, VectorXd* yddot) {
+  if (const auto* pp = dynamic_cast<const PiecewisePolynomial<double>*>(
+          &traj)) {
+    EvalTrajectoryDerivatives(*pp, t, y, ydot, yddot);
+  } else if (const auto* lipm = dynamic_cast<
+                 const ParameterizedExponentialPlusPiecewisePolynomial*>(
+                 &traj)) {
+    EvalTrajectoryDerivatives(*lipm, t, y, ydot, yddot);
+  } else if (const auto* exp_pp = dynamic_cast<
+                 const ExponentialPlusPiecewisePolynomial<double>*>(&traj)) {
+    EvalTrajectoryDerivatives(*exp_pp, t, y, ydot, yddot);
+  } else {
+    EvalGenericTrajectoryDerivatives(traj, t, y, ydot, yddot);
+  }
+}
+
+void EvalTrajectoryDerivatives(const PiecewisePolynomial<double>& traj,
+                               double t, VectorXd* y, VectorXd* ydot,
+                               VectorXd* yddot) {
+  if (traj.get_number_of_segments() == 0) {
+    EvalGenericTrajectoryDerivatives(traj, t, y, ydot, yddot);
+    return;
+  }
+  DRAKE_ASSERT(traj.cols() == 1);
+  EvalSegmentDerivatives(traj, traj.get_segment_index(t), t, y, ydot, yddot);
+}
+
+void EvalTrajectoryDerivatives(
+    const ExponentialPlusPiecewisePolynomial<double>& traj, double t,
+    VectorXd* y, VectorXd* ydot, VectorXd* yddot) {
+  *y = traj.value(t);
+  *ydot = traj.derivative(1).value(t);
+  *yddot = traj.derivative(2).value(t);
+}
+
+void EvalTrajectoryDerivatives(
+    const ParameterizedExponentialPlusPiecewisePolynomial& traj, double t,
+    VectorXd* y, VectorXd* ydot, VectorXd* yddot) {
+  const auto& pp_part = traj.get_piecewise_polynomial_part();
+  if (pp_part.get_number_of_segments() == 0) {
+    EvalGenericTrajectoryDerivatives(traj, t, y, ydot, yddot);
+    return;
+  }
+  DRAKE_ASSERT(traj.cols() == 1);
+
+  // The polynomial part has the same breaks, so one segment index serves
+  // both parts
+  const int segment_index = pp_part.get_segment_index(t);
+  // Same as ExponentialPlusPiecewisePolynomial::value(): the exponential is
+  // evaluated at the unclamped time, the polynomial at the clamped one
+  const MatrixXd& A = traj.get_A();
+  const VectorXd exponential =
+      (A * (t - pp_part.start_time(segment_index))).exp() *
+      traj.get_alpha().col(segment_index);
+  const VectorXd A_exponential = A * exponential;
+
+  EvalSegmentDerivatives(pp_part, segment_index, t, y, ydot, yddot);
+  const MatrixXd& K = traj.get_K();
+  y->noalias() += K * exponential;
+  ydot->noalias() += K * A_exponential;
+  yddot->noalias() += K * (A * A_exponential);
+}
+
+ParameterizedExponentialPlusPiecewisePolynomial::
+    ParameterizedExponentialPlusPiecewisePolynomial()
+    : ParameterizedExponentialPlusPiecewisePolynomial(
+          MatrixXd::Ones(0, 0), MatrixXd::Identity(0, 0), MatrixXd::Ones(0, 0),
+          PiecewisePolynomial<double>(VectorXd(0))) {}
+
+ParameterizedExponentialPlusPiecewisePolynomial::
+    ParameterizedExponentialPlusPiecewisePolynomial(
+        const MatrixXd& K, const MatrixXd& A, const MatrixXd& alpha,
+        const PiecewisePolynomial<double>& piecewise_polynomial_part)
+    : ExponentialPlusPiecewisePolynomial<double>(K, A, alpha,
+                                                 piecewise_polynomial_part),
+      K_(K),
+      A_(A),
+      alpha_(alpha),
+      piecewise_polynomial_part_(piecewise_polynomial_part) {}
+
+std::unique_ptr<Trajectory<double>>
+ParameterizedExponentialPlusPiecewisePolynomial::Clone() const {
+  return std::make_unique<ParameterizedExponentialPlusPiecewisePolynomial>(
+      *this);
+}
+
+}  // namespace dairlib::systems::controllers
@@ -0,0 +1,97 @@
+#pragma once
+
+#include <memory>
+
+#include <Eigen/Dense>
+
+#include "drake/common/trajectories/exponential_plus_piecewise_polynomial.h"
+#include "drake/common/trajectories/piecewise_polynomial.h"
+#include "drake/common/trajectories/trajectory.h"
+
+namespace dairlib {
+namespace systems {
+namespace controllers {
+
+/// ExponentialPlusPiecewisePolynomial that keeps its parameters, which Drake
+/// does not expose, so that EvalTrajectoryDerivatives() can evaluate it from
+/// one segment lookup. Its value is
+///   K exp(A (t - t_j)) alpha_j + piecewise_polynomial_part(t)
+/// on the segment [t_j, t_{j+1}]. Clone() preserves the type, so it survives
+/// abstract output ports (e.g. the LIPM CoM trajectory of LIPMTrajGenerator).
+class ParameterizedExponentialPlusPiecewisePolynomial
+    : public drake::trajectories::ExponentialPlusPiecewisePolynomial<double> {
+ public:
+  /// Empty trajectory, to allocate output ports
+  ParameterizedExponentialPlusPiecewisePolynomial();
+  ParameterizedExponentialPlusPiecewisePolynomial(
+      const Eigen::MatrixXd& K, const Eigen::MatrixXd& A,
+      const Eigen::MatrixXd& alpha,
+      const drake::trajectories::PiecewisePolynomial<double>&
+          piecewise_polynomial_part);
+
+  std::unique_ptr<drake::trajectories::Trajectory<double>> Clone()
+      const override;
+
+  const Eigen::MatrixXd& get_K() const { return K_; }
+  const Eigen::MatrixXd& get_A() const { return A_; }
+  const Eigen::MatrixXd& get_alpha() const { return alpha_; }
+  const drake::trajectories::PiecewisePolynomial<double>&
+  get_piecewise_polynomial_part() const {
+    return piecewise_polynomial_part_;
+  }
+
+ private:
+  Eigen::MatrixXd K_;
+  Eigen::MatrixXd A_;
+  Eigen::MatrixXd alpha_;
+  drake::trajectories::PiecewisePolynomial<double> piecewise_polynomial_part_;
+};
+
+/// EvalTrajectoryDerivatives() evaluates a (column vector valued) trajectory
+/// and its first and second time derivatives at time `t`, writing them into
+/// caller-owned vectors. The vectors are only reallocated if their size does
+/// not match the trajectory.
+///
+/// This replaces
+///   y = traj.value(t);
+///   ydot = traj.MakeDerivative(1)->value(t);
+///   yddot = traj.MakeDerivative(2)->value(t);
+/// which builds two derivative trajectories and searches for the segment
+/// three times.
+///  - PiecewisePolynomial: one segment lookup, after which the three values
+///    are read from the same polynomial coefficients. Nothing is allocated.
+///  - ParameterizedExponentialPlusPiecewisePolynomial: one segment lookup,
+///    for both the exponential and the polynomial part.
+///  - ExponentialPlusPiecewisePolynomial: Drake does not expose its
+///    parameters, so the derivatives still go through derivative(), but as
+///    plain values rather than heap-allocated Trajectory clones.
+///  - any other Trajectory falls back to value() and MakeDerivative().
+///
+/// Like Trajectory::value(), PiecewisePolynomials are evaluated at `t`
+/// clamped to [start_time(), end_time()].
+void EvalTrajectoryDerivatives(
+    const drake::trajectories::Trajectory<double>& traj, double t,
+    Eigen::VectorXd* y, Eigen::VectorXd* ydot, Eigen::VectorXd* yddot);
+
+/// PiecewisePolynomial specialization of EvalTrajectoryDerivatives()
+void EvalTrajectoryDerivatives(
+    const drake::trajectories::PiecewisePolynomial<double>& traj, double t,
+    Eigen::VectorXd* y, Eigen::VectorXd* ydot, Eigen::VectorXd* yddot);
+
+/// ExponentialPlusPiecewisePolynomial specialization of
+/// EvalTrajectoryDerivatives()
+void EvalTrajectoryDerivatives(
+    const drake::trajectories::ExponentialPlusPiecewisePolynomial<double>&
+        traj,
+    double t, Eigen::VectorXd* y, Eigen::VectorXd* ydot,
+    Eigen::VectorXd* yddot);
+
+/// ParameterizedExponentialPlusPiecewisePolynomial specialization of
+/// EvalTrajectoryDerivatives()
+void EvalTrajectoryDerivatives(
+    const ParameterizedExponentialPlusPiecewisePolynomial& traj, double t,
+    Eigen::VectorXd* y, Eigen::VectorXd* ydot, Eigen::VectorXd* yddot);
+
+}  // namespace controllers
+}  // namespace systems
+}  // namespace dairlib
@@ -20,6 +20,8 @@ PDConfigReceiver::PDConfigReceiver(const RigidBodyTree<double>& tree) {
   num_positions_ = tree.get_num_positions();
   num_velocities_ = tree.get_num_velocities();
   num_actuators_ = tree.get_num_actuators();
+  actuator_to_position_index_.assign(num_actuators_, -1);
+  actuator_to_velocity_index_.assign(num_actuators_, -1);
 
   MatrixXd B = tree.B;
   // using all one's because zeros will cause quaternions to NaN
@@ -45,7 +47,7 @@ PDConfigReceiver::PDConfigReceiver(const RigidBodyTree<double>& tree) {
       }
     }
     DRAKE_THROW_UNLESS(index != -1);
-    actuatorToVelocityIndexMap_[j] = index;
+    actuator_to_velocity_index_[j] = index;
     // Next use the GetVelocityToQDotMapping to map this velocity to a position
     // coordinate. The unit vector e_index should map to a single positive
     // element in qdot. This is not true for some joints (like quaternions),
@@ -60,19 +62,12 @@ PDConfigReceiver::PDConfigReceiver(const RigidBodyTree<double>& tree) {
         index_q = k;
       }
     }
-    if (index_q != -1)
-      actuatorToPositionIndexMap_[j] = index_q;
+    actuator_to_position_index_[j] = index_q;
     std::cout << "Map u_ind:" << j << " q_ind: " << index_q << " v_ind: " <<
                   index << std::endl;
   }
 
-  // Velocity map:
-  this->DeclareAbstractInputPort(
-      "lcmt_pd_config", drake::Value<dairlib::lcmt_pd_config>{});
-  this->DeclareVectorOutputPort(
-      LinearConfig(tree.get_num_positions() + tree.get_num_velocities(),
-                   tree.get_num_actuators()),
-      &PDConfigReceiver::CopyConfig);
+  DeclarePorts();
 }
 
 // methods implementation for CassiePDConfigReceiver.
@@ -82,13 +77,15 @@ PDConfigReceiver::PDConfigReceiver(const MultibodyPlant<double>& plant) {
   num_positions_ = plant.num_positions();
   num_velocities_ = plant.num_velocities();
   num_actuators_ = plant.num_actuators();
-
+  actuator_to_position_index_.assign(num_actuators_, -1);
+  actuator_to_velocity_index_.assign(num_actuators_, -1);
 
   MatrixXd B = plant.MakeActuationMatrix();
   // using all one's because zeros will cause quaternions to NaN
   // Don't really care about the answer here, just that it has the correct
   // sparsity pattern
   VectorXd q_zeros = VectorXd::Constant(plant.num_positions(), 1);
+  auto context = plant.CreateDefaultContext();
 
   // Use the plant to build a map from actuators to positions and velocities
   // Specific to systems where each actuator maps uniquely to a joint with
@@ -107,7 +104,7 @@ PDConfigReceiver::PDConfigReceiver(const MultibodyPlant<double>& plant) {
       }
     }
     DRAKE_THROW_UNLESS(index != -1);
-    actuatorToVelocityIndexMap_[j] = index;
+    actuator_to_velocity_index_[j] = index;
     // Next use the velocity to qdot map to convert this velocity to a position
     // coordinate. The unit vector e_index should map to a single positive
     // element in qdot. This is not true for some joints (like quaternions),
@@ -115,7 +112,6 @@ PDConfigReceiver::PDConfigReceiver(const MultibodyPlant<double>& plant) {
     VectorXd e_index = VectorXd::Zero(plant.num_velocities());
     e_index(index) = 1;
     VectorXd qdot(plant.num_positions());
-    auto context = plant.CreateDefaultContext();
     plant.MapVelocityToQDot(*context, e_index, &qdot);
     int index_q = -1;
     for (int k = 0; k < qdot.size(); k++) {
@@ -124,45 +120,89 @@ PDConfigReceiver::PDConfigReceiver(const MultibodyPlant<double>& plant) {
         index_q = k;
       }
     }
-    if (index_q != -1)
-      actuatorToPositionIndexMap_[j] = index_q;
+    actuator_to_position_index_[j] = index_q;
     std::cout << "Map u_ind:" << j << " q_ind: " << index_q << " v_ind: " <<
                   index << std::endl;
   }
 
-  // Velocity map:
+  DeclarePorts();
+}
+
+void PDConfigReceiver::DeclarePorts() {
   this->DeclareAbstractInputPort(
       "lcmt_pd_config", drake::Value<dairlib::lcmt_pd_config>{});
-  this->DeclareVectorOutputPort(
-      LinearConfig(plant.num_positions() + plant.num_velocities(),
-                   plant.num_actuators()),
-      &PDConfigReceiver::CopyConfig);
+  config_output_port_ =
+      this->DeclareVectorOutputPort(
+              LinearConfig(num_positions_ + num_velocities_, num_actuators_),
+              &PDConfigReceiver::CopyConfig)
+          .get_index();
+  joint_gains_output_port_ =
+      this->DeclareVectorOutputPort(JointPDGains(num_actuators_),
+                                    &PDConfigReceiver::CopyJointGains)
+          .get_index();
 }
+
 /// read and parse a configuration LCM message
+/// Only the (at most) two entries of K per actuator are written. The cached
+/// output is allocated and zeroed once, on the first evaluation.
 void PDConfigReceiver::CopyConfig(const Context<double>& context,
                                   LinearConfig* output) const {
   const AbstractValue* input = this->EvalAbstractInput(context, 0);
   DRAKE_THROW_UNLESS(input != nullptr);
   const auto& config_msg = input->get_value<dairlib::lcmt_pd_config>();
 
+  const int num_states = num_positions_ + num_velocities_;
+  MatrixXd& K = output->GetMutableK();
+  VectorXd& desired_state = output->GetMutableDesiredState();
+  if (K.rows() != num_actuators_ || K.cols() != num_states) {
+    K = MatrixXd::Zero(num_actuators_, num_states);
+    desired_state = VectorXd::Zero(num_states);
+  }
 
-  MatrixXd K = MatrixXd::Zero(num_actuators_, num_positions_ + num_velocities_);
-  VectorXd desired_state = VectorXd::Zero(num_positions_ + num_velocities_);
+  // Clear the actuated entries, since a message may not list every joint
+  for (int u_ind = 0; u_ind < num_actuators_; u_ind++) {
+    int q_ind = actuator_to_position_index_[u_ind];
+    int v_ind = actuator_to_velocity_index_[u_ind];
+    if (q_ind >= 0) {
+      K(u_ind, q_ind) = 0;
+      desired_state(q_ind) = 0;
+    }
+    K(u_ind, num_positions_ + v_ind) = 0;
+    desired_state(num_positions_ + v_ind) = 0;
+  }
 
   for (int i = 0; i < config_msg.num_joints; i++) {
     int u_ind = actuatorIndexMap_.at(config_msg.joint_names[i]);
-    // Need to generate position and velocity indices
-    int q_ind = actuatorToPositionIndexMap_.at(u_ind);
-    int v_ind = actuatorToVelocityIndexMap_.at(u_ind);
+    int q_ind = actuator_to_position_index_[u_ind];
+    int v_ind = actuator_to_velocity_index_[u_ind];
 
-    K(u_ind, q_ind) = config_msg.kp[i];
+    if (q_ind >= 0) {
+      K(u_ind, q_ind) = config_msg.kp[i];
+      desired_state(q_ind) = config_msg.desired_position[i];
+    }
     K(u_ind, num_positions_ + v_ind) = config_msg.kd[i];
-    desired_state(q_ind) = config_msg.desired_position[i];
     desired_state(num_positions_ + v_ind) = config_msg.desired_velocity[i];
   }
+}
 
-  output->SetK(K);
-  output->SetDesiredState(desired_state);
+/// read and parse a configuration LCM message into per-actuator gains
+void PDConfigReceiver::CopyJointGains(const Context<double>& context,
+                                      JointPDGains* output) const {
+  const AbstractValue* input = this->EvalAbstractInput(context, 0);
+  DRAKE_THROW_UNLESS(input != nullptr);
+  const auto& config_msg = input->get_value<dairlib::lcmt_pd_config>();
+
+  // Joints missing from the message get zero gains
+  output->get_mutable_data().setZero();
+  for (int i = 0; i < config_msg.num_joints; i++) {
+    int u_ind = actuatorIndexMap_.at(config_msg.joint_names[i]);
+    output->get_mutable_kp()(u_ind) = config_msg.kp[i];
+    output->get_mutable_kd()(u_ind) = config_msg.kd[i];
+    output->get_mutable_desired_position()(u_ind) =
+        config_msg.desired_position[i];
+    output->get_mutable_desired_velocity()(u_ind) =
+        config_msg.desired_velocity[i];
+  }
 }
 
 }  // namespace systems
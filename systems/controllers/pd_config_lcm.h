@@ -2,10 +2,12 @@
 
 #include <string>
 #include <map>
+#include <vector>
 
 #include "dairlib/lcmt_pd_config.hpp"
 #include "drake/systems/framework/leaf_system.h"
 #include "attic/multibody/rigidbody_utils.h"
+#include "systems/controllers/fixed_size_controllers.h"
 #include "systems/controllers/linear_controller.h"
 #include "systems/framework/timestamped_vector.h"
 #include "drake/multibody/plant/multibody_plant.h"
@@ -16,6 +18,14 @@ namespace systems {
 /// Receives the output of an LcmSubsriberSystem that subsribes to the
 /// Cassie PD configuration channel with LCM type lcmt_cassie_pd_config,
 /// and outputs the CassiePDConfig as Context
+///
+/// Two output ports are provided:
+///  - a dense LinearConfig, for use with LinearController
+///  - a diagonal-block JointPDGains, for use with FixedSizeJointPDController,
+///    together with actuator_to_position_index() and
+///    actuator_to_velocity_index()
+/// The actuator-to-joint index maps are built once at construction, so that
+/// a new configuration message only updates the gain entries.
 class PDConfigReceiver : public drake::systems::LeafSystem<double> {
  public:
   explicit PDConfigReceiver(const RigidBodyTree<double>& tree);
@@ -23,16 +33,42 @@ class PDConfigReceiver : public drake::systems::LeafSystem<double> {
   explicit PDConfigReceiver(
     const drake::multibody::MultibodyPlant<double>& plant);
 
+  const drake::systems::OutputPort<double>& get_output_port_config() const {
+    return this->get_output_port(config_output_port_);
+  }
+
+  const drake::systems::OutputPort<double>& get_output_port_joint_gains()
+      const {
+    return this->get_output_port(joint_gains_output_port_);
+  }
+
+  /// Position index of each actuator's joint, -1 if there is none
+  const std::vector<int>& actuator_to_position_index() const {
+    return actuator_to_position_index_;
+  }
+
+  /// Velocity index of each actuator's joint
+  const std::vector<int>& actuator_to_velocity_index() const {
+    return actuator_to_velocity_index_;
+  }
+
  private:
+  void DeclarePorts();
+
   void CopyConfig(const drake::systems::Context<double>& context,
                   LinearConfig* output) const;
 
+  void CopyJointGains(const drake::systems::Context<double>& context,
+                      JointPDGains* output) const;
+
   std::map<string, int> actuatorIndexMap_;
-  std::map<int, int> actuatorToPositionIndexMap_;
-  std::map<int, int> actuatorToVelocityIndexMap_;
+  std::vector<int> actuator_to_position_index_;
+  std::vector<int> actuator_to_velocity_index_;
   int num_positions_;
   int num_velocities_;
   int num_actuators_;
+  int config_output_port_;
+  int joint_gains_output_port_;
 };
 
 }  // namespace systems
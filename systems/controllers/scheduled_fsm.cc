@@ -0,0 +1,213 @@
+#include "systems/controllers/scheduled_fsm.h"
+
+#include <math.h>
+#include <algorithm>
+#include <limits>
+
+using drake::systems::BasicVector;
+using drake::systems::Context;
+using drake::systems::DiscreteValues;
+using drake::systems::EventStatus;
+using Eigen::VectorXd;
+
+namespace dairlib {
+namespace systems {
+
+ScheduledFiniteStateMachine::ScheduledFiniteStateMachine(
+    const drake::multibody::MultibodyPlant<double>& plant,
+    const std::vector<int>& states, const std::vector<double>& state_durations,
+    double t0, double update_period)
+    : states_(states),
+      state_durations_(state_durations),
+      early_switch_min_phase_(states.size(), -1),
+      t0_(t0) {
+  DRAKE_DEMAND(states.size() == state_durations.size());
+  DRAKE_DEMAND(!states.empty());
+
+  // Input/Output Setup
+  state_port_ =
+      this->DeclareVectorInputPort(OutputVector<double>(plant.num_positions(),
+                                                        plant.num_velocities(),
+                                                        plant.num_actuators()))
+          .get_index();
+  contact_port_ =
+      this->DeclareVectorInputPort(BasicVector<double>(1)).get_index();
+  fsm_output_port_ =
+      this->DeclareVectorOutputPort(
+              BasicVector<double>(1),
+              &ScheduledFiniteStateMachine::CalcFiniteState)
+          .get_index();
+  fsm_info_output_port_ =
+      this->DeclareVectorOutputPort(
+              FiniteStateMachineInfo(),
+              &ScheduledFiniteStateMachine::CalcFiniteStateInfo)
+          .get_index();
+
+  period_ = 0;
+  for (auto& duration_i : state_durations) {
+    DRAKE_DEMAND(duration_i > 0);
+    period_ += duration_i;
+  }
+
+  // The switching schedule. Before t0, the next switch is at t0.
+  VectorXd schedule(4);
+  schedule << -1, t0, t0, 0;
+  schedule_idx_ = this->DeclareDiscreteState(schedule);
+  // The timestamp of the last update, and the switch count before it
+  VectorXd prev_update(2);
+  prev_update << -std::numeric_limits<double>::infinity(), 0;
+  prev_update_idx_ = this->DeclareDiscreteState(prev_update);
+
+  if (update_period > 0) {
+    DeclarePeriodicDiscreteUpdateEvent(
+        update_period, 0, &ScheduledFiniteStateMachine::DiscreteVariableUpdate);
+  } else {
+    DeclarePerStepDiscreteUpdateEvent(
+        &ScheduledFiniteStateMachine::DiscreteVariableUpdate);
+  }
+}
+
+void ScheduledFiniteStateMachine::SetEarlySwitchOnContact(int state,
+                                                          double min_phase) {
+  DRAKE_DEMAND(min_phase >= 0 && min_phase <= 1);
+  bool found = false;
+  for (unsigned int i = 0; i < states_.size(); i++) {
+    if (states_[i] == state) {
+      early_switch_min_phase_[i] = min_phase;
+      found = true;
+    }
+  }
+  DRAKE_DEMAND(found);
+}
+
+ScheduledFiniteStateMachine::Schedule
+ScheduledFiniteStateMachine::ReadSchedule(
+    const Context<double>& context) const {
+  const auto& schedule = context.get_discrete_state(schedule_idx_).get_value();
+  return {static_cast<int>(schedule(0)), schedule(1), schedule(2),
+          static_cast<int>(schedule(3))};
+}
+
+ScheduledFiniteStateMachine::Schedule
+ScheduledFiniteStateMachine::AdvanceSchedule(Schedule schedule, double t,
+                                             bool contact) const {
+  const int n_states = states_.size();
+
+  if (schedule.mode_index < 0) {
+    if (t < t0_) {
+      return schedule;
+    }
+    // Entering the first state at t0 counts as a switch
+    schedule.mode_index = 0;
+    schedule.prev_switch_time = t0_;
+    schedule.next_switch_time = t0_ + state_durations_[0];
+    schedule.switch_count++;
+  }
+
+  // Contact-triggered early switch
+  double min_phase = early_switch_min_phase_[schedule.mode_index];
+  if (contact && min_phase >= 0 && t < schedule.next_switch_time &&
+      t - schedule.prev_switch_time >=
+          min_phase * state_durations_[schedule.mode_index]) {
+    schedule.mode_index = (schedule.mode_index + 1) % n_states;
+    schedule.prev_switch_time = t;
+    schedule.next_switch_time = t + state_durations_[schedule.mode_index];
+    schedule.switch_count++;
+  }
+
+  // Skip whole periods (e.g. after a gap in the input messages)
+  if (t >= schedule.next_switch_time + period_) {
+    double m = floor((t - schedule.next_switch_time) / period_);
+    schedule.prev_switch_time += m * period_;
+    schedule.next_switch_time += m * period_;
+    schedule.switch_count += static_cast<int>(m) * n_states;
+  }
+  while (t >= schedule.next_switch_time) {
+    schedule.mode_index = (schedule.mode_index + 1) % n_states;
+    schedule.prev_switch_time = schedule.next_switch_time;
+    schedule.next_switch_time += state_durations_[schedule.mode_index];
+    schedule.switch_count++;
+  }
+  return schedule;
+}
+
+ScheduledFiniteStateMachine::Schedule
+ScheduledFiniteStateMachine::CurrentSchedule(const Context<double>& context,
+                                             int* prev_switch_count) const {
+  const OutputVector<double>* robot_output =
+      (OutputVector<double>*)this->EvalVectorInput(context, state_port_);
+  double t = robot_output->get_timestamp();
+
+  const BasicVector<double>* contact =
+      this->EvalVectorInput(context, contact_port_);
+  bool is_contact = (contact != nullptr) && (contact->GetAtIndex(0) != 0);
+
+  Schedule schedule = ReadSchedule(context);
+  const auto& prev_update =
+      context.get_discrete_state(prev_update_idx_).get_value();
+  if (t == prev_update(0)) {
+    // The discrete update has already consumed this timestamp
+    *prev_switch_count = static_cast<int>(prev_update(1));
+    return schedule;
+  }
+  *prev_switch_count = schedule.switch_count;
+  return AdvanceSchedule(schedule, t, is_contact);
+}
+
+EventStatus ScheduledFiniteStateMachine::DiscreteVariableUpdate(
+    const Context<double>& context,
+    DiscreteValues<double>* discrete_state) const {
+  const OutputVector<double>* robot_output =
+      (OutputVector<double>*)this->EvalVectorInput(context, state_port_);
+  double t = robot_output->get_timestamp();
+
+  auto prev_update =
+      discrete_state->get_mutable_vector(prev_update_idx_).get_mutable_value();
+  if (t == prev_update(0)) {
+    return EventStatus::DidNothing();
+  }
+
+  int prev_switch_count;
+  Schedule schedule = CurrentSchedule(context, &prev_switch_count);
+  prev_update << t, prev_switch_count;
+  discrete_state->get_mutable_vector(schedule_idx_).get_mutable_value()
+      << schedule.mode_index, schedule.prev_switch_time,
+      schedule.next_switch_time, schedule.switch_count;
+  return EventStatus::Succeeded();
+}
+
+void ScheduledFiniteStateMachine::CalcFiniteState(
+    const Context<double>& context, BasicVector<double>* fsm_state) const {
+  int prev_switch_count;
+  Schedule schedule = CurrentSchedule(context, &prev_switch_count);
+  fsm_state->get_mutable_value()(0) = (schedule.mode_index < 0)
+                                          ? initial_state_
+                                          : states_[schedule.mode_index];
+}
+
+void ScheduledFiniteStateMachine::CalcFiniteStateInfo(
+    const Context<double>& context, FiniteStateMachineInfo* fsm_info) const {
+  const OutputVector<double>* robot_output =
+      (OutputVector<double>*)this->EvalVectorInput(context, state_port_);
+  double t = robot_output->get_timestamp();
+
+  int prev_switch_count;
+  Schedule schedule = CurrentSchedule(context, &prev_switch_count);
+  if (schedule.mode_index < 0) {
+    fsm_info->set_fsm_state(initial_state_);
+    fsm_info->set_phase(0);
+  } else {
+    fsm_info->set_fsm_state(states_[schedule.mode_index]);
+    fsm_info->set_phase(std::min(
+        1.0, (t - schedule.prev_switch_time) /
+                 (schedule.next_switch_time - schedule.prev_switch_time)));
+  }
+  fsm_info->set_prev_switch_time(schedule.prev_switch_time);
+  fsm_info->set_next_switch_time(schedule.next_switch_time);
+  fsm_info->set_switch_count(schedule.switch_count);
+  fsm_info->set_mode_changed(schedule.switch_count != prev_switch_count);
+  fsm_info->set_timestamp(t);
+}
+
+}  // namespace systems
+}  // namespace dairlib
@@ -0,0 +1,164 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "systems/framework/output_vector.h"
+
+#include "drake/multibody/plant/multibody_plant.h"
+#include "drake/systems/framework/leaf_system.h"
+
+namespace dairlib {
+namespace systems {
+
+/// FiniteStateMachineInfo is the output of ScheduledFiniteStateMachine.
+/// It stores, in this order,
+///  - the current fsm state
+///  - the phase fraction, i.e. elapsed time in the state divided by the
+///    scheduled duration of the state, in [0, 1]
+///  - the time of the last switch
+///  - the time of the next scheduled switch
+///  - the number of switches, counting the entry into the first state at t0
+///  - a mode-change flag (1 if the state switched at the current timestamp)
+/// plus the timestamp of the robot state it was computed from.
+class FiniteStateMachineInfo : public TimestampedVector<double> {
+ public:
+  static constexpr int kSize = 6;
+
+  FiniteStateMachineInfo() : TimestampedVector<double>(kSize) {}
+
+  int get_fsm_state() const { return static_cast<int>(GetAtIndex(0)); }
+  double get_phase() const { return GetAtIndex(1); }
+  double get_prev_switch_time() const { return GetAtIndex(2); }
+  double get_next_switch_time() const { return GetAtIndex(3); }
+  int get_switch_count() const { return static_cast<int>(GetAtIndex(4)); }
+  bool get_mode_changed() const { return GetAtIndex(5) != 0; }
+
+  /// Time elapsed in the current fsm state
+  double get_time_since_switch() const {
+    return get_timestamp() - get_prev_switch_time();
+  }
+  /// Time left until the next scheduled switch
+  double get_time_to_switch() const {
+    return get_next_switch_time() - get_timestamp();
+  }
+
+  void set_fsm_state(int fsm_state) { SetAtIndex(0, fsm_state); }
+  void set_phase(double phase) { SetAtIndex(1, phase); }
+  void set_prev_switch_time(double t) { SetAtIndex(2, t); }
+  void set_next_switch_time(double t) { SetAtIndex(3, t); }
+  void set_switch_count(int count) { SetAtIndex(4, count); }
+  void set_mode_changed(bool mode_changed) { SetAtIndex(5, mode_changed); }
+
+ private:
+  FiniteStateMachineInfo* DoClone() const override {
+    return new FiniteStateMachineInfo();
+  }
+};
+
+/// ScheduledFiniteStateMachine is an event-driven version of
+/// TimeBasedFiniteStateMachine. It cycles through `states` in order, staying
+/// in each for the corresponding duration, but instead of recomputing the
+/// state from the timestamp with modular arithmetic on every evaluation, it
+/// keeps its switching schedule (current state, last and next switch times)
+/// as discrete state and only advances it when a switch time is crossed.
+///
+/// With no contact input, the state sequence is identical to that of
+/// TimeBasedFiniteStateMachine with the same arguments.
+///
+/// Contact-triggered early switching: for states registered with
+/// SetEarlySwitchOnContact(), the machine moves to the next state as soon as
+/// the contact input is nonzero, provided that at least `min_phase` of the
+/// state's duration has elapsed. The rest of the schedule is then shifted to
+/// start from the actual switch time.
+///
+/// Outputs:
+///  - port 0: the fsm state as a BasicVector of size 1 (a drop-in for
+///    TimeBasedFiniteStateMachine's output)
+///  - FiniteStateMachineInfo, with the phase and switch times, so that
+///    downstream systems need not track the previous switch time themselves
+///
+/// Constructor:
+///  @param plant, multibody plant
+///  @param states, integer representation of each state
+///  @param state_durations, duration of each state
+///  @param t0, time offset of the whole finite state machine
+///  @param update_period, period of the discrete update. If zero, the update
+///    runs every step of the simulator (i.e. on every message in an
+///    LcmDrivenLoop).
+class ScheduledFiniteStateMachine : public drake::systems::LeafSystem<double> {
+ public:
+  ScheduledFiniteStateMachine(
+      const drake::multibody::MultibodyPlant<double>& plant,
+      const std::vector<int>& states,
+      const std::vector<double>& state_durations, double t0 = 0,
+      double update_period = 0);
+
+  /// Allows `state` to end early when the contact input port is nonzero,
+  /// once `min_phase` (in [0, 1]) of its duration has elapsed
+  void SetEarlySwitchOnContact(int state, double min_phase);
+
+  const drake::systems::InputPort<double>& get_input_port_state() const {
+    return this->get_input_port(state_port_);
+  }
+  /// Optional. A BasicVector of size 1, nonzero when touchdown is detected.
+  const drake::systems::InputPort<double>& get_input_port_contact() const {
+    return this->get_input_port(contact_port_);
+  }
+  const drake::systems::OutputPort<double>& get_output_port_fsm() const {
+    return this->get_output_port(fsm_output_port_);
+  }
+  const drake::systems::OutputPort<double>& get_output_port_fsm_info() const {
+    return this->get_output_port(fsm_info_output_port_);
+  }
+
+ private:
+  // The switching schedule, stored in the discrete state in this order
+  struct Schedule {
+    int mode_index;  // index into states_, -1 before t0
+    double prev_switch_time;
+    double next_switch_time;
+    int switch_count;
+  };
+
+  Schedule ReadSchedule(const drake::systems::Context<double>& context) const;
+
+  // Advances the schedule to time t. The cost is independent of how far t is
+  // past the next switch time.
+  Schedule AdvanceSchedule(Schedule schedule, double t, bool contact) const;
+
+  // Returns the schedule at the timestamp of the current input, and the
+  // number of switches before this timestamp (for the mode-change flag)
+  Schedule CurrentSchedule(const drake::systems::Context<double>& context,
+                           int* prev_switch_count) const;
+
+  drake::systems::EventStatus DiscreteVariableUpdate(
+      const drake::systems::Context<double>& context,
+      drake::systems::DiscreteValues<double>* discrete_state) const;
+
+  void CalcFiniteState(const drake::systems::Context<double>& context,
+                       drake::systems::BasicVector<double>* fsm_state) const;
+
+  void CalcFiniteStateInfo(const drake::systems::Context<double>& context,
+                           FiniteStateMachineInfo* fsm_info) const;
+
+  int state_port_;
+  int contact_port_;
+  int fsm_output_port_;
+  int fsm_info_output_port_;
+
+  // Discrete state indices
+  int schedule_idx_;
+  int prev_update_idx_;
+
+  std::vector<int> states_;
+  std::vector<double> state_durations_;
+  // Minimum phase for a contact-triggered switch, negative if disabled
+  std::vector<double> early_switch_min_phase_;
+  int initial_state_ = -1;
+  double t0_;
+  double period_;
+};
+
+}  // namespace systems
+}  // namespace dairlib
@@ -0,0 +1,77 @@
+#include <math.h>
+#include <algorithm>
+#include <iostream>
+#include <random>
+
+#include <gflags/gflags.h>
+
+#include "systems/controllers/lipm_mpc_footstep_planner.h"
+
+// Reports the solve time of LipmFootstepMpc against the horizon length, for
+// a sequence of perturbed states as seen in a walking controller (warm
+// started from the previous tick, with a touchdown every step_duration).
+
+DEFINE_int32(num_reps, 10000, "Number of solves per horizon length");
+DEFINE_int32(max_horizon, 10, "Longest horizon to time");
+DEFINE_double(dt, 0.002, "Controller period, in seconds");
+DEFINE_int32(max_iterations, 20, "Active-set iteration limit per axis");
+
+namespace dairlib {
+namespace systems {
+namespace {
+
+using Eigen::Vector2d;
+
+int do_main() {
+  std::default_random_engine generator(0);
+  std::normal_distribution<double> noise(0, 0.05);
+  const double omega = sqrt(9.81 / 0.89);
+
+  std::cout << "horizon, mean solve time (us), max solve time (us), "
+               "mean iterations, fraction converged"
+            << std::endl;
+  for (int horizon = 1; horizon <= FLAGS_max_horizon; horizon++) {
+    LipmFootstepMpcParams params;
+    params.horizon = horizon;
+    params.max_iterations = FLAGS_max_iterations;
+    LipmFootstepMpc mpc(params);
+    auto warm_start = mpc.MakeWarmStart();
+
+    double total_time = 0;
+    double max_time = 0;
+    int total_iterations = 0;
+    int num_converged = 0;
+    for (int i = 0; i < FLAGS_num_reps; i++) {
+      double t = i * FLAGS_dt;
+      int step = static_cast<int>(t / params.step_duration);
+      double time_to_touchdown = (step + 1) * params.step_duration - t;
+      bool first_step_is_left = (step % 2 == 0);
+      Vector2d dcm(0.15 + noise(generator),
+                   (first_step_is_left ? 0.1 : -0.1) + noise(generator));
+      Vector2d desired_velocity(0.5 + 0.5 * sin(t), 0.1 * cos(t));
+
+      const auto solution =
+          mpc.Solve(omega, time_to_touchdown, dcm, desired_velocity,
+                    first_step_is_left, &warm_start);
+      total_time += solution.solve_time;
+      max_time = std::max(max_time, solution.solve_time);
+      total_iterations += solution.iterations;
+      num_converged += solution.converged;
+    }
+    std::cout << horizon << ", " << 1e6 * total_time / FLAGS_num_reps << ", "
+              << 1e6 * max_time << ", "
+              << static_cast<double>(total_iterations) / FLAGS_num_reps << ", "
+              << static_cast<double>(num_converged) / FLAGS_num_reps
+              << std::endl;
+  }
+  return 0;
+}
+
+}  // namespace
+}  // namespace systems
+}  // namespace dairlib
+
+int main(int argc, char* argv[]) {
+  gflags::ParseCommandLineFlags(&argc, &argv, true);
+  return dairlib::systems::do_main();
+}
@@ -0,0 +1,180 @@
+#include <memory>
+#include <utility>
+
+#include <gtest/gtest.h>
+#include "examples/Cassie/cassie_utils.h"
+#include "systems/controllers/affine_controller.h"
+#include "systems/controllers/fixed_size_controllers.h"
+#include "systems/controllers/linear_controller.h"
+#include "systems/controllers/pd_config_lcm.h"
+
+namespace dairlib {
+namespace systems {
+namespace {
+
+using drake::multibody::MultibodyPlant;
+using drake::systems::BasicVector;
+using drake::systems::Context;
+using drake::systems::SystemOutput;
+using Eigen::MatrixXd;
+using Eigen::VectorXd;
+using std::make_unique;
+using std::unique_ptr;
+
+// Evaluates output port 0 of a controller with both inputs fixed, and returns
+// the control without the timestamp
+VectorXd CalcControl(const drake::systems::LeafSystem<double>& controller,
+                     const BasicVector<double>& input0,
+                     const BasicVector<double>& input1) {
+  auto context = controller.CreateDefaultContext();
+  context->FixInputPort(0, input0);
+  context->FixInputPort(1, input1);
+  auto output = controller.AllocateOutput();
+  controller.CalcOutput(*context, output.get());
+  VectorXd u = output->get_vector_data(0)->get_value();
+  return u.head(u.size() - 1);
+}
+
+TEST(FixedSizeControllersTest, AffineMatchesDynamic) {
+  const int np = 2;
+  const int nv = 2;
+  const int nu = 2;
+  VectorXd params_vec(np * nu + nv * nu + nu + np + nv + 1);
+  params_vec << 1.0, 2.0, 3.0, 4.0, 2.0, 1.0, 2.0, 1.0,  // K
+      -0.5, 3.5,                                       // E
+      0.0, 1.0, -1.5, 4.0,                             // x_des
+      0.0;                                             // timestamp
+  AffineParams params(np + nv, nu);
+  params.SetFromVector(params_vec);
+  OutputVector<double> state(Eigen::Vector2d(1.0, -2.5),
+                             Eigen::Vector2d(0.5, -1.5),
+                             Eigen::Vector2d::Zero());
+
+  AffineController dynamic_controller(np, nv, nu);
+  FixedSizeAffineController<np, nv, nu> fixed_controller;
+
+  VectorXd expected(nu);
+  expected << 16.0, 19.0;
+  EXPECT_TRUE(CalcControl(dynamic_controller, state, params)
+                  .isApprox(expected));
+  EXPECT_TRUE(CalcControl(fixed_controller, state, params)
+                  .isApprox(expected));
+}
+
+class FixedSizePDTest : public ::testing::Test {
+ protected:
+  static constexpr int kNumPositions = kCassieFixedBaseNumPositions;
+  static constexpr int kNumVelocities = kCassieFixedBaseNumVelocities;
+  static constexpr int kNumInputs = kCassieNumActuators;
+
+  void SetUp() override {
+    plant_ = make_unique<MultibodyPlant<double>>(0.0);
+    addCassieMultibody(plant_.get(), nullptr, false);
+    plant_->Finalize();
+    receiver_ = make_unique<PDConfigReceiver>(*plant_);
+
+    msg_.num_joints = 3;
+    msg_.joint_names = {"hip_pitch_left_motor", "knee_right_motor",
+                        "toe_left_motor"};
+    msg_.kp = {50, 30, 10};
+    msg_.kd = {5, 3, 1};
+    msg_.desired_position = {0.3, -1.1, -1.5};
+    msg_.desired_velocity = {0.1, 0, -0.2};
+
+    VectorXd q = VectorXd::LinSpaced(kNumPositions, -1, 1);
+    VectorXd v = VectorXd::LinSpaced(kNumVelocities, 2, -2);
+    state_ = make_unique<OutputVector<double>>(q, v,
+                                               VectorXd::Zero(kNumInputs));
+  }
+
+  // Evaluates both receiver output ports for msg_
+  void CalcConfig() {
+    auto context = receiver_->CreateDefaultContext();
+    context->FixInputPort(
+        0, drake::AbstractValue::Make<dairlib::lcmt_pd_config>(msg_));
+    config_ = receiver_->get_output_port_config().Allocate();
+    gains_ = receiver_->get_output_port_joint_gains().Allocate();
+    receiver_->get_output_port_config().Calc(*context, config_.get());
+    receiver_->get_output_port_joint_gains().Calc(*context, gains_.get());
+  }
+
+  const BasicVector<double>& config() {
+    return config_->get_value<BasicVector<double>>();
+  }
+
+  const BasicVector<double>& gains() {
+    return gains_->get_value<BasicVector<double>>();
+  }
+
+  unique_ptr<MultibodyPlant<double>> plant_;
+  unique_ptr<PDConfigReceiver> receiver_;
+  unique_ptr<OutputVector<double>> state_;
+  dairlib::lcmt_pd_config msg_;
+  unique_ptr<drake::AbstractValue> config_;
+  unique_ptr<drake::AbstractValue> gains_;
+};
+
+TEST_F(FixedSizePDTest, IndexMaps) {
+  ASSERT_EQ(receiver_->actuator_to_position_index().size(), kNumInputs);
+  ASSERT_EQ(receiver_->actuator_to_velocity_index().size(), kNumInputs);
+  // Fixed base: every actuated joint has matching q and v indices
+  for (int i = 0; i < kNumInputs; i++) {
+    EXPECT_EQ(receiver_->actuator_to_position_index()[i],
+              receiver_->actuator_to_velocity_index()[i]);
+  }
+}
+
+TEST_F(FixedSizePDTest, ControllersMatchDynamic) {
+  CalcConfig();
+
+  LinearController dynamic_controller(kNumPositions, kNumVelocities,
+                                      kNumInputs);
+  FixedSizeLinearController<kNumPositions, kNumVelocities, kNumInputs>
+      fixed_controller;
+  FixedSizeJointPDController<kNumPositions, kNumVelocities, kNumInputs>
+      pd_controller(receiver_->actuator_to_position_index(),
+                    receiver_->actuator_to_velocity_index());
+
+  // LinearController takes the state first, then the config
+  VectorXd u_dynamic = CalcControl(dynamic_controller, *state_, config());
+  VectorXd u_fixed = CalcControl(fixed_controller, *state_, config());
+  VectorXd u_pd = CalcControl(pd_controller, *state_, gains());
+
+  EXPECT_GT(u_dynamic.norm(), 0);
+  EXPECT_TRUE(u_fixed.isApprox(u_dynamic));
+  EXPECT_TRUE(u_pd.isApprox(u_dynamic));
+}
+
+TEST_F(FixedSizePDTest, NewConfigOnlyUpdatesGains) {
+  auto context = receiver_->CreateDefaultContext();
+  auto config = receiver_->get_output_port_config().Allocate();
+  context->FixInputPort(
+      0, drake::AbstractValue::Make<dairlib::lcmt_pd_config>(msg_));
+  receiver_->get_output_port_config().Calc(*context, config.get());
+
+  // Drop a joint from the message and reuse the same output storage. The
+  // dropped joint's entries must be cleared.
+  msg_.num_joints = 1;
+  msg_.joint_names.resize(1);
+  msg_.kp.resize(1);
+  msg_.kd.resize(1);
+  msg_.desired_position.resize(1);
+  msg_.desired_velocity.resize(1);
+  context->FixInputPort(
+      0, drake::AbstractValue::Make<dairlib::lcmt_pd_config>(msg_));
+  receiver_->get_output_port_config().Calc(*context, config.get());
+
+  const auto& K =
+      dynamic_cast<const LinearConfig&>(
+          config->get_value<BasicVector<double>>()).GetK();
+  EXPECT_EQ((K.array() != 0).count(), 2);
+}
+
+}  // namespace
+}  // namespace systems
+}  // namespace dairlib
+
+int main(int argc, char** argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,290 @@
+#include <math.h>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "systems/controllers/lipm_mpc_footstep_planner.h"
+
+#include "drake/systems/analysis/simulator.h"
+
+namespace dairlib {
+namespace systems {
+namespace {
+
+using drake::multibody::Frame;
+using drake::multibody::MultibodyPlant;
+using drake::multibody::SpatialInertia;
+using drake::multibody::UnitInertia;
+using drake::systems::BasicVector;
+using drake::systems::Context;
+using drake::systems::Simulator;
+using Eigen::Vector2d;
+using Eigen::Vector3d;
+using Eigen::VectorXd;
+using std::make_unique;
+using std::unique_ptr;
+
+class LipmFootstepMpcTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    params_.horizon = 4;
+    params_.max_iterations = 100;
+    omega_ = sqrt(9.81 / 0.89);
+    e_ = exp(omega_ * params_.step_duration);
+  }
+
+  // Displacement between consecutive planned footsteps (the first one is
+  // relative to the stance foot)
+  Vector2d StepDisplacement(const LipmFootstepMpc::Solution& solution,
+                            int k) {
+    if (k == 0) return solution.footsteps.col(0);
+    return solution.footsteps.col(k) - solution.footsteps.col(k - 1);
+  }
+
+  void ExpectFeasible(const LipmFootstepMpc::Solution& solution,
+                      bool first_step_is_left) {
+    for (int k = 0; k < params_.horizon; k++) {
+      Vector2d d = StepDisplacement(solution, k);
+      bool is_left = (k % 2 == 0) == first_step_is_left;
+      double width = is_left ? d(1) : -d(1);
+      EXPECT_LE(fabs(d(0)), params_.max_step_length + 1e-12);
+      EXPECT_GE(width, params_.min_step_width - 1e-12);
+      EXPECT_LE(width, params_.max_step_width + 1e-12);
+    }
+  }
+
+  LipmFootstepMpcParams params_;
+  double omega_;
+  double e_;
+};
+
+// Starting on the periodic orbit of the desired velocity, the plan is the
+// nominal gait
+TEST_F(LipmFootstepMpcTest, PeriodicGait) {
+  LipmFootstepMpc mpc(params_);
+  auto warm_start = mpc.MakeWarmStart();
+  const double T = params_.step_duration;
+  const double w = params_.nominal_step_width;
+  const double v = 0.5;
+
+  // Right stance, at touchdown of the left foot: the DCM is ahead of, and to
+  // the left of, the right foot
+  Vector2d dcm(e_ * v * T / (e_ - 1), e_ * w / (e_ + 1));
+  const auto solution =
+      mpc.Solve(omega_, 0, dcm, Vector2d(v, 0), true, &warm_start);
+
+  EXPECT_TRUE(solution.converged);
+  for (int k = 0; k < params_.horizon; k++) {
+    Vector2d d = StepDisplacement(solution, k);
+    EXPECT_NEAR(d(0), v * T, 1e-9);
+    EXPECT_NEAR(d(1), (k % 2 == 0) ? w : -w, 1e-9);
+  }
+}
+
+// Far above the reachable speed, the step length limit is active
+TEST_F(LipmFootstepMpcTest, KinematicLimits) {
+  LipmFootstepMpc mpc(params_);
+  auto warm_start = mpc.MakeWarmStart();
+  const auto solution = mpc.Solve(omega_, 0.1, Vector2d(0.3, -0.2),
+                                  Vector2d(1.5, 0), false, &warm_start);
+  EXPECT_TRUE(solution.converged);
+  ExpectFeasible(solution, false);
+  EXPECT_NEAR(StepDisplacement(solution, params_.horizon - 1)(0),
+              params_.max_step_length, 1e-12);
+}
+
+// With a single iteration the solve stops early, but the plan is feasible
+TEST_F(LipmFootstepMpcTest, IterationLimit) {
+  params_.max_iterations = 1;
+  LipmFootstepMpc mpc(params_);
+  auto warm_start = mpc.MakeWarmStart();
+  const auto solution = mpc.Solve(omega_, 0.1, Vector2d(0.3, 0.2),
+                                  Vector2d(1.5, 0.3), true, &warm_start);
+  EXPECT_FALSE(solution.converged);
+  EXPECT_LE(solution.iterations, 2);
+  ExpectFeasible(solution, true);
+}
+
+// Re-solving from the previous active set converges immediately
+TEST_F(LipmFootstepMpcTest, WarmStart) {
+  LipmFootstepMpc mpc(params_);
+  auto warm_start = mpc.MakeWarmStart();
+  Vector2d dcm(0.3, 0.2);
+  Vector2d velocity(1.5, 0);
+  const auto cold = mpc.Solve(omega_, 0.1, dcm, velocity, true, &warm_start);
+  const auto solution =
+      mpc.Solve(omega_, 0.1, dcm, velocity, true, &warm_start);
+  EXPECT_TRUE(solution.converged);
+  EXPECT_LT(solution.iterations, cold.iterations);
+  EXPECT_EQ(solution.iterations, 2);
+}
+
+// The solve only depends on its arguments: with the same warm start, an
+// iteration-capped solve gives the same plan
+TEST_F(LipmFootstepMpcTest, Deterministic) {
+  params_.max_iterations = 2;
+  LipmFootstepMpc mpc(params_);
+  auto warm_start = mpc.MakeWarmStart();
+  mpc.Solve(omega_, 0.2, Vector2d(0.1, 0.1), Vector2d(0.5, 0), true,
+            &warm_start);
+  auto warm_start_copy = warm_start;
+  const auto first = mpc.Solve(omega_, 0.1, Vector2d(0.3, 0.2),
+                               Vector2d(1.5, 0.3), true, &warm_start);
+  const auto second = mpc.Solve(omega_, 0.1, Vector2d(0.3, 0.2),
+                                Vector2d(1.5, 0.3), true, &warm_start_copy);
+  EXPECT_TRUE(first.footsteps == second.footsteps);
+  EXPECT_EQ(first.iterations, second.iterations);
+  EXPECT_TRUE(warm_start.steps == warm_start_copy.steps);
+}
+
+const int kLeftStance = 0;
+const int kRightStance = 1;
+
+// The planner as a system, on a point-mass "robot" (a floating body with the
+// feet fixed below its center of mass)
+class LipmMpcFootstepPlannerTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    plant_ = make_unique<MultibodyPlant<double>>(0.0);
+    plant_->AddRigidBody(
+        "pelvis",
+        SpatialInertia<double>(30, Vector3d::Zero(),
+                               UnitInertia<double>::SolidSphere(0.1)));
+    plant_->Finalize();
+    const Frame<double>& pelvis = plant_->GetFrameByName("pelvis");
+    std::vector<std::pair<const Vector3d, const Frame<double>&>>
+        left_right_foot = {{Vector3d(0, 0.1, -height_), pelvis},
+                           {Vector3d(0, -0.1, -height_), pelvis}};
+
+    params_.horizon = 3;
+    params_.max_iterations = 1;
+    planner_ = make_unique<LipmMpcFootstepPlanner>(
+        *plant_, std::vector<int>{kLeftStance, kRightStance}, left_right_foot,
+        params_);
+  }
+
+  unique_ptr<Simulator<double>> MakeSimulator() {
+    auto simulator = make_unique<Simulator<double>>(*planner_);
+    simulator->Initialize();
+    return simulator;
+  }
+
+  // Feeds the inputs at time t and advances the simulator, which runs the
+  // per-step discrete update. The pelvis is at the origin of the world frame.
+  void Step(Simulator<double>* simulator, double t, int fsm_state,
+            const Vector2d& velocity) {
+    Context<double>& context = simulator->get_mutable_context();
+    OutputVector<double> robot_output(plant_->num_positions(),
+                                      plant_->num_velocities(), 0);
+    VectorXd q(7);
+    q << 1, 0, 0, 0, 0, 0, 0;
+    VectorXd v = VectorXd::Zero(6);
+    v.segment<2>(3) = velocity;
+    robot_output.SetPositions(q);
+    robot_output.SetVelocities(v);
+    robot_output.set_timestamp(t);
+    context.FixInputPort(planner_->get_input_port_state().get_index(),
+                         robot_output);
+
+    FiniteStateMachineInfo fsm_info;
+    fsm_info.set_timestamp(t);
+    fsm_info.set_fsm_state(fsm_state);
+    fsm_info.set_next_switch_time(
+        params_.step_duration * (1 + floor(t / params_.step_duration)));
+    context.FixInputPort(planner_->get_input_port_fsm_info().get_index(),
+                         fsm_info);
+    context.FixInputPort(planner_->get_input_port_des_hor_vel().get_index(),
+                         BasicVector<double>(Vector2d(0.5, 0)));
+    simulator->AdvanceTo(t);
+  }
+
+  VectorXd Output(const Simulator<double>& simulator,
+                  const drake::systems::OutputPort<double>& port) {
+    auto output = planner_->AllocateOutput();
+    planner_->CalcOutput(simulator.get_context(), output.get());
+    return output->get_vector_data(port.get_index())->get_value();
+  }
+
+  const double height_ = 0.9;
+  unique_ptr<MultibodyPlant<double>> plant_;
+  LipmFootstepMpcParams params_;
+  unique_ptr<LipmMpcFootstepPlanner> planner_;
+};
+
+// The first plan is the solve of the MPC from an empty warm start, expressed
+// in the world frame
+TEST_F(LipmMpcFootstepPlannerTest, FirstPlan) {
+  auto simulator = MakeSimulator();
+  const Vector2d velocity(0.4, 0.1);
+  Step(simulator.get(), 0.1, kRightStance, velocity);
+
+  const double omega = sqrt(9.81 / height_);
+  const Vector2d stance_foot(0, -0.1);
+  const LipmFootstepMpc& mpc = planner_->get_mpc();
+  auto warm_start = mpc.MakeWarmStart();
+  const auto solution =
+      mpc.Solve(omega, params_.step_duration - 0.1,
+                velocity / omega - stance_foot, Vector2d(0.5, 0), true,
+                &warm_start);
+
+  const VectorXd footsteps =
+      Output(*simulator, planner_->get_output_port_footsteps());
+  for (int k = 0; k < params_.horizon; k++) {
+    EXPECT_TRUE(footsteps.segment<2>(2 * k).isApprox(
+        stance_foot + solution.footsteps.col(k), 1e-12));
+  }
+  EXPECT_TRUE(
+      Output(*simulator, planner_->get_output_port_deviation_from_cp())
+          .isApprox(solution.footsteps.col(0) - solution.dcm_at_touchdown,
+                    1e-12));
+}
+
+// The warm start is part of the context. A cloned context and a replay of
+// the same inputs give the same (iteration-capped) plans.
+TEST_F(LipmMpcFootstepPlannerTest, Deterministic) {
+  const std::vector<Vector2d> velocities = {
+      Vector2d(0.2, 0.1), Vector2d(0.6, -0.3), Vector2d(0.1, 0.4),
+      Vector2d(-0.2, 0.2)};
+  auto RunFirstSteps = [&](Simulator<double>* simulator) {
+    Step(simulator, 0.1, kRightStance, velocities[0]);
+    Step(simulator, 0.2, kRightStance, velocities[1]);
+    Step(simulator, 0.4, kLeftStance, velocities[2]);
+  };
+
+  auto simulator = MakeSimulator();
+  RunFirstSteps(simulator.get());
+  auto clone = make_unique<Simulator<double>>(
+      *planner_, simulator->get_context().Clone());
+  Step(simulator.get(), 0.5, kLeftStance, velocities[3]);
+  Step(clone.get(), 0.5, kLeftStance, velocities[3]);
+
+  auto replay = MakeSimulator();
+  RunFirstSteps(replay.get());
+  Step(replay.get(), 0.5, kLeftStance, velocities[3]);
+
+  const auto& port = planner_->get_output_port_footsteps();
+  const VectorXd footsteps = Output(*simulator, port);
+  EXPECT_TRUE(footsteps == Output(*clone, port));
+  EXPECT_TRUE(footsteps == Output(*replay, port));
+}
+
+// Outside of single support, there is no deviation from the capture point
+TEST_F(LipmMpcFootstepPlannerTest, DoubleSupport) {
+  auto simulator = MakeSimulator();
+  Step(simulator.get(), 0.1, kRightStance, Vector2d(0.4, 0.1));
+  Step(simulator.get(), 0.36, 2, Vector2d(0.4, 0.1));
+  EXPECT_TRUE(
+      Output(*simulator, planner_->get_output_port_deviation_from_cp())
+          .isZero());
+}
+
+}  // namespace
+}  // namespace systems
+}  // namespace dairlib
+
+int main(int argc, char** argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,169 @@
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include <gtest/gtest.h>
+#include "systems/controllers/scheduled_fsm.h"
+#include "systems/controllers/time_based_fsm.h"
+
+#include "drake/systems/analysis/simulator.h"
+
+namespace dairlib {
+namespace systems {
+namespace {
+
+using drake::multibody::MultibodyPlant;
+using drake::systems::BasicVector;
+using drake::systems::Context;
+using drake::systems::Simulator;
+using std::make_unique;
+using std::unique_ptr;
+using std::vector;
+
+class ScheduledFsmTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    plant_ = make_unique<MultibodyPlant<double>>(0.0);
+    plant_->Finalize();
+    states_ = {0, 2, 1, 2};
+    durations_ = {0.35, 0.02, 0.35, 0.02};
+    fsm_ = make_unique<ScheduledFiniteStateMachine>(*plant_, states_,
+                                                    durations_, t0_);
+    simulator_ = make_unique<Simulator<double>>(*fsm_);
+    simulator_->Initialize();
+  }
+
+  // Feeds a robot state with timestamp t and advances the simulator, which
+  // runs the per-step discrete update
+  void Step(double t, bool contact = false) {
+    FixInputs(&simulator_->get_mutable_context(), t, contact);
+    simulator_->AdvanceTo(t);
+  }
+
+  void FixInputs(Context<double>* context, double t, bool contact) {
+    OutputVector<double> robot_output(0, 0, 0);
+    robot_output.set_timestamp(t);
+    context->FixInputPort(fsm_->get_input_port_state().get_index(),
+                          robot_output);
+    context->FixInputPort(fsm_->get_input_port_contact().get_index(),
+                          BasicVector<double>(Eigen::VectorXd::Constant(
+                              1, contact ? 1 : 0)));
+  }
+
+  int fsm_state() {
+    auto output = fsm_->AllocateOutput();
+    fsm_->CalcOutput(simulator_->get_context(), output.get());
+    return output->get_vector_data(fsm_->get_output_port_fsm().get_index())
+        ->GetAtIndex(0);
+  }
+
+  unique_ptr<FiniteStateMachineInfo> fsm_info() {
+    auto output = fsm_->AllocateOutput();
+    fsm_->CalcOutput(simulator_->get_context(), output.get());
+    auto info = make_unique<FiniteStateMachineInfo>();
+    info->SetFromVector(
+        output
+            ->get_vector_data(fsm_->get_output_port_fsm_info().get_index())
+            ->get_value());
+    return info;
+  }
+
+  const double t0_ = 0.1;
+  vector<int> states_;
+  vector<double> durations_;
+  unique_ptr<MultibodyPlant<double>> plant_;
+  unique_ptr<ScheduledFiniteStateMachine> fsm_;
+  unique_ptr<Simulator<double>> simulator_;
+};
+
+TEST_F(ScheduledFsmTest, MatchesTimeBasedFsm) {
+  TimeBasedFiniteStateMachine time_based_fsm(*plant_, states_, durations_,
+                                             t0_);
+  auto time_based_context = time_based_fsm.CreateDefaultContext();
+  auto output = time_based_fsm.AllocateOutput();
+
+  // Sample at 2 kHz, offset to avoid evaluating exactly on switch times
+  for (double t = 0.00025; t < 3; t += 0.0005) {
+    Step(t);
+    OutputVector<double> robot_output(0, 0, 0);
+    robot_output.set_timestamp(t);
+    time_based_context->FixInputPort(0, robot_output);
+    time_based_fsm.CalcOutput(*time_based_context, output.get());
+    ASSERT_EQ(fsm_state(), output->get_vector_data(0)->GetAtIndex(0))
+        << "t = " << t;
+  }
+}
+
+TEST_F(ScheduledFsmTest, Info) {
+  Step(0.05);
+  EXPECT_EQ(fsm_info()->get_fsm_state(), -1);
+  EXPECT_DOUBLE_EQ(fsm_info()->get_next_switch_time(), t0_);
+  EXPECT_EQ(fsm_info()->get_switch_count(), 0);
+
+  Step(0.2);
+  auto info = fsm_info();
+  EXPECT_EQ(info->get_fsm_state(), 0);
+  EXPECT_DOUBLE_EQ(info->get_prev_switch_time(), 0.1);
+  EXPECT_DOUBLE_EQ(info->get_next_switch_time(), 0.45);
+  EXPECT_NEAR(info->get_phase(), 0.1 / 0.35, 1e-12);
+  EXPECT_NEAR(info->get_time_since_switch(), 0.1, 1e-12);
+  EXPECT_NEAR(info->get_time_to_switch(), 0.25, 1e-12);
+  EXPECT_EQ(info->get_switch_count(), 1);
+  EXPECT_TRUE(info->get_mode_changed());
+
+  Step(0.3);
+  EXPECT_FALSE(fsm_info()->get_mode_changed());
+
+  // The mode-change flag does not depend on whether the discrete update has
+  // run for the current timestamp yet
+  FixInputs(&simulator_->get_mutable_context(), 0.46, false);
+  EXPECT_EQ(fsm_info()->get_fsm_state(), 2);
+  EXPECT_TRUE(fsm_info()->get_mode_changed());
+  Step(0.46);
+  EXPECT_EQ(fsm_info()->get_fsm_state(), 2);
+  EXPECT_TRUE(fsm_info()->get_mode_changed());
+  EXPECT_EQ(fsm_info()->get_switch_count(), 2);
+}
+
+TEST_F(ScheduledFsmTest, LargeTimeJump) {
+  Step(0.2);
+  // 100 periods and part of the first state later
+  double t = t0_ + 100 * 0.74 + 0.2;
+  Step(t);
+  auto info = fsm_info();
+  EXPECT_EQ(info->get_fsm_state(), 0);
+  EXPECT_EQ(info->get_switch_count(), 1 + 100 * 4);
+  EXPECT_NEAR(info->get_prev_switch_time(), t0_ + 100 * 0.74, 1e-9);
+}
+
+TEST_F(ScheduledFsmTest, EarlySwitchOnContact) {
+  fsm_->SetEarlySwitchOnContact(0, 0.5);
+  simulator_ = make_unique<Simulator<double>>(*fsm_);
+  simulator_->Initialize();
+
+  Step(0.2);
+  // Contact before min_phase is ignored
+  Step(0.25, true);
+  EXPECT_EQ(fsm_state(), 0);
+  // Contact after min_phase switches early, and shifts the schedule
+  Step(0.3, true);
+  auto info = fsm_info();
+  EXPECT_EQ(info->get_fsm_state(), 2);
+  EXPECT_TRUE(info->get_mode_changed());
+  EXPECT_DOUBLE_EQ(info->get_prev_switch_time(), 0.3);
+  EXPECT_DOUBLE_EQ(info->get_next_switch_time(), 0.32);
+  // Double support is not registered, so contact does not end it early
+  Step(0.31, true);
+  EXPECT_EQ(fsm_state(), 2);
+  Step(0.33);
+  EXPECT_EQ(fsm_state(), 1);
+}
+
+}  // namespace
+}  // namespace systems
+}  // namespace dairlib
+
+int main(int argc, char** argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
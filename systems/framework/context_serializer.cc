@@ -0,0 +1,233 @@
+#include "systems/framework/context_serializer.h"
+
+#include <fstream>
+#include <sstream>
+
+namespace dairlib {
+namespace systems {
+
+using drake::AbstractValue;
+using drake::systems::Context;
+using Eigen::MatrixXd;
+using Eigen::VectorXd;
+using std::istream;
+using std::ostream;
+using std::string;
+
+namespace {
+
+const char kMagic[] = "dairlib_context_v1";
+
+void WriteVector(const VectorXd& vector, ostream* out) {
+  ContextSerializer::WriteMatrix(vector, out);
+}
+
+// Reads a vector, checking that its size matches the one of the context
+VectorXd ReadVector(istream* in, int expected_size, const string& what) {
+  MatrixXd vector = ContextSerializer::ReadMatrix(in);
+  if (vector.cols() != 1 || vector.rows() != expected_size) {
+    throw std::runtime_error("Context snapshot mismatch: " + what + " has " +
+                             std::to_string(vector.size()) +
+                             " elements, expected " +
+                             std::to_string(expected_size) + ".");
+  }
+  return vector;
+}
+
+void CheckCount(int count, int expected_count, const string& what) {
+  if (count != expected_count) {
+    throw std::runtime_error("Context snapshot mismatch: " +
+                             std::to_string(count) + " " + what +
+                             ", expected " + std::to_string(expected_count) +
+                             ".");
+  }
+}
+
+}  // namespace
+
+ContextSerializer::ContextSerializer() {
+  AddType<int>([](const int& value, ostream* out) { WriteScalar(value, out); },
+               [](istream* in, int* value) { *value = ReadScalar<int>(in); });
+  AddType<double>(
+      [](const double& value, ostream* out) { WriteScalar(value, out); },
+      [](istream* in, double* value) { *value = ReadScalar<double>(in); });
+  AddType<bool>(
+      [](const bool& value, ostream* out) { WriteScalar(value, out); },
+      [](istream* in, bool* value) { *value = ReadScalar<bool>(in); });
+  AddType<VectorXd>(
+      [](const VectorXd& value, ostream* out) { WriteMatrix(value, out); },
+      [](istream* in, VectorXd* value) { *value = ReadMatrix(in); });
+}
+
+void ContextSerializer::Write(const Context<double>& context,
+                              ostream* out) const {
+  WriteString(kMagic, out);
+  WriteScalar(context.get_time(), out);
+
+  WriteVector(context.get_continuous_state_vector().CopyToVector(), out);
+
+  const int num_discrete = context.num_discrete_state_groups();
+  WriteScalar(num_discrete, out);
+  for (int i = 0; i < num_discrete; i++) {
+    WriteVector(context.get_discrete_state(i).get_value(), out);
+  }
+
+  const int num_parameters = context.num_numeric_parameter_groups();
+  WriteScalar(num_parameters, out);
+  for (int i = 0; i < num_parameters; i++) {
+    WriteVector(context.get_numeric_parameter(i).get_value(), out);
+  }
+
+  const auto& abstract_state = context.get_abstract_state();
+  const int num_abstract = abstract_state.size();
+  WriteScalar(num_abstract, out);
+  for (int i = 0; i < num_abstract; i++) {
+    const AbstractValue& value = abstract_state.get_value(i);
+    auto it = serializers_.find(std::type_index(value.type_info()));
+    if (it == serializers_.end()) {
+      throw std::runtime_error("No serializer for abstract state " +
+                               std::to_string(i) + " of type " +
+                               value.GetNiceTypeName() + ".");
+    }
+    // Each value is written as a sized block, so that a reader can check it
+    // consumed exactly what was written
+    std::ostringstream block;
+    it->second.write(value, &block);
+    WriteString(value.GetNiceTypeName(), out);
+    WriteString(block.str(), out);
+  }
+}
+
+void ContextSerializer::Read(istream* in, Context<double>* context) const {
+  if (ReadString(in) != kMagic) {
+    throw std::runtime_error("Not a context snapshot.");
+  }
+  context->SetTime(ReadScalar<double>(in));
+
+  auto& continuous_state = context->get_mutable_continuous_state_vector();
+  continuous_state.SetFromVector(
+      ReadVector(in, continuous_state.size(), "continuous state"));
+
+  const int num_discrete = context->num_discrete_state_groups();
+  CheckCount(ReadScalar<int>(in), num_discrete, "discrete state groups");
+  for (int i = 0; i < num_discrete; i++) {
+    auto& discrete_state = context->get_mutable_discrete_state(i);
+    discrete_state.SetFromVector(
+        ReadVector(in, discrete_state.size(),
+                   "discrete state group " + std::to_string(i)));
+  }
+
+  const int num_parameters = context->num_numeric_parameter_groups();
+  CheckCount(ReadScalar<int>(in), num_parameters, "numeric parameter groups");
+  for (int i = 0; i < num_parameters; i++) {
+    auto& parameter = context->get_mutable_numeric_parameter(i);
+    parameter.SetFromVector(ReadVector(
+        in, parameter.size(), "numeric parameter " + std::to_string(i)));
+  }
+
+  auto& abstract_state = context->get_mutable_abstract_state();
+  const int num_abstract = abstract_state.size();
+  CheckCount(ReadScalar<int>(in), num_abstract, "abstract states");
+  for (int i = 0; i < num_abstract; i++) {
+    AbstractValue& value = abstract_state.get_mutable_value(i);
+    const string type_name = ReadString(in);
+    if (type_name != value.GetNiceTypeName()) {
+      throw std::runtime_error("Context snapshot mismatch: abstract state " +
+                               std::to_string(i) + " has type " + type_name +
+                               ", expected " + value.GetNiceTypeName() + ".");
+    }
+    auto it = serializers_.find(std::type_index(value.type_info()));
+    if (it == serializers_.end()) {
+      throw std::runtime_error("No serializer for abstract state " +
+                               std::to_string(i) + " of type " + type_name +
+                               ".");
+    }
+    std::istringstream block(ReadString(in));
+    it->second.read(&block, &value);
+    if (block.peek() != std::istringstream::traits_type::eof()) {
+      throw std::runtime_error("Abstract state " + std::to_string(i) +
+                               " of type " + type_name +
+                               " was not entirely read.");
+    }
+  }
+}
+
+void ContextSerializer::Save(const Context<double>& context,
+                             const string& filename) const {
+  std::ofstream file(filename, std::ios::binary);
+  if (!file) {
+    throw std::runtime_error("Unable to open " + filename + " for writing.");
+  }
+  Write(context, &file);
+}
+
+void ContextSerializer::Load(const string& filename,
+                             Context<double>* context) const {
+  std::ifstream file(filename, std::ios::binary);
+  if (!file) {
+    throw std::runtime_error("Unable to open " + filename + ".");
+  }
+  Read(&file, context);
+}
+
+double ContextSerializer::LoadTime(const string& filename) {
+  std::ifstream file(filename, std::ios::binary);
+  if (!file) {
+    throw std::runtime_error("Unable to open " + filename + ".");
+  }
+  if (ReadString(&file) != kMagic) {
+    throw std::runtime_error("Not a context snapshot.");
+  }
+  return ReadScalar<double>(&file);
+}
+
+void ContextSerializer::WriteMatrix(const MatrixXd& matrix, ostream* out) {
+  WriteScalar<int64_t>(matrix.rows(), out);
+  WriteScalar<int64_t>(matrix.cols(), out);
+  out->write(reinterpret_cast<const char*>(matrix.data()),
+             matrix.size() * sizeof(double));
+}
+
+MatrixXd ContextSerializer::ReadMatrix(istream* in) {
+  const int64_t rows = ReadScalar<int64_t>(in);
+  const int64_t cols = ReadScalar<int64_t>(in);
+  MatrixXd matrix(rows, cols);
+  in->read(reinterpret_cast<char*>(matrix.data()),
+           matrix.size() * sizeof(double));
+  if (!*in) throw std::runtime_error("Unexpected end of context snapshot.");
+  return matrix;
+}
+
+void ContextSerializer::WriteString(const string& value, ostream* out) {
+  WriteScalar<int64_t>(value.size(), out);
+  out->write(value.data(), value.size());
+}
+
+string ContextSerializer::ReadString(istream* in) {
+  string value(ReadScalar<int64_t>(in), '\0');
+  in->read(&value[0], value.size());
+  if (!*in) throw std::runtime_error("Unexpected end of context snapshot.");
+  return value;
+}
+
+void CopyContextState(const Context<double>& source, Context<double>* target) {
+  DRAKE_DEMAND(source.num_discrete_state_groups() ==
+               target->num_discrete_state_groups());
+  DRAKE_DEMAND(source.num_numeric_parameter_groups() ==
+               target->num_numeric_parameter_groups());
+  target->SetTime(source.get_time());
+  target->get_mutable_continuous_state_vector().SetFromVector(
+      source.get_continuous_state_vector().CopyToVector());
+  for (int i = 0; i < source.num_discrete_state_groups(); i++) {
+    target->get_mutable_discrete_state(i).SetFromVector(
+        source.get_discrete_state(i).get_value());
+  }
+  for (int i = 0; i < source.num_numeric_parameter_groups(); i++) {
+    target->get_mutable_numeric_parameter(i).SetFromVector(
+        source.get_numeric_parameter(i).get_value());
+  }
+  target->get_mutable_abstract_state().SetFrom(source.get_abstract_state());
+}
+
+}  // namespace systems
+}  // namespace dairlib
@@ -0,0 +1,127 @@
+#pragma once
+
+#include <functional>
+#include <istream>
+#include <map>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <typeindex>
+
+#include <Eigen/Dense>
+
+#include "drake/common/value.h"
+#include "drake/systems/framework/context.h"
+
+namespace dairlib {
+namespace systems {
+
+/// ContextSerializer saves the time, state (continuous, discrete and abstract)
+/// and numeric parameters of a Context to a binary stream or file, and
+/// restores them exactly, e.g. to resume a simulation from a snapshot instead
+/// of re-simulating from the start.
+///
+/// The Context of a Diagram is handled as a whole: the values of all its
+/// subsystems are written in order, with their sizes, so a snapshot can only
+/// be restored into the context of a diagram of the same structure (checked
+/// on load). Numeric values are written in their binary representation, so
+/// that restoring is bitwise exact.
+///
+/// Abstract state values are written by the serializer registered for their
+/// type. int, double, bool and Eigen::VectorXd are supported by default,
+/// LCM message types can be added with AddLcmType(), and other types with
+/// AddType(). Writing a context with an abstract state of an unregistered type
+/// throws. Abstract parameters are neither written nor restored, since they
+/// typically hold instance-specific data (e.g. the geometry ids of a
+/// SceneGraph) rather than simulation state.
+class ContextSerializer {
+ public:
+  ContextSerializer();
+
+  /// Registers the serializer of abstract state values of type T
+  template <typename T>
+  void AddType(std::function<void(const T&, std::ostream*)> write,
+               std::function<void(std::istream*, T*)> read) {
+    TypeSerializer serializer;
+    serializer.write = [write](const drake::AbstractValue& value,
+                               std::ostream* out) {
+      write(value.get_value<T>(), out);
+    };
+    serializer.read = [read](std::istream* in, drake::AbstractValue* value) {
+      read(in, &value->get_mutable_value<T>());
+    };
+    serializers_[std::type_index(typeid(T))] = serializer;
+  }
+
+  /// Registers an LCM message type, serialized with its LCM encoding
+  template <typename T>
+  void AddLcmType() {
+    AddType<T>(
+        [](const T& message, std::ostream* out) {
+          std::string buffer(message.getEncodedSize(), '\0');
+          message.encode(&buffer[0], 0, buffer.size());
+          WriteString(buffer, out);
+        },
+        [](std::istream* in, T* message) {
+          std::string buffer = ReadString(in);
+          if (message->decode(buffer.data(), 0, buffer.size()) < 0) {
+            throw std::runtime_error("Unable to decode LCM message.");
+          }
+        });
+  }
+
+  /// Writes the context to a binary stream
+  void Write(const drake::systems::Context<double>& context,
+             std::ostream* out) const;
+
+  /// Reads a context written by Write() into the context of a system of the
+  /// same structure
+  void Read(std::istream* in, drake::systems::Context<double>* context) const;
+
+  /// Writes the context to a binary file
+  void Save(const drake::systems::Context<double>& context,
+            const std::string& filename) const;
+
+  /// Reads a context from a binary file written by Save()
+  void Load(const std::string& filename,
+            drake::systems::Context<double>* context) const;
+
+  /// Reads the time of a context saved by Save(), without restoring it
+  static double LoadTime(const std::string& filename);
+
+  /// Helpers to write and read the binary representation of values, for use
+  /// by the serializers of abstract types
+  template <typename T>
+  static void WriteScalar(const T& value, std::ostream* out) {
+    out->write(reinterpret_cast<const char*>(&value), sizeof(T));
+  }
+  template <typename T>
+  static T ReadScalar(std::istream* in) {
+    T value;
+    in->read(reinterpret_cast<char*>(&value), sizeof(T));
+    if (!*in) throw std::runtime_error("Unexpected end of context snapshot.");
+    return value;
+  }
+  static void WriteMatrix(const Eigen::MatrixXd& matrix, std::ostream* out);
+  static Eigen::MatrixXd ReadMatrix(std::istream* in);
+  static void WriteString(const std::string& value, std::ostream* out);
+  static std::string ReadString(std::istream* in);
+
+ private:
+  struct TypeSerializer {
+    std::function<void(const drake::AbstractValue&, std::ostream*)> write;
+    std::function<void(std::istream*, drake::AbstractValue*)> read;
+  };
+
+  std::map<std::type_index, TypeSerializer> serializers_;
+};
+
+/// Copies the time, state and numeric parameters of source into target, e.g.
+/// between the contexts of two instances of the same diagram. Unlike
+/// Context::SetTimeStateAndParametersFrom(), abstract parameters are left
+/// unchanged (see ContextSerializer).
+void CopyContextState(const drake::systems::Context<double>& source,
+                      drake::systems::Context<double>* target);
+
+}  // namespace systems
+}  // namespace dairlib
@@ -13,6 +13,7 @@
 #include "drake/systems/lcm/serializer.h"
 
 #include "dairlib/lcmt_controller_switch.hpp"
+#include "systems/framework/system_tracer.h"
 
 namespace dairlib {
 namespace systems {
@@ -200,6 +201,7 @@ class LcmDrivenLoop {
 
       // Update the diagram context when there is new input message
       if (is_new_input_message) {
+        TickTraceScope tick(diagram_name_);
         // Write the InputMessageType message into the context if lcm_parser is
         // provided
         if (lcm_parser_ != nullptr) {
@@ -227,6 +229,7 @@ class LcmDrivenLoop {
         simulator_->AdvanceTo(time);
         if (is_forced_publish_) {
           // Force-publish via the diagram
+          TraceScope trace("publish", diagram_name_, "Publish");
           diagram_ptr_->Publish(diagram_context);
         }
 
@@ -0,0 +1,178 @@
+#include "systems/framework/system_tracer.h"
+
+#include <algorithm>
+#include <chrono>
+#include <csignal>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <thread>
+
+namespace dairlib {
+namespace systems {
+
+using std::string;
+using std::vector;
+
+namespace {
+
+int CurrentThread() {
+  static std::atomic<int> num_threads{0};
+  thread_local const int thread = ++num_threads;
+  return thread;
+}
+
+void RequestDefaultDump(int) { SystemTracer::Default().RequestDump(); }
+
+// Writes a string as a JSON string (names are plain identifiers, but may
+// contain quotes or backslashes)
+void WriteJsonString(const char* str, std::ostream* out) {
+  *out << '"';
+  for (; *str; str++) {
+    if (*str == '"' || *str == '\\') *out << '\\';
+    *out << *str;
+  }
+  *out << '"';
+}
+
+}  // namespace
+
+SystemTracer::SystemTracer(int capacity) : events_(std::max(capacity, 1)) {}
+
+SystemTracer& SystemTracer::Default() {
+  static SystemTracer tracer;
+  return tracer;
+}
+
+void SystemTracer::set_dump_prefix(const string& prefix) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  dump_prefix_ = prefix;
+}
+
+void SystemTracer::SetOverrunDump(double deadline, int max_dumps) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  deadline_ = static_cast<int64_t>(deadline * 1e9);
+  max_dumps_ = max_dumps;
+  num_dumps_ = 0;
+}
+
+void SystemTracer::InstallDumpSignalHandler(int signal) {
+  Default();  // Not constructed in the signal handler
+  std::signal(signal, RequestDefaultDump);
+}
+
+void SystemTracer::EnableDefault(const string& dump_prefix, double deadline) {
+  SystemTracer& tracer = Default();
+  tracer.set_dump_prefix(dump_prefix);
+  tracer.SetOverrunDump(deadline);
+  InstallDumpSignalHandler(SIGUSR1);
+  tracer.set_enabled(true);
+}
+
+int64_t SystemTracer::Now() {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+void SystemTracer::Record(const char* category, const string& name,
+                          const char* method, int64_t begin, int64_t end) {
+  const int thread = CurrentThread();
+  std::lock_guard<std::mutex> lock(mutex_);
+  TraceEvent& event = events_[next_];
+  event.category = category;
+  const size_t length =
+      std::min(name.size(), static_cast<size_t>(TraceEvent::kMaxNameLength));
+  std::memcpy(event.name, name.data(), length);
+  event.name[length] = '\0';
+  event.method = method;
+  event.begin = begin;
+  event.end = end;
+  event.thread = thread;
+  if (num_recorded_ >= static_cast<int64_t>(events_.size())) num_dropped_++;
+  num_recorded_++;
+  next_ = (next_ + 1) % events_.size();
+}
+
+string SystemTracer::RecordTick(const string& name, int64_t begin,
+                                int64_t end) {
+  Record("tick", name, "tick", begin, end);
+  if (dump_requested_.exchange(false)) return Dump("request");
+  bool overrun;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    overrun = deadline_ > 0 && end - begin > deadline_ &&
+              num_dumps_ < max_dumps_;
+    if (overrun) num_dumps_++;
+  }
+  return overrun ? Dump("overrun") : "";
+}
+
+string SystemTracer::Dump(const string& reason) {
+  string filename;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    filename = dump_prefix_ + "_" + reason + "_" +
+               std::to_string(num_files_++) + ".json";
+  }
+  return WriteChromeTraceFile(filename) ? filename : "";
+}
+
+vector<TraceEvent> SystemTracer::GetEvents() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  vector<TraceEvent> events;
+  const int size =
+      std::min(num_recorded_, static_cast<int64_t>(events_.size()));
+  events.reserve(size);
+  const int first = (next_ - size + events_.size()) % events_.size();
+  for (int i = 0; i < size; i++) {
+    events.push_back(events_[(first + i) % events_.size()]);
+  }
+  return events;
+}
+
+int64_t SystemTracer::num_dropped() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return num_dropped_;
+}
+
+void SystemTracer::Clear() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  next_ = 0;
+  num_recorded_ = 0;
+  num_dropped_ = 0;
+}
+
+void SystemTracer::WriteChromeTrace(std::ostream* out) const {
+  const vector<TraceEvent> events = GetEvents();
+  // Complete ("X") events, with times in us relative to the earliest begin
+  // (events are recorded when they end, so enclosing ones come later)
+  int64_t origin = events.empty() ? 0 : events.front().begin;
+  for (const auto& event : events) origin = std::min(origin, event.begin);
+  *out << std::fixed << std::setprecision(3);
+  *out << "{\"displayTimeUnit\": \"ns\", \"traceEvents\": [";
+  for (size_t i = 0; i < events.size(); i++) {
+    const TraceEvent& event = events[i];
+    *out << (i ? ",\n" : "\n") << "{\"name\": ";
+    WriteJsonString(event.name, out);
+    *out << ", \"cat\": ";
+    WriteJsonString(event.category, out);
+    *out << ", \"ph\": \"X\", \"ts\": " << 1e-3 * (event.begin - origin)
+         << ", \"dur\": " << 1e-3 * (event.end - event.begin)
+         << ", \"pid\": 0, \"tid\": " << event.thread
+         << ", \"args\": {\"method\": ";
+    WriteJsonString(event.method, out);
+    *out << "}}";
+  }
+  *out << "\n]}\n";
+}
+
+bool SystemTracer::WriteChromeTraceFile(const string& filename) const {
+  std::ofstream file(filename);
+  if (!file.good()) return false;
+  WriteChromeTrace(&file);
+  return file.good();
+}
+
+}  // namespace systems
+}  // namespace dairlib
@@ -0,0 +1,174 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "drake/common/drake_copyable.h"
+
+namespace dairlib {
+namespace systems {
+
+/// Timed section recorded by SystemTracer
+struct TraceEvent {
+  static constexpr int kMaxNameLength = 63;
+
+  /// Kind of section, e.g. "calc", "update", "publish" or "tick"
+  const char* category = "";
+  /// Name of the system (truncated to kMaxNameLength)
+  char name[kMaxNameLength + 1] = "";
+  /// Method of the system, e.g. "CalcOptimalInput"
+  const char* method = "";
+  /// Steady clock times (ns)
+  int64_t begin = 0;
+  int64_t end = 0;
+  /// Small integer identifying the recording thread
+  int thread = 0;
+};
+
+/// SystemTracer records the execution of the systems of a diagram (output
+/// port calculations, discrete and unrestricted updates, publishes) and of the
+/// loop ticks driving it, to see which system made a tick slow.
+///
+/// The systems record their sections with TraceScope, and the loops
+/// (LcmDrivenLoop, UDPDrivenLoop, ...) record their ticks with TickTraceScope.
+/// The events are kept in a ring buffer holding the latest ones, and written
+/// in the Chrome trace event format, which chrome://tracing and Perfetto
+/// (ui.perfetto.dev) open as a timeline.
+///
+/// Tracing is off by default. While disabled, a scope costs one relaxed
+/// atomic load. When enabled, recording an event copies it into the buffer
+/// under a mutex, without allocating.
+///
+/// The buffer can be dumped to a file explicitly, on request from a signal
+/// handler (RequestDump(), taken into account at the end of the next tick), or
+/// whenever a tick overruns a deadline. Dumps happen in the thread ending the
+/// tick, which is delayed by the file write.
+class SystemTracer {
+ public:
+  DRAKE_NO_COPY_NO_MOVE_NO_ASSIGN(SystemTracer)
+
+  /// @param capacity number of events kept
+  explicit SystemTracer(int capacity = 1 << 16);
+
+  /// Process-wide tracer, used by default by the scopes
+  static SystemTracer& Default();
+
+  void set_enabled(bool enabled) { enabled_.store(enabled); }
+  bool enabled() const { return enabled_.load(std::memory_order_relaxed); }
+
+  /// Sets the prefix of the dump files, "<prefix>_<reason>_<n>.json"
+  void set_dump_prefix(const std::string& prefix);
+  /// Dumps the buffer when a tick lasts longer than deadline (s), at most
+  /// max_dumps times. A deadline of 0 disables the dumps.
+  void SetOverrunDump(double deadline, int max_dumps = 10);
+
+  /// Asks for a dump at the end of the next tick. Async-signal-safe.
+  void RequestDump() { dump_requested_.store(true); }
+  /// Calls RequestDump() of the default tracer on the given signal (e.g.
+  /// SIGUSR1)
+  static void InstallDumpSignalHandler(int signal);
+
+  /// Enables the default tracer for a process: dumps to dump_prefix on
+  /// overruns of deadline (s, 0 for none) and on SIGUSR1
+  static void EnableDefault(const std::string& dump_prefix, double deadline);
+
+  /// Records a section. name is truncated to TraceEvent::kMaxNameLength, and
+  /// category and method must outlive the tracer (e.g. string literals).
+  void Record(const char* category, const std::string& name,
+              const char* method, int64_t begin, int64_t end);
+
+  /// Records a tick of a loop, and dumps the buffer if it overran the
+  /// deadline or a dump was requested. Returns the file written, if any.
+  std::string RecordTick(const std::string& name, int64_t begin, int64_t end);
+
+  /// Events in the buffer, oldest first
+  std::vector<TraceEvent> GetEvents() const;
+  /// Number of events overwritten since the last Clear()
+  int64_t num_dropped() const;
+  void Clear();
+
+  /// Writes the events in the Chrome trace event format
+  void WriteChromeTrace(std::ostream* out) const;
+  /// Returns false if the file can't be written
+  bool WriteChromeTraceFile(const std::string& filename) const;
+
+  /// Steady clock time (ns)
+  static int64_t Now();
+
+ private:
+  std::string Dump(const std::string& reason);
+
+  std::atomic<bool> enabled_{false};
+  std::atomic<bool> dump_requested_{false};
+
+  mutable std::mutex mutex_;
+  std::vector<TraceEvent> events_;
+  // Index of the next event written, and number of events written
+  int next_ = 0;
+  int64_t num_recorded_ = 0;
+  int64_t num_dropped_ = 0;
+
+  std::string dump_prefix_ = "/tmp/dairlib_trace";
+  int64_t deadline_ = 0;
+  int max_dumps_ = 0;
+  int num_dumps_ = 0;
+  int num_files_ = 0;
+};
+
+/// Records the section between its construction and destruction, e.g. at the
+/// start of an output port calculation:
+///   TraceScope trace("calc", this->get_name(), "CalcOptimalInput");
+/// name is referenced, not copied, until the end of the scope.
+class TraceScope {
+ public:
+  DRAKE_NO_COPY_NO_MOVE_NO_ASSIGN(TraceScope)
+
+  TraceScope(const char* category, const std::string& name, const char* method,
+             SystemTracer* tracer = &SystemTracer::Default())
+      : tracer_(tracer->enabled() ? tracer : nullptr),
+        category_(category),
+        name_(name),
+        method_(method),
+        begin_(tracer_ ? SystemTracer::Now() : 0) {}
+
+  ~TraceScope() {
+    if (tracer_) {
+      tracer_->Record(category_, name_, method_, begin_, SystemTracer::Now());
+    }
+  }
+
+ private:
+  SystemTracer* const tracer_;
+  const char* const category_;
+  const std::string& name_;
+  const char* const method_;
+  const int64_t begin_;
+};
+
+/// Records a tick of a loop (see SystemTracer::RecordTick())
+class TickTraceScope {
+ public:
+  DRAKE_NO_COPY_NO_MOVE_NO_ASSIGN(TickTraceScope)
+
+  explicit TickTraceScope(const std::string& name,
+                          SystemTracer* tracer = &SystemTracer::Default())
+      : tracer_(tracer->enabled() ? tracer : nullptr),
+        name_(name),
+        begin_(tracer_ ? SystemTracer::Now() : 0) {}
+
+  ~TickTraceScope() {
+    if (tracer_) tracer_->RecordTick(name_, begin_, SystemTracer::Now());
+  }
+
+ private:
+  SystemTracer* const tracer_;
+  const std::string& name_;
+  const int64_t begin_;
+};
+
+}  // namespace systems
+}  // namespace dairlib
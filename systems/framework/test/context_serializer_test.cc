@@ -0,0 +1,126 @@
+#include "systems/framework/context_serializer.h"
+
+#include <memory>
+#include <sstream>
+#include <string>
+
+#include <gtest/gtest.h>
+
+#include "dairlib/lcmt_robot_output.hpp"
+
+#include "drake/systems/framework/leaf_system.h"
+
+namespace dairlib {
+namespace systems {
+namespace {
+
+using drake::AbstractValue;
+using drake::systems::BasicVector;
+using drake::systems::Context;
+using drake::systems::LeafSystem;
+using Eigen::VectorXd;
+
+// System with every kind of state, and numeric parameters
+class StatefulSystem : public LeafSystem<double> {
+ public:
+  explicit StatefulSystem(int discrete_size) {
+    DeclareContinuousState(2);
+    DeclareDiscreteState(discrete_size);
+    DeclareDiscreteState(1);
+    DeclareAbstractState(AbstractValue::Make<int>(0));
+    DeclareAbstractState(AbstractValue::Make<VectorXd>(VectorXd::Zero(2)));
+    DeclareAbstractState(AbstractValue::Make<lcmt_robot_output>());
+    DeclareNumericParameter(BasicVector<double>(2));
+  }
+};
+
+class ContextSerializerTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    serializer_.AddLcmType<lcmt_robot_output>();
+    context_ = system_.CreateDefaultContext();
+    context_->SetTime(0.123456789);
+    context_->get_mutable_continuous_state_vector().SetFromVector(
+        Eigen::Vector2d(1.0 / 3, -2.0 / 7));
+    context_->get_mutable_discrete_state(0).SetFromVector(
+        Eigen::Vector3d(M_PI, 1e-300, -4));
+    context_->get_mutable_discrete_state(1)[0] = 5;
+    context_->get_mutable_abstract_state<int>(0) = 42;
+    context_->get_mutable_abstract_state<VectorXd>(1) = VectorXd::LinSpaced(
+        4, 0, 1);
+    auto& message = context_->get_mutable_abstract_state<lcmt_robot_output>(2);
+    message.utime = 123456;
+    message.num_positions = 1;
+    message.position_names = {"base_z"};
+    message.position = {0.95};
+    message.imu_accel[2] = 9.81;
+    context_->get_mutable_numeric_parameter(0).SetFromVector(
+        Eigen::Vector2d(0.1, 0.2));
+  }
+
+  // Checks that the time, state and parameters of the two contexts are
+  // bitwise identical
+  void ExpectEqual(const Context<double>& context) {
+    EXPECT_EQ(context.get_time(), context_->get_time());
+    EXPECT_EQ(context.get_continuous_state_vector().CopyToVector(),
+              context_->get_continuous_state_vector().CopyToVector());
+    for (int i = 0; i < 2; i++) {
+      EXPECT_EQ(context.get_discrete_state(i).get_value(),
+                context_->get_discrete_state(i).get_value());
+    }
+    EXPECT_EQ(context.get_abstract_state<int>(0), 42);
+    EXPECT_EQ(context.get_abstract_state<VectorXd>(1),
+              context_->get_abstract_state<VectorXd>(1));
+    const auto& message = context.get_abstract_state<lcmt_robot_output>(2);
+    EXPECT_EQ(message.utime, 123456);
+    ASSERT_EQ(message.num_positions, 1);
+    EXPECT_EQ(message.position_names[0], "base_z");
+    EXPECT_EQ(message.position[0], 0.95);
+    EXPECT_EQ(message.imu_accel[2], 9.81);
+    EXPECT_EQ(context.get_numeric_parameter(0).get_value(),
+              context_->get_numeric_parameter(0).get_value());
+  }
+
+  StatefulSystem system_{3};
+  std::unique_ptr<Context<double>> context_;
+  ContextSerializer serializer_;
+};
+
+TEST_F(ContextSerializerTest, WriteAndRead) {
+  std::stringstream stream;
+  serializer_.Write(*context_, &stream);
+  auto context = system_.CreateDefaultContext();
+  serializer_.Read(&stream, context.get());
+  ExpectEqual(*context);
+}
+
+TEST_F(ContextSerializerTest, CopyContextState) {
+  StatefulSystem other_system(3);
+  auto context = other_system.CreateDefaultContext();
+  CopyContextState(*context_, context.get());
+  ExpectEqual(*context);
+}
+
+// A snapshot can't be restored into a system of a different structure
+TEST_F(ContextSerializerTest, StructureMismatch) {
+  std::stringstream stream;
+  serializer_.Write(*context_, &stream);
+  StatefulSystem other_system(4);
+  auto context = other_system.CreateDefaultContext();
+  EXPECT_THROW(serializer_.Read(&stream, context.get()), std::runtime_error);
+}
+
+TEST_F(ContextSerializerTest, UnregisteredType) {
+  ContextSerializer serializer;
+  std::stringstream stream;
+  EXPECT_THROW(serializer.Write(*context_, &stream), std::runtime_error);
+}
+
+}  // namespace
+}  // namespace systems
+}  // namespace dairlib
+
+int main(int argc, char** argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,148 @@
+#include "systems/framework/system_tracer.h"
+
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <thread>
+
+#include <gtest/gtest.h>
+
+namespace dairlib {
+namespace systems {
+namespace {
+
+int CountOccurrences(const std::string& text, const std::string& pattern) {
+  int count = 0;
+  for (auto i = text.find(pattern); i != std::string::npos;
+       i = text.find(pattern, i + 1)) {
+    count++;
+  }
+  return count;
+}
+
+GTEST_TEST(SystemTracerTest, DisabledRecordsNothing) {
+  SystemTracer tracer(16);
+  const std::string name = "osc";
+  {
+    TickTraceScope tick(name, &tracer);
+    TraceScope trace("calc", name, "CalcOptimalInput", &tracer);
+  }
+  EXPECT_TRUE(tracer.GetEvents().empty());
+}
+
+GTEST_TEST(SystemTracerTest, NestedScopes) {
+  SystemTracer tracer(16);
+  tracer.set_enabled(true);
+  const std::string loop = "controller";
+  const std::string osc = "osc";
+  const std::string fsm = "fsm";
+  {
+    TickTraceScope tick(loop, &tracer);
+    { TraceScope trace("update", fsm, "DiscreteVariableUpdate", &tracer); }
+    TraceScope trace("calc", osc, "CalcOptimalInput", &tracer);
+  }
+  auto events = tracer.GetEvents();
+  ASSERT_EQ(events.size(), 3);
+  // Events are recorded when their scope ends
+  EXPECT_EQ(std::string(events[0].name), "fsm");
+  EXPECT_EQ(std::string(events[0].category), "update");
+  EXPECT_EQ(std::string(events[1].name), "osc");
+  EXPECT_EQ(std::string(events[1].method), "CalcOptimalInput");
+  EXPECT_EQ(std::string(events[2].name), "controller");
+  EXPECT_EQ(std::string(events[2].category), "tick");
+  // The tick encloses the sections, which follow each other
+  for (const auto& event : events) {
+    EXPECT_LE(event.begin, event.end);
+    EXPECT_EQ(event.thread, events[0].thread);
+  }
+  EXPECT_LE(events[2].begin, events[0].begin);
+  EXPECT_LE(events[0].end, events[1].begin);
+  EXPECT_LE(events[1].end, events[2].end);
+
+  std::stringstream json;
+  tracer.WriteChromeTrace(&json);
+  const std::string trace = json.str();
+  EXPECT_EQ(trace.find("{\"displayTimeUnit\": \"ns\", \"traceEvents\": ["), 0);
+  EXPECT_EQ(CountOccurrences(trace, "\"ph\": \"X\""), 3);
+  EXPECT_EQ(CountOccurrences(trace, "\"name\": \"osc\", \"cat\": \"calc\""),
+            1);
+  EXPECT_EQ(CountOccurrences(trace, "\"args\": {\"method\": \"tick\"}"), 1);
+  // The first event starts at 0
+  EXPECT_NE(trace.find("\"ts\": 0.000,"), std::string::npos);
+  EXPECT_EQ(trace.substr(trace.size() - 4), "\n]}\n");
+}
+
+GTEST_TEST(SystemTracerTest, RingBuffer) {
+  SystemTracer tracer(4);
+  tracer.set_enabled(true);
+  for (int i = 0; i < 10; i++) {
+    tracer.Record("calc", "system" + std::to_string(i), "Calc", i, i + 1);
+  }
+  auto events = tracer.GetEvents();
+  ASSERT_EQ(events.size(), 4);
+  for (int i = 0; i < 4; i++) {
+    EXPECT_EQ(std::string(events[i].name), "system" + std::to_string(6 + i));
+    EXPECT_EQ(events[i].begin, 6 + i);
+  }
+  EXPECT_EQ(tracer.num_dropped(), 6);
+
+  // Long names are truncated
+  tracer.Record("calc", std::string(100, 'a'), "Calc", 0, 1);
+  EXPECT_EQ(std::string(tracer.GetEvents().back().name),
+            std::string(TraceEvent::kMaxNameLength, 'a'));
+
+  tracer.Clear();
+  EXPECT_TRUE(tracer.GetEvents().empty());
+  EXPECT_EQ(tracer.num_dropped(), 0);
+}
+
+GTEST_TEST(SystemTracerTest, Dumps) {
+  SystemTracer tracer(16);
+  tracer.set_enabled(true);
+  const std::string prefix = ::testing::TempDir() + "/system_tracer_test";
+  tracer.set_dump_prefix(prefix);
+  tracer.SetOverrunDump(1e-3, 1);
+
+  // Ticks within the deadline aren't dumped
+  EXPECT_EQ(tracer.RecordTick("loop", 0, 500000), "");
+  // Overruns are, up to max_dumps
+  const std::string overrun_file = tracer.RecordTick("loop", 0, 2000000);
+  EXPECT_EQ(overrun_file, prefix + "_overrun_0.json");
+  EXPECT_EQ(tracer.RecordTick("loop", 0, 2000000), "");
+  // Requests are taken into account at the end of the next tick
+  tracer.RequestDump();
+  const std::string request_file = tracer.RecordTick("loop", 0, 1000);
+  EXPECT_EQ(request_file, prefix + "_request_1.json");
+  EXPECT_EQ(tracer.RecordTick("loop", 0, 1000), "");
+
+  std::ifstream file(overrun_file);
+  std::stringstream trace;
+  trace << file.rdbuf();
+  EXPECT_EQ(CountOccurrences(trace.str(), "\"ph\": \"X\""), 2);
+  std::remove(overrun_file.c_str());
+  std::remove(request_file.c_str());
+}
+
+GTEST_TEST(SystemTracerTest, Threads) {
+  SystemTracer tracer(16);
+  tracer.set_enabled(true);
+  const std::string name = "estimator";
+  { TraceScope trace("update", name, "Update", &tracer); }
+  std::thread thread([&tracer, &name]() {
+    TraceScope trace("update", name, "Update", &tracer);
+  });
+  thread.join();
+  auto events = tracer.GetEvents();
+  ASSERT_EQ(events.size(), 2);
+  EXPECT_NE(events[0].thread, events[1].thread);
+}
+
+}  // namespace
+}  // namespace systems
+}  // namespace dairlib
+
+int main(int argc, char** argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
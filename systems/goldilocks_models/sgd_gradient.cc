@@ -0,0 +1,220 @@
+#include "systems/goldilocks_models/sgd_gradient.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <limits>
+#include <thread>
+
+#include <Eigen/Sparse>
+
+#include "drake/common/drake_assert.h"
+
+using Eigen::MatrixXd;
+using Eigen::VectorXd;
+using std::vector;
+
+namespace dairlib {
+namespace goldilocks_models {
+
+SgdSample MakeSgdSample(const MatrixXd& H, const VectorXd& w,
+                        const VectorXd& z, const MatrixXd& A,
+                        const MatrixXd& B, const VectorXd& y,
+                        const VectorXd& lb, const VectorXd& ub, double tol) {
+  DRAKE_DEMAND(A.rows() == y.size() && B.rows() == y.size());
+  DRAKE_DEMAND(H.rows() == A.cols() && w.size() == A.cols());
+  DRAKE_DEMAND(z.size() == A.cols());
+
+  vector<int> active;
+  for (int i = 0; i < y.size(); i++) {
+    if (y(i) >= ub(i) - tol || y(i) <= lb(i) + tol) active.push_back(i);
+  }
+
+  SgdSample sample;
+  sample.H = H;
+  sample.w = w;
+  sample.z = z;
+  sample.z_lb = VectorXd::Constant(z.size(),
+                                   -std::numeric_limits<double>::infinity());
+  sample.z_ub = VectorXd::Constant(z.size(),
+                                   std::numeric_limits<double>::infinity());
+  for (int i = 0; i < A.rows(); i++) {
+    if (B.row(i).any() || (A.row(i).array() != 0).count() != 1) continue;
+    int j;
+    A.row(i).cwiseAbs().maxCoeff(&j);
+    const double a = A(i, j);
+    // lb <= y + a * (z_new - z) <= ub
+    double lower = z(j) + (lb(i) - y(i)) / a;
+    double upper = z(j) + (ub(i) - y(i)) / a;
+    if (a < 0) std::swap(lower, upper);
+    sample.z_lb(j) = std::max(sample.z_lb(j), lower);
+    sample.z_ub(j) = std::min(sample.z_ub(j), upper);
+  }
+  sample.A_active.resize(active.size(), A.cols());
+  sample.B_active.resize(active.size(), B.cols());
+  for (size_t i = 0; i < active.size(); i++) {
+    sample.A_active.row(i) = A.row(active[i]);
+    sample.B_active.row(i) = B.row(active[i]);
+  }
+  return sample;
+}
+
+double SgdGradient::ConstraintResidual(const vector<SgdSample>& samples) const {
+  double squared_norm = 0;
+  for (size_t i = 0; i < samples.size(); i++) {
+    squared_norm += (samples[i].A_active * dz[i] +
+                     samples[i].B_active * dtheta).squaredNorm();
+  }
+  return std::sqrt(squared_norm);
+}
+
+double SgdGradient::Descent(const vector<SgdSample>& samples) const {
+  double descent = 0;
+  for (size_t i = 0; i < samples.size(); i++) {
+    descent += samples[i].w.dot(dz[i]);
+  }
+  return descent;
+}
+
+double SgdGradient::Curvature(const vector<SgdSample>& samples) const {
+  double curvature = 0;
+  for (size_t i = 0; i < samples.size(); i++) {
+    curvature += dz[i].dot(samples[i].H * dz[i]);
+  }
+  return curvature;
+}
+
+SgdGradient SolveSgdGradient(const vector<SgdSample>& samples,
+                             int num_threads) {
+  DRAKE_DEMAND(!samples.empty());
+  const int n_samples = samples.size();
+  const int nt = samples[0].B_active.cols();
+
+  // Per sample, with K_i = [H_i A_i'; A_i 0]:
+  //   u_i = K_i^-1 [-w_i; 0] and V_i = K_i^-1 [0; -B_i],
+  // so that (dz_i, lambda_i) = u_i + V_i dtheta
+  vector<VectorXd> u(n_samples);
+  vector<MatrixXd> V(n_samples);
+  std::atomic<int> next_sample(0);
+  auto worker = [&]() {
+    for (int i = next_sample++; i < n_samples; i = next_sample++) {
+      const SgdSample& sample = samples[i];
+      const int nz = sample.A_active.cols();
+      const int nl = sample.A_active.rows();
+      DRAKE_DEMAND(sample.B_active.cols() == nt);
+
+      MatrixXd K = MatrixXd::Zero(nz + nl, nz + nl);
+      K.topLeftCorner(nz, nz) = sample.H;
+      K.topRightCorner(nz, nl) = sample.A_active.transpose();
+      K.bottomLeftCorner(nl, nz) = sample.A_active;
+
+      MatrixXd rhs = MatrixXd::Zero(nz + nl, 1 + nt);
+      rhs.block(0, 0, nz, 1) = -sample.w;
+      rhs.block(nz, 1, nl, nt) = -sample.B_active;
+
+      // Column pivoting handles redundant active constraints, as SparseQR does
+      // for the assembled system
+      const MatrixXd solution = K.colPivHouseholderQr().solve(rhs);
+      u[i] = solution.col(0);
+      V[i] = solution.rightCols(nt);
+    }
+  };
+  vector<std::thread> threads;
+  for (int i = 1; i < std::min(num_threads, n_samples); i++) {
+    threads.emplace_back(worker);
+  }
+  worker();
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  // Schur complement in dtheta of sum_i B_i' lambda_i = 0
+  MatrixXd S = MatrixXd::Zero(nt, nt);
+  VectorXd r = VectorXd::Zero(nt);
+  for (int i = 0; i < n_samples; i++) {
+    const int nl = samples[i].A_active.rows();
+    S += samples[i].B_active.transpose() * V[i].bottomRows(nl);
+    r -= samples[i].B_active.transpose() * u[i].tail(nl);
+  }
+
+  SgdGradient gradient;
+  gradient.dtheta = S.colPivHouseholderQr().solve(r);
+  for (int i = 0; i < n_samples; i++) {
+    const int nz = samples[i].A_active.cols();
+    const VectorXd x = u[i] + V[i] * gradient.dtheta;
+    gradient.dz.push_back(x.head(nz));
+    gradient.lambda.push_back(x.tail(x.size() - nz));
+    // Perturbing the stationarity and active constraints gives
+    // K_i [dz_i; dlambda_i] = [0; -B_i dtheta], i.e. V_i dtheta
+    gradient.dz_dtheta.push_back(V[i].topRows(nz));
+  }
+  return gradient;
+}
+
+VectorXd PredictSgdSolution(const SgdSample& sample, const MatrixXd& dz_dtheta,
+                            const VectorXd& dtheta) {
+  const VectorXd z = sample.z + dz_dtheta * dtheta;
+  return z.cwiseMax(sample.z_lb).cwiseMin(sample.z_ub);
+}
+
+SgdGradient SolveSgdGradientSparseQR(const vector<SgdSample>& samples) {
+  DRAKE_DEMAND(!samples.empty());
+  const int nt = samples[0].B_active.cols();
+  int nz = 0, nl = 0;
+  for (const auto& sample : samples) {
+    nz += sample.A_active.cols();
+    nl += sample.A_active.rows();
+  }
+
+  // Variables ordered as [dz_0; ...; dz_n; dtheta; lambda_0; ...; lambda_n]
+  std::vector<Eigen::Triplet<double>> triplets;
+  VectorXd b = VectorXd::Zero(nz + nt + nl);
+  int nz_start = 0;
+  int nl_start = 0;
+  for (const auto& sample : samples) {
+    const int nz_i = sample.A_active.cols();
+    const int nl_i = sample.A_active.rows();
+    for (int i = 0; i < nz_i; i++) {
+      for (int j = 0; j < nz_i; j++) {
+        triplets.emplace_back(nz_start + i, nz_start + j, sample.H(i, j));
+      }
+    }
+    for (int i = 0; i < nl_i; i++) {
+      const int i_ind = nz + nt + nl_start + i;
+      for (int j = 0; j < nz_i; j++) {
+        triplets.emplace_back(i_ind, nz_start + j, sample.A_active(i, j));
+        triplets.emplace_back(nz_start + j, i_ind, sample.A_active(i, j));
+      }
+      for (int j = 0; j < nt; j++) {
+        triplets.emplace_back(i_ind, nz + j, sample.B_active(i, j));
+        triplets.emplace_back(nz + j, i_ind, sample.B_active(i, j));
+      }
+    }
+    b.segment(nz_start, nz_i) = -sample.w;
+    nz_start += nz_i;
+    nl_start += nl_i;
+  }
+
+  Eigen::SparseMatrix<double> M(nz + nt + nl, nz + nt + nl);
+  M.setFromTriplets(triplets.begin(), triplets.end());
+  Eigen::SparseQR<Eigen::SparseMatrix<double>, Eigen::COLAMDOrdering<int>> qr(
+      M);
+  const VectorXd x = qr.solve(b);
+
+  SgdGradient gradient;
+  gradient.dtheta = x.segment(nz, nt);
+  nz_start = 0;
+  nl_start = 0;
+  for (const auto& sample : samples) {
+    const int nz_i = sample.A_active.cols();
+    const int nl_i = sample.A_active.rows();
+    gradient.dz.push_back(x.segment(nz_start, nz_i));
+    gradient.lambda.push_back(x.segment(nz + nt + nl_start, nl_i));
+    nz_start += nz_i;
+    nl_start += nl_i;
+  }
+  return gradient;
+}
+
+}  // namespace goldilocks_models
+}  // namespace dairlib
@@ -0,0 +1,73 @@
+#pragma once
+
+#include <vector>
+
+#include <Eigen/Dense>
+
+namespace dairlib {
+namespace goldilocks_models {
+
+/// Linearization of the trajectory optimization of one sample of an SGD batch,
+/// at its solution z: cost Hessian H and gradient w in z, and the active
+/// constraints A_active * dz + B_active * dtheta = 0.
+struct SgdSample {
+  Eigen::MatrixXd H;
+  Eigen::VectorXd w;
+  Eigen::MatrixXd A_active;
+  Eigen::MatrixXd B_active;
+
+  Eigen::VectorXd z;
+  /// Bounds of z imposed by the constraints on single variables (e.g. the
+  /// bounding boxes), linearized at z. Infinite where there is none.
+  Eigen::VectorXd z_lb;
+  Eigen::VectorXd z_ub;
+};
+
+/// Builds a sample from the constraint Jacobians A (in z) and B (in theta),
+/// keeping the rows of the constraints y within tol of their bounds lb/ub.
+SgdSample MakeSgdSample(const Eigen::MatrixXd& H, const Eigen::VectorXd& w,
+                        const Eigen::VectorXd& z, const Eigen::MatrixXd& A,
+                        const Eigen::MatrixXd& B, const Eigen::VectorXd& y,
+                        const Eigen::VectorXd& lb, const Eigen::VectorXd& ub,
+                        double tol = 1e-4);
+
+/// Solution of the KKT system of the SGD gradient over a batch
+///   H_i dz_i + A_i' lambda_i = -w_i       for each sample i
+///   sum_i B_i' lambda_i = 0
+///   A_i dz_i + B_i dtheta = 0              for each sample i
+/// The samples are coupled only through the shared dtheta.
+struct SgdGradient {
+  std::vector<Eigen::VectorXd> dz;
+  std::vector<Eigen::VectorXd> lambda;
+  Eigen::VectorXd dtheta;
+  /// First-order sensitivity of the solution z of each sample to theta, with
+  /// the active set held fixed. Only computed by SolveSgdGradient().
+  std::vector<Eigen::MatrixXd> dz_dtheta;
+
+  /// Norm of the residual of the active constraints
+  double ConstraintResidual(const std::vector<SgdSample>& samples) const;
+  /// sum_i w_i' dz_i
+  double Descent(const std::vector<SgdSample>& samples) const;
+  /// sum_i dz_i' H_i dz_i
+  double Curvature(const std::vector<SgdSample>& samples) const;
+};
+
+/// Solves the KKT system by eliminating each sample's (dz_i, lambda_i) with a
+/// dense factorization of its own block K_i = [H_i A_i'; A_i 0], on
+/// num_threads threads, and then solving the small Schur complement system in
+/// dtheta. Time and memory grow linearly with the number of samples.
+SgdGradient SolveSgdGradient(const std::vector<SgdSample>& samples,
+                             int num_threads = 1);
+
+/// Predicts the solution of a sample after a step dtheta of theta, to warm
+/// start its next solve: z + dz_dtheta * dtheta, projected onto [z_lb, z_ub].
+Eigen::VectorXd PredictSgdSolution(const SgdSample& sample,
+                                   const Eigen::MatrixXd& dz_dtheta,
+                                   const Eigen::VectorXd& dtheta);
+
+/// Solves the KKT system assembled as one sparse matrix over all the samples
+/// with SparseQR. Reference for SolveSgdGradient().
+SgdGradient SolveSgdGradientSparseQR(const std::vector<SgdSample>& samples);
+
+}  // namespace goldilocks_models
+}  // namespace dairlib
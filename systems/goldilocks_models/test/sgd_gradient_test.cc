@@ -0,0 +1,147 @@
+#include <cmath>
+
+#include <gtest/gtest.h>
+
+#include "systems/goldilocks_models/sgd_gradient.h"
+
+namespace dairlib {
+namespace goldilocks_models {
+namespace {
+
+using Eigen::MatrixXd;
+using Eigen::VectorXd;
+using std::vector;
+
+// Random batch with positive definite Hessians and fewer active constraints
+// than variables in each sample, so that the KKT system is nonsingular
+vector<SgdSample> MakeBatch(int n_samples, int nt) {
+  std::srand(0);
+  vector<SgdSample> samples;
+  for (int i = 0; i < n_samples; i++) {
+    const int nz = 20 + 3 * i;
+    const int nl = 8 + i;
+    const MatrixXd L = MatrixXd::Random(nz, nz);
+    SgdSample sample;
+    sample.H = L * L.transpose() + MatrixXd::Identity(nz, nz);
+    sample.w = VectorXd::Random(nz);
+    sample.A_active = MatrixXd::Random(nl, nz);
+    sample.B_active = MatrixXd::Random(nl, nt);
+    samples.push_back(sample);
+  }
+  return samples;
+}
+
+void ExpectSameGradient(const SgdGradient& a, const SgdGradient& b,
+                        double tol) {
+  EXPECT_TRUE(a.dtheta.isApprox(b.dtheta, tol));
+  ASSERT_EQ(a.dz.size(), b.dz.size());
+  for (size_t i = 0; i < a.dz.size(); i++) {
+    EXPECT_TRUE(a.dz[i].isApprox(b.dz[i], tol));
+    EXPECT_TRUE(a.lambda[i].isApprox(b.lambda[i], tol));
+  }
+}
+
+TEST(SgdGradientTest, MatchesSparseQR) {
+  const auto samples = MakeBatch(5, 6);
+  const auto reference = SolveSgdGradientSparseQR(samples);
+  const auto gradient = SolveSgdGradient(samples);
+  ExpectSameGradient(gradient, reference, 1e-8);
+
+  EXPECT_LT(gradient.ConstraintResidual(samples), 1e-10);
+  EXPECT_NEAR(gradient.Descent(samples), reference.Descent(samples), 1e-8);
+  EXPECT_NEAR(gradient.Curvature(samples), reference.Curvature(samples),
+              1e-8);
+  // The step descends the cost
+  EXPECT_LT(gradient.Descent(samples), 0);
+}
+
+TEST(SgdGradientTest, Threads) {
+  const auto samples = MakeBatch(7, 4);
+  ExpectSameGradient(SolveSgdGradient(samples, 3), SolveSgdGradient(samples),
+                     1e-12);
+}
+
+TEST(SgdGradientTest, RedundantActiveConstraints) {
+  auto samples = MakeBatch(3, 4);
+  // The same constraint active twice, e.g. with equal bounds
+  auto& sample = samples[1];
+  const int nl = sample.A_active.rows();
+  sample.A_active.conservativeResize(nl + 1, Eigen::NoChange);
+  sample.B_active.conservativeResize(nl + 1, Eigen::NoChange);
+  sample.A_active.row(nl) = sample.A_active.row(0);
+  sample.B_active.row(nl) = sample.B_active.row(0);
+
+  const auto reference = SolveSgdGradientSparseQR(samples);
+  const auto gradient = SolveSgdGradient(samples);
+  // The multipliers of the repeated constraint are not unique
+  EXPECT_TRUE(gradient.dtheta.isApprox(reference.dtheta, 1e-8));
+  for (size_t i = 0; i < samples.size(); i++) {
+    EXPECT_TRUE(gradient.dz[i].isApprox(reference.dz[i], 1e-8));
+  }
+  EXPECT_LT(gradient.ConstraintResidual(samples), 1e-10);
+}
+
+TEST(SgdGradientTest, MakeSgdSample) {
+  MatrixXd A = MatrixXd::Random(5, 3);
+  MatrixXd B = MatrixXd::Random(5, 2);
+  // Last row: bound 0 <= -2 z_1 <= 3 on a single variable
+  A.row(4) << 0, -2, 0;
+  B.row(4).setZero();
+  VectorXd z(3), y(5), lb(5), ub(5);
+  z << 1, -0.5, 2;
+  y << 0, 1, 0.5, -1, 1;
+  lb << 0, 0, 0, -1, 0;
+  ub << 1, 1, 1, -1, 3;
+  const auto sample = MakeSgdSample(MatrixXd::Identity(3, 3),
+                                    VectorXd::Ones(3), z, A, B, y, lb, ub);
+  ASSERT_EQ(sample.A_active.rows(), 3);
+  EXPECT_EQ(sample.A_active.row(0), A.row(0));
+  EXPECT_EQ(sample.A_active.row(1), A.row(1));
+  EXPECT_EQ(sample.A_active.row(2), A.row(3));
+  EXPECT_EQ(sample.B_active.row(2), B.row(3));
+
+  EXPECT_DOUBLE_EQ(sample.z_lb(1), -1.5);
+  EXPECT_DOUBLE_EQ(sample.z_ub(1), 0);
+  EXPECT_TRUE(std::isinf(sample.z_lb(0)) && std::isinf(sample.z_ub(2)));
+
+  // The prediction is projected onto the bounds
+  MatrixXd dz_dtheta = MatrixXd::Zero(3, 2);
+  dz_dtheta(1, 0) = 1;
+  dz_dtheta(2, 0) = 1;
+  const VectorXd prediction =
+      PredictSgdSolution(sample, dz_dtheta, Eigen::Vector2d(1, 0));
+  EXPECT_TRUE(prediction.isApprox(Eigen::Vector3d(1, 0, 3)));
+}
+
+TEST(SgdGradientTest, Sensitivity) {
+  const auto samples = MakeBatch(3, 4);
+  const auto gradient = SolveSgdGradient(samples);
+  ASSERT_EQ(gradient.dz_dtheta.size(), samples.size());
+
+  // The samples are quadratic programs with linear constraints, whose
+  // solution moves exactly with the sensitivity: with the cost gradient at
+  // the solution w = -A' lambda, a step dtheta moves it by the solution of
+  // [H A'; A 0] [dz; dlambda] = [0; -B dtheta]
+  const VectorXd dtheta = VectorXd::Random(4);
+  for (size_t i = 0; i < samples.size(); i++) {
+    const auto& sample = samples[i];
+    const int nz = sample.A_active.cols();
+    const int nl = sample.A_active.rows();
+    MatrixXd K = MatrixXd::Zero(nz + nl, nz + nl);
+    K << sample.H, sample.A_active.transpose(), sample.A_active,
+        MatrixXd::Zero(nl, nl);
+    VectorXd rhs(nz + nl);
+    rhs << VectorXd::Zero(nz), -sample.B_active * dtheta;
+    const VectorXd dz = K.lu().solve(rhs).head(nz);
+    EXPECT_TRUE((gradient.dz_dtheta[i] * dtheta).isApprox(dz, 1e-8));
+  }
+}
+
+}  // namespace
+}  // namespace goldilocks_models
+}  // namespace dairlib
+
+int main(int argc, char** argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
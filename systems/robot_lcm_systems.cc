@@ -1,5 +1,6 @@
 #include "robot_lcm_systems.h"
 #include "multibody/multibody_utils.h"
+#include "systems/framework/system_tracer.h"
 
 
 namespace dairlib {
@@ -52,6 +53,7 @@ RobotOutputReceiver::RobotOutputReceiver(
 
 void RobotOutputReceiver::CopyOutput(
     const Context<double>& context, OutputVector<double>* output) const {
+  TraceScope trace("calc", this->get_name(), "CopyOutput");
   const drake::AbstractValue* input =
       this->EvalAbstractInput(context, 0);
   DRAKE_ASSERT(input != nullptr);
@@ -170,6 +172,7 @@ RobotOutputSender::RobotOutputSender(
 /// Populate a state message with all states
 void RobotOutputSender::Output(const Context<double>& context,
                                dairlib::lcmt_robot_output* state_msg) const {
+  TraceScope trace("calc", this->get_name(), "Output");
   const auto state = this->EvalVectorInput(context, state_input_port_);
 
   // using the time from the context
@@ -228,6 +231,7 @@ RobotInputReceiver::RobotInputReceiver(
 
 void RobotInputReceiver::CopyInputOut(const Context<double>& context,
                                       TimestampedVector<double>* output) const {
+  TraceScope trace("calc", this->get_name(), "CopyInputOut");
   const drake::AbstractValue* input =
       this->EvalAbstractInput(context, 0);
   DRAKE_ASSERT(input != nullptr);
@@ -274,6 +278,7 @@ for (JointActuatorIndex i(0); i < plant.num_actuators(); ++i) {
 
 void RobotCommandSender::OutputCommand(const Context<double>& context,
     dairlib::lcmt_robot_input* input_msg) const {
+  TraceScope trace("calc", this->get_name(), "OutputCommand");
   const TimestampedVector<double>* command = (TimestampedVector<double>*)
       this->EvalVectorInput(context, 0);
 
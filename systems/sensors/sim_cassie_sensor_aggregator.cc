@@ -22,6 +22,22 @@ SimCassieSensorAggregator::SimCassieSensorAggregator(
   velocityIndexMap_ = multibody::makeNameToVelocitiesMap(tree);
   actuatorIndexMap_ = multibody::makeNameToActuatorsMap(tree);
 
+  DeclarePorts();
+}
+
+SimCassieSensorAggregator::SimCassieSensorAggregator(
+    const drake::multibody::MultibodyPlant<double>& plant) {
+  num_positions_ = plant.num_positions();
+  num_velocities_ = plant.num_velocities();
+
+  positionIndexMap_ = multibody::makeNameToPositionsMap(plant);
+  velocityIndexMap_ = multibody::makeNameToVelocitiesMap(plant);
+  actuatorIndexMap_ = multibody::makeNameToActuatorsMap(plant);
+
+  DeclarePorts();
+}
+
+void SimCassieSensorAggregator::DeclarePorts() {
   input_input_port_ = this->DeclareVectorInputPort(
                         BasicVector<double>(10)).get_index();
   state_input_port_ = this->DeclareVectorInputPort(
@@ -29,6 +29,9 @@ class SimCassieSensorAggregator : public drake::systems::LeafSystem<double> {
  public:
   explicit SimCassieSensorAggregator(const RigidBodyTree<double>& tree);
 
+  explicit SimCassieSensorAggregator(
+      const drake::multibody::MultibodyPlant<double>& plant);
+
   const drake::systems::InputPort<double>& get_input_port_input() const {
     return this->get_input_port(input_input_port_);
   }
@@ -43,6 +46,8 @@ class SimCassieSensorAggregator : public drake::systems::LeafSystem<double> {
   }
 
  private:
+  void DeclarePorts();
+
   void Aggregate(const drake::systems::Context<double>& context,
                  dairlib::lcmt_cassie_out* cassie_out_msg) const;
 
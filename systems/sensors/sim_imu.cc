@@ -0,0 +1,78 @@
+#include "systems/sensors/sim_imu.h"
+
+namespace dairlib {
+namespace systems {
+
+using drake::multibody::MultibodyPlant;
+using drake::systems::BasicVector;
+using drake::systems::Context;
+using drake::systems::DiscreteValues;
+using drake::systems::EventStatus;
+using Eigen::Vector3d;
+using Eigen::VectorXd;
+
+SimImu::SimImu(const MultibodyPlant<double>& plant,
+               const std::string& body_name, const Vector3d& p_BS,
+               double period)
+    : plant_(plant),
+      body_(plant.GetBodyByName(body_name)),
+      p_BS_(p_BS),
+      period_(period),
+      gravity_(0, 0, -9.81) {
+  state_port_ = this->DeclareVectorInputPort(
+                        BasicVector<double>(plant.num_positions() +
+                                            plant.num_velocities()))
+                    .get_index();
+  acce_port_ = this->DeclareVectorOutputPort(BasicVector<double>(3),
+                                             &SimImu::CalcAcceleration)
+                   .get_index();
+  gyro_port_ = this->DeclareVectorOutputPort(BasicVector<double>(3),
+                                             &SimImu::CalcAngularVelocity)
+                   .get_index();
+
+  prev_velocity_idx_ = this->DeclareDiscreteState(VectorXd::Zero(3));
+  // The accelerometer of a robot at rest reads +g along the vertical
+  acceleration_idx_ = this->DeclareDiscreteState(-gravity_);
+  this->DeclarePeriodicDiscreteUpdateEvent(period_, 0,
+                                           &SimImu::DiscreteVariableUpdate);
+
+  context_ = plant_.CreateDefaultContext();
+}
+
+EventStatus SimImu::DiscreteVariableUpdate(
+    const Context<double>& context,
+    DiscreteValues<double>* discrete_state) const {
+  const VectorXd& x = this->EvalVectorInput(context, state_port_)->get_value();
+  plant_.SetPositionsAndVelocities(context_.get(), x);
+
+  const auto& X_WB = plant_.EvalBodyPoseInWorld(*context_, body_);
+  const auto& V_WB = plant_.EvalBodySpatialVelocityInWorld(*context_, body_);
+  Vector3d v_WS = V_WB.Shift(X_WB.rotation() * p_BS_).translational();
+
+  auto prev_velocity = discrete_state->get_mutable_vector(prev_velocity_idx_)
+                           .get_mutable_value();
+  Vector3d a_WS = (v_WS - prev_velocity) / period_;
+  discrete_state->get_mutable_vector(acceleration_idx_).SetFromVector(
+      X_WB.rotation().inverse() * (a_WS - gravity_));
+  prev_velocity = v_WS;
+  return EventStatus::Succeeded();
+}
+
+void SimImu::CalcAcceleration(const Context<double>& context,
+                              BasicVector<double>* output) const {
+  output->SetFromVector(
+      context.get_discrete_state(acceleration_idx_).get_value());
+}
+
+void SimImu::CalcAngularVelocity(const Context<double>& context,
+                                 BasicVector<double>* output) const {
+  const VectorXd& x = this->EvalVectorInput(context, state_port_)->get_value();
+  plant_.SetPositionsAndVelocities(context_.get(), x);
+
+  const auto& X_WB = plant_.EvalBodyPoseInWorld(*context_, body_);
+  const auto& V_WB = plant_.EvalBodySpatialVelocityInWorld(*context_, body_);
+  output->SetFromVector(X_WB.rotation().inverse() * V_WB.rotational());
+}
+
+}  // namespace systems
+}  // namespace dairlib
@@ -0,0 +1,73 @@
+#pragma once
+
+#include <memory>
+#include <string>
+
+#include "drake/multibody/plant/multibody_plant.h"
+#include "drake/systems/framework/leaf_system.h"
+
+namespace dairlib {
+namespace systems {
+
+/// SimImu emulates an IMU rigidly attached to a body of a MultibodyPlant. It
+/// is the MultibodyPlant counterpart of the Accelerometer and Gyroscope
+/// blocks used with RigidBodyPlant (see addImuAndAggregatorToSimulation).
+///
+/// Both outputs are expressed in the body frame:
+///  - the gyroscope measures the angular velocity of the body,
+///  - the accelerometer measures the proper acceleration (acceleration minus
+///    gravity) of the sensor point.
+/// The acceleration is a finite difference of the velocity of the sensor
+/// point over one sample period, so that it only depends on the plant state.
+/// It is updated every `period` seconds and held in between.
+///
+/// Constructor:
+///  @param plant, MultibodyPlant of the robot
+///  @param body_name, name of the body the IMU is attached to
+///  @param p_BS, position of the sensor in the body frame
+///  @param period, sample period of the accelerometer
+class SimImu : public drake::systems::LeafSystem<double> {
+ public:
+  SimImu(const drake::multibody::MultibodyPlant<double>& plant,
+         const std::string& body_name, const Eigen::Vector3d& p_BS,
+         double period);
+
+  const drake::systems::InputPort<double>& get_input_port_state() const {
+    return this->get_input_port(state_port_);
+  }
+  const drake::systems::OutputPort<double>& get_output_port_acce() const {
+    return this->get_output_port(acce_port_);
+  }
+  const drake::systems::OutputPort<double>& get_output_port_gyro() const {
+    return this->get_output_port(gyro_port_);
+  }
+
+ private:
+  drake::systems::EventStatus DiscreteVariableUpdate(
+      const drake::systems::Context<double>& context,
+      drake::systems::DiscreteValues<double>* discrete_state) const;
+
+  void CalcAcceleration(const drake::systems::Context<double>& context,
+                        drake::systems::BasicVector<double>* output) const;
+  void CalcAngularVelocity(const drake::systems::Context<double>& context,
+                           drake::systems::BasicVector<double>* output) const;
+
+  int state_port_;
+  int acce_port_;
+  int gyro_port_;
+
+  // Discrete state: the velocity of the sensor point in the world frame at
+  // the last sample, and the measured acceleration
+  int prev_velocity_idx_;
+  int acceleration_idx_;
+
+  const drake::multibody::MultibodyPlant<double>& plant_;
+  const drake::multibody::Body<double>& body_;
+  const Eigen::Vector3d p_BS_;
+  const double period_;
+  const Eigen::Vector3d gravity_;
+  std::unique_ptr<drake::systems::Context<double>> context_;
+};
+
+}  // namespace systems
+}  // namespace dairlib
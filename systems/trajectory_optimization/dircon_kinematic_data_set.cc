@@ -16,6 +16,15 @@ using drake::multibody::MultibodyPlant;
 using drake::systems::Context;
 using drake::math::DiscardGradient;
 
+namespace {
+
+// Newton's method of completeState: tolerance on the loop closures, and
+// iteration limit
+constexpr double kClosureTolerance = 1e-12;
+constexpr int kClosureMaxIterations = 20;
+
+}  // namespace
+
 template <typename T>
 DirconKinematicDataSet<T>::DirconKinematicDataSet(
     const MultibodyPlant<T>& plant,
@@ -59,6 +68,105 @@ DirconKinematicDataSet<T>::DirconKinematicDataSet(
   xdot_ = VectorX<T>(num_positions_ + num_velocities_);
   M_ = MatrixX<T>(num_velocities_, num_velocities_);
   right_hand_side_ = VectorX<T>(num_velocities_);
+  J_closure_ = MatrixX<T>(0, num_velocities_);
+}
+
+template <typename T>
+void DirconKinematicDataSet<T>::setLoopClosures(
+    vector<DirconKinematicData<T>*>* closures, vector<int> dependent_positions,
+    vector<int> dependent_velocities,
+    const Eigen::VectorXd& dependent_positions_guess) {
+  int n = 0;
+  for (auto closure : *closures) {
+    n += closure->getLength();
+  }
+  DRAKE_DEMAND(static_cast<int>(dependent_positions.size()) == n);
+  DRAKE_DEMAND(static_cast<int>(dependent_velocities.size()) == n);
+  DRAKE_DEMAND(dependent_positions_guess.size() == n);
+
+  closures_ = closures;
+  dependent_positions_ = dependent_positions;
+  dependent_velocities_ = dependent_velocities;
+  dependent_positions_guess_ = dependent_positions_guess;
+  closure_context_ = plant_.CreateDefaultContext();
+  c_closure_ = VectorX<T>(n);
+  J_closure_ = MatrixX<T>(n, num_velocities_);
+  Jdotv_closure_ = VectorX<T>(n);
+}
+
+template <typename T>
+void DirconKinematicDataSet<T>::updateLoopClosures(const Context<T>& context) {
+  int index = 0;
+  for (auto closure : *closures_) {
+    closure->updateConstraint(context);
+    const int n = closure->getLength();
+    c_closure_.segment(index, n) = closure->getC();
+    J_closure_.block(index, 0, n, num_velocities_) = closure->getJ();
+    Jdotv_closure_.segment(index, n) = closure->getJdotv();
+    index += n;
+  }
+}
+
+template <typename T>
+VectorX<T> DirconKinematicDataSet<T>::completeState(const VectorX<T>& x) {
+  if (!hasLoopClosures()) {
+    return x;
+  }
+  const int n = dependent_positions_.size();
+  MatrixX<T> J_dependent(n, n);
+  // Newton step of the dependent positions of q. The dependent joints are
+  // revolute or prismatic, so their columns of J are the derivatives of the
+  // closures with respect to their positions.
+  auto newton_step = [&](VectorX<T>* q) {
+    plant_.SetPositions(closure_context_.get(), *q);
+    updateLoopClosures(*closure_context_);
+    for (int j = 0; j < n; j++) {
+      J_dependent.col(j) = J_closure_.col(dependent_velocities_[j]);
+    }
+    const VectorX<T> dq = J_dependent.lu().solve(c_closure_);
+    for (int j = 0; j < n; j++) {
+      (*q)(dependent_positions_[j]) -= dq(j);
+    }
+  };
+
+  // Values of the dependent positions, from the guess
+  VectorX<T> q_value =
+      VectorX<T>(DiscardGradient(x.head(num_positions_)).template cast<T>());
+  for (int j = 0; j < n; j++) {
+    q_value(dependent_positions_[j]) = dependent_positions_guess_(j);
+  }
+  for (int i = 0; i < kClosureMaxIterations; i++) {
+    newton_step(&q_value);
+    if (DiscardGradient(c_closure_).template lpNorm<Eigen::Infinity>() <
+        kClosureTolerance) {
+      break;
+    }
+  }
+
+  // A last step with the independent positions of x, from the converged
+  // values, gives the gradients -J_dependent^{-1} dc/dq_independent of the
+  // dependent positions
+  VectorX<T> x_complete = x;
+  VectorX<T> q = x.head(num_positions_);
+  for (int j = 0; j < n; j++) {
+    q(dependent_positions_[j]) = q_value(dependent_positions_[j]);
+  }
+  newton_step(&q);
+  x_complete.head(num_positions_) = q;
+
+  // Dependent velocities, from cdot = J*v = 0
+  plant_.SetPositions(closure_context_.get(), q);
+  updateLoopClosures(*closure_context_);
+  for (int j = 0; j < n; j++) {
+    J_dependent.col(j) = J_closure_.col(dependent_velocities_[j]);
+  }
+  VectorX<T> v = x.tail(num_velocities_);
+  const VectorX<T> dv = J_dependent.lu().solve(J_closure_ * v);
+  for (int j = 0; j < n; j++) {
+    v(dependent_velocities_[j]) -= dv(j);
+  }
+  x_complete.tail(num_velocities_) = v;
+  return x_complete;
 }
 
 
@@ -84,6 +192,7 @@ void DirconKinematicDataSet<T>::updateData(const Context<T>& context,
     cddot_ = data.cddot_;
     vdot_ = data.vdot_;
     xdot_ = data.xdot_;
+    J_closure_ = data.J_closure_;
   } else {
     int index = 0;
     int n;
@@ -111,7 +220,20 @@ void DirconKinematicDataSet<T>::updateData(const Context<T>& context,
         plant_.CalcGravityGeneralizedForces(context) +
         getJWithoutSkipping().transpose() * forces;
 
-    vdot_ = M_.llt().solve(right_hand_side_);
+    const auto M_llt = M_.llt();
+    if (hasLoopClosures()) {
+      // Loop closure forces, for which the closure accelerations
+      // J*vdot + Jdotv are zero
+      updateLoopClosures(context);
+      const MatrixX<T> M_inv_Jt = M_llt.solve(J_closure_.transpose());
+      const VectorX<T> closure_forces =
+          -(J_closure_ * M_inv_Jt)
+               .llt()
+               .solve(J_closure_ * M_llt.solve(right_hand_side_) +
+                      Jdotv_closure_);
+      right_hand_side_ += J_closure_.transpose() * closure_forces;
+    }
+    vdot_ = M_llt.solve(right_hand_side_);
 
     cddot_ = Jdotv_ + getJWithoutSkipping()*vdot_;
 
@@ -120,7 +242,7 @@ void DirconKinematicDataSet<T>::updateData(const Context<T>& context,
     xdot_ << q_dot, vdot_;
 
     CacheData data{c_, cdot_, getJWithoutSkipping(),
-                   Jdotv_, cddot_, vdot_, xdot_};
+                   Jdotv_, cddot_, vdot_, xdot_, J_closure_};
 
     cache_.AddData(key, data);
   }
@@ -181,6 +303,11 @@ VectorX<T> DirconKinematicDataSet<T>::getXDot() {
   return xdot_;
 }
 
+template <typename T>
+MatrixX<T> DirconKinematicDataSet<T>::getLoopClosureJ() {
+  return J_closure_;
+}
+
 template <typename T>
 MatrixX<double> DirconKinematicDataSet<T>::getConstraintMap() {
   return constraint_map_;
@@ -16,6 +16,42 @@ class DirconKinematicDataSet {
       std::vector<DirconKinematicData<T>*>* constraints,
       std::vector<int> skip_constraint_inds = std::vector<int>());
 
+  /// Eliminates holonomic loop closures (e.g. the Cassie four-bars) by
+  /// minimal coordinates, in place of adding them to the constraint set:
+  /// each closure determines a dependent joint, whose position and velocity
+  /// are computed from the other (independent) coordinates by completeState,
+  /// and whose constraint force is solved for in updateData, so that the
+  /// closures have no force variables and no kinematic constraints.
+  /// @param closures the loop closure constraints
+  /// @param dependent_positions position indices of the dependent joints,
+  ///   which must be revolute or prismatic joints (one per closure)
+  /// @param dependent_velocities velocity indices of the dependent joints
+  /// @param dependent_positions_guess start of the inner solve of the
+  ///   dependent positions, which selects the branch of the solution
+  void setLoopClosures(std::vector<DirconKinematicData<T>*>* closures,
+                       std::vector<int> dependent_positions,
+                       std::vector<int> dependent_velocities,
+                       const Eigen::VectorXd& dependent_positions_guess);
+
+  bool hasLoopClosures() const { return closures_ != nullptr; }
+  const std::vector<int>& getDependentPositions() const {
+    return dependent_positions_;
+  }
+  const std::vector<int>& getDependentVelocities() const {
+    return dependent_velocities_;
+  }
+  const Eigen::VectorXd& getDependentPositionsGuess() const {
+    return dependent_positions_guess_;
+  }
+
+  /// Returns the state x with the dependent positions and velocities computed
+  /// from the independent ones (x itself without loop closures). The
+  /// positions are found by Newton's method from the guess, and the gradients
+  /// (if T is AutoDiffXd) follow from the implicit function theorem.
+  drake::VectorX<T> completeState(const drake::VectorX<T>& x);
+
+  /// The state of the context must be complete (see completeState) if there
+  /// are loop closures
   void updateData(const drake::systems::Context<T>& context,
                   const drake::VectorX<T>& forces);
 
@@ -27,6 +63,8 @@ class DirconKinematicDataSet {
   drake::VectorX<T> getCDDot();
   drake::VectorX<T> getVDot();
   drake::VectorX<T> getXDot();
+  /// Jacobian of the loop closures (empty without loop closures)
+  drake::MatrixX<T> getLoopClosureJ();
 
   drake::MatrixX<double> getConstraintMap();
 
@@ -53,6 +91,7 @@ class DirconKinematicDataSet {
     drake::VectorX<T> cddot_;
     drake::VectorX<T> vdot_;
     drake::VectorX<T> xdot_;
+    drake::MatrixX<T> J_closure_;
   };
 
   // Hashes a CacheKey by bit shifting and combining hashes of the double
@@ -161,6 +200,17 @@ class DirconKinematicDataSet {
 
   Eigen::MatrixXd constraint_map_;
 
+  // Loop closures eliminated by minimal coordinates (see setLoopClosures)
+  void updateLoopClosures(const drake::systems::Context<T>& context);
+  std::vector<DirconKinematicData<T>*>* closures_ = nullptr;
+  std::vector<int> dependent_positions_;
+  std::vector<int> dependent_velocities_;
+  Eigen::VectorXd dependent_positions_guess_;
+  std::unique_ptr<drake::systems::Context<T>> closure_context_;
+  drake::VectorX<T> c_closure_;
+  drake::MatrixX<T> J_closure_;
+  drake::VectorX<T> Jdotv_closure_;
+
   Cache cache_;
 };
 }  // namespace dairlib
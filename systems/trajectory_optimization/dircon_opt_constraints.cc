@@ -102,8 +102,10 @@ void DirconDynamicConstraint<T>::EvaluateConstraint(
   // x0, x1 state vector at time steps k, k+1
   // u0, u1 input vector at time steps k, k+1
   const T h = x(0);
-  const VectorX<T> x0 = x.segment(1, num_states_);
-  const VectorX<T> x1 = x.segment(1 + num_states_, num_states_);
+  const VectorX<T> x0 =
+      constraints_->completeState(x.segment(1, num_states_));
+  const VectorX<T> x1 =
+      constraints_->completeState(x.segment(1 + num_states_, num_states_));
   const VectorX<T> u0 = x.segment(1 + (2 * num_states_), num_inputs_);
   const VectorX<T> u1 =
       x.segment(1 + (2 * num_states_) + num_inputs_, num_inputs_);
@@ -131,7 +133,8 @@ void DirconDynamicConstraint<T>::EvaluateConstraint(
   const VectorX<T> xdot1 = constraints_->getXDot();
 
   // Cubic interpolation to get xcol and xdotcol.
-  const VectorX<T> xcol = 0.5 * (x0 + x1) + h / 8 * (xdot0 - xdot1);
+  const VectorX<T> xcol = constraints_->completeState(
+      0.5 * (x0 + x1) + h / 8 * (xdot0 - xdot1));
   const VectorX<T> xdotcol = -1.5 * (x0 - x1) / h - .25 * (xdot0 + xdot1);
   const VectorX<T> ucol = 0.5 * (u0 + u1);
 
@@ -150,6 +153,15 @@ void DirconDynamicConstraint<T>::EvaluateConstraint(
   }
 
   *y = xdotcol - g;
+
+  // Dependent coordinates of loop closures are not integrated, but computed
+  // from the others
+  for (int i : constraints_->getDependentPositions()) {
+    (*y)(i) = 0;
+  }
+  for (int i : constraints_->getDependentVelocities()) {
+    (*y)(num_positions_ + i) = 0;
+  }
 }
 
 template <typename T>
@@ -290,7 +302,8 @@ void DirconKinematicConstraint<T>::EvaluateConstraint(
   // h - current time (knot) value
   // x0, x1 state vector at time steps k, k+1
   // u0, u1 input vector at time steps k, k+1
-  const VectorX<T> state = x.segment(0, num_states_);
+  const VectorX<T> state =
+      constraints_->completeState(x.segment(0, num_states_));
   const VectorX<T> input = x.segment(num_states_, num_inputs_);
   const VectorX<T> force = x.segment(num_states_ + num_inputs_,
                                      num_kinematic_constraints_wo_skipping_);
@@ -355,11 +368,15 @@ void DirconImpactConstraint<T>::EvaluateConstraint(
   // x0, state vector at time k^-
   // impulse, impulsive force at impact
   // v1, post-impact velocity at time k^+
-  const VectorX<T> x0 = x.segment(0, num_states_);
+  const VectorX<T> x0 =
+      constraints_->completeState(x.segment(0, num_states_));
   const VectorX<T> impulse =
       x.segment(num_states_, num_kinematic_constraints_wo_skipping_);
-  const VectorX<T> v1 = x.segment(
-      num_states_ + num_kinematic_constraints_wo_skipping_, num_velocities_);
+  VectorX<T> x1(num_states_);
+  x1 << x0.head(num_positions_),
+      x.segment(num_states_ + num_kinematic_constraints_wo_skipping_,
+                num_velocities_);
+  const VectorX<T> v1 = constraints_->completeState(x1).tail(num_velocities_);
 
   const VectorX<T> v0 = x0.tail(num_velocities_);
 
@@ -376,6 +393,20 @@ void DirconImpactConstraint<T>::EvaluateConstraint(
 
   *y =
       M * (v1 - v0) - constraints_->getJWithoutSkipping().transpose() * impulse;
+
+  if (constraints_->hasLoopClosures()) {
+    // Loop closure impulse, which balances the rows of the dependent
+    // velocities (v1 satisfies the closures). The remaining rows vanish
+    // together with those of the independent velocities.
+    const MatrixX<T> J = constraints_->getLoopClosureJ();
+    const auto M_llt = M.llt();
+    const MatrixX<T> M_inv_Jt = M_llt.solve(J.transpose());
+    *y -= J.transpose() *
+          (J * M_inv_Jt).llt().solve(M_inv_Jt.transpose() * (*y));
+    for (int i : constraints_->getDependentVelocities()) {
+      (*y)(i) = 0;
+    }
+  }
 }
 
 template <typename T>
@@ -450,6 +481,39 @@ void PointVelocityConstraint<T>::EvaluateConstraint(
   *y = dir_ * J * x.tail(plant_.num_velocities());
 };
 
+template <typename T>
+CompletedStateConstraint<T>::CompletedStateConstraint(
+    const MultibodyPlant<T>& plant, DirconKinematicDataSet<T>* constraints,
+    const std::vector<int>& state_indices,
+    std::shared_ptr<Constraint> constraint, const std::string& description)
+    : solvers::NonlinearConstraint<T>(
+          constraint->num_constraints(),
+          plant.num_positions() + plant.num_velocities() +
+              constraint->num_vars() - state_indices.size(),
+          constraint->lower_bound(), constraint->upper_bound(),
+          description.empty() ? "completed_" + constraint->get_description()
+                              : description),
+      constraints_(constraints),
+      num_states_(plant.num_positions() + plant.num_velocities()),
+      state_indices_(state_indices),
+      constraint_(constraint) {
+  DRAKE_DEMAND(constraint->num_vars() >=
+               static_cast<int>(state_indices.size()));
+}
+
+template <typename T>
+void CompletedStateConstraint<T>::EvaluateConstraint(
+    const Eigen::Ref<const drake::VectorX<T>>& x, drake::VectorX<T>* y) const {
+  const VectorX<T> state = constraints_->completeState(x.head(num_states_));
+  const int num_states = state_indices_.size();
+  VectorX<T> input(constraint_->num_vars());
+  for (int i = 0; i < num_states; i++) {
+    input(i) = state(state_indices_[i]);
+  }
+  input.tail(input.size() - num_states) = x.tail(input.size() - num_states);
+  constraint_->Eval(input, y);
+}
+
 // Explicitly instantiates on the most common scalar types.
 template class QuaternionNormConstraint<double>;
 template class QuaternionNormConstraint<AutoDiffXd>;
@@ -463,6 +527,8 @@ template class PointPositionConstraint<double>;
 template class PointPositionConstraint<AutoDiffXd>;
 template class PointVelocityConstraint<double>;
 template class PointVelocityConstraint<AutoDiffXd>;
+template class CompletedStateConstraint<double>;
+template class CompletedStateConstraint<AutoDiffXd>;
 
 }  // namespace trajectory_optimization
 }  // namespace systems
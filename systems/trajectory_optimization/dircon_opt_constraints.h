@@ -262,6 +262,38 @@ class PointVelocityConstraint : public solvers::NonlinearConstraint<T> {
   std::unique_ptr<drake::systems::Context<T>> context_;
 };
 
+/// Evaluates a constraint on the complete state (see
+/// DirconKinematicDataSet::completeState) of a mode whose loop closures are
+/// eliminated by minimal coordinates. The dependent coordinates of the state
+/// variables are fixed, so constraints on them (e.g. joint limits, or
+/// positions of points beyond a four-bar) have to see the values computed
+/// from the independent coordinates instead.
+/// The variables are the state x = [q; v], followed by
+/// constraint->num_vars() - state_indices.size() other variables z, and the
+/// constraint is evaluated (with its bounds and scaling) on
+/// [completeState(x)(state_indices); z]. Without loop closures, it is the
+/// constraint on [x(state_indices); z].
+template <typename T>
+class CompletedStateConstraint : public solvers::NonlinearConstraint<T> {
+ public:
+  CompletedStateConstraint(
+      const drake::multibody::MultibodyPlant<T>& plant,
+      DirconKinematicDataSet<T>* constraints,
+      const std::vector<int>& state_indices,
+      std::shared_ptr<drake::solvers::Constraint> constraint,
+      const std::string& description = "");
+  ~CompletedStateConstraint() override = default;
+
+  void EvaluateConstraint(const Eigen::Ref<const drake::VectorX<T>>& x,
+                          drake::VectorX<T>* y) const override;
+
+ private:
+  DirconKinematicDataSet<T>* constraints_;
+  const int num_states_;
+  const std::vector<int> state_indices_;
+  std::shared_ptr<drake::solvers::Constraint> constraint_;
+};
+
 }  // namespace trajectory_optimization
 }  // namespace systems
 }  // namespace dairlib
@@ -203,6 +203,28 @@ HybridDircon<T>::HybridDircon(const MultibodyPlant<T>& plant,
            offset_vars(i)});
     }
 
+    // Fix the dependent coordinates of the loop closures, which are not
+    // decision variables but computed from the others by the constraints
+    if (constraints_[i]->hasLoopClosures()) {
+      const auto& dependent_positions =
+          constraints_[i]->getDependentPositions();
+      const auto& dependent_velocities =
+          constraints_[i]->getDependentVelocities();
+      for (int j = 0; j < mode_lengths_[i]; j++) {
+        auto x_j = state_vars_by_mode(i, j);
+        for (unsigned int k = 0; k < dependent_positions.size(); k++) {
+          const double q_k = constraints_[i]->getDependentPositionsGuess()(k);
+          AddBoundingBoxConstraint(q_k, q_k, x_j(dependent_positions[k]));
+          SetInitialGuess(x_j(dependent_positions[k]), q_k);
+        }
+        for (int v_k : dependent_velocities) {
+          const int index = plant.num_positions() + v_k;
+          AddBoundingBoxConstraint(0, 0, x_j(index));
+          SetInitialGuess(x_j(index), 0);
+        }
+      }
+    }
+
     // Add constraints on force
     for (int l = 0; l < mode_lengths_[i]; l++) {
       int start_index = l * num_kinematic_constraints_wo_skipping(i);
@@ -271,6 +293,40 @@ HybridDircon<T>::v_post_impact_vars_by_mode(int mode) const {
                                      plant_.num_velocities());
 }
 
+template <typename T>
+vector<int> HybridDircon<T>::GetDecisionVariableStages() const {
+  vector<int> stages(num_vars(), -1);
+  auto set_stage = [&](const VectorXDecisionVariable& vars, int stage) {
+    for (int i = 0; i < vars.size(); i++) {
+      stages[FindDecisionVariableIndex(vars(i))] = stage;
+    }
+  };
+  for (int k = 0; k < N(); k++) {
+    set_stage(x_vars().segment(k * num_states(), num_states()), k);
+    set_stage(u_vars().segment(k * num_inputs(), num_inputs()), k);
+    if (k < N() - 1) set_stage(h_vars().segment(k, 1), k);
+  }
+  for (int i = 0; i < num_modes_; i++) {
+    const int n_l = num_kinematic_constraints_wo_skipping_[i];
+    for (int j = 0; j < mode_lengths_[i]; j++) {
+      const int k = mode_start_[i] + j;
+      set_stage(force_vars_[i].segment(j * n_l, n_l), k);
+      if (j < mode_lengths_[i] - 1) {
+        set_stage(collocation_force_vars_[i].segment(j * n_l, n_l), k);
+        set_stage(collocation_slack_vars_[i].segment(j * n_l, n_l), k);
+        if (quaternion_slack_vars_[i].size() > 0) {
+          set_stage(quaternion_slack_vars_[i].segment(j, 1), k);
+        }
+      }
+    }
+    if (i > 0) {
+      set_stage(impulse_vars_[i - 1], mode_start_[i]);
+      set_stage(v_post_impact_vars_by_mode(i - 1), mode_start_[i]);
+    }
+  }
+  return stages;
+}
+
 template <typename T>
 VectorX<Expression> HybridDircon<T>::SubstitutePlaceholderVariables(
     const VectorX<Expression>& f, int interval_index) const {
@@ -361,7 +417,8 @@ PiecewisePolynomial<double> HybridDircon<T>::ReconstructStateTrajectory(
       if (i > 0 && j == 0) {
         times(k) += +1e-6;
       }
-      VectorX<T> xk = result.GetSolution(state_vars_by_mode(i, j));
+      VectorX<T> xk = constraints_[i]->completeState(
+          result.GetSolution(state_vars_by_mode(i, j)));
       VectorX<T> uk = result.GetSolution(input(k_data));
       states.col(k) = drake::math::DiscardGradient(xk);
       inputs.col(k) = drake::math::DiscardGradient(uk);
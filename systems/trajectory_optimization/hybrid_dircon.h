@@ -32,6 +32,10 @@ namespace trajectory_optimization {
 /// achieve a 3rd order integration accuracy.
 /// DIRCON addresses kinematic constraints by incorporating constraint forces
 /// and corresponding acceleration, velocity, and position constraints.
+/// Loop closures can instead be eliminated by minimal coordinates (see
+/// DirconKinematicDataSet::setLoopClosures). The dependent coordinates of the
+/// state variables are then fixed, and ReconstructStateTrajectory computes
+/// them from the others.
 
 template <typename T>
 class HybridDircon
@@ -172,6 +176,14 @@ class HybridDircon
         num_kinematic_constraints_wo_skipping_[mode]);
   }
 
+  /// Knot point of each decision variable, in the order of
+  /// decision_variables(), for solvers exploiting the stage structure (see
+  /// solvers/structured_sqp.h). The variables of an interval (timestep,
+  /// collocation forces and slacks) belong to its first knot, the impact
+  /// variables to the knot of the impact, and the offset variables, shared by
+  /// all the knots of a mode, to none (-1).
+  std::vector<int> GetDecisionVariableStages() const;
+
   drake::VectorX<drake::symbolic::Expression> SubstitutePlaceholderVariables(
       const drake::VectorX<drake::symbolic::Expression>& f,
       int interval_index) const;
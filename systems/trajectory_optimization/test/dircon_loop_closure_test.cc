@@ -0,0 +1,209 @@
+#include <memory>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "examples/Cassie/cassie_utils.h"
+#include "multibody/multibody_utils.h"
+#include "systems/trajectory_optimization/dircon_distance_data.h"
+#include "systems/trajectory_optimization/dircon_kinematic_data_set.h"
+#include "systems/trajectory_optimization/dircon_opt_constraints.h"
+
+#include "drake/math/autodiff.h"
+#include "drake/math/autodiff_gradient.h"
+#include "drake/multibody/plant/multibody_plant.h"
+#include "drake/solvers/constraint.h"
+
+namespace dairlib {
+namespace {
+
+using drake::AutoDiffXd;
+using drake::VectorX;
+using drake::multibody::MultibodyPlant;
+using systems::trajectory_optimization::CompletedStateConstraint;
+using Eigen::MatrixXd;
+using Eigen::VectorXd;
+using std::vector;
+
+// The four-bar closures of the fixed-spring Cassie, as in run_dircon_walking
+template <typename T>
+vector<std::unique_ptr<DirconDistanceData<T>>> FourBars(
+    const MultibodyPlant<T>& plant) {
+  const double rod_length = 0.5012;
+  const Eigen::Vector3d pt_on_heel_spring(.11877, -.01, 0.0);
+  vector<std::unique_ptr<DirconDistanceData<T>>> closures;
+  closures.push_back(std::make_unique<DirconDistanceData<T>>(
+      plant, plant.GetBodyByName("thigh_left"), Eigen::Vector3d(0, 0, 0.045),
+      plant.GetBodyByName("heel_spring_left"), pt_on_heel_spring,
+      rod_length));
+  closures.push_back(std::make_unique<DirconDistanceData<T>>(
+      plant, plant.GetBodyByName("thigh_right"), Eigen::Vector3d(0, 0, -0.045),
+      plant.GetBodyByName("heel_spring_right"), pt_on_heel_spring,
+      rod_length));
+  return closures;
+}
+
+class DirconLoopClosureTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    plant_ = std::make_unique<MultibodyPlant<double>>(0.0);
+    addCassieMultibody(plant_.get(), nullptr, true,
+                       "examples/Cassie/urdf/cassie_fixed_springs.urdf",
+                       false, false);
+    plant_->Finalize();
+    n_q_ = plant_->num_positions();
+    n_v_ = plant_->num_velocities();
+
+    auto positions_map = multibody::makeNameToPositionsMap(*plant_);
+    auto velocities_map = multibody::makeNameToVelocitiesMap(*plant_);
+    dependent_positions_ = {positions_map.at("ankle_joint_left"),
+                            positions_map.at("ankle_joint_right")};
+    dependent_velocities_ = {velocities_map.at("ankle_joint_leftdot"),
+                             velocities_map.at("ankle_joint_rightdot")};
+
+    // Bent legs, with arbitrary (inconsistent) ankles
+    std::srand(0);
+    x_ = VectorXd::Random(n_q_ + n_v_);
+    x_.head(4) << 1, 0, 0, 0;
+    for (const std::string side : {"_left", "_right"}) {
+      x_(positions_map.at("hip_pitch" + side)) = 0.9;
+      x_(positions_map.at("knee" + side)) = -1.4;
+      x_(positions_map.at("toe" + side)) = -1.6;
+    }
+  }
+
+  std::unique_ptr<MultibodyPlant<double>> plant_;
+  int n_q_;
+  int n_v_;
+  vector<int> dependent_positions_;
+  vector<int> dependent_velocities_;
+  VectorXd x_;
+};
+
+TEST_F(DirconLoopClosureTest, CompleteState) {
+  auto closures = FourBars(*plant_);
+  vector<DirconKinematicData<double>*> closure_list{closures[0].get(),
+                                                    closures[1].get()};
+  vector<DirconKinematicData<double>*> contacts;
+  DirconKinematicDataSet<double> dataset(*plant_, &contacts);
+  dataset.setLoopClosures(&closure_list, dependent_positions_,
+                          dependent_velocities_, Eigen::Vector2d(1.6, 1.6));
+
+  const VectorXd x = dataset.completeState(x_);
+  auto context = multibody::createContext(
+      *plant_, x, VectorXd::Zero(plant_->num_actuators()));
+  for (auto closure : closure_list) {
+    closure->updateConstraint(*context);
+    EXPECT_LT(std::abs(closure->getC()(0)), 1e-10);
+    EXPECT_LT(std::abs(closure->getCDot()(0)), 1e-10);
+  }
+  // Only the dependent coordinates change
+  VectorXd dx = x - x_;
+  for (int i : dependent_positions_) dx(i) = 0;
+  for (int i : dependent_velocities_) dx(n_q_ + i) = 0;
+  EXPECT_EQ(dx.norm(), 0);
+}
+
+TEST_F(DirconLoopClosureTest, ConstrainedDynamics) {
+  auto closures = FourBars(*plant_);
+  vector<DirconKinematicData<double>*> closure_list{closures[0].get(),
+                                                    closures[1].get()};
+  vector<DirconKinematicData<double>*> contacts;
+  DirconKinematicDataSet<double> minimal(*plant_, &contacts);
+  minimal.setLoopClosures(&closure_list, dependent_positions_,
+                          dependent_velocities_, Eigen::Vector2d(1.6, 1.6));
+  DirconKinematicDataSet<double> constrained(*plant_, &closure_list);
+
+  const VectorXd x = minimal.completeState(x_);
+  const VectorXd u = VectorXd::Random(plant_->num_actuators());
+  auto context = multibody::createContext(*plant_, x, u);
+  minimal.updateData(*context, VectorXd::Zero(0));
+  const VectorXd vdot = minimal.getVDot();
+
+  // The closure accelerations are affine in the closure forces of the
+  // constrained formulation, whose forces with zero accelerations give the
+  // same dynamics
+  constrained.updateData(*context, VectorXd::Zero(2));
+  const VectorXd cddot_0 = constrained.getCDDot();
+  MatrixXd A(2, 2);
+  for (int i = 0; i < 2; i++) {
+    constrained.updateData(*context, VectorXd::Unit(2, i));
+    A.col(i) = constrained.getCDDot() - cddot_0;
+  }
+  const VectorXd lambda = A.lu().solve(-cddot_0);
+  constrained.updateData(*context, lambda);
+  EXPECT_TRUE(vdot.isApprox(constrained.getVDot(), 1e-8));
+}
+
+TEST_F(DirconLoopClosureTest, CompletedStateConstraint) {
+  auto closures = FourBars(*plant_);
+  vector<DirconKinematicData<double>*> closure_list{closures[0].get(),
+                                                    closures[1].get()};
+  vector<DirconKinematicData<double>*> contacts;
+  DirconKinematicDataSet<double> dataset(*plant_, &contacts);
+  dataset.setLoopClosures(&closure_list, dependent_positions_,
+                          dependent_velocities_, Eigen::Vector2d(1.6, 1.6));
+  const VectorXd x = dataset.completeState(x_);
+
+  // Ankle positions against bounds, and the ankle velocity of the complete
+  // state equal to an extra variable
+  CompletedStateConstraint<double> limits(
+      *plant_, &dataset, dependent_positions_,
+      std::make_shared<drake::solvers::BoundingBoxConstraint>(
+          VectorXd::Zero(2), VectorXd::Ones(2)));
+  EXPECT_EQ(limits.num_vars(), n_q_ + n_v_);
+  EXPECT_TRUE(limits.lower_bound().isZero());
+  VectorXd y;
+  limits.Eval(x_, &y);
+  EXPECT_EQ(y(0), x(dependent_positions_[0]));
+  EXPECT_EQ(y(1), x(dependent_positions_[1]));
+
+  MatrixXd A(1, 2);
+  A << 1, -1;
+  CompletedStateConstraint<double> velocity(
+      *plant_, &dataset, {n_q_ + dependent_velocities_[0]},
+      std::make_shared<drake::solvers::LinearEqualityConstraint>(
+          A, VectorXd::Zero(1)));
+  EXPECT_EQ(velocity.num_vars(), n_q_ + n_v_ + 1);
+  VectorXd x_and_v(n_q_ + n_v_ + 1);
+  x_and_v << x_, 0.3;
+  velocity.Eval(x_and_v, &y);
+  EXPECT_NEAR(y(0), x(n_q_ + dependent_velocities_[0]) - 0.3, 1e-12);
+}
+
+TEST_F(DirconLoopClosureTest, Gradient) {
+  auto plant_ad = drake::systems::System<double>::ToAutoDiffXd(*plant_);
+  auto closures = FourBars(*plant_ad);
+  vector<DirconKinematicData<AutoDiffXd>*> closure_list{closures[0].get(),
+                                                        closures[1].get()};
+  vector<DirconKinematicData<AutoDiffXd>*> contacts;
+  DirconKinematicDataSet<AutoDiffXd> dataset(*plant_ad, &contacts);
+  dataset.setLoopClosures(&closure_list, dependent_positions_,
+                          dependent_velocities_, Eigen::Vector2d(1.6, 1.6));
+
+  const VectorX<AutoDiffXd> x = dataset.completeState(
+      drake::math::initializeAutoDiff(x_));
+  const MatrixXd gradient = drake::math::autoDiffToGradientMatrix(x);
+
+  // Central differences
+  const double eps = 1e-6;
+  MatrixXd numerical_gradient(x_.size(), x_.size());
+  for (int i = 0; i < x_.size(); i++) {
+    const VectorXd dx = eps * VectorXd::Unit(x_.size(), i);
+    numerical_gradient.col(i) =
+        (drake::math::autoDiffToValueMatrix(dataset.completeState(
+             drake::math::initializeAutoDiff(VectorXd(x_ + dx)))) -
+         drake::math::autoDiffToValueMatrix(dataset.completeState(
+             drake::math::initializeAutoDiff(VectorXd(x_ - dx))))) /
+        (2 * eps);
+  }
+  EXPECT_LT((gradient - numerical_gradient).lpNorm<Eigen::Infinity>(), 1e-6);
+}
+
+}  // namespace
+}  // namespace dairlib
+
+int main(int argc, char** argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
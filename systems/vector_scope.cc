@@ -1,3 +1,5 @@
+#include <sstream>
+
 #include "drake/systems/framework/basic_vector.h"
 #include "drake/systems/framework/diagram_builder.h"
 #include "drake/systems/framework/leaf_system.h"
@@ -24,18 +26,28 @@ using drake::systems::EventStatus;
   @param debug      Message the message that's printed out before the number
   @param message    Rate the rate at which messages are printed
 
+  Messages go through an AsyncDebugSink, so the publish event only formats
+  the vector and never waits on the terminal.
+
 */
-VectorScope::VectorScope(int size, std::string debugMessage, double publishRate)
-    : msg_(debugMessage) {
+VectorScope::VectorScope(int size, std::string debugMessage, double publishRate,
+                         double min_print_period, AsyncDebugSink* sink)
+    : msg_(debugMessage),
+      sink_(sink ? sink : &AsyncDebugSink::Default()),
+      print_limiter_(min_print_period) {
 
     this->DeclareVectorInputPort("debug: ", BasicVector<double>(size));
     this->DeclarePeriodicPublishEvent(publishRate, 0.0, &VectorScope::PrintOutput);
 }
 
 EventStatus VectorScope::PrintOutput(const Context<double>& context) const {
+    if (!print_limiter_.Ready()) {
+      return EventStatus::DidNothing();
+    }
     auto val = this->EvalVectorInput(context, 0)->get_value();
-    std::cout << msg_ << std::endl;
-    std::cout << val << std::endl;
+    std::ostringstream out;
+    out << msg_ << "\n" << val;
+    sink_->Log(out.str());
     return EventStatus::Succeeded();
 }
 
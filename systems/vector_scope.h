@@ -1,5 +1,10 @@
 #pragma once
 
+#include <string>
+
+#include "drake/systems/framework/leaf_system.h"
+#include "common/async_debug_sink.h"
+
 namespace dairlib {
 namespace systems {
 
@@ -9,10 +14,20 @@ using drake::systems::EventStatus;
 
 class VectorScope : public drake::systems::LeafSystem<double> {
  public:
-  VectorScope(int size, std::string debugMessage, double publishRate);
+  /// @param size Size of the input vector
+  /// @param debugMessage the message that's printed out before the vector
+  /// @param publishRate the (simulation time) period of the printing
+  /// @param min_print_period minimum wall-clock time between prints, in
+  ///   seconds. Default = 0 (no rate limiting)
+  /// @param sink where to print. Printing never blocks the calling thread.
+  ///   Default = AsyncDebugSink::Default(), which writes to std::cout
+  VectorScope(int size, std::string debugMessage, double publishRate,
+              double min_print_period = 0, AsyncDebugSink* sink = nullptr);
 
  private:
   const std::string msg_;
+  AsyncDebugSink* sink_;
+  DebugRateLimiter print_limiter_;
 
   EventStatus PrintOutput(const Context<double>& context) const;
 